@@ -216,17 +216,29 @@ function deferredRenderPass.setup(pTknGfxContext, assetsPath, renderPassIndex, p
     }}
     tkn.tknUpdateMaterialPtr(pTknGfxContext, deferredRenderPass.pLightingSubpassMaterial, lightingInputBindings)
 
-    local pipelineIndex = 0
-    deferredRenderPass.pGeometryPipeline = geometryPipeline.createPipelinePtr(pTknGfxContext, deferredRenderPass.pTknRenderPass, pipelineIndex, assetsPath, deferredRenderPass.pVoxelVertexInputLayout, deferredRenderPass.pInstanceVertexInputLayout)
-    pipelineIndex = pipelineIndex + 1
-    deferredRenderPass.pLightingPipeline = lightingPipeline.createPipelinePtr(pTknGfxContext, deferredRenderPass.pTknRenderPass, pipelineIndex, assetsPath)
+    -- Both pipelines compile in parallel
+    local pipelinePtrs = tkn.tknCreatePipelinesPtr(pTknGfxContext, {
+        geometryPipeline.getCreateArguments(deferredRenderPass.pTknRenderPass, 0, assetsPath, deferredRenderPass.pVoxelVertexInputLayout, deferredRenderPass.pInstanceVertexInputLayout),
+        lightingPipeline.getCreateArguments(deferredRenderPass.pTknRenderPass, 1, assetsPath),
+    })
+    deferredRenderPass.pGeometryPipeline = pipelinePtrs[1]
+    deferredRenderPass.pLightingPipeline = pipelinePtrs[2]
     deferredRenderPass.pGeometryMaterial = tkn.tknCreatePipelineMaterialPtr(pTknGfxContext, deferredRenderPass.pGeometryPipeline)
     deferredRenderPass.pLightingMaterial = tkn.tknCreatePipelineMaterialPtr(pTknGfxContext, deferredRenderPass.pLightingPipeline)
 
     deferredRenderPass.pLightingDrawCall = tkn.tknCreateDrawCallPtr(pTknGfxContext, deferredRenderPass.pLightingPipeline, deferredRenderPass.pLightingMaterial, nil, nil)
+
+    -- Geometry draws are collected during the frame and recorded sorted by state in one call
+    deferredRenderPass.pGeometryDrawQueue = tkn.tknCreateDrawQueuePtr(pTknGfxContext)
+    deferredRenderPass.geometryDrawQueueEntries = {}
+    deferredRenderPass.geometryDrawQueueEntryCount = 0
 end
 
 function deferredRenderPass.teardown(pTknGfxContext)
+    tkn.tknDestroyDrawQueuePtr(pTknGfxContext, deferredRenderPass.pGeometryDrawQueue)
+    deferredRenderPass.pGeometryDrawQueue = nil
+    deferredRenderPass.geometryDrawQueueEntries = nil
+    deferredRenderPass.geometryDrawQueueEntryCount = nil
     tkn.tknDestroyDrawCallPtr(pTknGfxContext, deferredRenderPass.pLightingDrawCall)
 
     geometryPipeline.destroyPipelinePtr(pTknGfxContext, deferredRenderPass.pGeometryPipeline)
@@ -259,4 +271,19 @@ function deferredRenderPass.teardown(pTknGfxContext)
     deferredRenderPass.pVoxelVertexInputLayout = nil
 end
 
+-- sortKey comes from tkn.tknGetDrawCallSortKey, it only changes with the draw call's state so callers can keep it
+function deferredRenderPass.pushGeometryDrawCall(pTknDrawCall, sortKey)
+    local entries = deferredRenderPass.geometryDrawQueueEntries
+    local entryCount = deferredRenderPass.geometryDrawQueueEntryCount
+    entries[entryCount * 3 + 1] = sortKey
+    entries[entryCount * 3 + 2] = pTknDrawCall
+    entries[entryCount * 3 + 3] = false
+    deferredRenderPass.geometryDrawQueueEntryCount = entryCount + 1
+end
+
+function deferredRenderPass.recordGeometryDrawQueue(pTknGfxContext, pTknFrame)
+    tkn.tknRecordDrawQueuePtr(pTknGfxContext, pTknFrame, deferredRenderPass.pGeometryDrawQueue, deferredRenderPass.geometryDrawQueueEntries, deferredRenderPass.geometryDrawQueueEntryCount)
+    deferredRenderPass.geometryDrawQueueEntryCount = 0
+end
+
 return deferredRenderPass
@@ -1,7 +1,8 @@
 local vulkan = require("vulkan")
 local tkn = require("tkn")
 local geometryPipeline = {}
-function geometryPipeline.createPipelinePtr(pTknGfxContext, pTknRenderPass, subpassIndex, assetsPath, pTknMeshVertexInputLayout, pInstanceVertexInputLayout)
+-- Arguments of tkn.tknCreatePipelinePtr after the context, batch them with tkn.tknCreatePipelinesPtr
+function geometryPipeline.getCreateArguments(pTknRenderPass, subpassIndex, assetsPath, pTknMeshVertexInputLayout, pInstanceVertexInputLayout)
     local geometryPipelineSpvPaths = {assetsPath .. "/shaders/opaqueGeometry.vert.spv", assetsPath .. "/shaders/opaqueGeometry.frag.spv"}
     local vkPipelineInputAssemblyStateCreateInfo = {
         topology = vulkan.VK_PRIMITIVE_TOPOLOGY_POINT_LIST,
@@ -42,7 +43,7 @@ function geometryPipeline.createPipelinePtr(pTknGfxContext, pTknRenderPass, subp
         blendConstants = {0.0, 0.0, 0.0, 0.0},
     }
 
-    return tkn.tknCreatePipelinePtr(pTknGfxContext, pTknRenderPass, subpassIndex, geometryPipelineSpvPaths, pTknMeshVertexInputLayout, pInstanceVertexInputLayout, vkPipelineInputAssemblyStateCreateInfo, tkn.defaultVkPipelineViewportStateCreateInfo, tkn.defaultVkPipelineRasterizationStateCreateInfo, tkn.defaultVkPipelineMultisampleStateCreateInfo, vkPipelineDepthStencilStateCreateInfo, vkPipelineColorBlendStateCreateInfo, tkn.defaultVkPipelineDynamicStateCreateInfo)
+    return {pTknRenderPass, subpassIndex, geometryPipelineSpvPaths, pTknMeshVertexInputLayout, pInstanceVertexInputLayout, vkPipelineInputAssemblyStateCreateInfo, tkn.defaultVkPipelineViewportStateCreateInfo, tkn.defaultVkPipelineRasterizationStateCreateInfo, tkn.defaultVkPipelineMultisampleStateCreateInfo, vkPipelineDepthStencilStateCreateInfo, vkPipelineColorBlendStateCreateInfo, tkn.defaultVkPipelineDynamicStateCreateInfo}
 end
 
 function geometryPipeline.destroyPipelinePtr(pTknGfxContext, pTknPipeline)
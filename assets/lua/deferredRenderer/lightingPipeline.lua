@@ -1,7 +1,8 @@
 local vulkan = require("vulkan")
 local tkn = require("tkn")
 local lightingPipeline = {}
-function lightingPipeline.createPipelinePtr(pTknGfxContext, pTknRenderPass, subpassIndex, assetsPath)
+-- Arguments of tkn.tknCreatePipelinePtr after the context, batch them with tkn.tknCreatePipelinesPtr
+function lightingPipeline.getCreateArguments(pTknRenderPass, subpassIndex, assetsPath)
     local lightingPipelineSpvPaths = {assetsPath .. "/shaders/opaqueLighting.vert.spv", assetsPath .. "/shaders/opaqueLighting.frag.spv"}
 
     local vkPipelineInputAssemblyStateCreateInfo = {
@@ -35,7 +36,7 @@ function lightingPipeline.createPipelinePtr(pTknGfxContext, pTknRenderPass, subp
         blendConstants = {0.0, 0.0, 0.0, 0.0},
     }
 
-    return tkn.tknCreatePipelinePtr(pTknGfxContext, pTknRenderPass, subpassIndex, lightingPipelineSpvPaths, nil, nil, vkPipelineInputAssemblyStateCreateInfo, tkn.defaultVkPipelineViewportStateCreateInfo, tkn.defaultVkPipelineRasterizationStateCreateInfo, tkn.defaultVkPipelineMultisampleStateCreateInfo, vkPipelineDepthStencilStateCreateInfo, vkPipelineColorBlendStateCreateInfo, tkn.defaultVkPipelineDynamicStateCreateInfo)
+    return {pTknRenderPass, subpassIndex, lightingPipelineSpvPaths, nil, nil, vkPipelineInputAssemblyStateCreateInfo, tkn.defaultVkPipelineViewportStateCreateInfo, tkn.defaultVkPipelineRasterizationStateCreateInfo, tkn.defaultVkPipelineMultisampleStateCreateInfo, vkPipelineDepthStencilStateCreateInfo, vkPipelineColorBlendStateCreateInfo, tkn.defaultVkPipelineDynamicStateCreateInfo}
 end
 
 function lightingPipeline.destroyPipelinePtr(pTknGfxContext, pTknRenderPass)
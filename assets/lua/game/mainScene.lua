@@ -21,6 +21,7 @@ function mainScene.start(game, pTknGfxContext)
     mapSystem.generateRoom(321312, 16, 16, game.voxelPerMeter)
     print("Generated map with " .. #mapSystem.groundMap .. "x" .. #mapSystem.groundMap[1] .. " tiles")
     mainScene.pTknMesh, mainScene.pTknInstance, mainScene.pTknDrawCall = mapSystem.createMesh(pTknGfxContext)
+    mainScene.sortKey = tkn.tknGetDrawCallSortKey(mainScene.pTknDrawCall, 0, 0)
 
     mainScene.rockWallCount = 0
     mainScene.pRockWallMesh = nil
@@ -58,6 +59,7 @@ function mainScene.start(game, pTknGfxContext)
             model = models,
         })
         mainScene.pRockWallDrawCall = tkn.tknCreateDrawCallPtr(pTknGfxContext, deferredRenderPass.pGeometryPipeline, deferredRenderPass.pGeometryMaterial, mainScene.pRockWallMesh, mainScene.pRockWallInstance)
+        mainScene.rockWallSortKey = tkn.tknGetDrawCallSortKey(mainScene.pRockWallDrawCall, 0, 0)
         mainScene.rockWallCount = count
     end
     print("Loaded random rockWalls: " .. tostring(mainScene.rockWallCount))
@@ -70,10 +72,12 @@ end
 function mainScene.stopGfx(game, pTknGfxContext)
 
     mapSystem.destroyMesh(pTknGfxContext, mainScene.pTknMesh, mainScene.pTknInstance, mainScene.pTknDrawCall)
+    mainScene.sortKey = nil
 
     if mainScene.pRockWallDrawCall then
         tkn.tknDestroyDrawCallPtr(pTknGfxContext, mainScene.pRockWallDrawCall)
         mainScene.pRockWallDrawCall = nil
+        mainScene.rockWallSortKey = nil
     end
 
     if mainScene.pRockWallInstance then
@@ -100,10 +104,10 @@ function mainScene.updateGfx(game, pTknGfxContext, width, height)
 end
 
 function mainScene.recordFrame(game, pTknGfxContext, pTknFrame)
-    -- Main scene rendering logic here
-    tkn.tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, mainScene.pTknDrawCall)
+    -- Main scene rendering logic here, the geometry subpass records the pushed draws sorted by state
+    deferredRenderPass.pushGeometryDrawCall(mainScene.pTknDrawCall, mainScene.sortKey)
     if mainScene.pRockWallDrawCall then
-        tkn.tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, mainScene.pRockWallDrawCall)
+        deferredRenderPass.pushGeometryDrawCall(mainScene.pRockWallDrawCall, mainScene.rockWallSortKey)
     end
 end
 
@@ -345,7 +345,8 @@ function mapSystem.createMesh(pTknGfxContext)
         end
     end
     print(tknMath.minN, tknMath.maxN, "!@!#!")
-    local pTknMesh = tkn.tknCreateMeshPtrWithData(pTknGfxContext, deferredRenderPass.pVoxelVertexInputLayout, deferredRenderPass.vertexFormat, vertices, nil, nil)
+    -- Draw calls skip the mesh until the transfer queue is done with it
+    local pTknMesh = tkn.tknUploadMeshAsync(pTknGfxContext, deferredRenderPass.pVoxelVertexInputLayout, deferredRenderPass.vertexFormat, vertices, nil, nil)
 
     local scale = 1.0 / mapSystem.voxelPerMeter
     local pTknInstance = tkn.tknCreateInstancePtr(pTknGfxContext, deferredRenderPass.pInstanceVertexInputLayout, deferredRenderPass.instanceFormat, {
@@ -0,0 +1,85 @@
+local vulkan = require("vulkan")
+local tkn = require("tkn")
+-- A compute pass splits the instances of a non-indexed draw call into indirect commands and writes the draw count
+local indirectCommands = {}
+local localSizeX = 64
+-- VkDrawIndirectCommand
+local commandSize = 16
+
+indirectCommands.pushConstantsFormat = {{
+    name = "vertexCount",
+    type = tkn.type.uint32,
+    count = 1,
+}, {
+    name = "instanceCount",
+    type = tkn.type.uint32,
+    count = 1,
+}, {
+    name = "instancesPerDraw",
+    type = tkn.type.uint32,
+    count = 1,
+}, {
+    name = "maxDrawCount",
+    type = tkn.type.uint32,
+    count = 1,
+}}
+
+function indirectCommands.create(pTknGfxContext, assetsPath, maxDrawCount)
+    local self = {
+        maxDrawCount = maxDrawCount,
+    }
+    self.pTknComputePipeline = tkn.tknCreateComputePipelinePtr(pTknGfxContext, assetsPath .. "/shaders/indirectCommands.comp.spv")
+    self.pTknMaterial = tkn.tknCreateComputeMaterialPtr(pTknGfxContext, self.pTknComputePipeline)
+    self.pCommandTknStorageBuffer = tkn.tknCreateStorageBufferPtr(pTknGfxContext, nil, maxDrawCount * commandSize)
+    self.pCountTknStorageBuffer = tkn.tknCreateStorageBufferPtr(pTknGfxContext, nil, 4)
+    local inputBindings = {{
+        vkDescriptorType = vulkan.VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        pTknStorageBuffer = self.pCommandTknStorageBuffer,
+        binding = 0,
+    }, {
+        vkDescriptorType = vulkan.VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        pTknStorageBuffer = self.pCountTknStorageBuffer,
+        binding = 1,
+    }}
+    tkn.tknUpdateMaterialPtr(pTknGfxContext, self.pTknMaterial, inputBindings)
+    return self
+end
+
+-- The draw call's pipeline must not use a mesh with indices, its commands are VkDrawIndirectCommand
+function indirectCommands.attach(pTknGfxContext, self, pTknDrawCall)
+    local pCountTknStorageBuffer = nil
+    if tkn.tknIsDrawIndirectCountSupported(pTknGfxContext) then
+        pCountTknStorageBuffer = self.pCountTknStorageBuffer
+    end
+    tkn.tknSetDrawCallIndirectStorage(pTknGfxContext, pTknDrawCall, self.pCommandTknStorageBuffer, 1, self.maxDrawCount, pCountTknStorageBuffer)
+end
+
+function indirectCommands.detach(pTknGfxContext, pTknDrawCall)
+    tkn.tknSetDrawCallIndirectStorage(pTknGfxContext, pTknDrawCall, nil, nil, nil, nil)
+end
+
+-- Records outside any render pass, before the pass that draws the attached draw calls
+function indirectCommands.record(pTknGfxContext, pTknFrame, self, vertexCount, instanceCount, instancesPerDraw)
+    -- The previous frame's draws read the same buffers
+    tkn.tknBufferBarrier(pTknGfxContext, pTknFrame, self.pCommandTknStorageBuffer, vulkan.VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, vulkan.VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0)
+    tkn.tknBufferBarrier(pTknGfxContext, pTknFrame, self.pCountTknStorageBuffer, vulkan.VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, vulkan.VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0)
+    local pushConstants = {
+        vertexCount = vertexCount,
+        instanceCount = instanceCount,
+        instancesPerDraw = instancesPerDraw,
+        maxDrawCount = self.maxDrawCount,
+    }
+    local groupCountX = (self.maxDrawCount + localSizeX - 1) // localSizeX
+    tkn.tknDispatch(pTknGfxContext, pTknFrame, self.pTknComputePipeline, self.pTknMaterial, groupCountX, 1, 1, indirectCommands.pushConstantsFormat, pushConstants)
+    tkn.tknBufferBarrier(pTknGfxContext, pTknFrame, self.pCommandTknStorageBuffer, vulkan.VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, vulkan.VK_ACCESS_SHADER_WRITE_BIT, vulkan.VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, vulkan.VK_ACCESS_INDIRECT_COMMAND_READ_BIT)
+    tkn.tknBufferBarrier(pTknGfxContext, pTknFrame, self.pCountTknStorageBuffer, vulkan.VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, vulkan.VK_ACCESS_SHADER_WRITE_BIT, vulkan.VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, vulkan.VK_ACCESS_INDIRECT_COMMAND_READ_BIT)
+end
+
+-- Draw calls must be detached first
+function indirectCommands.destroy(pTknGfxContext, self)
+    tkn.tknDestroyStorageBufferPtr(pTknGfxContext, self.pCountTknStorageBuffer)
+    tkn.tknDestroyStorageBufferPtr(pTknGfxContext, self.pCommandTknStorageBuffer)
+    tkn.tknDestroyComputePipelinePtr(pTknGfxContext, self.pTknComputePipeline)
+end
+
+return indirectCommands
@@ -85,6 +85,32 @@ function tkn.tknCreateImagePtrWithPath(tknContext, path)
     end
 end
 
+-- Same as tknCreateImagePtrWithPath but the copy runs on the transfer queue, sample the image only once the ticket completes
+function tkn.tknCreateImagePtrWithPathAsync(tknContext, path)
+    local astcFile = io.open(path, "rb")
+    if astcFile then
+        local content = astcFile:read("*all")
+        astcFile:close()
+        local pASTC, data, width, height, vkFormat, size = tkn.tknCreateASTCFromMemory(content)
+        if pASTC then
+            local vkExtent3D = {
+                width = width,
+                height = height,
+                depth = 1,
+            }
+            local pTknImage, ticket = tkn.tknUploadImageAsync(tknContext, vkExtent3D, vkFormat, vulkan.VK_IMAGE_USAGE_TEXTURE_BIT, vulkan.VK_IMAGE_ASPECT_COLOR_BIT, data)
+            tkn.tknDestroyASTCImage(pASTC)
+            return pTknImage, width, height, ticket
+        else
+            print("Failed to create ASTC image from file: " .. path)
+            return nil
+        end
+    else
+        print("Failed to open ASTC file: " .. path)
+        return nil
+    end
+end
+
 -- Creates a mesh with default zero-initialized vertex and index data
 function tkn.tknCreateDefaultMeshPtr(pTknGfxContext, format, pTknMeshVertexInputLayout, vertexCount, indexType, indexCount)
     local vertices = {}
@@ -230,6 +256,26 @@ if not tkn.tknCreatePipelinePtr then
     end
 end
 
+if not tkn.tknCreatePipelinesPtr then
+    ---Create several graphics pipelines in parallel, blocks until all of them are ready
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param createArgumentsArray table Array of argument lists, each laid out like tknCreatePipelinePtr's arguments after pTknGfxContext
+    ---@return table Array of TknPipeline pointers in the same order
+    function tkn.tknCreatePipelinesPtr(pTknGfxContext, createArgumentsArray)
+        error("tkn.tknCreatePipelinesPtr: C binding not loaded")
+    end
+end
+
+if not tkn.tknReloadShaderReflection then
+    ---Reread a compiled shader for hot reload, pipelines created afterwards use the new code
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param spvPath string Path of the compiled shader
+    ---@return boolean Whether the file contents changed
+    function tkn.tknReloadShaderReflection(pTknGfxContext, spvPath)
+        error("tkn.tknReloadShaderReflection: C binding not loaded")
+    end
+end
+
 if not tkn.tknDestroyPipelinePtr then
     ---Destroy a graphics pipeline
     ---@param pTknGfxContext lightuserdata Graphics context pointer
@@ -239,6 +285,25 @@ if not tkn.tknDestroyPipelinePtr then
     end
 end
 
+if not tkn.tknCreateComputePipelinePtr then
+    ---Create a compute pipeline, its set 2 comes from the shader reflection and set 1 stays empty
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param spvPath string Compute shader SPIR-V path
+    ---@return lightuserdata TknComputePipeline pointer
+    function tkn.tknCreateComputePipelinePtr(pTknGfxContext, spvPath)
+        error("tkn.tknCreateComputePipelinePtr: C binding not loaded")
+    end
+end
+
+if not tkn.tknDestroyComputePipelinePtr then
+    ---Destroy a compute pipeline and its materials
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknComputePipeline lightuserdata TknComputePipeline pointer
+    function tkn.tknDestroyComputePipelinePtr(pTknGfxContext, pTknComputePipeline)
+        error("tkn.tknDestroyComputePipelinePtr: C binding not loaded")
+    end
+end
+
 if not tkn.tknCreateDrawCallPtr then
     ---Create a draw call combining pipeline, material, mesh, and instance data
     ---@param pTknGfxContext lightuserdata Graphics context pointer
@@ -261,11 +326,156 @@ if not tkn.tknDestroyDrawCallPtr then
     end
 end
 
+if not tkn.tknSetDrawCallDynamicOffsets then
+    ---Set the byte offsets a draw call binds its material's dynamic buffers at, in binding order
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknDrawCall lightuserdata TknDrawCall pointer
+    ---@param offsets table One offset per dynamic binding of the material, from tknGetDynamicBufferOffset
+    function tkn.tknSetDrawCallDynamicOffsets(pTknGfxContext, pTknDrawCall, offsets)
+        error("tkn.tknSetDrawCallDynamicOffsets: C binding not loaded")
+    end
+end
+
+if not tkn.tknSetDrawCallPushConstants then
+    ---Set the push constants a draw call pushes before it is drawn, packed from the start of the pipeline's push constant block
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknDrawCall lightuserdata TknDrawCall pointer
+    ---@param format table|userdata Field layout descriptors or a compiled layout
+    ---@param buffer table|userdata Data table with named arrays, or a buffer from tknNewBuffer
+    function tkn.tknSetDrawCallPushConstants(pTknGfxContext, pTknDrawCall, format, buffer)
+        error("tkn.tknSetDrawCallPushConstants: C binding not loaded")
+    end
+end
+
+if not tkn.tknSetDrawCallIndirect then
+    ---Draw from indirect commands in a storage dynamic buffer, one element per command: indexCount, instanceCount, firstIndex, vertexOffset, firstInstance for indexed meshes, vertexCount, instanceCount, firstVertex, firstInstance otherwise
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknDrawCall lightuserdata TknDrawCall pointer
+    ---@param pCommandTknDynamicBuffer lightuserdata|nil TknDynamicBuffer pointer, nil goes back to direct draws
+    ---@param firstCommand integer|nil 1-based index of the first command
+    ---@param maxDrawCount integer|nil Commands drawn, or the cap when a count buffer is used
+    ---@param pCountTknDynamicBuffer lightuserdata|nil TknDynamicBuffer pointer of one uint32 draw count, only allowed when tknIsDrawIndirectCountSupported
+    function tkn.tknSetDrawCallIndirect(pTknGfxContext, pTknDrawCall, pCommandTknDynamicBuffer, firstCommand, maxDrawCount, pCountTknDynamicBuffer)
+        error("tkn.tknSetDrawCallIndirect: C binding not loaded")
+    end
+end
+
+if not tkn.tknSetDrawCallIndirectStorage then
+    ---Draw from indirect commands a compute pass writes, tightly packed in a storage buffer with the same fields as tknSetDrawCallIndirect. Order the writes with tknBufferBarrier before the render pass
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknDrawCall lightuserdata TknDrawCall pointer
+    ---@param pCommandTknStorageBuffer lightuserdata|nil TknStorageBuffer pointer, nil goes back to direct draws
+    ---@param firstCommand integer|nil 1-based index of the first command
+    ---@param maxDrawCount integer|nil Commands drawn, or the cap when a count buffer is used
+    ---@param pCountTknStorageBuffer lightuserdata|nil TknStorageBuffer pointer whose first uint32 is the draw count, only allowed when tknIsDrawIndirectCountSupported
+    function tkn.tknSetDrawCallIndirectStorage(pTknGfxContext, pTknDrawCall, pCommandTknStorageBuffer, firstCommand, maxDrawCount, pCountTknStorageBuffer)
+        error("tkn.tknSetDrawCallIndirectStorage: C binding not loaded")
+    end
+end
+
+if not tkn.tknIsDrawIndirectCountSupported then
+    ---Whether indirect draws read their draw count from a buffer
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@return boolean
+    function tkn.tknIsDrawIndirectCountSupported(pTknGfxContext)
+        error("tkn.tknIsDrawIndirectCountSupported: C binding not loaded")
+    end
+end
+
+if not tkn.tknDispatch then
+    ---Record a compute dispatch outside any render pass
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknFrame lightuserdata Frame pointer
+    ---@param pTknComputePipeline lightuserdata TknComputePipeline pointer
+    ---@param pTknMaterial lightuserdata TknMaterial pointer from tknCreateComputeMaterialPtr
+    ---@param groupCountX integer Workgroups in x
+    ---@param groupCountY integer Workgroups in y
+    ---@param groupCountZ integer Workgroups in z
+    ---@param format table|userdata|nil Push constant layout matching the shader's block, nil when it declares none
+    ---@param buffer table|userdata|nil Push constant data
+    function tkn.tknDispatch(pTknGfxContext, pTknFrame, pTknComputePipeline, pTknMaterial, groupCountX, groupCountY, groupCountZ, format, buffer)
+        error("tkn.tknDispatch: C binding not loaded")
+    end
+end
+
+if not tkn.tknBufferBarrier then
+    ---Order accesses to a whole storage buffer, outside any render pass
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknFrame lightuserdata Frame pointer
+    ---@param pTknStorageBuffer lightuserdata TknStorageBuffer pointer
+    ---@param srcVkPipelineStageFlags integer Stages that wrote the buffer
+    ---@param srcVkAccessFlags integer Accesses to make available
+    ---@param dstVkPipelineStageFlags integer Stages that read it next
+    ---@param dstVkAccessFlags integer Accesses that wait
+    function tkn.tknBufferBarrier(pTknGfxContext, pTknFrame, pTknStorageBuffer, srcVkPipelineStageFlags, srcVkAccessFlags, dstVkPipelineStageFlags, dstVkAccessFlags)
+        error("tkn.tknBufferBarrier: C binding not loaded")
+    end
+end
+
+if not tkn.tknImageBarrier then
+    ---Order accesses to a whole image without changing its layout, outside any render pass
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknFrame lightuserdata Frame pointer
+    ---@param pTknImage lightuserdata TknImage pointer
+    ---@param srcVkPipelineStageFlags integer Stages that wrote the image
+    ---@param srcVkAccessFlags integer Accesses to make available
+    ---@param dstVkPipelineStageFlags integer Stages that read it next
+    ---@param dstVkAccessFlags integer Accesses that wait
+    function tkn.tknImageBarrier(pTknGfxContext, pTknFrame, pTknImage, srcVkPipelineStageFlags, srcVkAccessFlags, dstVkPipelineStageFlags, dstVkAccessFlags)
+        error("tkn.tknImageBarrier: C binding not loaded")
+    end
+end
+
+if not tkn.tknCompileLayout then
+    ---Compile a format table into the layout the data packers use. Format tables passed to the packers are compiled and cached on first use, so they must not change afterwards
+    ---@param format table Field layout descriptors
+    ---@return userdata compiledLayout Accepted wherever a format is packed, not by tknCreateVertexInputLayoutPtr
+    function tkn.tknCompileLayout(format)
+        error("tkn.tknCompileLayout: C binding not loaded")
+    end
+end
+
+if not tkn.tknNewBuffer then
+    ---Create a native buffer of zeroed elements packed with a format, collected with its last reference.
+    ---The packers take it in place of a data table and copy it as is, a nil format uses its own.
+    ---buffer:set(index, name, ...) writes one element's field from values or a table, buffer:get(index, name) returns them,
+    ---buffer:setField(name, values) writes every element from a flat array or one number, #buffer is the element count
+    ---@param format table|userdata Field layout descriptors or a compiled layout
+    ---@param count integer Element count
+    ---@return userdata buffer
+    function tkn.tknNewBuffer(format, count)
+        error("tkn.tknNewBuffer: C binding not loaded")
+    end
+end
+
+if not tkn.tknGetUniformBufferView then
+    ---Get a view that writes fields straight into a uniform buffer, frames copy only the written bytes.
+    ---view:set(index, name, ...) writes a field like buffer:set, view:setFloats(offset, ...) writes floats from a byte offset
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknUniformBuffer lightuserdata TknUniformBuffer pointer, must outlive the view
+    ---@param format table|userdata|nil Field layout descriptors or a compiled layout, nil for setFloats only
+    ---@return userdata view
+    function tkn.tknGetUniformBufferView(pTknGfxContext, pTknUniformBuffer, format)
+        error("tkn.tknGetUniformBufferView: C binding not loaded")
+    end
+end
+
+if not tkn.tknGetInstanceView then
+    ---Get a view that writes fields straight into an instance's current elements, like tknGetUniformBufferView
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknInstance lightuserdata TknInstance pointer, must outlive the view
+    ---@param format table|userdata|nil Field layout descriptors or a compiled layout, nil for setFloats only
+    ---@return userdata view
+    function tkn.tknGetInstanceView(pTknGfxContext, pTknInstance, format)
+        error("tkn.tknGetInstanceView: C binding not loaded")
+    end
+end
+
 if not tkn.tknCreateUniformBufferPtr then
     ---Create a uniform buffer with initial data
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     ---@param format table Field layout descriptors
-    ---@param buffer table Data table with named arrays
+    ---@param buffer table|userdata Data table with named arrays, or a buffer from tknNewBuffer
     ---@return lightuserdata TknUniformBuffer pointer
     function tkn.tknCreateUniformBufferPtr(pTknGfxContext, format, buffer)
         error("tkn.tknCreateUniformBufferPtr: C binding not loaded")
@@ -286,7 +496,7 @@ if not tkn.tknUpdateUniformBufferPtr then
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     ---@param pTknUniformBuffer lightuserdata TknUniformBuffer pointer
     ---@param format table Field layout descriptors (must be before buffer)
-    ---@param buffer table Data table with named arrays
+    ---@param buffer table|userdata Data table with named arrays, or a buffer from tknNewBuffer
     ---@param size integer Optional override size, or nil for auto-calculated
     ---@note Parameter order is: (pTknGfxContext, pTknUniformBuffer, format, buffer, size)
     function tkn.tknUpdateUniformBufferPtr(pTknGfxContext, pTknUniformBuffer, format, buffer, size)
@@ -294,12 +504,54 @@ if not tkn.tknUpdateUniformBufferPtr then
     end
 end
 
+if not tkn.tknCreateDynamicBufferPtr then
+    ---Create a dynamic uniform or storage buffer holding an array of elements, draws pick an element by offset
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param vkDescriptorType integer VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC or VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC
+    ---@param format table|userdata Field layout descriptors of one element, or a compiled layout
+    ---@param buffer table|userdata Data table with named arrays, or a buffer from tknNewBuffer, its element count sizes the buffer
+    ---@return lightuserdata TknDynamicBuffer pointer
+    function tkn.tknCreateDynamicBufferPtr(pTknGfxContext, vkDescriptorType, format, buffer)
+        error("tkn.tknCreateDynamicBufferPtr: C binding not loaded")
+    end
+end
+
+if not tkn.tknDestroyDynamicBufferPtr then
+    ---Destroy a dynamic buffer
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknDynamicBuffer lightuserdata TknDynamicBuffer pointer
+    function tkn.tknDestroyDynamicBufferPtr(pTknGfxContext, pTknDynamicBuffer)
+        error("tkn.tknDestroyDynamicBufferPtr: C binding not loaded")
+    end
+end
+
+if not tkn.tknGetDynamicBufferView then
+    ---Get a view that writes elements of a dynamic buffer, like tknGetUniformBufferView
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknDynamicBuffer lightuserdata TknDynamicBuffer pointer, must outlive the view
+    ---@param format table|userdata|nil Field layout descriptors or a compiled layout, nil for setFloats only
+    ---@return userdata view
+    function tkn.tknGetDynamicBufferView(pTknGfxContext, pTknDynamicBuffer, format)
+        error("tkn.tknGetDynamicBufferView: C binding not loaded")
+    end
+end
+
+if not tkn.tknGetDynamicBufferOffset then
+    ---Get the byte offset a draw call binds to read one element
+    ---@param pTknDynamicBuffer lightuserdata TknDynamicBuffer pointer
+    ---@param index integer 1-based element index
+    ---@return integer offset
+    function tkn.tknGetDynamicBufferOffset(pTknDynamicBuffer, index)
+        error("tkn.tknGetDynamicBufferOffset: C binding not loaded")
+    end
+end
+
 if not tkn.tknCreateInstancePtr then
     ---Create instance data with vertex attributes
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     ---@param pTknVertexInputLayout lightuserdata TknVertexInputLayout pointer
     ---@param format table Field layout descriptors
-    ---@param instances table Data table with named arrays
+    ---@param instances table|userdata Data table with named arrays, or a buffer from tknNewBuffer
     ---@return lightuserdata TknInstance pointer
     function tkn.tknCreateInstancePtr(pTknGfxContext, pTknVertexInputLayout, format, instances)
         error("tkn.tknCreateInstancePtr: C binding not loaded")
@@ -315,12 +567,32 @@ if not tkn.tknDestroyInstancePtr then
     end
 end
 
+if not tkn.tknCreateStorageBufferPtr then
+    ---Create a device local storage buffer that shaders read and write, also usable for indirect commands and vertices
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param format table|userdata|nil Field layout descriptors, or a compiled layout, nil for an uninitialized buffer
+    ---@param buffer table|userdata|integer Initial data, or the size in bytes when format is nil
+    ---@return lightuserdata TknStorageBuffer pointer
+    function tkn.tknCreateStorageBufferPtr(pTknGfxContext, format, buffer)
+        error("tkn.tknCreateStorageBufferPtr: C binding not loaded")
+    end
+end
+
+if not tkn.tknDestroyStorageBufferPtr then
+    ---Destroy a storage buffer
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknStorageBuffer lightuserdata TknStorageBuffer pointer
+    function tkn.tknDestroyStorageBufferPtr(pTknGfxContext, pTknStorageBuffer)
+        error("tkn.tknDestroyStorageBufferPtr: C binding not loaded")
+    end
+end
+
 if not tkn.tknCreateMeshPtrWithData then
     ---Create a mesh with vertex and index data
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     ---@param pTknMeshVertexInputLayout lightuserdata TknVertexInputLayout pointer
     ---@param format table Field layout descriptors
-    ---@param vertices table Data table with named vertex arrays
+    ---@param vertices table|userdata Data table with named vertex arrays, or a buffer from tknNewBuffer
     ---@param indexType integer VkIndexType (UINT16 or UINT32)
     ---@param indices table Index array or nil for non-indexed geometry
     ---@return lightuserdata TknMesh pointer
@@ -329,12 +601,61 @@ if not tkn.tknCreateMeshPtrWithData then
     end
 end
 
+if not tkn.tknUploadMeshAsync then
+    ---Create a mesh whose data is copied on the transfer queue, draw calls skip it until the upload completes
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknMeshVertexInputLayout lightuserdata TknVertexInputLayout pointer
+    ---@param format table Field layout descriptors
+    ---@param vertices table|userdata Data table with named vertex arrays, or a buffer from tknNewBuffer
+    ---@param indexType integer VkIndexType (UINT16 or UINT32)
+    ---@param indices table Index array or nil for non-indexed geometry
+    ---@return lightuserdata TknMesh pointer
+    ---@return integer Upload ticket, 0 if the upload already went through the graphics queue
+    function tkn.tknUploadMeshAsync(pTknGfxContext, pTknMeshVertexInputLayout, format, vertices, indexType, indices)
+        error("tkn.tknUploadMeshAsync: C binding not loaded")
+    end
+end
+
+if not tkn.tknUploadImageAsync then
+    ---Create a device local image whose data is copied on the transfer queue
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param vkExtent3D table Image dimensions {width, height, depth}
+    ---@param vkFormat integer VkFormat enum value
+    ---@param vkImageUsageFlags integer VkImageUsageFlags combination, TRANSFER_DST is added
+    ---@param vkImageAspectFlags integer VkImageAspectFlags (COLOR, DEPTH, STENCIL)
+    ---@param data string Raw image data
+    ---@return lightuserdata TknImage pointer
+    ---@return integer Upload ticket, 0 if the upload already went through the graphics queue
+    function tkn.tknUploadImageAsync(pTknGfxContext, vkExtent3D, vkFormat, vkImageUsageFlags, vkImageAspectFlags, data)
+        error("tkn.tknUploadImageAsync: C binding not loaded")
+    end
+end
+
+if not tkn.tknIsUploadComplete then
+    ---Check whether an async upload can be used by the next frame
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param ticket integer Upload ticket
+    ---@return boolean True once the upload is done
+    function tkn.tknIsUploadComplete(pTknGfxContext, ticket)
+        error("tkn.tknIsUploadComplete: C binding not loaded")
+    end
+end
+
+if not tkn.tknWaitUpload then
+    ---Block until an async upload is done
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param ticket integer Upload ticket
+    function tkn.tknWaitUpload(pTknGfxContext, ticket)
+        error("tkn.tknWaitUpload: C binding not loaded")
+    end
+end
+
 if not tkn.tknUpdateMeshPtr then
     ---Update mesh vertex and index data
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     ---@param pTknMesh lightuserdata TknMesh pointer
     ---@param format string Format string for data layout
-    ---@param vertices table Vertex data
+    ---@param vertices table|userdata Vertex data, or a buffer from tknNewBuffer
     ---@param indexType integer VkIndexType (UINT16 or UINT32)
     ---@param indices table Index array or nil
     function tkn.tknUpdateMeshPtr(pTknGfxContext, pTknMesh, format, vertices, indexType, indices)
@@ -351,6 +672,19 @@ if not tkn.tknDestroyMeshPtr then
     end
 end
 
+if not tkn.tknSetFrameCamera then
+    ---Set the camera of the next acquired frame, C fills in time, frame count and screen size of the global uniform
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param view number[] Column major 4x4 view matrix
+    ---@param proj number[] Column major 4x4 projection matrix
+    ---@param near number Near plane distance
+    ---@param far number Far plane distance
+    ---@param fov number Field of view in degrees
+    function tkn.tknSetFrameCamera(pTknGfxContext, view, proj, near, far, fov)
+        error("tkn.tknSetFrameCamera: C binding not loaded")
+    end
+end
+
 if not tkn.tknGetGlobalMaterialPtr then
     ---Get the global material descriptor set
     ---@param pTknGfxContext lightuserdata Graphics context pointer
@@ -381,6 +715,16 @@ if not tkn.tknCreatePipelineMaterialPtr then
     end
 end
 
+if not tkn.tknCreateComputeMaterialPtr then
+    ---Create a material for a compute pipeline, destroyed with tknDestroyPipelineMaterialPtr
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknComputePipeline lightuserdata TknComputePipeline pointer
+    ---@return lightuserdata TknMaterial pointer
+    function tkn.tknCreateComputeMaterialPtr(pTknGfxContext, pTknComputePipeline)
+        error("tkn.tknCreateComputeMaterialPtr: C binding not loaded")
+    end
+end
+
 if not tkn.tknDestroyPipelineMaterialPtr then
     ---Destroy a pipeline-specific material descriptor set
     ---@param pTknGfxContext lightuserdata Graphics context pointer
@@ -536,20 +880,114 @@ if not tkn.tknLoadChar then
     end
 end
 
+if not tkn.tknBeginProfileScope then
+    ---Open a CPU profile scope on the calling thread, close it with tknEndProfileScope
+    ---@param name string Scope name shown in the trace
+    function tkn.tknBeginProfileScope(name)
+        error("tkn.tknBeginProfileScope: C binding not loaded")
+    end
+end
+
+if not tkn.tknEndProfileScope then
+    ---Close the innermost CPU profile scope of the calling thread
+    function tkn.tknEndProfileScope()
+        error("tkn.tknEndProfileScope: C binding not loaded")
+    end
+end
+
+if not tkn.tknSetProfilerEnabled then
+    ---Start or stop recording CPU profile scopes, disabled scopes cost one flag check
+    ---@param isEnabled boolean
+    function tkn.tknSetProfilerEnabled(isEnabled)
+        error("tkn.tknSetProfilerEnabled: C binding not loaded")
+    end
+end
+
+if not tkn.tknWriteProfileTrace then
+    ---Write the recorded CPU profile scopes of every thread as Chrome trace JSON
+    ---@param filePath string Output file, open it in chrome://tracing or Perfetto
+    ---@return boolean isWritten
+    function tkn.tknWriteProfileTrace(filePath)
+        error("tkn.tknWriteProfileTrace: C binding not loaded")
+    end
+end
+
+if not tkn.tknStartLuaProfiler then
+    ---Start sampling Lua call stacks on the main thread, samples from an earlier run are dropped
+    ---@param instructionCount integer|nil VM instructions between samples, 1000 by default
+    function tkn.tknStartLuaProfiler(instructionCount)
+        error("tkn.tknStartLuaProfiler: C binding not loaded")
+    end
+end
+
+if not tkn.tknStopLuaProfiler then
+    ---Stop sampling, the hook is removed and the samples are kept for tknDumpLuaProfile
+    function tkn.tknStopLuaProfiler()
+        error("tkn.tknStopLuaProfiler: C binding not loaded")
+    end
+end
+
+if not tkn.tknDumpLuaProfile then
+    ---Write the sampled stacks as collapsed stack text, one "root;caller;callee count" line per stack
+    ---@param filePath string Output file for flamegraph.pl, speedscope or similar tools
+    ---@return boolean isWritten
+    function tkn.tknDumpLuaProfile(filePath)
+        error("tkn.tknDumpLuaProfile: C binding not loaded")
+    end
+end
+
 if not tkn.tknWaitRenderFence then
-    ---Wait for GPU render fence before modifying GPU resources
+    ---Wait until the GPU is done with the frame that is about to be recorded, other frames in flight keep running
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     function tkn.tknWaitRenderFence(pTknGfxContext)
         error("tkn.tknWaitRenderFence: C binding not loaded")
     end
 end
 
+if not tkn.tknGetFrameStats then
+    ---Get the bind counts recorded since the frame was acquired
+    ---@param pTknFrame lightuserdata Frame pointer
+    ---@return table stats { emittedBindCount = integer, skippedBindCount = integer }
+    function tkn.tknGetFrameStats(pTknFrame)
+        error("tkn.tknGetFrameStats: C binding not loaded")
+    end
+end
+
+if not tkn.tknSetGpuProfilerEnabled then
+    ---Enable GPU timestamps and pipeline statistics per render pass, from the next acquired frame on
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param isTimestampEnabled boolean Time render passes and subpasses
+    ---@param isPipelineStatisticsEnabled boolean Count vertices, primitives and shader invocations per render pass
+    function tkn.tknSetGpuProfilerEnabled(pTknGfxContext, isTimestampEnabled, isPipelineStatisticsEnabled)
+        error("tkn.tknSetGpuProfilerEnabled: C binding not loaded")
+    end
+end
+
+if not tkn.tknGetGpuProfile then
+    ---Get the latest GPU profile read back, it lags behind by the number of frames in flight
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@return table profile { isTimestampSupported = boolean, isPipelineStatisticsSupported = boolean, frameCount = integer, renderPasses = { { pTknRenderPass = lightuserdata, milliseconds = number, subpassMilliseconds = number[], inputAssemblyVertexCount = integer, inputAssemblyPrimitiveCount = integer, vertexShaderInvocationCount = integer, clippingPrimitiveCount = integer, fragmentShaderInvocationCount = integer } } }
+    function tkn.tknGetGpuProfile(pTknGfxContext)
+        error("tkn.tknGetGpuProfile: C binding not loaded")
+    end
+end
+
+if not tkn.tknGetFrameIndex then
+    ---Get the index of the frame in flight, in [0, frameInFlightCount)
+    ---@param pTknFrame lightuserdata Frame pointer
+    ---@return integer frameIndex
+    function tkn.tknGetFrameIndex(pTknFrame)
+        error("tkn.tknGetFrameIndex: C binding not loaded")
+    end
+end
+
 if not tkn.tknBeginRenderPassPtr then
     ---Begin a render pass
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     ---@param pTknFrame lightuserdata Frame pointer
     ---@param pTknRenderPass lightuserdata RenderPass pointer
-    function tkn.tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, pTknRenderPass)
+    ---@param vkSubpassContents integer VkSubpassContents of the first subpass, secondary subpasses only record draw queues
+    function tkn.tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, pTknRenderPass, vkSubpassContents)
         error("tkn.tknBeginRenderPassPtr: C binding not loaded")
     end
 end
@@ -567,7 +1005,8 @@ if not tkn.tknNextSubpassPtr then
     ---Move to next subpass in current render pass
     ---@param pTknGfxContext lightuserdata Graphics context pointer
     ---@param pTknFrame lightuserdata Frame pointer
-    function tkn.tknNextSubpassPtr(pTknGfxContext, pTknFrame)
+    ---@param vkSubpassContents integer VkSubpassContents of the next subpass, secondary subpasses only record draw queues
+    function tkn.tknNextSubpassPtr(pTknGfxContext, pTknFrame, vkSubpassContents)
         error("tkn.tknNextSubpassPtr: C binding not loaded")
     end
 end
@@ -582,6 +1021,47 @@ if not tkn.tknRecordDrawCallPtr then
     end
 end
 
+if not tkn.tknGetDrawCallSortKey then
+    ---Sort key that groups draws by pipeline, material and mesh within a layer
+    ---@param pTknDrawCall lightuserdata DrawCall pointer
+    ---@param layer integer 0 to 255, lower layers are recorded first
+    ---@param depth number 0 to 1, orders draws with the same state front to back
+    ---@return integer sortKey
+    function tkn.tknGetDrawCallSortKey(pTknDrawCall, layer, depth)
+        error("tkn.tknGetDrawCallSortKey: C binding not loaded")
+    end
+end
+
+if not tkn.tknCreateDrawQueuePtr then
+    ---Create a queue that sorts and records the draws of a subpass in one call
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@return lightuserdata pTknDrawQueue
+    function tkn.tknCreateDrawQueuePtr(pTknGfxContext)
+        error("tkn.tknCreateDrawQueuePtr: C binding not loaded")
+    end
+end
+
+if not tkn.tknDestroyDrawQueuePtr then
+    ---Destroy a draw queue
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknDrawQueue lightuserdata DrawQueue pointer
+    function tkn.tknDestroyDrawQueuePtr(pTknGfxContext, pTknDrawQueue)
+        error("tkn.tknDestroyDrawQueuePtr: C binding not loaded")
+    end
+end
+
+if not tkn.tknRecordDrawQueuePtr then
+    ---Sort the entries by key and record them into the current subpass, in parallel when it was begun with secondary command buffers
+    ---@param pTknGfxContext lightuserdata Graphics context pointer
+    ---@param pTknFrame lightuserdata Frame pointer
+    ---@param pTknDrawQueue lightuserdata DrawQueue pointer
+    ---@param entries table Flat triples of sortKey, pTknDrawCall and stencil, stencil is false or compareMask | writeMask << 8 | reference << 16
+    ---@param entryCount integer Number of triples to read, the rest of the table is ignored
+    function tkn.tknRecordDrawQueuePtr(pTknGfxContext, pTknFrame, pTknDrawQueue, entries, entryCount)
+        error("tkn.tknRecordDrawQueuePtr: C binding not loaded")
+    end
+end
+
 if not tkn.tknSetStencilCompareMask then
     ---Set stencil compare mask for a frame
     ---@param pTknGfxContext lightuserdata Graphics context pointer
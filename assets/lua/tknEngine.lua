@@ -13,98 +13,6 @@ local tknScrollViewWidget = require("engine.widgets.tknScrollViewWidget")
 local tknInputFieldWidget = require("engine.widgets.tknInputFieldWidget")
 local tknEngine = {}
 
-local function setupGlobalMaterial(pTknGfxContext)
-    tknEngine.globalUniformBufferFormat = {{
-        name = "view",
-        type = tkn.type.float,
-        count = 16,
-    }, {
-        name = "proj",
-        type = tkn.type.float,
-        count = 16,
-    }, {
-        name = "near",
-        type = tkn.type.float,
-        count = 1,
-    }, {
-        name = "far",
-        type = tkn.type.float,
-        count = 1,
-    }, {
-        name = "fov",
-        type = tkn.type.float,
-        count = 1,
-    }, {
-        name = "time",
-        type = tkn.type.float,
-        count = 1,
-    }, {
-        name = "frameCount",
-        type = tkn.type.int32,
-        count = 1,
-    }, {
-        name = "screenWidth",
-        type = tkn.type.int32,
-        count = 1,
-    }, {
-        name = "screenHeight",
-        type = tkn.type.int32,
-        count = 1,
-    }}
-
-    -- Create global uniform buffer
-    local pGlobalUniformBuffer = {
-        view = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1},
-        proj = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1},
-        near = 0.01,
-        far = 32,
-        fov = 90,
-        time = 0.0,
-        frameCount = 0,
-        screenWidth = 800,
-        screenHeight = 600,
-    }
-    tknEngine.pGlobalUniformBuffer = tkn.tknCreateUniformBufferPtr(pTknGfxContext, tknEngine.globalUniformBufferFormat, pGlobalUniformBuffer)
-    local inputBindings = {{
-        vkDescriptorType = vulkan.VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-        pTknUniformBuffer = tknEngine.pGlobalUniformBuffer,
-        binding = 0,
-    }}
-    tknEngine.pGlobalMaterial = tkn.tknGetGlobalMaterialPtr(pTknGfxContext)
-    tkn.tknUpdateMaterialPtr(pTknGfxContext, tknEngine.pGlobalMaterial, inputBindings)
-end
-local function teardownGlobalMaterial(pTknGfxContext)
-    tkn.tknDestroyUniformBufferPtr(pTknGfxContext, tknEngine.pGlobalUniformBuffer)
-    tknEngine.pGlobalUniformBuffer = nil
-    tknEngine.pGlobalMaterial = nil
-    tknEngine.globalUniformBufferFormat = nil
-end
-local function updateGlobalMaterial(pTknGfxContext, camera, time, frameCount, screenWidth, screenHeight)
-    local view = camera.view
-    local proj = camera.proj
-    -- Create global uniform buffer
-    local pGlobalUniformBuffer = {
-        view = view,
-        proj = proj,
-        near = camera.near,
-        far = camera.far,
-        fov = camera.fov,
-        time = time,
-        frameCount = frameCount,
-        screenWidth = screenWidth,
-        screenHeight = screenHeight,
-    }
-    -- tknEngine.pGlobalUniformBuffer = tkn.tknCreateUniformBufferPtr(pTknGfxContext, tknEngine.globalUniformBufferFormat, pGlobalUniformBuffer)
-    tkn.tknUpdateUniformBufferPtr(pTknGfxContext, tknEngine.pGlobalUniformBuffer, tknEngine.globalUniformBufferFormat, pGlobalUniformBuffer, nil)
-    local inputBindings = {{
-        vkDescriptorType = vulkan.VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-        pTknUniformBuffer = tknEngine.pGlobalUniformBuffer,
-        binding = 0,
-    }}
-    tknEngine.pGlobalMaterial = tkn.tknGetGlobalMaterialPtr(pTknGfxContext)
-    tkn.tknUpdateMaterialPtr(pTknGfxContext, tknEngine.pGlobalMaterial, inputBindings)
-end
-
 local function updateDeferredGeometrySubpassMaterial(pTknGfxContext, camera, screenWidth, screenHeight, sizeFactor)
     camera.screenWidth = screenWidth
     camera.screenHeight = screenHeight
@@ -113,15 +21,17 @@ local function updateDeferredGeometrySubpassMaterial(pTknGfxContext, camera, scr
     local focalY = camera.screenHeight * camera.proj[6] * 0.5 -- proj[6] == m11 (f)
     -- print("focalX:", focalX, "focalY:", focalY)
     local focal = math.max(focalX, focalY)
-    tkn.tknUpdateUniformBufferPtr(pTknGfxContext, deferredRenderPass.pGeometryUniformBuffer, deferredRenderPass.geometryUniformBufferFormat, {
-        pointSize = focal * sizeFactor,
-    }, nil)
+    local pointSize = focal * sizeFactor
+    -- Only changes with the projection or the screen size
+    if pointSize ~= tknEngine.pointSize then
+        tknEngine.pointSize = pointSize
+        tknEngine.geometryUniformView:set(1, "pointSize", pointSize)
+    end
 end
 
 function tknEngine.start(pTknGfxContext, assetsPath)
     tknEngine.frameCount = 0
     tknEngine.assetsPath = assetsPath
-    -- Global uniform buffer format (view, projection, etc.)
     local depthVkFormat = tkn.tknGetSupportedFormat(pTknGfxContext, {vulkan.VK_FORMAT_D24_UNORM_S8_UINT, vulkan.VK_FORMAT_D32_SFLOAT_S8_UINT}, vulkan.VK_IMAGE_TILING_OPTIMAL, vulkan.VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
     tknEngine.pDepthStencilAttachment = tkn.tknCreateDynamicAttachmentPtr(pTknGfxContext, depthVkFormat, vulkan.VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | vulkan.VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | vulkan.VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, vulkan.VK_IMAGE_ASPECT_DEPTH_BIT, 1)
     tknEngine.pSwapchainAttachment = tkn.tknGetSwapchainAttachmentPtr(pTknGfxContext)
@@ -136,7 +46,7 @@ function tknEngine.start(pTknGfxContext, assetsPath)
     tknEngine.voxelPerMeter = 16
     game.start(pTknGfxContext, assetsPath, tknEngine.gameRootUINode, tknEngine.voxelPerMeter)
 
-    setupGlobalMaterial(pTknGfxContext)
+    tknEngine.geometryUniformView = tkn.tknGetUniformBufferView(pTknGfxContext, deferredRenderPass.pGeometryUniformBuffer, deferredRenderPass.geometryUniformBufferFormat)
     transformSystem.setup()
     cameraSystem.setup()
 
@@ -152,7 +62,6 @@ function tknEngine.stop(pTknGfxContext)
     cameraSystem.teardown()
     game.stop()
 
-    tkn.tknWaitRenderFence(pTknGfxContext)
     game.stopGfx(pTknGfxContext)
 
     editorPanel.destroy(pTknGfxContext, tknEngine.editorPanel)
@@ -162,7 +71,8 @@ function tknEngine.stop(pTknGfxContext)
     tknWidgetConfig.teardown(pTknGfxContext)
     ui.teardown(pTknGfxContext)
 
-    teardownGlobalMaterial(pTknGfxContext)
+    tknEngine.geometryUniformView = nil
+    tknEngine.pointSize = nil
     deferredRenderPass.teardown(pTknGfxContext)
 
     tkn.tknDestroyDynamicAttachmentPtr(pTknGfxContext, tknEngine.pDepthStencilAttachment)
@@ -174,27 +84,43 @@ end
 
 function tknEngine.update(pTknGfxContext, width, height)
     tknEngine.frameCount = tknEngine.frameCount + 1
+    tkn.tknBeginProfileScope("game.update")
     game.update()
+    tkn.tknEndProfileScope()
     cameraTransformController.update(tknEngine.cameraTransform)
+    tkn.tknBeginProfileScope("transformSystem.update")
     transformSystem.update()
+    tkn.tknEndProfileScope()
+    tkn.tknBeginProfileScope("cameraSystem.update")
     cameraSystem.update(pTknGfxContext, width, height)
-    updateGlobalMaterial(pTknGfxContext, tknEngine.camera, 0, 0, width, height)
+    tkn.tknEndProfileScope()
+    local camera = tknEngine.camera
+    tkn.tknSetFrameCamera(pTknGfxContext, camera.view, camera.proj, camera.near, camera.far, camera.fov)
     updateDeferredGeometrySubpassMaterial(pTknGfxContext, tknEngine.camera, width, height, 1.414 / tknEngine.voxelPerMeter)
-    tkn.tknWaitRenderFence(pTknGfxContext)
+    tkn.tknBeginProfileScope("game.updateGfx")
     local shouldQuit = game.updateGfx(pTknGfxContext, width, height)
+    tkn.tknEndProfileScope()
+    tkn.tknBeginProfileScope("ui.update")
     ui.update(pTknGfxContext, width, height)
+    tkn.tknEndProfileScope()
     tknScrollViewWidget.update()
     tknInputFieldWidget.update(tknEngine.frameCount)
     return shouldQuit
 end
 
 function tknEngine.recordFrame(pTknGfxContext, pTknFrame)
-    tkn.tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, deferredRenderPass.pTknRenderPass)
+    -- Geometry draws are recorded on workers, the single lighting draw goes inline
+    tkn.tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, deferredRenderPass.pTknRenderPass, vulkan.VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
+    tkn.tknBeginProfileScope("game.recordFrame")
     game.recordFrame(pTknGfxContext, pTknFrame)
-    tkn.tknNextSubpassPtr(pTknGfxContext, pTknFrame)
+    tkn.tknEndProfileScope()
+    deferredRenderPass.recordGeometryDrawQueue(pTknGfxContext, pTknFrame)
+    tkn.tknNextSubpassPtr(pTknGfxContext, pTknFrame, vulkan.VK_SUBPASS_CONTENTS_INLINE)
     tkn.tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, deferredRenderPass.pLightingDrawCall)
     tkn.tknEndRenderPassPtr(pTknGfxContext, pTknFrame)
+    tkn.tknBeginProfileScope("ui.recordFrame")
     ui.recordFrame(pTknGfxContext, pTknFrame)
+    tkn.tknEndProfileScope()
 end
 
 _G.tknEngine = tknEngine
@@ -11,6 +11,7 @@ function imageNode.setup(assetsPath)
         contain = "contain",
     }
     imageNode.pathToImage = {}
+    imageNode.pathToPendingImage = {}
 end
 
 function imageNode.teardown(pTknGfxContext)
@@ -20,6 +21,27 @@ function imageNode.teardown(pTknGfxContext)
     imageNode.assetsPath = nil
     imageNode.fitModeType = nil
     imageNode.pathToImage = nil
+    imageNode.pathToPendingImage = nil
+end
+
+local function bindImage(pTknGfxContext, image)
+    local inputBindings = {{
+        vkDescriptorType = vulkan.VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        pTknImage = image.pTknImage,
+        pTknSampler = image.pTknSampler,
+        binding = 0,
+    }}
+    tkn.tknUpdateMaterialPtr(pTknGfxContext, image.pTknMaterial, inputBindings)
+end
+
+-- Images still on the transfer queue are drawn with the empty image, they are bound once their upload completes
+function imageNode.update(pTknGfxContext)
+    for path, image in pairs(imageNode.pathToPendingImage) do
+        if tkn.tknIsUploadComplete(pTknGfxContext, image.ticket) then
+            bindImage(pTknGfxContext, image)
+            imageNode.pathToPendingImage[path] = nil
+        end
+    end
 end
 
 function imageNode.loadImage(pTknGfxContext, relativePath, pTknSampler, pTknPipeline)
@@ -27,26 +49,25 @@ function imageNode.loadImage(pTknGfxContext, relativePath, pTknSampler, pTknPipe
     if imageNode.pathToImage[path] then
         return imageNode.pathToImage[path]
     else
-        local pTknImage, width, height = tkn.tknCreateImagePtrWithPath(pTknGfxContext, path)
+        local pTknImage, width, height, ticket = tkn.tknCreateImagePtrWithPathAsync(pTknGfxContext, path)
         if pTknImage == nil then
             return nil
         else
-            local pTknMaterial = tkn.tknCreatePipelineMaterialPtr(pTknGfxContext, pTknPipeline)
-            local inputBindings = {{
-                vkDescriptorType = vulkan.VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                pTknImage = pTknImage,
-                pTknSampler = pTknSampler,
-                binding = 0,
-            }}
-            tkn.tknUpdateMaterialPtr(pTknGfxContext, pTknMaterial, inputBindings)
             local image = {
                 pTknImage = pTknImage,
+                pTknSampler = pTknSampler,
                 width = width,
                 height = height,
                 path = path,
-                pTknMaterial = pTknMaterial,
+                pTknMaterial = tkn.tknCreatePipelineMaterialPtr(pTknGfxContext, pTknPipeline),
+                ticket = ticket,
             }
             imageNode.pathToImage[path] = image
+            if tkn.tknIsUploadComplete(pTknGfxContext, ticket) then
+                bindImage(pTknGfxContext, image)
+            else
+                imageNode.pathToPendingImage[path] = image
+            end
             return image
         end
     end
@@ -54,6 +75,7 @@ end
 
 function imageNode.unloadImage(pTknGfxContext, image)
     imageNode.pathToImage[image.path] = nil
+    imageNode.pathToPendingImage[image.path] = nil
     tkn.tknDestroyImagePtr(pTknGfxContext, image.pTknImage)
     image.pTknImage = nil
     image.width = 0
@@ -107,6 +129,7 @@ function imageNode.setMask(pTknGfxContext, node, mask)
         else
             tkn.tknDestroyDrawCallPtr(pTknGfxContext, node.pClearMaskTknDrawCall)
             tkn.tknDestroyInstancePtr(pTknGfxContext, node.pClearMaskTknInstance)
+            node.clearMaskInstanceView = nil
         end
         node.mask = mask
     end
@@ -116,6 +139,7 @@ function imageNode.teardownNode(pTknGfxContext, node)
     if node.mask then
         tkn.tknDestroyDrawCallPtr(pTknGfxContext, node.pClearMaskTknDrawCall)
         tkn.tknDestroyInstancePtr(pTknGfxContext, node.pClearMaskTknInstance)
+        node.clearMaskInstanceView = nil
     end
     tkn.tknDestroyDrawCallPtr(pTknGfxContext, node.pTknDrawCall)
     tkn.tknDestroyInstancePtr(pTknGfxContext, node.pTknInstance)
@@ -125,6 +149,7 @@ function imageNode.teardownNode(pTknGfxContext, node)
     node.uv = nil
     node.pTknMesh = nil
     node.pTknInstance = nil
+    node.instanceView = nil
     node.pTknDrawCall = nil
     node.fitMode = nil
     node.color = colorPreset.white
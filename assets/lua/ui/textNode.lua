@@ -133,6 +133,7 @@ function textNode.teardownNode(pTknGfxContext, node)
     node.pTknMaterial = nil
     node.pTknMesh = nil
     node.pTknInstance = nil
+    node.instanceView = nil
     node.pTknDrawCall = nil
     node.font = nil
     node.text = ""
@@ -2,7 +2,8 @@ local vulkan = require("vulkan")
 local tkn = require("tkn")
 local textPipeline = {}
 
-function textPipeline.createPipelinePtr(pTknGfxContext, pTknRenderPass, subpassIndex, assetsPath, pUIVertexInputLayout, pUIInstanceInputLayout)
+-- Arguments of tkn.tknCreatePipelinePtr after the context, batch them with tkn.tknCreatePipelinesPtr
+function textPipeline.getCreateArguments(pTknRenderPass, subpassIndex, assetsPath, pUIVertexInputLayout, pUIInstanceInputLayout)
     local textPipelineSpvPaths = {assetsPath .. "/shaders/ui.vert.spv", assetsPath .. "/shaders/text.frag.spv"}
     local vkPipelineInputAssemblyStateCreateInfo = {
         topology = vulkan.VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
@@ -54,7 +55,7 @@ function textPipeline.createPipelinePtr(pTknGfxContext, pTknRenderPass, subpassI
     local vkPipelineDynamicStateCreateInfo = {
         pDynamicStates = {vulkan.VK_DYNAMIC_STATE_VIEWPORT, vulkan.VK_DYNAMIC_STATE_SCISSOR, vulkan.VK_DYNAMIC_STATE_STENCIL_WRITE_MASK, vulkan.VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK, vulkan.VK_DYNAMIC_STATE_STENCIL_REFERENCE},
     }
-    return tkn.tknCreatePipelinePtr(pTknGfxContext, pTknRenderPass, subpassIndex, textPipelineSpvPaths, pUIVertexInputLayout, pUIInstanceInputLayout, vkPipelineInputAssemblyStateCreateInfo, tkn.defaultVkPipelineViewportStateCreateInfo, tkn.defaultVkPipelineRasterizationStateCreateInfo, tkn.defaultVkPipelineMultisampleStateCreateInfo, vkPipelineDepthStencilStateCreateInfo, vkPipelineColorBlendStateCreateInfo, vkPipelineDynamicStateCreateInfo)
+    return {pTknRenderPass, subpassIndex, textPipelineSpvPaths, pUIVertexInputLayout, pUIInstanceInputLayout, vkPipelineInputAssemblyStateCreateInfo, tkn.defaultVkPipelineViewportStateCreateInfo, tkn.defaultVkPipelineRasterizationStateCreateInfo, tkn.defaultVkPipelineMultisampleStateCreateInfo, vkPipelineDepthStencilStateCreateInfo, vkPipelineColorBlendStateCreateInfo, vkPipelineDynamicStateCreateInfo}
 end
 
 function textPipeline.destroyPipelinePtr(pTknGfxContext, pTknPipeline)
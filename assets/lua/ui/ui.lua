@@ -201,17 +201,16 @@ local function updateNodeGfxRecursively(pTknGfxContext, ui, node, screenWidth, s
     end
 
     if node.pTknInstance and instanceDirty then
-        tkn.tknUpdateInstancePtr(pTknGfxContext, node.pTknInstance, ui.instanceFormat, {
-            model = rect.model,
-            color = {tkn.rgbaToAbgr(tknMath.multiplyColors(rect.color, node.color))},
-            alphaThreshold = node.alphaThreshold,
-        })
+        -- Views are dropped together with their instances
+        node.instanceView = node.instanceView or tkn.tknGetInstanceView(pTknGfxContext, node.pTknInstance, ui.instanceFormat)
+        node.instanceView:set(1, "model", rect.model)
+        node.instanceView:set(1, "color", tkn.rgbaToAbgr(tknMath.multiplyColors(rect.color, node.color)))
+        node.instanceView:set(1, "alphaThreshold", node.alphaThreshold)
         if node.mask then
-            tkn.tknUpdateInstancePtr(pTknGfxContext, node.pClearMaskTknInstance, ui.instanceFormat, {
-                model = rect.model,
-                color = {tkn.rgbaToAbgr(colorPreset.transparent)},
-                alphaThreshold = node.alphaThreshold,
-            })
+            node.clearMaskInstanceView = node.clearMaskInstanceView or tkn.tknGetInstanceView(pTknGfxContext, node.pClearMaskTknInstance, ui.instanceFormat)
+            node.clearMaskInstanceView:set(1, "model", rect.model)
+            node.clearMaskInstanceView:set(1, "color", tkn.rgbaToAbgr(colorPreset.transparent))
+            node.clearMaskInstanceView:set(1, "alphaThreshold", node.alphaThreshold)
         end
     end
 
@@ -442,6 +441,9 @@ function ui.setup(pTknGfxContext, pSwapchainAttachment, pDepthStencilAttachment,
 
     ui.pTknSampler = tkn.tknCreateSamplerPtr(pTknGfxContext, vulkan.VK_FILTER_LINEAR, vulkan.VK_FILTER_LINEAR, vulkan.VK_SAMPLER_MIPMAP_MODE_LINEAR, vulkan.VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER, vulkan.VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER, vulkan.VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER, 0.0, false, 0.0, 0.0, 0.0, vulkan.VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK)
     ui.renderPass = uiRenderPass
+    ui.pTknDrawQueue = tkn.tknCreateDrawQueuePtr(pTknGfxContext)
+    ui.drawQueueEntries = {}
+    ui.drawQueueEntryCount = 0
 
     imageNode.setup(assetsPath)
     ui.fitModeType = imageNode.fitModeType
@@ -473,6 +475,10 @@ end
 function ui.teardown(pTknGfxContext)
     ui.removeNode(pTknGfxContext, ui.rootNode)
     ui.renderPass = nil
+    tkn.tknDestroyDrawQueuePtr(pTknGfxContext, ui.pTknDrawQueue)
+    ui.pTknDrawQueue = nil
+    ui.drawQueueEntries = nil
+    ui.drawQueueEntryCount = nil
     tkn.tknDestroySamplerPtr(pTknGfxContext, ui.pTknSampler)
     ui.pTknSampler = nil
     ui.rootNode = nil
@@ -503,48 +509,53 @@ function ui.update(pTknGfxContext, screenWidth, screenHeight)
     end
 
     textNode.update(pTknGfxContext)
+    imageNode.update(pTknGfxContext)
     updateNodeGfxRecursively(pTknGfxContext, ui, ui.rootNode, screenWidth, screenHeight, ui.screenWidth ~= screenWidth, ui.screenHeight ~= screenHeight, false, false, false, false, false)
     ui.screenWidth = screenWidth
     ui.screenHeight = screenHeight
 
 end
 
-function ui.recordDrawCalls(node, pTknGfxContext, pTknFrame, maskIndex)
+local function packStencil(compareMask, writeMask, reference)
+    return compareMask | (writeMask << 8) | (reference << 16)
+end
+
+local function pushDrawCall(pTknDrawCall, stencil)
+    -- UI draws overlap, so the key is the tree order and the queue only saves the crossings and redundant state
+    local entries = ui.drawQueueEntries
+    local entryCount = ui.drawQueueEntryCount
+    entries[entryCount * 3 + 1] = entryCount
+    entries[entryCount * 3 + 2] = pTknDrawCall
+    entries[entryCount * 3 + 3] = stencil
+    ui.drawQueueEntryCount = entryCount + 1
+end
+
+local function pushDrawCallsRecursively(node, maskIndex)
     if node.pTknDrawCall then
         if node.rect.active then
             if node.mask then
-                -- Mask-creating node: enable stencil write, create new mask layer
-                tkn.tknSetStencilWriteMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0xFF)
+                -- Mask-creating node: write the new mask layer
                 maskIndex = maskIndex + 1
-                assert(maskIndex <= 7, "ui.recordDrawCalls: exceeded maximum mask count of 7")
+                assert(maskIndex <= 7, "ui.recordFrame: exceeded maximum mask count of 7")
                 local maskBit = (1 << maskIndex) - 1
                 local compareMask = maskBit - 1
                 if compareMask < 0 then
                     compareMask = 0
                 end
-                tkn.tknSetStencilCompareMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, compareMask)
-                tkn.tknSetStencilReference(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, maskBit)
-                tkn.tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, node.pTknDrawCall)
-                -- Disable stencil write for children (they read, not write)
-                tkn.tknSetStencilWriteMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0x00)
+                pushDrawCall(node.pTknDrawCall, packStencil(compareMask, 0xFF, maskBit))
             elseif maskIndex > 0 then
                 -- Masked node: read from current mask, don't write
                 local maskBit = (1 << maskIndex) - 1
-                tkn.tknSetStencilCompareMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0xFF)
-                tkn.tknSetStencilReference(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, maskBit)
-                tkn.tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, node.pTknDrawCall)
+                pushDrawCall(node.pTknDrawCall, packStencil(0xFF, 0x00, maskBit))
             else
-                -- Unmasked root node: render normally, can write if needed
-                tkn.tknSetStencilWriteMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0x00)
-                tkn.tknSetStencilCompareMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0xFF)
-                tkn.tknSetStencilReference(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0x00)
-                tkn.tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, node.pTknDrawCall)
+                -- Unmasked root node: render normally
+                pushDrawCall(node.pTknDrawCall, packStencil(0xFF, 0x00, 0x00))
             end
         end
     end
 
     for _, child in ipairs(node.children) do
-        ui.recordDrawCalls(child, pTknGfxContext, pTknFrame, maskIndex)
+        pushDrawCallsRecursively(child, maskIndex)
     end
 
     -- Cleanup: restore stencil state after processing children
@@ -552,24 +563,15 @@ function ui.recordDrawCalls(node, pTknGfxContext, pTknFrame, maskIndex)
         -- Clear stencil by writing back to parent level value
         -- compareMask selects only the parent level bits for comparison
         local parentMaskBit = maskIndex > 1 and ((1 << (maskIndex - 1)) - 1) or 0
-        tkn.tknSetStencilCompareMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, parentMaskBit)
-        tkn.tknSetStencilReference(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, parentMaskBit)
-        tkn.tknSetStencilWriteMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0xFF)
-        tkn.tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, node.pClearMaskTknDrawCall)
-        -- Restore write mask state after clearing
-        if maskIndex > 1 then
-            -- Still inside a parent mask, keep write disabled
-            tkn.tknSetStencilWriteMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0x00)
-        else
-            -- Exiting root mask layer, restore to write-enabled
-            tkn.tknSetStencilWriteMask(pTknGfxContext, pTknFrame, vulkan.VK_STENCIL_FACE_FRONT_AND_BACK, 0xFF)
-        end
+        pushDrawCall(node.pClearMaskTknDrawCall, packStencil(parentMaskBit, 0xFF, parentMaskBit))
     end
 end
 
 function ui.recordFrame(pTknGfxContext, pTknFrame)
-    tkn.tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, ui.renderPass.pTknRenderPass)
-    ui.recordDrawCalls(ui.rootNode, pTknGfxContext, pTknFrame, 0)
+    tkn.tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, ui.renderPass.pTknRenderPass, vulkan.VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
+    ui.drawQueueEntryCount = 0
+    pushDrawCallsRecursively(ui.rootNode, 0)
+    tkn.tknRecordDrawQueuePtr(pTknGfxContext, pTknFrame, ui.pTknDrawQueue, ui.drawQueueEntries, ui.drawQueueEntryCount)
     tkn.tknEndRenderPassPtr(pTknGfxContext, pTknFrame)
 end
 
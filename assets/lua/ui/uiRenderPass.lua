@@ -66,8 +66,12 @@ function uiRenderPass.setup(pTknGfxContext, pSwapchainAttachment, pDepthStencilA
     }}
 
     uiRenderPass.pTknRenderPass = tkn.tknCreateRenderPassPtr(pTknGfxContext, vkAttachmentDescriptions, {pSwapchainAttachment, pDepthStencilAttachment}, vkClearValues, vkSubpassDescriptions, spvPathsArray, vkSubpassDependencies, renderPassIndex)
-    uiRenderPass.pImagePipeline = imagePipeline.createPipelinePtr(pTknGfxContext, uiRenderPass.pTknRenderPass, 0, assetsPath, pUIVertexInputLayout, pUIInstanceInputLayout)
-    uiRenderPass.pTextPipeline = textPipeline.createPipelinePtr(pTknGfxContext, uiRenderPass.pTknRenderPass, 0, assetsPath, pUIVertexInputLayout, pUIInstanceInputLayout)
+    local pipelinePtrs = tkn.tknCreatePipelinesPtr(pTknGfxContext, {
+        imagePipeline.getCreateArguments(uiRenderPass.pTknRenderPass, 0, assetsPath, pUIVertexInputLayout, pUIInstanceInputLayout),
+        textPipeline.getCreateArguments(uiRenderPass.pTknRenderPass, 0, assetsPath, pUIVertexInputLayout, pUIInstanceInputLayout),
+    })
+    uiRenderPass.pImagePipeline = pipelinePtrs[1]
+    uiRenderPass.pTextPipeline = pipelinePtrs[2]
 end
 
 function uiRenderPass.teardown(pTknGfxContext)
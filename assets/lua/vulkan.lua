@@ -1004,4 +1004,10 @@ vulkan.VK_STENCIL_FRONT_AND_BACK = vulkan.VK_STENCIL_FACE_FRONT_AND_BACK
 vulkan.VK_STENCIL_FACE_FLAG_BITS_MAX_ENUM = 0x7FFFFFFF
 -- } VkStencilFaceFlagBits;
 
+-- typedef enum VkSubpassContents {
+vulkan.VK_SUBPASS_CONTENTS_INLINE = 0
+vulkan.VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS = 1
+vulkan.VK_SUBPASS_CONTENTS_MAX_ENUM = 0x7FFFFFFF
+-- } VkSubpassContents;
+
 return vulkan
@@ -21,7 +21,8 @@ typedef struct
     luaL_Reg *luaRegs;
 } LuaLibrary;
 
-TknContext *createTknContextPtr(const char *assetsPath, uint32_t luaLibraryCount, LuaLibrary *luaLibraries, int targetSwapchainImageCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D swapchainExtent);
+// cachePath is a writable directory for data kept between runs such as the pipeline cache, NULL keeps nothing
+TknContext *createTknContextPtr(const char *assetsPath, const char *cachePath, uint32_t luaLibraryCount, LuaLibrary *luaLibraries, int targetSwapchainImageCount, uint32_t frameInFlightCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D swapchainExtent);
 void destroyTknContextPtr(TknContext *pTknContext);
 void updateTknContext(TknContext *pTknContext, VkExtent2D swapchainExtent, uint32_t keyCodeStateCount, InputState *keyCodeStates, uint32_t mouseCodeStateCount, InputState *mouseCodeStates, float scrollingDeltaX, float scrollingDeltaY, float mousePositionNDCX, float mousePositionNDCY, const char *inputText, bool *pShouldQuit, bool *pImeEnabled);
 #endif
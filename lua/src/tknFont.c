@@ -159,10 +159,11 @@ void flushTknFontPtr(TknFont *pTknFont, TknGfxContext *pTknGfxContext)
         return;
     }
 
-    void **datas = tknMalloc(sizeof(void *) * validCharCount);
-    VkOffset3D *offsets = tknMalloc(sizeof(VkOffset3D) * validCharCount);
-    VkExtent3D *extents = tknMalloc(sizeof(VkExtent3D) * validCharCount);
-    VkDeviceSize *sizes = tknMalloc(sizeof(VkDeviceSize) * validCharCount);
+    size_t scratchMarker = tknGetScratchMarker();
+    void **datas = tknAllocateScratch(sizeof(void *) * validCharCount);
+    VkOffset3D *offsets = tknAllocateScratch(sizeof(VkOffset3D) * validCharCount);
+    VkExtent3D *extents = tknAllocateScratch(sizeof(VkExtent3D) * validCharCount);
+    VkDeviceSize *sizes = tknAllocateScratch(sizeof(VkDeviceSize) * validCharCount);
 
     pCurrent = pTknFont->pDirtyTknChar;
     uint32_t index = 0;
@@ -204,10 +205,7 @@ void flushTknFontPtr(TknFont *pTknFont, TknGfxContext *pTknGfxContext)
     pTknFont->pDirtyTknChar = NULL;
     pTknFont->dirtyTknCharPtrCount = 0;
 
-    tknFree(datas);
-    tknFree(offsets);
-    tknFree(extents);
-    tknFree(sizes);
+    tknRewindScratch(scratchMarker);
 }
 
 TknFont *createTknFontPtr(TknFontLibrary *pTknFontLibrary, TknGfxContext *pTknGfxContext, uint32_t fontPathCount, const char **fontPaths, uint32_t fontSize, uint32_t atlasLength, const FT_Pos *boldStrengths)
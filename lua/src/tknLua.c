@@ -1,9 +1,39 @@
 #include "tknLuaBinding.h"
+#include <string.h>
+
+#define TKN_LUA_PROFILE_MAX_DEPTH 64
+#define TKN_LUA_PROFILE_MAX_STACK_LENGTH 4096
+#define TKN_DEFAULT_LUA_PROFILE_INSTRUCTION_COUNT 1000
+
+// Lua functions are told apart by source and definition line, C functions by their address with linedefined left at -1
+typedef struct
+{
+    const void *function;
+    int linedefined;
+} TknLuaProfileFrame;
+
+// One distinct call stack, keyed by the functions on it rather than the text so a sample only builds text the first time
+typedef struct
+{
+    uint64_t stackHash;
+    uint32_t sampleCount;
+    // Innermost first, compared on a hash hit so colliding stacks are never merged
+    uint32_t depth;
+    TknLuaProfileFrame *frames;
+    // root;caller;callee, NULL marks an empty slot
+    char *foldedStack;
+} TknLuaProfileStack;
 
 struct TknContext
 {
     lua_State *pLuaState;
     TknGfxContext *pTknGfxContext;
+    // Sampling profiler, the count hook is only installed while it runs
+    bool isLuaProfilerRunning;
+    uint32_t luaProfileSampleCount;
+    uint32_t luaProfileStackCount;
+    uint32_t luaProfileStackCapacity;
+    TknLuaProfileStack *luaProfileStacks;
 };
 
 static int errorHandler(lua_State *L)
@@ -27,7 +57,239 @@ static void assertLuaResult(lua_State *pLuaState, int result)
     }
 }
 
-TknContext *createTknContextPtr(const char *assetsPath, uint32_t luaLibraryCount, LuaLibrary *luaLibraries, int targetSwapchainImageCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D swapchainExtent)
+static void clearLuaProfileStacks(TknContext *pTknContext)
+{
+    for (uint32_t stackIndex = 0; stackIndex < pTknContext->luaProfileStackCapacity; stackIndex++)
+    {
+        tknFree(pTknContext->luaProfileStacks[stackIndex].frames);
+        tknFree(pTknContext->luaProfileStacks[stackIndex].foldedStack);
+    }
+    tknFree(pTknContext->luaProfileStacks);
+    pTknContext->luaProfileStacks = NULL;
+    pTknContext->luaProfileStackCapacity = 0;
+    pTknContext->luaProfileStackCount = 0;
+    pTknContext->luaProfileSampleCount = 0;
+}
+
+static bool isSameLuaProfileStack(TknLuaProfileStack *pTknLuaProfileStack, uint64_t stackHash, uint32_t depth, const TknLuaProfileFrame *frames)
+{
+    if (pTknLuaProfileStack->stackHash != stackHash || pTknLuaProfileStack->depth != depth)
+    {
+        return false;
+    }
+    else
+    {
+        for (uint32_t frameIndex = 0; frameIndex < depth; frameIndex++)
+        {
+            if (pTknLuaProfileStack->frames[frameIndex].function != frames[frameIndex].function || pTknLuaProfileStack->frames[frameIndex].linedefined != frames[frameIndex].linedefined)
+            {
+                return false;
+            }
+            else
+            {
+                // Same frame
+            }
+        }
+        return true;
+    }
+}
+
+static TknLuaProfileStack *findLuaProfileStack(TknLuaProfileStack *luaProfileStacks, uint32_t capacity, uint64_t stackHash, uint32_t depth, const TknLuaProfileFrame *frames)
+{
+    uint32_t stackIndex = (uint32_t)stackHash & (capacity - 1);
+    while (luaProfileStacks[stackIndex].foldedStack != NULL && !isSameLuaProfileStack(&luaProfileStacks[stackIndex], stackHash, depth, frames))
+    {
+        stackIndex = (stackIndex + 1) & (capacity - 1);
+    }
+    return &luaProfileStacks[stackIndex];
+}
+
+// Kept at most half full so probing stays short
+static void reserveLuaProfileStack(TknContext *pTknContext)
+{
+    if ((pTknContext->luaProfileStackCount + 1) * 2 > pTknContext->luaProfileStackCapacity)
+    {
+        uint32_t capacity = pTknContext->luaProfileStackCapacity > 0 ? pTknContext->luaProfileStackCapacity * 2 : 256;
+        TknLuaProfileStack *luaProfileStacks = tknMalloc(sizeof(TknLuaProfileStack) * capacity);
+        memset(luaProfileStacks, 0, sizeof(TknLuaProfileStack) * capacity);
+        for (uint32_t stackIndex = 0; stackIndex < pTknContext->luaProfileStackCapacity; stackIndex++)
+        {
+            TknLuaProfileStack *pTknLuaProfileStack = &pTknContext->luaProfileStacks[stackIndex];
+            if (pTknLuaProfileStack->foldedStack != NULL)
+            {
+                *findLuaProfileStack(luaProfileStacks, capacity, pTknLuaProfileStack->stackHash, pTknLuaProfileStack->depth, pTknLuaProfileStack->frames) = *pTknLuaProfileStack;
+            }
+            else
+            {
+                // Empty slot
+            }
+        }
+        tknFree(pTknContext->luaProfileStacks);
+        pTknContext->luaProfileStacks = luaProfileStacks;
+        pTknContext->luaProfileStackCapacity = capacity;
+    }
+    else
+    {
+        // Enough room
+    }
+}
+
+// Frames are written outermost first, the layout flamegraph tools expect
+static char *buildFoldedStack(lua_State *pLuaState, int depth)
+{
+    char foldedStack[TKN_LUA_PROFILE_MAX_STACK_LENGTH];
+    size_t length = 0;
+    foldedStack[0] = '\0';
+    for (int level = depth - 1; level >= 0; level--)
+    {
+        lua_Debug luaDebug;
+        lua_getstack(pLuaState, level, &luaDebug);
+        lua_getinfo(pLuaState, "Sn", &luaDebug);
+        const char *separator = level == depth - 1 ? "" : ";";
+        int written;
+        if ('C' == luaDebug.what[0])
+        {
+            written = snprintf(foldedStack + length, sizeof(foldedStack) - length, "%s%s [C]", separator, luaDebug.name != NULL ? luaDebug.name : "?");
+        }
+        else if ('m' == luaDebug.what[0])
+        {
+            written = snprintf(foldedStack + length, sizeof(foldedStack) - length, "%smain (%s)", separator, luaDebug.short_src);
+        }
+        else
+        {
+            written = snprintf(foldedStack + length, sizeof(foldedStack) - length, "%s%s (%s:%d)", separator, luaDebug.name != NULL ? luaDebug.name : "?", luaDebug.short_src, luaDebug.linedefined);
+        }
+        // snprintf reports the untruncated length, deep stacks are cut at the buffer end
+        length += written > 0 ? (size_t)written : 0;
+        length = length < sizeof(foldedStack) ? length : sizeof(foldedStack) - 1;
+    }
+    char *copiedFoldedStack = tknMalloc(length + 1);
+    memcpy(copiedFoldedStack, foldedStack, length + 1);
+    return copiedFoldedStack;
+}
+
+static void sampleLuaStack(lua_State *pLuaState, lua_Debug *pLuaDebug)
+{
+    TknContext *pTknContext = *(TknContext **)lua_getextraspace(pLuaState);
+    // Function sources and definition lines identify the frames without looking up any names, C functions all share the "=[C]" source
+    TknLuaProfileFrame frames[TKN_LUA_PROFILE_MAX_DEPTH];
+    uint64_t stackHash = 0xcbf29ce484222325ull;
+    int depth = 0;
+    lua_Debug luaDebug;
+    while (depth < TKN_LUA_PROFILE_MAX_DEPTH && lua_getstack(pLuaState, depth, &luaDebug))
+    {
+        lua_getinfo(pLuaState, "Sf", &luaDebug);
+        if ('C' == luaDebug.what[0])
+        {
+            frames[depth] = (TknLuaProfileFrame){
+                .function = lua_topointer(pLuaState, -1),
+                .linedefined = -1,
+            };
+        }
+        else
+        {
+            frames[depth] = (TknLuaProfileFrame){
+                .function = luaDebug.source,
+                .linedefined = luaDebug.linedefined,
+            };
+        }
+        lua_pop(pLuaState, 1);
+        stackHash = (stackHash ^ (uint64_t)(uintptr_t)frames[depth].function) * 0x100000001b3ull;
+        stackHash = (stackHash ^ (uint64_t)(uint32_t)frames[depth].linedefined) * 0x100000001b3ull;
+        depth++;
+    }
+    if (depth > 0)
+    {
+        reserveLuaProfileStack(pTknContext);
+        TknLuaProfileStack *pTknLuaProfileStack = findLuaProfileStack(pTknContext->luaProfileStacks, pTknContext->luaProfileStackCapacity, stackHash, (uint32_t)depth, frames);
+        if (NULL == pTknLuaProfileStack->foldedStack)
+        {
+            TknLuaProfileFrame *copiedFrames = tknMalloc(sizeof(TknLuaProfileFrame) * (size_t)depth);
+            memcpy(copiedFrames, frames, sizeof(TknLuaProfileFrame) * (size_t)depth);
+            *pTknLuaProfileStack = (TknLuaProfileStack){
+                .stackHash = stackHash,
+                .sampleCount = 0,
+                .depth = (uint32_t)depth,
+                .frames = copiedFrames,
+                .foldedStack = buildFoldedStack(pLuaState, depth),
+            };
+            pTknContext->luaProfileStackCount++;
+        }
+        else
+        {
+            // Seen before
+        }
+        pTknLuaProfileStack->sampleCount++;
+        pTknContext->luaProfileSampleCount++;
+    }
+    else
+    {
+        // Skip
+    }
+}
+
+// tkn.tknStartLuaProfiler(instructionCount), samples the call stack every instructionCount VM instructions and drops earlier samples
+static int luaStartLuaProfiler(lua_State *pLuaState)
+{
+    TknContext *pTknContext = *(TknContext **)lua_getextraspace(pLuaState);
+    lua_Integer instructionCount = lua_isinteger(pLuaState, -1) ? lua_tointeger(pLuaState, -1) : TKN_DEFAULT_LUA_PROFILE_INSTRUCTION_COUNT;
+    instructionCount = instructionCount < 1 ? 1 : (instructionCount > INT32_MAX ? INT32_MAX : instructionCount);
+    clearLuaProfileStacks(pTknContext);
+    // Only the main thread is hooked, coroutines would need their own hook
+    lua_sethook(pTknContext->pLuaState, sampleLuaStack, LUA_MASKCOUNT, (int)instructionCount);
+    pTknContext->isLuaProfilerRunning = true;
+    return 0;
+}
+
+// tkn.tknStopLuaProfiler(), removes the hook so Lua runs at full speed again, the samples are kept for dumping
+static int luaStopLuaProfiler(lua_State *pLuaState)
+{
+    TknContext *pTknContext = *(TknContext **)lua_getextraspace(pLuaState);
+    lua_sethook(pTknContext->pLuaState, NULL, 0, 0);
+    pTknContext->isLuaProfilerRunning = false;
+    return 0;
+}
+
+// tkn.tknDumpLuaProfile(filePath), writes collapsed stacks ("a;b;c count" per line) for flamegraph.pl, speedscope and the like
+static int luaDumpLuaProfile(lua_State *pLuaState)
+{
+    TknContext *pTknContext = *(TknContext **)lua_getextraspace(pLuaState);
+    const char *filePath = lua_tostring(pLuaState, -1);
+    FILE *file = fopen(filePath, "w");
+    if (NULL == file)
+    {
+        tknWarning("Failed to open %s for writing, the Lua profile is not saved", filePath);
+        lua_pushboolean(pLuaState, 0);
+    }
+    else
+    {
+        for (uint32_t stackIndex = 0; stackIndex < pTknContext->luaProfileStackCapacity; stackIndex++)
+        {
+            TknLuaProfileStack *pTknLuaProfileStack = &pTknContext->luaProfileStacks[stackIndex];
+            if (pTknLuaProfileStack->foldedStack != NULL)
+            {
+                fprintf(file, "%s %u\n", pTknLuaProfileStack->foldedStack, pTknLuaProfileStack->sampleCount);
+            }
+            else
+            {
+                // Empty slot
+            }
+        }
+        bool isWritten = 0 == fclose(file);
+        if (isWritten)
+        {
+            printf("Saved %u Lua samples over %u stacks to %s\n", pTknContext->luaProfileSampleCount, pTknContext->luaProfileStackCount, filePath);
+        }
+        else
+        {
+            tknWarning("Failed to write the Lua profile to %s", filePath);
+        }
+        lua_pushboolean(pLuaState, isWritten);
+    }
+    return 1;
+}
+
+TknContext *createTknContextPtr(const char *assetsPath, const char *cachePath, uint32_t luaLibraryCount, LuaLibrary *luaLibraries, int targetSwapchainImageCount, uint32_t frameInFlightCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D swapchainExtent)
 {
     TknContext *pTknContext = tknMalloc(sizeof(TknContext));
 
@@ -41,7 +303,17 @@ TknContext *createTknContextPtr(const char *assetsPath, uint32_t luaLibraryCount
         globalFragSpvPath,
     };
 
-    TknGfxContext *pTknGfxContext = tknCreateGfxContextPtr(targetSwapchainImageCount, targetVkSurfaceFormat, targetVkPresentMode, vkInstance, vkSurface, swapchainExtent, TKN_ARRAY_COUNT(spvPaths), spvPaths);
+    char pipelineCachePath[FILENAME_MAX];
+    if (cachePath != NULL)
+    {
+        snprintf(pipelineCachePath, FILENAME_MAX, "%s/pipeline.cache", cachePath);
+    }
+    else
+    {
+        // Pipelines are compiled from scratch on every start
+    }
+
+    TknGfxContext *pTknGfxContext = tknCreateGfxContextPtr(targetSwapchainImageCount, frameInFlightCount, targetVkSurfaceFormat, targetVkPresentMode, vkInstance, vkSurface, swapchainExtent, TKN_ARRAY_COUNT(spvPaths), spvPaths, cachePath != NULL ? pipelineCachePath : NULL);
 
     lua_State *pLuaState = luaL_newstate();
     tknAssert(pLuaState, "Failed to create Lua state");
@@ -55,6 +327,26 @@ TknContext *createTknContextPtr(const char *assetsPath, uint32_t luaLibraryCount
     lua_pop(pLuaState, 1);
 
     bindFunctions(pLuaState);
+    // The profiler hook only gets the lua_State, coroutines created later inherit the pointer
+    *(TknContext **)lua_getextraspace(pLuaState) = pTknContext;
+    *pTknContext = (TknContext){
+        .pLuaState = pLuaState,
+        .pTknGfxContext = pTknGfxContext,
+        .isLuaProfilerRunning = false,
+        .luaProfileSampleCount = 0,
+        .luaProfileStackCount = 0,
+        .luaProfileStackCapacity = 0,
+        .luaProfileStacks = NULL,
+    };
+    luaL_Reg luaProfilerRegs[] = {
+        {"tknStartLuaProfiler", luaStartLuaProfiler},
+        {"tknStopLuaProfiler", luaStopLuaProfiler},
+        {"tknDumpLuaProfile", luaDumpLuaProfile},
+        {NULL, NULL},
+    };
+    lua_getglobal(pLuaState, "tkn");
+    luaL_setfuncs(pLuaState, luaProfilerRegs, 0);
+    lua_pop(pLuaState, 1);
     for (uint32_t luaLibraryIndex = 0; luaLibraryIndex < luaLibraryCount; luaLibraryIndex++)
     {
         LuaLibrary luaLibrary = luaLibraries[luaLibraryIndex];
@@ -76,11 +368,6 @@ TknContext *createTknContextPtr(const char *assetsPath, uint32_t luaLibraryCount
     assertLuaResult(pLuaState, lua_pcall(pLuaState, 2, 0, -4));
     lua_pop(pLuaState, 1);
 
-    TknContext TknContext = {
-        .pTknGfxContext = pTknGfxContext,
-        .pLuaState = pLuaState,
-    };
-    *pTknContext = TknContext;
     return pTknContext;
 }
 
@@ -100,12 +387,17 @@ void destroyTknContextPtr(TknContext *pTknContext)
     lua_pop(pLuaState, 2);
 
     tknDestroyGfxContextPtr(pTknGfxContext);
+    // Lua scope names die with the state, and the worker threads are joined by now
+    tknDestroyProfiler();
+    lua_sethook(pLuaState, NULL, 0, 0);
+    clearLuaProfileStacks(pTknContext);
     lua_close(pLuaState);
     tknFree(pTknContext);
 }
 
 void updateTknContext(TknContext *pTknContext, VkExtent2D swapchainExtent, uint32_t keyCodeStateCount, InputState *keyCodeStates, uint32_t mouseCodeStateCount, InputState *mouseCodeStates, float scrollingDeltaX, float scrollingDeltaY, float mousePositionNDCX, float mousePositionNDCY, const char *inputText, bool *pShouldQuit, bool *pImeEnabled)
 {
+    tknBeginProfileScope("updateTknContext");
     lua_State *pLuaState = pTknContext->pLuaState;
     *pShouldQuit = false;
     *pImeEnabled = false;
@@ -166,7 +458,10 @@ void updateTknContext(TknContext *pTknContext, VkExtent2D swapchainExtent, uint3
     lua_pushlightuserdata(pLuaState, pTknGfxContext);
     lua_pushinteger(pLuaState, swapchainExtent.width);
     lua_pushinteger(pLuaState, swapchainExtent.height);
-    assertLuaResult(pLuaState, lua_pcall(pLuaState, 3, 1, -6));
+    TKN_PROFILE_SCOPE("tknEngine.update")
+    {
+        assertLuaResult(pLuaState, lua_pcall(pLuaState, 3, 1, -6));
+    }
 
     // Get return value if present
     if (lua_isboolean(pLuaState, -1))
@@ -174,17 +469,28 @@ void updateTknContext(TknContext *pTknContext, VkExtent2D swapchainExtent, uint3
         *pShouldQuit = lua_toboolean(pLuaState, -1);
     }
     lua_pop(pLuaState, 1); // Pop return value, errorHandler and tknEngine table
-    TknFrame *pTknFrame = tknAcquireFramePtr(pTknGfxContext, swapchainExtent);
+    TknFrame *pTknFrame = NULL;
+    TKN_PROFILE_SCOPE("tknAcquireFramePtr")
+    {
+        pTknFrame = tknAcquireFramePtr(pTknGfxContext, swapchainExtent);
+    }
     if (pTknFrame != NULL)
     {
         lua_getfield(pLuaState, -1, "recordFrame");
         lua_pushlightuserdata(pLuaState, pTknGfxContext);
         lua_pushlightuserdata(pLuaState, pTknFrame);
-        int recordFrameResult = lua_pcall(pLuaState, 2, 0, -5);
+        int recordFrameResult = LUA_OK;
+        TKN_PROFILE_SCOPE("tknEngine.recordFrame")
+        {
+            recordFrameResult = lua_pcall(pLuaState, 2, 0, -5);
+        }
         if (recordFrameResult == LUA_OK)
         {
             // Submit and present
-            tknSubmitAndPresentFramePtr(pTknGfxContext, pTknFrame);
+            TKN_PROFILE_SCOPE("tknSubmitAndPresentFramePtr")
+            {
+                tknSubmitAndPresentFramePtr(pTknGfxContext, pTknFrame);
+            }
         }
         else
         {
@@ -206,4 +512,5 @@ void updateTknContext(TknContext *pTknContext, VkExtent2D swapchainExtent, uint3
     lua_getfield(pLuaState, -1, "imeEnabled");
     *pImeEnabled = lua_toboolean(pLuaState, -1);
     lua_pop(pLuaState, 2);
+    tknEndProfileScope();
 }
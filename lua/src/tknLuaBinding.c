@@ -3,203 +3,597 @@
 #include <string.h>
 #include <ft2build.h>
 #include FT_FREETYPE_H
-// Helper function to calculate size from layout
-static VkDeviceSize calculateLayoutSize(lua_State *pLuaState, int layoutIndex)
+#define TKN_COMPILED_LAYOUT_METATABLE "TknCompiledLayout"
+#define TKN_COMPILED_LAYOUT_CACHE "tknCompiledLayouts"
+#define TKN_LUA_BUFFER_METATABLE "TknLuaBuffer"
+#define TKN_LUA_VIEW_METATABLE "TknLuaView"
+
+typedef struct
+{
+    NumberType type;
+    uint32_t count;
+    uint32_t typeSize;
+    VkDeviceSize offset;
+} TknCompiledLayoutField;
+
+// A format table read once. Field names stay in the userdata's user value as Lua strings, so packing looks them up without interning.
+// The same table maps each name back to its field index for the buffer accessors
+typedef struct
+{
+    uint32_t fieldCount;
+    VkDeviceSize stride;
+    TknCompiledLayoutField tknCompiledLayoutFields[];
+} TknCompiledLayout;
+
+// Elements already packed with a compiled layout, written from Lua field by field instead of through data tables.
+// The user value keeps the compiled layout alive
+typedef struct
 {
-    VkDeviceSize totalSize = 0;
-    lua_len(pLuaState, layoutIndex);
+    TknCompiledLayout *pTknCompiledLayout;
+    uint32_t count;
+    uint8_t data[];
+} TknLuaBuffer;
+
+// Writes straight into the CPU copy of a uniform buffer, a dynamic buffer or an instance, frames copy only the written range.
+// The user value keeps the compiled layout alive, the target must outlive the view
+typedef struct
+{
+    TknGfxContext *pTknGfxContext;
+    TknUniformBuffer *pTknUniformBuffer;
+    TknDynamicBuffer *pTknDynamicBuffer;
+    TknInstance *pTknInstance;
+    TknCompiledLayout *pTknCompiledLayout;
+} TknLuaView;
+
+static uint32_t getNumberTypeSize(NumberType type)
+{
+    if (type == TYPE_UINT8 || type == TYPE_INT8)
+        return 1;
+    else if (type == TYPE_UINT16 || type == TYPE_INT16)
+        return 2;
+    else if (type == TYPE_UINT64 || type == TYPE_INT64 || type == TYPE_DOUBLE)
+        return 8;
+    else
+        return 4; // 32 bit types and the default
+}
+
+// Pushes a new compiled layout userdata for the format table at layoutIndex
+static TknCompiledLayout *compileLayout(lua_State *pLuaState, int layoutIndex)
+{
+    int absoluteLayoutIndex = lua_absindex(pLuaState, layoutIndex);
+    lua_len(pLuaState, absoluteLayoutIndex);
     uint32_t fieldCount = (uint32_t)lua_tointeger(pLuaState, -1);
     lua_pop(pLuaState, 1);
 
+    TknCompiledLayout *pTknCompiledLayout = lua_newuserdatauv(pLuaState, sizeof(TknCompiledLayout) + sizeof(TknCompiledLayoutField) * fieldCount, 1);
+    pTknCompiledLayout->fieldCount = fieldCount;
+    pTknCompiledLayout->stride = 0;
+    lua_createtable(pLuaState, (int)fieldCount, 0);
     for (uint32_t i = 0; i < fieldCount; i++)
     {
-        lua_rawgeti(pLuaState, layoutIndex, i + 1);
-
+        lua_rawgeti(pLuaState, absoluteLayoutIndex, i + 1);
+        lua_getfield(pLuaState, -1, "name");
+        lua_rawseti(pLuaState, -3, i + 1);
+        lua_getfield(pLuaState, -1, "name");
+        lua_pushinteger(pLuaState, (lua_Integer)i + 1);
+        lua_rawset(pLuaState, -4);
         lua_getfield(pLuaState, -1, "type");
-        uint32_t type = (uint32_t)lua_tointeger(pLuaState, -1);
+        NumberType type = (NumberType)lua_tointeger(pLuaState, -1);
         lua_pop(pLuaState, 1);
-
         lua_getfield(pLuaState, -1, "count");
         uint32_t count = (uint32_t)lua_tointeger(pLuaState, -1);
-        lua_pop(pLuaState, 1);
+        lua_pop(pLuaState, 2);
 
-        uint32_t typeSize = 0;
-        if (type == TYPE_UINT8)
-            typeSize = 1;
-        else if (type == TYPE_UINT16)
-            typeSize = 2;
-        else if (type == TYPE_UINT32)
-            typeSize = 4;
-        else if (type == TYPE_UINT64)
-            typeSize = 8;
-        else if (type == TYPE_INT8)
-            typeSize = 1;
-        else if (type == TYPE_INT16)
-            typeSize = 2;
-        else if (type == TYPE_INT32)
-            typeSize = 4;
-        else if (type == TYPE_INT64)
-            typeSize = 8;
-        else if (type == TYPE_FLOAT)
-            typeSize = 4;
-        else if (type == TYPE_DOUBLE)
-            typeSize = 8;
+        uint32_t typeSize = getNumberTypeSize(type);
+        pTknCompiledLayout->tknCompiledLayoutFields[i] = (TknCompiledLayoutField){
+            .type = type,
+            .count = count,
+            .typeSize = typeSize,
+            .offset = pTknCompiledLayout->stride,
+        };
+        pTknCompiledLayout->stride += (VkDeviceSize)typeSize * count;
+    }
+    lua_setiuservalue(pLuaState, -2, 1);
+    luaL_setmetatable(pLuaState, TKN_COMPILED_LAYOUT_METATABLE);
+    return pTknCompiledLayout;
+}
+
+// Pushes the compiled layout for the value at layoutIndex, either a compiled layout or a format table.
+// Format tables are compiled on first use and cached for as long as the table lives, so they must not change afterwards.
+static TknCompiledLayout *pushCompiledLayout(lua_State *pLuaState, int layoutIndex)
+{
+    int absoluteLayoutIndex = lua_absindex(pLuaState, layoutIndex);
+    TknCompiledLayout *pTknCompiledLayout = luaL_testudata(pLuaState, absoluteLayoutIndex, TKN_COMPILED_LAYOUT_METATABLE);
+    if (pTknCompiledLayout != NULL)
+    {
+        lua_pushvalue(pLuaState, absoluteLayoutIndex);
+    }
+    else
+    {
+        lua_getfield(pLuaState, LUA_REGISTRYINDEX, TKN_COMPILED_LAYOUT_CACHE);
+        lua_pushvalue(pLuaState, absoluteLayoutIndex);
+        lua_rawget(pLuaState, -2);
+        pTknCompiledLayout = luaL_testudata(pLuaState, -1, TKN_COMPILED_LAYOUT_METATABLE);
+        if (NULL == pTknCompiledLayout)
+        {
+            lua_pop(pLuaState, 1);
+            pTknCompiledLayout = compileLayout(pLuaState, absoluteLayoutIndex);
+            lua_pushvalue(pLuaState, absoluteLayoutIndex);
+            lua_pushvalue(pLuaState, -2);
+            lua_rawset(pLuaState, -4);
+        }
         else
         {
-            typeSize = 4; // default
+            // Compiled before
         }
+        lua_remove(pLuaState, -2);
+    }
+    return pTknCompiledLayout;
+}
 
-        totalSize += typeSize * count;
-        lua_pop(pLuaState, 1);
+// Writes one field of every element, column by column so the type is resolved once per field rather than per value
+#define TKN_PACK_COLUMN(valueType, luaToValue)                                             \
+    for (uint32_t elementIndex = 0; elementIndex < elementCount; elementIndex++)           \
+    {                                                                                      \
+        uint8_t *elementPtr = fieldPtr + elementIndex * stride;                            \
+        lua_Integer valueIndex = (lua_Integer)elementIndex * count + 1;                    \
+        for (uint32_t j = 0; j < count; j++)                                               \
+        {                                                                                  \
+            lua_rawgeti(pLuaState, -1, valueIndex + j);                                    \
+            valueType value = (valueType)luaToValue(pLuaState, -1);                        \
+            memcpy(elementPtr + j * sizeof(valueType), &value, sizeof(valueType));         \
+            lua_pop(pLuaState, 1);                                                         \
+        }                                                                                  \
     }
 
-    return totalSize;
+static void packColumn(lua_State *pLuaState, uint8_t *fieldPtr, VkDeviceSize stride, uint32_t elementCount, TknCompiledLayoutField *pTknCompiledLayoutField)
+{
+    uint32_t count = pTknCompiledLayoutField->count;
+    switch (pTknCompiledLayoutField->type)
+    {
+    case TYPE_UINT8:
+    case TYPE_INT8:
+        TKN_PACK_COLUMN(uint8_t, lua_tointeger)
+        break;
+    case TYPE_UINT16:
+    case TYPE_INT16:
+        TKN_PACK_COLUMN(uint16_t, lua_tointeger)
+        break;
+    case TYPE_UINT64:
+    case TYPE_INT64:
+        TKN_PACK_COLUMN(uint64_t, lua_tointeger)
+        break;
+    case TYPE_FLOAT:
+        TKN_PACK_COLUMN(float, lua_tonumber)
+        break;
+    case TYPE_DOUBLE:
+        TKN_PACK_COLUMN(double, lua_tonumber)
+        break;
+    default:
+        TKN_PACK_COLUMN(uint32_t, lua_tointeger)
+        break;
+    }
 }
+#undef TKN_PACK_COLUMN
 
-// Helper function to pack data from Lua table according to layout
-static void *packDataFromLayout(lua_State *pLuaState, int layoutIndex, int dataIndex, VkDeviceSize *outSize)
+static void writeLuaNumber(lua_State *pLuaState, int valueIndex, NumberType type, uint8_t *valuePtr)
 {
-    // Convert negative indices to absolute indices to avoid stack changes affecting them
-    int absoluteLayoutIndex = lua_absindex(pLuaState, layoutIndex);
-    int absoluteDataIndex = lua_absindex(pLuaState, dataIndex);
+    if (type == TYPE_FLOAT)
+    {
+        float floatValue = (float)lua_tonumber(pLuaState, valueIndex);
+        memcpy(valuePtr, &floatValue, sizeof(floatValue));
+    }
+    else if (type == TYPE_DOUBLE)
+    {
+        double doubleValue = (double)lua_tonumber(pLuaState, valueIndex);
+        memcpy(valuePtr, &doubleValue, sizeof(doubleValue));
+    }
+    else
+    {
+        // Little endian, the low bytes fit every integer size
+        uint64_t integerValue = (uint64_t)lua_tointeger(pLuaState, valueIndex);
+        memcpy(valuePtr, &integerValue, getNumberTypeSize(type));
+    }
+}
 
-    VkDeviceSize singleVertexSize = calculateLayoutSize(pLuaState, absoluteLayoutIndex);
+static void pushLuaNumber(lua_State *pLuaState, NumberType type, const uint8_t *valuePtr)
+{
+    switch (type)
+    {
+    case TYPE_UINT8:
+        lua_pushinteger(pLuaState, (lua_Integer)*valuePtr);
+        break;
+    case TYPE_INT8:
+        lua_pushinteger(pLuaState, (lua_Integer)(int8_t)*valuePtr);
+        break;
+    case TYPE_UINT16:
+    {
+        uint16_t value;
+        memcpy(&value, valuePtr, sizeof(value));
+        lua_pushinteger(pLuaState, (lua_Integer)value);
+        break;
+    }
+    case TYPE_INT16:
+    {
+        int16_t value;
+        memcpy(&value, valuePtr, sizeof(value));
+        lua_pushinteger(pLuaState, (lua_Integer)value);
+        break;
+    }
+    case TYPE_INT32:
+    {
+        int32_t value;
+        memcpy(&value, valuePtr, sizeof(value));
+        lua_pushinteger(pLuaState, (lua_Integer)value);
+        break;
+    }
+    case TYPE_UINT64:
+    case TYPE_INT64:
+    {
+        int64_t value;
+        memcpy(&value, valuePtr, sizeof(value));
+        lua_pushinteger(pLuaState, (lua_Integer)value);
+        break;
+    }
+    case TYPE_FLOAT:
+    {
+        float value;
+        memcpy(&value, valuePtr, sizeof(value));
+        lua_pushnumber(pLuaState, (lua_Number)value);
+        break;
+    }
+    case TYPE_DOUBLE:
+    {
+        double value;
+        memcpy(&value, valuePtr, sizeof(value));
+        lua_pushnumber(pLuaState, (lua_Number)value);
+        break;
+    }
+    default:
+    {
+        uint32_t value;
+        memcpy(&value, valuePtr, sizeof(value));
+        lua_pushinteger(pLuaState, (lua_Integer)value);
+        break;
+    }
+    }
+}
 
-    // Calculate vertex count by checking the first field's array length
-    uint32_t vertexCount = 0;
-    lua_len(pLuaState, absoluteLayoutIndex);
-    uint32_t fieldCount = (uint32_t)lua_tointeger(pLuaState, -1);
-    lua_pop(pLuaState, 1);
+// Single values are written to the first component of every element
+static void packScalar(lua_State *pLuaState, uint8_t *fieldPtr, VkDeviceSize stride, uint32_t elementCount, TknCompiledLayoutField *pTknCompiledLayoutField)
+{
+    uint8_t value[8];
+    writeLuaNumber(pLuaState, -1, pTknCompiledLayoutField->type, value);
+    for (uint32_t elementIndex = 0; elementIndex < elementCount; elementIndex++)
+    {
+        memcpy(fieldPtr + elementIndex * stride, value, pTknCompiledLayoutField->typeSize);
+    }
+}
 
-    if (fieldCount > 0)
+// Packs the data table at dataIndex with the layout at layoutIndex, a compiled layout or a format table.
+// The element count follows the first field. Missing fields are zero.
+// The result lives in scratch memory, callers rewind to their scratch marker once consumed.
+// A buffer from tknNewBuffer is already packed and returned as is, its layout may be nil
+static void *packDataFromLayout(lua_State *pLuaState, int layoutIndex, int dataIndex, VkDeviceSize *outSize, uint32_t *pElementCount)
+{
+    // Convert negative indices to absolute indices to avoid stack changes affecting them
+    int absoluteDataIndex = lua_absindex(pLuaState, dataIndex);
+    TknLuaBuffer *pTknLuaBuffer = luaL_testudata(pLuaState, absoluteDataIndex, TKN_LUA_BUFFER_METATABLE);
+    if (pTknLuaBuffer != NULL)
     {
-        // Get first field info
-        lua_rawgeti(pLuaState, absoluteLayoutIndex, 1);
-        lua_getfield(pLuaState, -1, "name");
-        const char *firstFieldName = lua_tostring(pLuaState, -1);
-        lua_pop(pLuaState, 1);
-        lua_getfield(pLuaState, -1, "count");
-        uint32_t firstFieldCount = (uint32_t)lua_tointeger(pLuaState, -1);
-        lua_pop(pLuaState, 2);
+        VkDeviceSize bufferStride = pTknLuaBuffer->pTknCompiledLayout->stride;
+        if (!lua_isnil(pLuaState, layoutIndex))
+        {
+            TknCompiledLayout *pTknCompiledLayout = pushCompiledLayout(pLuaState, layoutIndex);
+            tknAssert(pTknCompiledLayout->stride == bufferStride, "Buffer stride %llu does not match layout stride %llu", (unsigned long long)bufferStride, (unsigned long long)pTknCompiledLayout->stride);
+            lua_pop(pLuaState, 1);
+        }
+        else
+        {
+            // The buffer's own layout
+        }
+        *outSize = bufferStride * pTknLuaBuffer->count;
+        *pElementCount = pTknLuaBuffer->count;
+        return pTknLuaBuffer->data;
+    }
+    else
+    {
+        // Pack the data table
+    }
+    TknCompiledLayout *pTknCompiledLayout = pushCompiledLayout(pLuaState, layoutIndex);
+    lua_getiuservalue(pLuaState, -1, 1);
+    int nameTableIndex = lua_gettop(pLuaState);
 
-        // Get first field data to determine vertex count
-        lua_getfield(pLuaState, absoluteDataIndex, firstFieldName);
+    uint32_t elementCount = 0;
+    if (pTknCompiledLayout->fieldCount > 0)
+    {
+        lua_rawgeti(pLuaState, nameTableIndex, 1);
+        lua_rawget(pLuaState, absoluteDataIndex);
         if (lua_istable(pLuaState, -1))
         {
-            lua_len(pLuaState, -1);
-            uint32_t arrayLength = (uint32_t)lua_tointeger(pLuaState, -1);
-            lua_pop(pLuaState, 1);
-            vertexCount = arrayLength / firstFieldCount;
+            uint32_t firstFieldCount = pTknCompiledLayout->tknCompiledLayoutFields[0].count;
+            elementCount = firstFieldCount > 0 ? (uint32_t)lua_rawlen(pLuaState, -1) / firstFieldCount : 0;
         }
         else if (!lua_isnil(pLuaState, -1))
         {
             // Single scalar value provided for this field -> treat as one "vertex" (uniform buffer single element)
-            vertexCount = 1;
+            elementCount = 1;
+        }
+        lua_pop(pLuaState, 1);
+    }
+    else
+    {
+        // Empty layout
+    }
+
+    VkDeviceSize stride = pTknCompiledLayout->stride;
+    VkDeviceSize totalSize = stride * elementCount;
+    uint8_t *data = tknAllocateScratch(totalSize);
+    memset(data, 0, totalSize);
+    for (uint32_t i = 0; i < pTknCompiledLayout->fieldCount; i++)
+    {
+        TknCompiledLayoutField *pTknCompiledLayoutField = &pTknCompiledLayout->tknCompiledLayoutFields[i];
+        uint8_t *fieldPtr = data + pTknCompiledLayoutField->offset;
+        lua_rawgeti(pLuaState, nameTableIndex, i + 1);
+        lua_rawget(pLuaState, absoluteDataIndex);
+        if (lua_istable(pLuaState, -1))
+        {
+            packColumn(pLuaState, fieldPtr, stride, elementCount, pTknCompiledLayoutField);
+        }
+        else if (!lua_isnil(pLuaState, -1))
+        {
+            packScalar(pLuaState, fieldPtr, stride, elementCount, pTknCompiledLayoutField);
+        }
+        else
+        {
+            // Left zero
         }
         lua_pop(pLuaState, 1);
     }
+    lua_pop(pLuaState, 2);
+    *outSize = totalSize;
+    *pElementCount = elementCount;
+    return data;
+}
 
-    VkDeviceSize totalSize = singleVertexSize * vertexCount;
-    // printf("Calculated vertex count: %u, single vertex size: %llu, total size: %llu\n", vertexCount, singleVertexSize, totalSize);
-    void *data = tknMalloc(totalSize);
-    uint8_t *dataPtr = (uint8_t *)data;
+// tkn.tknCompileLayout(format), compiles a format table up front. Format tables passed directly are compiled on first use
+static int luaCompileLayout(lua_State *pLuaState)
+{
+    compileLayout(pLuaState, -1);
+    return 1;
+}
 
-    lua_len(pLuaState, absoluteLayoutIndex);
-    fieldCount = (uint32_t)lua_tointeger(pLuaState, -1);
-    lua_pop(pLuaState, 1);
+// tkn.tknNewBuffer(layout, count), zeroed elements owned by the garbage collector
+static int luaNewBuffer(lua_State *pLuaState)
+{
+    uint32_t count = (uint32_t)lua_tointeger(pLuaState, -1);
+    TknCompiledLayout *pTknCompiledLayout = pushCompiledLayout(pLuaState, -2);
+    VkDeviceSize size = pTknCompiledLayout->stride * count;
+    TknLuaBuffer *pTknLuaBuffer = lua_newuserdatauv(pLuaState, sizeof(TknLuaBuffer) + (size_t)size, 1);
+    pTknLuaBuffer->pTknCompiledLayout = pTknCompiledLayout;
+    pTknLuaBuffer->count = count;
+    memset(pTknLuaBuffer->data, 0, (size_t)size);
+    lua_pushvalue(pLuaState, -2);
+    lua_setiuservalue(pLuaState, -2, 1);
+    luaL_setmetatable(pLuaState, TKN_LUA_BUFFER_METATABLE);
+    return 1;
+}
 
-    // Pack data for each vertex
-    for (uint32_t vertexIdx = 0; vertexIdx < vertexCount; vertexIdx++)
+// Looks up a field by name through the compiled layout kept in the user value of the userdata at ownerIndex
+static TknCompiledLayoutField *getLayoutField(lua_State *pLuaState, TknCompiledLayout *pTknCompiledLayout, int ownerIndex, int nameIndex)
+{
+    lua_getiuservalue(pLuaState, ownerIndex, 1);
+    lua_getiuservalue(pLuaState, -1, 1);
+    lua_pushvalue(pLuaState, nameIndex);
+    lua_rawget(pLuaState, -2);
+    tknAssert(lua_isinteger(pLuaState, -1), "Unknown layout field: %s", lua_tostring(pLuaState, nameIndex));
+    uint32_t fieldIndex = (uint32_t)lua_tointeger(pLuaState, -1) - 1;
+    lua_pop(pLuaState, 3);
+    return &pTknCompiledLayout->tknCompiledLayoutFields[fieldIndex];
+}
+
+// The values start at firstValueIndex, either as arguments or as a single table holding the whole field
+static uint32_t getFieldValueCount(lua_State *pLuaState, int firstValueIndex, TknCompiledLayoutField *pTknCompiledLayoutField)
+{
+    if (lua_istable(pLuaState, firstValueIndex))
     {
-        for (uint32_t i = 0; i < fieldCount; i++)
-        {
-            lua_rawgeti(pLuaState, absoluteLayoutIndex, i + 1);
+        return pTknCompiledLayoutField->count;
+    }
+    else
+    {
+        uint32_t valueCount = (uint32_t)(lua_gettop(pLuaState) - firstValueIndex + 1);
+        tknAssert(valueCount <= pTknCompiledLayoutField->count, "%u values for a field of %u", valueCount, pTknCompiledLayoutField->count);
+        return valueCount;
+    }
+}
 
-            lua_getfield(pLuaState, -1, "name");
-            const char *fieldName = lua_tostring(pLuaState, -1);
+static void writeFieldValues(lua_State *pLuaState, int firstValueIndex, TknCompiledLayoutField *pTknCompiledLayoutField, uint32_t valueCount, uint8_t *valuePtr)
+{
+    if (lua_istable(pLuaState, firstValueIndex))
+    {
+        for (uint32_t j = 0; j < valueCount; j++)
+        {
+            lua_rawgeti(pLuaState, firstValueIndex, j + 1);
+            writeLuaNumber(pLuaState, -1, pTknCompiledLayoutField->type, valuePtr + j * pTknCompiledLayoutField->typeSize);
             lua_pop(pLuaState, 1);
+        }
+    }
+    else
+    {
+        for (uint32_t j = 0; j < valueCount; j++)
+        {
+            writeLuaNumber(pLuaState, firstValueIndex + (int)j, pTknCompiledLayoutField->type, valuePtr + j * pTknCompiledLayoutField->typeSize);
+        }
+    }
+}
 
-            lua_getfield(pLuaState, -1, "type");
-            uint32_t type = (uint32_t)lua_tointeger(pLuaState, -1);
-            lua_pop(pLuaState, 1);
+static uint8_t *getLuaBufferValuePtr(lua_State *pLuaState, TknLuaBuffer *pTknLuaBuffer, lua_Integer index, TknCompiledLayoutField *pTknCompiledLayoutField)
+{
+    tknAssert(index >= 1 && index <= (lua_Integer)pTknLuaBuffer->count, "Buffer index %lld out of range [1, %u]", (long long)index, pTknLuaBuffer->count);
+    return pTknLuaBuffer->data + (VkDeviceSize)(index - 1) * pTknLuaBuffer->pTknCompiledLayout->stride + pTknCompiledLayoutField->offset;
+}
 
-            lua_getfield(pLuaState, -1, "count");
-            uint32_t count = (uint32_t)lua_tointeger(pLuaState, -1);
-            lua_pop(pLuaState, 1);
+// buffer:set(index, name, ...) writes one element's field from the values, or from a single table of values
+static int luaSetLuaBufferValue(lua_State *pLuaState)
+{
+    TknLuaBuffer *pTknLuaBuffer = luaL_checkudata(pLuaState, 1, TKN_LUA_BUFFER_METATABLE);
+    TknCompiledLayoutField *pTknCompiledLayoutField = getLayoutField(pLuaState, pTknLuaBuffer->pTknCompiledLayout, 1, 3);
+    uint8_t *valuePtr = getLuaBufferValuePtr(pLuaState, pTknLuaBuffer, lua_tointeger(pLuaState, 2), pTknCompiledLayoutField);
+    writeFieldValues(pLuaState, 4, pTknCompiledLayoutField, getFieldValueCount(pLuaState, 4, pTknCompiledLayoutField), valuePtr);
+    return 0;
+}
 
-            // Get data for this field
-            lua_getfield(pLuaState, absoluteDataIndex, fieldName);
-            if (!lua_isnil(pLuaState, -1))
-            {
-                if (lua_istable(pLuaState, -1))
-                {
-                    // Array data - get data for current vertex
-                    for (uint32_t j = 0; j < count; j++)
-                    {
-                        uint32_t dataIndex = vertexIdx * count + j + 1; // Lua arrays are 1-indexed
-                        lua_rawgeti(pLuaState, -1, dataIndex);
-                        if (type == TYPE_UINT8 || type == TYPE_INT8)
-                        {
-                            uint8_t value = (uint8_t)lua_tointeger(pLuaState, -1);
-                            memcpy(dataPtr, &value, 1);
-                            dataPtr += 1;
-                        }
-                        else if (type == TYPE_UINT16 || type == TYPE_INT16)
-                        {
-                            uint16_t value = (uint16_t)lua_tointeger(pLuaState, -1);
-                            memcpy(dataPtr, &value, 2);
-                            dataPtr += 2;
-                        }
-                        else if (type == TYPE_UINT32 || type == TYPE_INT32)
-                        {
-                            uint32_t value = (uint32_t)lua_tointeger(pLuaState, -1);
-                            memcpy(dataPtr, &value, 4);
-                            dataPtr += 4;
-                        }
-                        else if (type == TYPE_UINT64 || type == TYPE_INT64)
-                        {
-                            uint64_t value = (uint64_t)lua_tointeger(pLuaState, -1);
-                            memcpy(dataPtr, &value, 8);
-                            dataPtr += 8;
-                        }
-                        else if (type == TYPE_FLOAT)
-                        {
-                            float value = (float)lua_tonumber(pLuaState, -1);
-                            memcpy(dataPtr, &value, 4);
-                            dataPtr += 4;
-                        }
-                        else if (type == TYPE_DOUBLE)
-                        {
-                            double value = (double)lua_tonumber(pLuaState, -1);
-                            memcpy(dataPtr, &value, 8);
-                            dataPtr += 8;
-                        }
-                        lua_pop(pLuaState, 1);
-                    }
-                }
-                else
-                {
-                    // Single value - repeat for each vertex
-                    if (type == TYPE_FLOAT)
-                    {
-                        float value = (float)lua_tonumber(pLuaState, -1);
-                        memcpy(dataPtr, &value, 4);
-                        dataPtr += 4;
-                    }
-                    else
-                    {
-                        uint32_t value = (uint32_t)lua_tointeger(pLuaState, -1);
-                        memcpy(dataPtr, &value, 4);
-                        dataPtr += 4;
-                    }
-                }
-            }
-            lua_pop(pLuaState, 1); // pop field data
-            lua_pop(pLuaState, 1); // pop layout entry
+// buffer:get(index, name) returns the field's values
+static int luaGetLuaBufferValue(lua_State *pLuaState)
+{
+    TknLuaBuffer *pTknLuaBuffer = luaL_checkudata(pLuaState, 1, TKN_LUA_BUFFER_METATABLE);
+    TknCompiledLayoutField *pTknCompiledLayoutField = getLayoutField(pLuaState, pTknLuaBuffer->pTknCompiledLayout, 1, 3);
+    uint8_t *valuePtr = getLuaBufferValuePtr(pLuaState, pTknLuaBuffer, lua_tointeger(pLuaState, 2), pTknCompiledLayoutField);
+    luaL_checkstack(pLuaState, (int)pTknCompiledLayoutField->count, "Too many values");
+    for (uint32_t j = 0; j < pTknCompiledLayoutField->count; j++)
+    {
+        pushLuaNumber(pLuaState, pTknCompiledLayoutField->type, valuePtr + j * pTknCompiledLayoutField->typeSize);
+    }
+    return (int)pTknCompiledLayoutField->count;
+}
+
+// buffer:setField(name, values) writes the field of every element from a flat array, like a data table column.
+// Elements past the end of the array keep their values, a single number is written to all of them
+static int luaSetLuaBufferField(lua_State *pLuaState)
+{
+    TknLuaBuffer *pTknLuaBuffer = luaL_checkudata(pLuaState, 1, TKN_LUA_BUFFER_METATABLE);
+    TknCompiledLayoutField *pTknCompiledLayoutField = getLayoutField(pLuaState, pTknLuaBuffer->pTknCompiledLayout, 1, 2);
+    uint8_t *fieldPtr = pTknLuaBuffer->data + pTknCompiledLayoutField->offset;
+    VkDeviceSize stride = pTknLuaBuffer->pTknCompiledLayout->stride;
+    lua_settop(pLuaState, 3);
+    if (lua_istable(pLuaState, 3))
+    {
+        uint32_t elementCount = pTknCompiledLayoutField->count > 0 ? (uint32_t)lua_rawlen(pLuaState, 3) / pTknCompiledLayoutField->count : 0;
+        elementCount = elementCount < pTknLuaBuffer->count ? elementCount : pTknLuaBuffer->count;
+        packColumn(pLuaState, fieldPtr, stride, elementCount, pTknCompiledLayoutField);
+    }
+    else
+    {
+        packScalar(pLuaState, fieldPtr, stride, pTknLuaBuffer->count, pTknCompiledLayoutField);
+    }
+    return 0;
+}
+
+static int luaGetLuaBufferCount(lua_State *pLuaState)
+{
+    TknLuaBuffer *pTknLuaBuffer = luaL_checkudata(pLuaState, 1, TKN_LUA_BUFFER_METATABLE);
+    lua_pushinteger(pLuaState, (lua_Integer)pTknLuaBuffer->count);
+    return 1;
+}
+
+// Pushes a view over the uniform buffer, dynamic buffer or instance, layout at -1 may be nil when only raw offsets are written
+static void pushLuaView(lua_State *pLuaState, TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, TknDynamicBuffer *pTknDynamicBuffer, TknInstance *pTknInstance)
+{
+    TknCompiledLayout *pTknCompiledLayout = NULL;
+    if (lua_isnil(pLuaState, -1))
+    {
+        lua_pushnil(pLuaState);
+    }
+    else
+    {
+        pTknCompiledLayout = pushCompiledLayout(pLuaState, -1);
+    }
+    TknLuaView *pTknLuaView = lua_newuserdatauv(pLuaState, sizeof(TknLuaView), 1);
+    *pTknLuaView = (TknLuaView){
+        .pTknGfxContext = pTknGfxContext,
+        .pTknUniformBuffer = pTknUniformBuffer,
+        .pTknDynamicBuffer = pTknDynamicBuffer,
+        .pTknInstance = pTknInstance,
+        .pTknCompiledLayout = pTknCompiledLayout,
+    };
+    lua_pushvalue(pLuaState, -2);
+    lua_setiuservalue(pLuaState, -2, 1);
+    luaL_setmetatable(pLuaState, TKN_LUA_VIEW_METATABLE);
+}
+
+// tkn.tknGetUniformBufferView(pTknGfxContext, pTknUniformBuffer, layout)
+static int luaGetUniformBufferView(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -3);
+    TknUniformBuffer *pTknUniformBuffer = (TknUniformBuffer *)lua_touserdata(pLuaState, -2);
+    pushLuaView(pLuaState, pTknGfxContext, pTknUniformBuffer, NULL, NULL);
+    return 1;
+}
+
+// tkn.tknGetDynamicBufferView(pTknGfxContext, pTknDynamicBuffer, layout), view indices are elements
+static int luaGetDynamicBufferView(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -3);
+    TknDynamicBuffer *pTknDynamicBuffer = (TknDynamicBuffer *)lua_touserdata(pLuaState, -2);
+    pushLuaView(pLuaState, pTknGfxContext, NULL, pTknDynamicBuffer, NULL);
+    return 1;
+}
+
+// tkn.tknGetInstanceView(pTknGfxContext, pTknInstance, layout)
+static int luaGetInstanceView(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -3);
+    TknInstance *pTknInstance = (TknInstance *)lua_touserdata(pLuaState, -2);
+    pushLuaView(pLuaState, pTknGfxContext, NULL, NULL, pTknInstance);
+    return 1;
+}
+
+static uint8_t *writeLuaViewRange(TknLuaView *pTknLuaView, VkDeviceSize offset, VkDeviceSize size)
+{
+    if (pTknLuaView->pTknUniformBuffer != NULL)
+    {
+        return tknWriteUniformBufferRangePtr(pTknLuaView->pTknGfxContext, pTknLuaView->pTknUniformBuffer, offset, size);
+    }
+    else if (pTknLuaView->pTknDynamicBuffer != NULL)
+    {
+        return tknWriteDynamicBufferRangePtr(pTknLuaView->pTknGfxContext, pTknLuaView->pTknDynamicBuffer, offset, size);
+    }
+    else
+    {
+        return tknWriteInstanceRangePtr(pTknLuaView->pTknGfxContext, pTknLuaView->pTknInstance, offset, size);
+    }
+}
+
+// view:set(index, name, ...) writes one element's field like buffer:set, only those bytes are copied to the frames
+static int luaSetLuaViewValue(lua_State *pLuaState)
+{
+    TknLuaView *pTknLuaView = luaL_checkudata(pLuaState, 1, TKN_LUA_VIEW_METATABLE);
+    tknAssert(pTknLuaView->pTknCompiledLayout != NULL, "View was created without a layout");
+    TknCompiledLayoutField *pTknCompiledLayoutField = getLayoutField(pLuaState, pTknLuaView->pTknCompiledLayout, 1, 3);
+    lua_Integer index = luaL_checkinteger(pLuaState, 2);
+    luaL_argcheck(pLuaState, index >= 1, 2, "view index starts at 1");
+    uint32_t valueCount = getFieldValueCount(pLuaState, 4, pTknCompiledLayoutField);
+    VkDeviceSize offset = (VkDeviceSize)(index - 1) * pTknLuaView->pTknCompiledLayout->stride + pTknCompiledLayoutField->offset;
+    uint8_t *valuePtr = writeLuaViewRange(pTknLuaView, offset, (VkDeviceSize)valueCount * pTknCompiledLayoutField->typeSize);
+    writeFieldValues(pLuaState, 4, pTknCompiledLayoutField, valueCount, valuePtr);
+    return 0;
+}
+
+// view:setFloats(offset, ...) writes consecutive floats from a byte offset, or from a single table of floats
+static int luaSetLuaViewFloats(lua_State *pLuaState)
+{
+    TknLuaView *pTknLuaView = luaL_checkudata(pLuaState, 1, TKN_LUA_VIEW_METATABLE);
+    lua_Integer offsetInteger = luaL_checkinteger(pLuaState, 2);
+    luaL_argcheck(pLuaState, offsetInteger >= 0, 2, "byte offset must not be negative");
+    VkDeviceSize offset = (VkDeviceSize)offsetInteger;
+    bool isTable = lua_istable(pLuaState, 3);
+    uint32_t valueCount = isTable ? (uint32_t)lua_rawlen(pLuaState, 3) : (uint32_t)(lua_gettop(pLuaState) - 2);
+    uint8_t *valuePtr = writeLuaViewRange(pTknLuaView, offset, (VkDeviceSize)valueCount * sizeof(float));
+    for (uint32_t j = 0; j < valueCount; j++)
+    {
+        if (isTable)
+        {
+            lua_rawgeti(pLuaState, 3, j + 1);
         }
+        else
+        {
+            lua_pushvalue(pLuaState, 3 + (int)j);
+        }
+        float value = (float)lua_tonumber(pLuaState, -1);
+        memcpy(valuePtr + j * sizeof(float), &value, sizeof(float));
+        lua_pop(pLuaState, 1);
     }
-    *outSize = totalSize;
-    return data;
+    return 0;
 }
 
 static int luaGetSupportedFormat(lua_State *pLuaState)
@@ -571,10 +965,9 @@ static int luaDestroyRenderPassPtr(lua_State *pLuaState)
     return 0;
 }
 
-static int luaCreatePipelinePtr(lua_State *pLuaState)
+// Reads the pipeline parameters from the 12 values on top of the stack, free the arrays with freePipelineCreateInfo
+static TknPipelineCreateInfo readPipelineCreateInfoFromLua(lua_State *pLuaState)
 {
-    // Get parameters from Lua stack (13 parameters total)
-    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -13);
     TknRenderPass *pTknRenderPass = (TknRenderPass *)lua_touserdata(pLuaState, -12);
     uint32_t subpassIndex = (uint32_t)lua_tointeger(pLuaState, -11);
 
@@ -760,7 +1153,7 @@ static int luaCreatePipelinePtr(lua_State *pLuaState)
     lua_pop(pLuaState, 1);
 
     // Handle pSampleMask array
-    VkSampleMask *pSampleMask;
+    VkSampleMask *pSampleMask = NULL;
     lua_getfield(pLuaState, -4, "pSampleMask");
     if (lua_isnil(pLuaState, -1))
     {
@@ -982,56 +1375,251 @@ static int luaCreatePipelinePtr(lua_State *pLuaState)
     vkPipelineDynamicStateCreateInfo.pDynamicStates = pDynamicStates;
     lua_pop(pLuaState, 1); // Pop pDynamicStates
 
-    // Call the C function
-    TknPipeline *pTknPipeline = tknCreatePipelinePtr(pTknGfxContext, pTknRenderPass, subpassIndex, spvPathCount, spvPaths,
-                                                     pTknMeshVertexInputLayout,
-                                                     pTknInstanceVertexInputLayout,
-                                                     vkPipelineInputAssemblyStateCreateInfo,
-                                                     vkPipelineViewportStateCreateInfo,
-                                                     vkPipelineRasterizationStateCreateInfo,
-                                                     vkPipelineMultisampleStateCreateInfo,
-                                                     vkPipelineDepthStencilStateCreateInfo,
-                                                     vkPipelineColorBlendStateCreateInfo,
-                                                     vkPipelineDynamicStateCreateInfo);
+    TknPipelineCreateInfo tknPipelineCreateInfo = {
+        .pTknRenderPass = pTknRenderPass,
+        .subpassIndex = subpassIndex,
+        .spvPathCount = spvPathCount,
+        .spvPaths = spvPaths,
+        .pTknMeshVertexInputLayout = pTknMeshVertexInputLayout,
+        .pTknInstanceVertexInputLayout = pTknInstanceVertexInputLayout,
+        .vkPipelineInputAssemblyStateCreateInfo = vkPipelineInputAssemblyStateCreateInfo,
+        .vkPipelineViewportStateCreateInfo = vkPipelineViewportStateCreateInfo,
+        .vkPipelineRasterizationStateCreateInfo = vkPipelineRasterizationStateCreateInfo,
+        .vkPipelineMultisampleStateCreateInfo = vkPipelineMultisampleStateCreateInfo,
+        .vkPipelineDepthStencilStateCreateInfo = vkPipelineDepthStencilStateCreateInfo,
+        .vkPipelineColorBlendStateCreateInfo = vkPipelineColorBlendStateCreateInfo,
+        .vkPipelineDynamicStateCreateInfo = vkPipelineDynamicStateCreateInfo,
+    };
+    return tknPipelineCreateInfo;
+}
+
+static void freePipelineCreateInfo(TknPipelineCreateInfo *pTknPipelineCreateInfo)
+{
+    tknFree(pTknPipelineCreateInfo->spvPaths);
+    tknFree((void *)pTknPipelineCreateInfo->vkPipelineViewportStateCreateInfo.pViewports);
+    tknFree((void *)pTknPipelineCreateInfo->vkPipelineViewportStateCreateInfo.pScissors);
+    tknFree((void *)pTknPipelineCreateInfo->vkPipelineMultisampleStateCreateInfo.pSampleMask);
+    tknFree((void *)pTknPipelineCreateInfo->vkPipelineColorBlendStateCreateInfo.pAttachments);
+    tknFree((void *)pTknPipelineCreateInfo->vkPipelineDynamicStateCreateInfo.pDynamicStates);
+}
+
+static int luaCreatePipelinePtr(lua_State *pLuaState)
+{
+    // Get parameters from Lua stack (13 parameters total), the context at -13 and the pipeline parameters above it
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -13);
+    TknPipelineCreateInfo tknPipelineCreateInfo = readPipelineCreateInfoFromLua(pLuaState);
+    TknPipeline *pTknPipeline = NULL;
+    tknCreatePipelinesPtr(pTknGfxContext, 1, &tknPipelineCreateInfo, &pTknPipeline);
+    freePipelineCreateInfo(&tknPipelineCreateInfo);
+
+    // Return TknPipeline as userdata
+    lua_pushlightuserdata(pLuaState, pTknPipeline);
+    return 1;
+}
+
+static int luaReloadShaderReflection(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    const char *spvPath = lua_tostring(pLuaState, -1);
+    lua_pushboolean(pLuaState, tknReloadShaderReflection(pTknGfxContext, spvPath));
+    return 1;
+}
+
+static int luaCreatePipelinesPtr(lua_State *pLuaState)
+{
+    // Parameters: pTknGfxContext, an array of argument lists laid out like tknCreatePipelinePtr's after the context
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    lua_len(pLuaState, -1);
+    uint32_t pipelineCount = (uint32_t)lua_tointeger(pLuaState, -1);
+    lua_pop(pLuaState, 1);
+    TknPipelineCreateInfo *tknPipelineCreateInfos = tknMalloc(sizeof(TknPipelineCreateInfo) * pipelineCount);
+    TknPipeline **pipelinePtrs = tknMalloc(sizeof(TknPipeline *) * pipelineCount);
+    for (uint32_t pipelineIndex = 0; pipelineIndex < pipelineCount; pipelineIndex++)
+    {
+        lua_rawgeti(pLuaState, -1, pipelineIndex + 1);
+        for (int argumentIndex = 1; argumentIndex <= 12; argumentIndex++)
+        {
+            lua_rawgeti(pLuaState, -argumentIndex, argumentIndex);
+        }
+        tknPipelineCreateInfos[pipelineIndex] = readPipelineCreateInfoFromLua(pLuaState);
+        lua_pop(pLuaState, 13); // Pop the arguments and the argument list
+    }
+
+    // The argument lists stay referenced by the parameter, so the shader paths read from them remain valid
+    tknCreatePipelinesPtr(pTknGfxContext, pipelineCount, tknPipelineCreateInfos, pipelinePtrs);
+
+    lua_createtable(pLuaState, (int)pipelineCount, 0);
+    for (uint32_t pipelineIndex = 0; pipelineIndex < pipelineCount; pipelineIndex++)
+    {
+        freePipelineCreateInfo(&tknPipelineCreateInfos[pipelineIndex]);
+        lua_pushlightuserdata(pLuaState, pipelinePtrs[pipelineIndex]);
+        lua_rawseti(pLuaState, -2, pipelineIndex + 1);
+    }
+    tknFree(tknPipelineCreateInfos);
+    tknFree(pipelinePtrs);
+    return 1;
+}
+
+static int luaDestroyPipelinePtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    TknPipeline *pTknPipeline = (TknPipeline *)lua_touserdata(pLuaState, -1);
+    tknDestroyPipelinePtr(pTknGfxContext, pTknPipeline);
+    return 0;
+}
+
+static int luaCreateDrawCallPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -5);
+    TknPipeline *pTknPipeline = (TknPipeline *)lua_touserdata(pLuaState, -4);
+    TknMaterial *pTknMaterial = (TknMaterial *)lua_touserdata(pLuaState, -3);
+    TknMesh *pTknMesh = (TknMesh *)lua_touserdata(pLuaState, -2);
+    TknInstance *pTknInstance = (TknInstance *)lua_touserdata(pLuaState, -1);
+    TknDrawCall *pTknDrawCall = tknCreateDrawCallPtr(pTknGfxContext, pTknPipeline, pTknMaterial, pTknMesh, pTknInstance);
+    lua_pushlightuserdata(pLuaState, pTknDrawCall);
+    return 1;
+}
+
+static int luaDestroyDrawCallPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    TknDrawCall *pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -1);
+    tknDestroyDrawCallPtr(pTknGfxContext, pTknDrawCall);
+    return 0;
+}
+
+static int luaSetDrawCallDynamicOffsets(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -3);
+    TknDrawCall *pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -2);
+    uint32_t dynamicOffsetCount = (uint32_t)lua_rawlen(pLuaState, -1);
+    tknAssert(dynamicOffsetCount <= TKN_MAX_DYNAMIC_OFFSET_COUNT, "Too many dynamic offsets: %u", dynamicOffsetCount);
+    uint32_t dynamicOffsets[TKN_MAX_DYNAMIC_OFFSET_COUNT];
+    for (uint32_t i = 0; i < dynamicOffsetCount; i++)
+    {
+        lua_rawgeti(pLuaState, -1, i + 1);
+        dynamicOffsets[i] = (uint32_t)lua_tointeger(pLuaState, -1);
+        lua_pop(pLuaState, 1);
+    }
+    tknSetDrawCallDynamicOffsets(pTknGfxContext, pTknDrawCall, dynamicOffsetCount, dynamicOffsets);
+    return 0;
+}
+
+static int luaSetDrawCallPushConstants(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -4);
+    TknDrawCall *pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -3);
+    // layout at -2, data at -1
+    VkDeviceSize size;
+    uint32_t elementCount;
+    size_t scratchMarker = tknGetScratchMarker();
+    void *packedData = packDataFromLayout(pLuaState, -2, -1, &size, &elementCount);
+    tknSetDrawCallPushConstants(pTknGfxContext, pTknDrawCall, 0, (uint32_t)size, packedData);
+    tknRewindScratch(scratchMarker);
+    return 0;
+}
+
+static int luaSetDrawCallIndirect(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -6);
+    TknDrawCall *pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -5);
+    TknDynamicBuffer *pCommandTknDynamicBuffer = (TknDynamicBuffer *)lua_touserdata(pLuaState, -4);
+    // Lua indices are 1-based
+    uint32_t firstCommand = lua_isnil(pLuaState, -3) ? 0 : (uint32_t)(lua_tointeger(pLuaState, -3) - 1);
+    uint32_t maxDrawCount = lua_isnil(pLuaState, -2) ? 0 : (uint32_t)lua_tointeger(pLuaState, -2);
+    TknDynamicBuffer *pCountTknDynamicBuffer = (TknDynamicBuffer *)lua_touserdata(pLuaState, -1);
+    tknSetDrawCallIndirect(pTknGfxContext, pTknDrawCall, pCommandTknDynamicBuffer, firstCommand, maxDrawCount, pCountTknDynamicBuffer);
+    return 0;
+}
 
-    // Clean up memory
-    tknFree(spvPaths);
-    tknFree(pViewports);
-    tknFree(pScissors);
-    tknFree(pSampleMask);
-    tknFree(pColorBlendAttachments);
-    tknFree(pDynamicStates);
+static int luaSetDrawCallIndirectStorage(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -6);
+    TknDrawCall *pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -5);
+    TknStorageBuffer *pCommandTknStorageBuffer = (TknStorageBuffer *)lua_touserdata(pLuaState, -4);
+    // Lua indices are 1-based
+    uint32_t firstCommand = lua_isnil(pLuaState, -3) ? 0 : (uint32_t)(lua_tointeger(pLuaState, -3) - 1);
+    uint32_t maxDrawCount = lua_isnil(pLuaState, -2) ? 0 : (uint32_t)lua_tointeger(pLuaState, -2);
+    TknStorageBuffer *pCountTknStorageBuffer = (TknStorageBuffer *)lua_touserdata(pLuaState, -1);
+    tknSetDrawCallIndirectStorage(pTknGfxContext, pTknDrawCall, pCommandTknStorageBuffer, firstCommand, maxDrawCount, pCountTknStorageBuffer);
+    return 0;
+}
 
-    // Return TknPipeline as userdata
-    lua_pushlightuserdata(pLuaState, pTknPipeline);
+static int luaIsDrawIndirectCountSupported(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -1);
+    lua_pushboolean(pLuaState, tknIsDrawIndirectCountSupported(pTknGfxContext));
     return 1;
 }
 
-static int luaDestroyPipelinePtr(lua_State *pLuaState)
+static int luaCreateComputePipelinePtr(lua_State *pLuaState)
 {
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
-    TknPipeline *pTknPipeline = (TknPipeline *)lua_touserdata(pLuaState, -1);
-    tknDestroyPipelinePtr(pTknGfxContext, pTknPipeline);
+    const char *spvPath = lua_tostring(pLuaState, -1);
+    TknComputePipeline *pTknComputePipeline = tknCreateComputePipelinePtr(pTknGfxContext, spvPath);
+    lua_pushlightuserdata(pLuaState, pTknComputePipeline);
+    return 1;
+}
+
+static int luaDestroyComputePipelinePtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    TknComputePipeline *pTknComputePipeline = (TknComputePipeline *)lua_touserdata(pLuaState, -1);
+    tknDestroyComputePipelinePtr(pTknGfxContext, pTknComputePipeline);
     return 0;
 }
 
-static int luaCreateDrawCallPtr(lua_State *pLuaState)
+// tkn.tknDispatch(pTknGfxContext, pTknFrame, pTknComputePipeline, pTknMaterial, groupCountX, groupCountY, groupCountZ, format, buffer), format and buffer pack the push constants
+static int luaDispatch(lua_State *pLuaState)
 {
-    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -5);
-    TknPipeline *pTknPipeline = (TknPipeline *)lua_touserdata(pLuaState, -4);
-    TknMaterial *pTknMaterial = (TknMaterial *)lua_touserdata(pLuaState, -3);
-    TknMesh *pTknMesh = (TknMesh *)lua_touserdata(pLuaState, -2);
-    TknInstance *pTknInstance = (TknInstance *)lua_touserdata(pLuaState, -1);
-    TknDrawCall *pTknDrawCall = tknCreateDrawCallPtr(pTknGfxContext, pTknPipeline, pTknMaterial, pTknMesh, pTknInstance);
-    lua_pushlightuserdata(pLuaState, pTknDrawCall);
-    return 1;
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -9);
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -8);
+    TknComputePipeline *pTknComputePipeline = (TknComputePipeline *)lua_touserdata(pLuaState, -7);
+    TknMaterial *pTknMaterial = (TknMaterial *)lua_touserdata(pLuaState, -6);
+    uint32_t groupCountX = (uint32_t)lua_tointeger(pLuaState, -5);
+    uint32_t groupCountY = (uint32_t)lua_tointeger(pLuaState, -4);
+    uint32_t groupCountZ = (uint32_t)lua_tointeger(pLuaState, -3);
+    size_t scratchMarker = tknGetScratchMarker();
+    void *packedData = NULL;
+    if (!lua_isnil(pLuaState, -2))
+    {
+        // layout at -2, data at -1
+        VkDeviceSize size;
+        uint32_t elementCount;
+        packedData = packDataFromLayout(pLuaState, -2, -1, &size, &elementCount);
+    }
+    else
+    {
+        // The pipeline declares no push constants
+    }
+    tknDispatch(pTknGfxContext, pTknFrame, pTknComputePipeline, pTknMaterial, packedData, groupCountX, groupCountY, groupCountZ);
+    tknRewindScratch(scratchMarker);
+    return 0;
 }
 
-static int luaDestroyDrawCallPtr(lua_State *pLuaState)
+static int luaBufferBarrier(lua_State *pLuaState)
 {
-    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
-    TknDrawCall *pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -1);
-    tknDestroyDrawCallPtr(pTknGfxContext, pTknDrawCall);
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -7);
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -6);
+    TknStorageBuffer *pTknStorageBuffer = (TknStorageBuffer *)lua_touserdata(pLuaState, -5);
+    VkPipelineStageFlags srcVkPipelineStageFlags = (VkPipelineStageFlags)lua_tointeger(pLuaState, -4);
+    VkAccessFlags srcVkAccessFlags = (VkAccessFlags)lua_tointeger(pLuaState, -3);
+    VkPipelineStageFlags dstVkPipelineStageFlags = (VkPipelineStageFlags)lua_tointeger(pLuaState, -2);
+    VkAccessFlags dstVkAccessFlags = (VkAccessFlags)lua_tointeger(pLuaState, -1);
+    tknBufferBarrier(pTknGfxContext, pTknFrame, pTknStorageBuffer, srcVkPipelineStageFlags, srcVkAccessFlags, dstVkPipelineStageFlags, dstVkAccessFlags);
+    return 0;
+}
+
+static int luaImageBarrier(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -7);
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -6);
+    TknImage *pTknImage = (TknImage *)lua_touserdata(pLuaState, -5);
+    VkPipelineStageFlags srcVkPipelineStageFlags = (VkPipelineStageFlags)lua_tointeger(pLuaState, -4);
+    VkAccessFlags srcVkAccessFlags = (VkAccessFlags)lua_tointeger(pLuaState, -3);
+    VkPipelineStageFlags dstVkPipelineStageFlags = (VkPipelineStageFlags)lua_tointeger(pLuaState, -2);
+    VkAccessFlags dstVkAccessFlags = (VkAccessFlags)lua_tointeger(pLuaState, -1);
+    tknImageBarrier(pTknGfxContext, pTknFrame, pTknImage, srcVkPipelineStageFlags, srcVkAccessFlags, dstVkPipelineStageFlags, dstVkAccessFlags);
     return 0;
 }
 
@@ -1116,15 +1704,86 @@ static int luaCreateUniformBufferPtr(lua_State *pLuaState)
     // layout at -2, data at -1
 
     VkDeviceSize size;
-    void *packedData = packDataFromLayout(pLuaState, -2, -1, &size);
+    uint32_t elementCount;
+    size_t scratchMarker = tknGetScratchMarker();
+    void *packedData = packDataFromLayout(pLuaState, -2, -1, &size, &elementCount);
 
     TknUniformBuffer *pTknUniformBuffer = tknCreateUniformBufferPtr(pTknGfxContext, packedData, size);
 
-    tknFree(packedData);
+    tknRewindScratch(scratchMarker);
     lua_pushlightuserdata(pLuaState, pTknUniformBuffer);
     return 1;
 }
 
+// tkn.tknCreateDynamicBufferPtr(pTknGfxContext, vkDescriptorType, layout, data), one element per packed element of data
+static int luaCreateDynamicBufferPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -4);
+    VkDescriptorType vkDescriptorType = (VkDescriptorType)lua_tointeger(pLuaState, -3);
+    // layout at -2, data at -1
+
+    VkDeviceSize size;
+    uint32_t elementCount;
+    size_t scratchMarker = tknGetScratchMarker();
+    void *packedData = packDataFromLayout(pLuaState, -2, -1, &size, &elementCount);
+    tknAssert(elementCount > 0, "Dynamic buffer data has no elements");
+
+    TknDynamicBuffer *pTknDynamicBuffer = tknCreateDynamicBufferPtr(pTknGfxContext, vkDescriptorType, packedData, size / elementCount, elementCount);
+
+    tknRewindScratch(scratchMarker);
+    lua_pushlightuserdata(pLuaState, pTknDynamicBuffer);
+    return 1;
+}
+
+static int luaDestroyDynamicBufferPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    TknDynamicBuffer *pTknDynamicBuffer = (TknDynamicBuffer *)lua_touserdata(pLuaState, -1);
+    tknDestroyDynamicBufferPtr(pTknGfxContext, pTknDynamicBuffer);
+    return 0;
+}
+
+// tkn.tknGetDynamicBufferOffset(pTknDynamicBuffer, index), index starts at 1 like view indices
+static int luaGetDynamicBufferOffset(lua_State *pLuaState)
+{
+    TknDynamicBuffer *pTknDynamicBuffer = (TknDynamicBuffer *)lua_touserdata(pLuaState, -2);
+    lua_Integer index = lua_tointeger(pLuaState, -1);
+    tknAssert(index >= 1, "Dynamic buffer index %lld out of range", (long long)index);
+    lua_pushinteger(pLuaState, (lua_Integer)tknGetDynamicBufferOffset(pTknDynamicBuffer, (uint32_t)(index - 1)));
+    return 1;
+}
+
+// tkn.tknCreateStorageBufferPtr(pTknGfxContext, format, buffer), a nil format makes buffer the size in bytes of an uninitialized buffer
+static int luaCreateStorageBufferPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -3);
+    TknStorageBuffer *pTknStorageBuffer = NULL;
+    if (lua_isnil(pLuaState, -2))
+    {
+        pTknStorageBuffer = tknCreateStorageBufferPtr(pTknGfxContext, NULL, (VkDeviceSize)lua_tointeger(pLuaState, -1));
+    }
+    else
+    {
+        // layout at -2, data at -1
+        VkDeviceSize size;
+        uint32_t elementCount;
+        size_t scratchMarker = tknGetScratchMarker();
+        void *packedData = packDataFromLayout(pLuaState, -2, -1, &size, &elementCount);
+        pTknStorageBuffer = tknCreateStorageBufferPtr(pTknGfxContext, packedData, size);
+        tknRewindScratch(scratchMarker);
+    }
+    lua_pushlightuserdata(pLuaState, pTknStorageBuffer);
+    return 1;
+}
+
+static int luaDestroyStorageBufferPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    TknStorageBuffer *pTknStorageBuffer = (TknStorageBuffer *)lua_touserdata(pLuaState, -1);
+    tknDestroyStorageBufferPtr(pTknGfxContext, pTknStorageBuffer);
+    return 0;
+}
+
 static int luaDestroyUniformBufferPtr(lua_State *pLuaState)
 {
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
@@ -1140,17 +1799,20 @@ static int luaUpdateUniformBufferPtr(lua_State *pLuaState)
     // layout at -3, data at -2, size at -1
 
     VkDeviceSize size;
-    void *packedData = packDataFromLayout(pLuaState, -3, -2, &size);
+    uint32_t elementCount;
+    size_t scratchMarker = tknGetScratchMarker();
+    void *packedData = packDataFromLayout(pLuaState, -3, -2, &size, &elementCount);
 
     // Use the provided size if available, otherwise use calculated size
     VkDeviceSize finalSize = lua_isnil(pLuaState, -1) ? size : (VkDeviceSize)lua_tointeger(pLuaState, -1);
     tknUpdateUniformBufferPtr(pTknGfxContext, pTknUniformBuffer, packedData, finalSize);
 
-    tknFree(packedData);
+    tknRewindScratch(scratchMarker);
     return 0;
 }
 
-static int luaCreateMeshPtrWithData(lua_State *pLuaState)
+// Shared by tknCreateMeshPtrWithData and tknUploadMeshAsync, returns the upload ticket
+static uint64_t createMeshPtrFromLua(lua_State *pLuaState, bool isAsync, TknMesh **ppTknMesh)
 {
     // Parameters: pTknGfxContext, pTknVertexInputLayout, vertexLayout, vertices, indexType, indices
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -6);
@@ -1158,15 +1820,9 @@ static int luaCreateMeshPtrWithData(lua_State *pLuaState)
     // vertexLayout at -4, vertices at -3, indexType at -2, indices at -1
 
     VkDeviceSize vertexSize;
-    void *vertexData = packDataFromLayout(pLuaState, -4, -3, &vertexSize);
-
-    // Calculate vertex count based on layout
     uint32_t vertexCount = 0;
-    VkDeviceSize layoutSize = calculateLayoutSize(pLuaState, -4);
-    if (layoutSize > 0)
-    {
-        vertexCount = (uint32_t)(vertexSize / layoutSize);
-    }
+    size_t scratchMarker = tknGetScratchMarker();
+    void *vertexData = packDataFromLayout(pLuaState, -4, -3, &vertexSize, &vertexCount);
 
     // Handle indices
     void *indexData = NULL;
@@ -1179,7 +1835,7 @@ static int luaCreateMeshPtrWithData(lua_State *pLuaState)
         lua_pop(pLuaState, 1);
 
         size_t indexSize = (indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
-        indexData = tknMalloc(indexSize * indexCount);
+        indexData = tknAllocateScratch(indexSize * indexCount);
 
         for (uint32_t i = 0; i < indexCount; i++)
         {
@@ -1196,15 +1852,34 @@ static int luaCreateMeshPtrWithData(lua_State *pLuaState)
         }
     }
 
-    TknMesh *pTknMesh = tknCreateMeshPtrWithData(pTknGfxContext, pTknVertexInputLayout, vertexData, vertexCount, indexType, indexData, indexCount);
-
-    tknFree(vertexData);
-    if (indexData)
-        tknFree(indexData);
+    uint64_t ticket = 0;
+    if (isAsync)
+    {
+        ticket = tknUploadMeshAsync(pTknGfxContext, pTknVertexInputLayout, vertexData, vertexCount, indexType, indexData, indexCount, ppTknMesh);
+    }
+    else
+    {
+        *ppTknMesh = tknCreateMeshPtrWithData(pTknGfxContext, pTknVertexInputLayout, vertexData, vertexCount, indexType, indexData, indexCount);
+    }
 
+    tknRewindScratch(scratchMarker);
+    return ticket;
+}
+static int luaCreateMeshPtrWithData(lua_State *pLuaState)
+{
+    TknMesh *pTknMesh = NULL;
+    createMeshPtrFromLua(pLuaState, false, &pTknMesh);
     lua_pushlightuserdata(pLuaState, pTknMesh);
     return 1;
 }
+static int luaUploadMeshAsync(lua_State *pLuaState)
+{
+    TknMesh *pTknMesh = NULL;
+    uint64_t ticket = createMeshPtrFromLua(pLuaState, true, &pTknMesh);
+    lua_pushlightuserdata(pLuaState, pTknMesh);
+    lua_pushinteger(pLuaState, (lua_Integer)ticket);
+    return 2;
+}
 static int luaDestroyMeshPtr(lua_State *pLuaState)
 {
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
@@ -1220,19 +1895,13 @@ static int luaCreateInstancePtr(lua_State *pLuaState)
     // instanceLayout at -2, instances at -1
 
     VkDeviceSize instanceSize;
-    void *instanceData = packDataFromLayout(pLuaState, -2, -1, &instanceSize);
-
-    // Calculate instance count based on layout
-    uint32_t instanceCount = 1;
-    VkDeviceSize layoutSize = calculateLayoutSize(pLuaState, -2);
-    if (layoutSize > 0)
-    {
-        instanceCount = (uint32_t)(instanceSize / layoutSize);
-    }
+    uint32_t instanceCount = 0;
+    size_t scratchMarker = tknGetScratchMarker();
+    void *instanceData = packDataFromLayout(pLuaState, -2, -1, &instanceSize, &instanceCount);
 
     TknInstance *pTknInstance = tknCreateInstancePtr(pTknGfxContext, pTknVertexInputLayout, instanceCount, instanceData);
 
-    tknFree(instanceData);
+    tknRewindScratch(scratchMarker);
     lua_pushlightuserdata(pLuaState, pTknInstance);
     return 1;
 }
@@ -1252,19 +1921,34 @@ static int luaUpdateInstancePtr(lua_State *pLuaState)
     // instanceLayout at -2, instances at -1
 
     VkDeviceSize instanceSize;
-    void *instanceData = packDataFromLayout(pLuaState, -2, -1, &instanceSize);
-
-    // Calculate instance count based on layout
-    uint32_t instanceCount = 1;
-    VkDeviceSize layoutSize = calculateLayoutSize(pLuaState, -2);
-    if (layoutSize > 0)
-    {
-        instanceCount = (uint32_t)(instanceSize / layoutSize);
-    }
+    uint32_t instanceCount = 0;
+    size_t scratchMarker = tknGetScratchMarker();
+    void *instanceData = packDataFromLayout(pLuaState, -2, -1, &instanceSize, &instanceCount);
 
     tknUpdateInstancePtr(pTknGfxContext, pTknInstance, instanceData, instanceCount);
 
-    tknFree(instanceData);
+    tknRewindScratch(scratchMarker);
+    return 0;
+}
+
+static int luaSetFrameCamera(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -6);
+    float view[16];
+    float proj[16];
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        lua_rawgeti(pLuaState, -5, i + 1);
+        view[i] = (float)lua_tonumber(pLuaState, -1);
+        lua_pop(pLuaState, 1);
+        lua_rawgeti(pLuaState, -4, i + 1);
+        proj[i] = (float)lua_tonumber(pLuaState, -1);
+        lua_pop(pLuaState, 1);
+    }
+    float nearPlane = (float)lua_tonumber(pLuaState, -3);
+    float farPlane = (float)lua_tonumber(pLuaState, -2);
+    float fov = (float)lua_tonumber(pLuaState, -1);
+    tknSetFrameCamera(pTknGfxContext, view, proj, nearPlane, farPlane, fov);
     return 0;
 }
 
@@ -1296,6 +1980,15 @@ static int luaCreatePipelineMaterialPtr(lua_State *pLuaState)
     return 1;
 }
 
+static int luaCreateComputeMaterialPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    TknComputePipeline *pTknComputePipeline = (TknComputePipeline *)lua_touserdata(pLuaState, -1);
+    TknMaterial *pTknMaterial = tknCreateComputeMaterialPtr(pTknGfxContext, pTknComputePipeline);
+    lua_pushlightuserdata(pLuaState, pTknMaterial);
+    return 1;
+}
+
 static int luaDestroyPipelineMaterialPtr(lua_State *pLuaState)
 {
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
@@ -1314,7 +2007,8 @@ static int luaUpdateMaterialPtr(lua_State *pLuaState)
     uint32_t inputBindingCount = (uint32_t)lua_tointeger(pLuaState, -1);
     lua_pop(pLuaState, 1);
 
-    TknInputBinding *tknInputBindings = tknMalloc(sizeof(TknInputBinding) * inputBindingCount);
+    size_t scratchMarker = tknGetScratchMarker();
+    TknInputBinding *tknInputBindings = tknAllocateScratch(sizeof(TknInputBinding) * inputBindingCount);
 
     for (uint32_t i = 0; i < inputBindingCount; i++)
     {
@@ -1349,6 +2043,14 @@ static int luaUpdateMaterialPtr(lua_State *pLuaState)
 
             tknInputBindings[i].tknInputBindingUnion.tknUniformBufferBinding.pTknUniformBuffer = pTknUniformBuffer;
         }
+        else if (vkDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || vkDescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+        {
+            lua_getfield(pLuaState, -1, "pTknDynamicBuffer");
+            TknDynamicBuffer *pTknDynamicBuffer = (TknDynamicBuffer *)lua_touserdata(pLuaState, -1);
+            lua_pop(pLuaState, 1);
+
+            tknInputBindings[i].tknInputBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer = pTknDynamicBuffer;
+        }
         else if (vkDescriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
         {
             lua_getfield(pLuaState, -1, "pTknSampler");
@@ -1361,6 +2063,20 @@ static int luaUpdateMaterialPtr(lua_State *pLuaState)
             lua_pop(pLuaState, 1);
             tknInputBindings[i].tknInputBindingUnion.tknCombinedImageSamplerBinding.pTknImage = pTknImage;
         }
+        else if (vkDescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+        {
+            lua_getfield(pLuaState, -1, "pTknImage");
+            TknImage *pTknImage = (TknImage *)lua_touserdata(pLuaState, -1);
+            lua_pop(pLuaState, 1);
+            tknInputBindings[i].tknInputBindingUnion.tknStorageImageBinding.pTknImage = pTknImage;
+        }
+        else if (vkDescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+        {
+            lua_getfield(pLuaState, -1, "pTknStorageBuffer");
+            TknStorageBuffer *pTknStorageBuffer = (TknStorageBuffer *)lua_touserdata(pLuaState, -1);
+            lua_pop(pLuaState, 1);
+            tknInputBindings[i].tknInputBindingUnion.tknStorageBufferBinding.pTknStorageBuffer = pTknStorageBuffer;
+        }
         else
         {
             tknError("Unsupported descriptor type in TknInputBinding: %d", vkDescriptorType);
@@ -1371,7 +2087,7 @@ static int luaUpdateMaterialPtr(lua_State *pLuaState)
 
     tknUpdateMaterialPtr(pTknGfxContext, pTknMaterial, inputBindingCount, tknInputBindings);
 
-    tknFree(tknInputBindings);
+    tknRewindScratch(scratchMarker);
     return 0;
 }
 
@@ -1385,17 +2101,11 @@ static int luaUpdateMeshPtr(lua_State *pLuaState)
     VkDeviceSize vertexSize;
     void *vertexData = NULL;
     uint32_t vertexCount = 0;
+    size_t scratchMarker = tknGetScratchMarker();
 
     if (!lua_isnil(pLuaState, -3))
     {
-        vertexData = packDataFromLayout(pLuaState, -4, -3, &vertexSize);
-
-        // Calculate vertex count based on layout
-        VkDeviceSize layoutSize = calculateLayoutSize(pLuaState, -4);
-        if (layoutSize > 0)
-        {
-            vertexCount = (uint32_t)(vertexSize / layoutSize);
-        }
+        vertexData = packDataFromLayout(pLuaState, -4, -3, &vertexSize, &vertexCount);
     }
 
     // Handle indices
@@ -1409,7 +2119,7 @@ static int luaUpdateMeshPtr(lua_State *pLuaState)
         lua_pop(pLuaState, 1);
 
         size_t indexSize = (indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
-        indexData = tknMalloc(indexSize * indexCount);
+        indexData = tknAllocateScratch(indexSize * indexCount);
 
         for (uint32_t i = 0; i < indexCount; i++)
         {
@@ -1429,10 +2139,7 @@ static int luaUpdateMeshPtr(lua_State *pLuaState)
 
     tknUpdateMeshPtr(pTknGfxContext, pTknMesh, NULL, vertexData, vertexCount, (uint32_t)indexType, indexData, indexCount);
 
-    if (vertexData)
-        tknFree(vertexData);
-    if (indexData)
-        tknFree(indexData);
+    tknRewindScratch(scratchMarker);
 
     return 0;
 }
@@ -1492,6 +2199,54 @@ static int luaCreateImagePtr(lua_State *pLuaState)
     return 1;
 }
 
+static int luaUploadImageAsync(lua_State *pLuaState)
+{
+    // Parameters: pTknGfxContext, vkExtent3D, vkFormat, vkImageUsageFlags, vkImageAspectFlags, data
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -6);
+
+    VkExtent3D vkExtent3D;
+    lua_getfield(pLuaState, -5, "width");
+    vkExtent3D.width = (uint32_t)lua_tointeger(pLuaState, -1);
+    lua_pop(pLuaState, 1);
+
+    lua_getfield(pLuaState, -5, "height");
+    vkExtent3D.height = (uint32_t)lua_tointeger(pLuaState, -1);
+    lua_pop(pLuaState, 1);
+
+    lua_getfield(pLuaState, -5, "depth");
+    vkExtent3D.depth = (uint32_t)lua_tointeger(pLuaState, -1);
+    lua_pop(pLuaState, 1);
+
+    VkFormat vkFormat = (VkFormat)lua_tointeger(pLuaState, -4);
+    VkImageUsageFlags vkImageUsageFlags = (VkImageUsageFlags)lua_tointeger(pLuaState, -3);
+    VkImageAspectFlags vkImageAspectFlags = (VkImageAspectFlags)lua_tointeger(pLuaState, -2);
+
+    // The data is copied into staging memory before this returns, so the Lua string can be used directly
+    size_t dataSize = 0;
+    const char *data = lua_tolstring(pLuaState, -1, &dataSize);
+    TknImage *pTknImage = NULL;
+    uint64_t ticket = tknUploadImageAsync(pTknGfxContext, vkExtent3D, vkFormat, vkImageUsageFlags, vkImageAspectFlags, (void *)data, (VkDeviceSize)dataSize, &pTknImage);
+    lua_pushlightuserdata(pLuaState, pTknImage);
+    lua_pushinteger(pLuaState, (lua_Integer)ticket);
+    return 2;
+}
+
+static int luaIsUploadComplete(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    uint64_t ticket = (uint64_t)lua_tointeger(pLuaState, -1);
+    lua_pushboolean(pLuaState, tknIsUploadComplete(pTknGfxContext, ticket));
+    return 1;
+}
+
+static int luaWaitUpload(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    uint64_t ticket = (uint64_t)lua_tointeger(pLuaState, -1);
+    tknWaitUpload(pTknGfxContext, ticket);
+    return 0;
+}
+
 static int luaCreateSamplerPtr(lua_State *pLuaState)
 {
     // Parameters: pTknGfxContext, magFilter, minFilter, mipmapMode, addressModeU, addressModeV, addressModeW, mipLodBias, anisotropyEnable, maxAnisotropy, minLod, maxLod, borderColor
@@ -1693,6 +2448,44 @@ static int luaLoadTknChar(lua_State *pLuaState)
     }
 }
 
+static int luaGetMallocCount(lua_State *pLuaState)
+{
+    lua_pushinteger(pLuaState, (lua_Integer)tknGetMallocCount());
+    return 1;
+}
+
+// Trace events keep the name pointer, so the string is anchored in the registry until the state closes
+static int luaBeginProfileScope(lua_State *pLuaState)
+{
+    const char *name = lua_tostring(pLuaState, -1);
+    lua_getfield(pLuaState, LUA_REGISTRYINDEX, "tknProfileScopeNames");
+    lua_pushvalue(pLuaState, -2);
+    lua_pushboolean(pLuaState, 1);
+    lua_rawset(pLuaState, -3);
+    lua_pop(pLuaState, 1);
+    tknBeginProfileScope(name);
+    return 0;
+}
+
+static int luaEndProfileScope(lua_State *pLuaState)
+{
+    tknEndProfileScope();
+    return 0;
+}
+
+static int luaSetProfilerEnabled(lua_State *pLuaState)
+{
+    tknSetProfilerEnabled(lua_toboolean(pLuaState, -1));
+    return 0;
+}
+
+static int luaWriteProfileTrace(lua_State *pLuaState)
+{
+    const char *filePath = lua_tostring(pLuaState, -1);
+    lua_pushboolean(pLuaState, tknWriteProfileTrace(filePath));
+    return 1;
+}
+
 static int luaWaitRenderFence(lua_State *pLuaState)
 {
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -1);
@@ -1700,12 +2493,84 @@ static int luaWaitRenderFence(lua_State *pLuaState)
     return 0;
 }
 
-static int luaBeginRenderPassPtr(lua_State *pLuaState)
+static int luaGetFrameIndex(lua_State *pLuaState)
+{
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -1);
+    lua_pushinteger(pLuaState, tknGetFrameIndex(pTknFrame));
+    return 1;
+}
+
+static int luaGetFrameStats(lua_State *pLuaState)
+{
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -1);
+    TknFrameStats tknFrameStats = tknGetFrameStats(pTknFrame);
+    lua_createtable(pLuaState, 0, 2);
+    lua_pushinteger(pLuaState, tknFrameStats.emittedBindCount);
+    lua_setfield(pLuaState, -2, "emittedBindCount");
+    lua_pushinteger(pLuaState, tknFrameStats.skippedBindCount);
+    lua_setfield(pLuaState, -2, "skippedBindCount");
+    return 1;
+}
+
+static int luaSetGpuProfilerEnabled(lua_State *pLuaState)
 {
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -3);
-    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -2);
-    TknRenderPass *pTknRenderPass = (TknRenderPass *)lua_touserdata(pLuaState, -1);
-    tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, pTknRenderPass);
+    bool isTimestampEnabled = lua_toboolean(pLuaState, -2);
+    bool isPipelineStatisticsEnabled = lua_toboolean(pLuaState, -1);
+    tknSetGpuProfilerEnabled(pTknGfxContext, isTimestampEnabled, isPipelineStatisticsEnabled);
+    return 0;
+}
+
+static int luaGetGpuProfile(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -1);
+    TknGpuProfile tknGpuProfile = tknGetGpuProfile(pTknGfxContext);
+    lua_createtable(pLuaState, 0, 4);
+    lua_pushboolean(pLuaState, tknGpuProfile.isTimestampSupported);
+    lua_setfield(pLuaState, -2, "isTimestampSupported");
+    lua_pushboolean(pLuaState, tknGpuProfile.isPipelineStatisticsSupported);
+    lua_setfield(pLuaState, -2, "isPipelineStatisticsSupported");
+    lua_pushinteger(pLuaState, tknGpuProfile.frameCount);
+    lua_setfield(pLuaState, -2, "frameCount");
+    lua_createtable(pLuaState, (int)tknGpuProfile.renderPassCount, 0);
+    for (uint32_t renderPassIndex = 0; renderPassIndex < tknGpuProfile.renderPassCount; renderPassIndex++)
+    {
+        TknGpuRenderPassProfile *pTknGpuRenderPassProfile = &tknGpuProfile.tknGpuRenderPassProfiles[renderPassIndex];
+        lua_createtable(pLuaState, 0, 8);
+        lua_pushlightuserdata(pLuaState, pTknGpuRenderPassProfile->pTknRenderPass);
+        lua_setfield(pLuaState, -2, "pTknRenderPass");
+        lua_pushnumber(pLuaState, pTknGpuRenderPassProfile->milliseconds);
+        lua_setfield(pLuaState, -2, "milliseconds");
+        lua_createtable(pLuaState, (int)pTknGpuRenderPassProfile->subpassCount, 0);
+        for (uint32_t subpassIndex = 0; subpassIndex < pTknGpuRenderPassProfile->subpassCount; subpassIndex++)
+        {
+            lua_pushnumber(pLuaState, pTknGpuRenderPassProfile->subpassMilliseconds[subpassIndex]);
+            lua_rawseti(pLuaState, -2, subpassIndex + 1);
+        }
+        lua_setfield(pLuaState, -2, "subpassMilliseconds");
+        lua_pushinteger(pLuaState, (lua_Integer)pTknGpuRenderPassProfile->inputAssemblyVertexCount);
+        lua_setfield(pLuaState, -2, "inputAssemblyVertexCount");
+        lua_pushinteger(pLuaState, (lua_Integer)pTknGpuRenderPassProfile->inputAssemblyPrimitiveCount);
+        lua_setfield(pLuaState, -2, "inputAssemblyPrimitiveCount");
+        lua_pushinteger(pLuaState, (lua_Integer)pTknGpuRenderPassProfile->vertexShaderInvocationCount);
+        lua_setfield(pLuaState, -2, "vertexShaderInvocationCount");
+        lua_pushinteger(pLuaState, (lua_Integer)pTknGpuRenderPassProfile->clippingPrimitiveCount);
+        lua_setfield(pLuaState, -2, "clippingPrimitiveCount");
+        lua_pushinteger(pLuaState, (lua_Integer)pTknGpuRenderPassProfile->fragmentShaderInvocationCount);
+        lua_setfield(pLuaState, -2, "fragmentShaderInvocationCount");
+        lua_rawseti(pLuaState, -2, renderPassIndex + 1);
+    }
+    lua_setfield(pLuaState, -2, "renderPasses");
+    return 1;
+}
+
+static int luaBeginRenderPassPtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -4);
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -3);
+    TknRenderPass *pTknRenderPass = (TknRenderPass *)lua_touserdata(pLuaState, -2);
+    VkSubpassContents vkSubpassContents = (VkSubpassContents)lua_tointeger(pLuaState, -1);
+    tknBeginRenderPassPtr(pTknGfxContext, pTknFrame, pTknRenderPass, vkSubpassContents);
     return 0;
 }
 
@@ -1719,9 +2584,10 @@ static int luaEndRenderPassPtr(lua_State *pLuaState)
 
 static int luaNextSubpassPtr(lua_State *pLuaState)
 {
-    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
-    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -1);
-    tknNextSubpassPtr(pTknGfxContext, pTknFrame);
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -3);
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -2);
+    VkSubpassContents vkSubpassContents = (VkSubpassContents)lua_tointeger(pLuaState, -1);
+    tknNextSubpassPtr(pTknGfxContext, pTknFrame, vkSubpassContents);
     return 0;
 }
 
@@ -1734,6 +2600,72 @@ static int luaRecordDrawCallPtr(lua_State *pLuaState)
     return 0;
 }
 
+static int luaCreateDrawQueuePtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -1);
+    TknDrawQueue *pTknDrawQueue = tknCreateDrawQueuePtr(pTknGfxContext);
+    lua_pushlightuserdata(pLuaState, pTknDrawQueue);
+    return 1;
+}
+
+static int luaDestroyDrawQueuePtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -2);
+    TknDrawQueue *pTknDrawQueue = (TknDrawQueue *)lua_touserdata(pLuaState, -1);
+    tknDestroyDrawQueuePtr(pTknGfxContext, pTknDrawQueue);
+    return 0;
+}
+
+static int luaGetDrawCallSortKey(lua_State *pLuaState)
+{
+    TknDrawCall *pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -3);
+    uint8_t layer = (uint8_t)lua_tointeger(pLuaState, -2);
+    float depth = (float)lua_tonumber(pLuaState, -1);
+    lua_pushinteger(pLuaState, (lua_Integer)tknGetDrawCallSortKey(pTknDrawCall, layer, depth));
+    return 1;
+}
+
+// entries is a flat array of entryCount triples: sortKey, pTknDrawCall, stencil.
+// stencil is false or compareMask | writeMask << 8 | reference << 16, the array is reused so only entryCount triples are read
+static int luaRecordDrawQueuePtr(lua_State *pLuaState)
+{
+    TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -5);
+    TknFrame *pTknFrame = (TknFrame *)lua_touserdata(pLuaState, -4);
+    TknDrawQueue *pTknDrawQueue = (TknDrawQueue *)lua_touserdata(pLuaState, -3);
+    int entriesIndex = lua_absindex(pLuaState, -2);
+    uint32_t entryCount = (uint32_t)lua_tointeger(pLuaState, -1);
+    for (uint32_t entryIndex = 0; entryIndex < entryCount; entryIndex++)
+    {
+        lua_Integer firstIndex = (lua_Integer)entryIndex * 3 + 1;
+        lua_rawgeti(pLuaState, entriesIndex, firstIndex);
+        lua_rawgeti(pLuaState, entriesIndex, firstIndex + 1);
+        lua_rawgeti(pLuaState, entriesIndex, firstIndex + 2);
+        TknDrawQueueEntry tknDrawQueueEntry = {
+            .sortKey = (uint64_t)lua_tointeger(pLuaState, -3),
+            .pTknDrawCall = (TknDrawCall *)lua_touserdata(pLuaState, -2),
+            .isStencilSet = lua_isinteger(pLuaState, -1),
+            .stencilCompareMask = 0,
+            .stencilWriteMask = 0,
+            .stencilReference = 0,
+        };
+        if (tknDrawQueueEntry.isStencilSet)
+        {
+            lua_Integer stencil = lua_tointeger(pLuaState, -1);
+            tknDrawQueueEntry.stencilCompareMask = (uint8_t)(stencil & 0xFF);
+            tknDrawQueueEntry.stencilWriteMask = (uint8_t)((stencil >> 8) & 0xFF);
+            tknDrawQueueEntry.stencilReference = (uint8_t)((stencil >> 16) & 0xFF);
+        }
+        else
+        {
+            // Keeps the stencil state of the previous draw
+        }
+        lua_pop(pLuaState, 3);
+        tknPushToDrawQueue(pTknDrawQueue, tknDrawQueueEntry);
+    }
+    tknRecordDrawQueuePtr(pTknGfxContext, pTknFrame, pTknDrawQueue);
+    return 0;
+}
+
 static int luaSetStencilCompareMask(lua_State *pLuaState)
 {
     TknGfxContext *pTknGfxContext = (TknGfxContext *)lua_touserdata(pLuaState, -4);
@@ -1775,7 +2707,7 @@ static int luaClearAttachments(lua_State *pLuaState)
     uint32_t clearAttachmentCount = (uint32_t)lua_tointeger(pLuaState, -1);
     lua_pop(pLuaState, 1);
 
-    VkClearAttachment *pClearAttachments = tknMalloc(sizeof(VkClearAttachment) * clearAttachmentCount);
+    VkClearAttachment *pClearAttachments = tknAllocateFrameMemory(pTknFrame, sizeof(VkClearAttachment) * clearAttachmentCount);
     memset(pClearAttachments, 0, sizeof(VkClearAttachment) * clearAttachmentCount);
 
     for (uint32_t i = 0; i < clearAttachmentCount; i++)
@@ -1837,7 +2769,7 @@ static int luaClearAttachments(lua_State *pLuaState)
     uint32_t clearRectCount = (uint32_t)lua_tointeger(pLuaState, -1);
     lua_pop(pLuaState, 1);
 
-    VkClearRect *pClearRects = tknMalloc(sizeof(VkClearRect) * clearRectCount);
+    VkClearRect *pClearRects = tknAllocateFrameMemory(pTknFrame, sizeof(VkClearRect) * clearRectCount);
     memset(pClearRects, 0, sizeof(VkClearRect) * clearRectCount);
 
     for (uint32_t i = 0; i < clearRectCount; i++)
@@ -1893,15 +2825,17 @@ static int luaClearAttachments(lua_State *pLuaState)
 
     tknClearAttachments(pTknGfxContext, pTknFrame, clearAttachmentCount, pClearAttachments, clearRectCount, pClearRects);
 
-    tknFree(pClearAttachments);
-    tknFree(pClearRects);
-
     return 0;
 }
 
 void bindFunctions(lua_State *pLuaState)
 {
     luaL_Reg regs[] = {
+        {"tknCompileLayout", luaCompileLayout},
+        {"tknNewBuffer", luaNewBuffer},
+        {"tknGetUniformBufferView", luaGetUniformBufferView},
+        {"tknGetInstanceView", luaGetInstanceView},
+        {"tknGetDynamicBufferView", luaGetDynamicBufferView},
         {"tknGetSupportedFormat", luaGetSupportedFormat},
         {"tknCreateDynamicAttachmentPtr", luaCreateDynamicAttachmentPtr},
         {"tknCreateFixedAttachmentPtr", luaCreateFixedAttachmentPtr},
@@ -1913,9 +2847,22 @@ void bindFunctions(lua_State *pLuaState)
         {"tknCreateRenderPassPtr", luaCreateRenderPassPtr},
         {"tknDestroyRenderPassPtr", luaDestroyRenderPassPtr},
         {"tknCreatePipelinePtr", luaCreatePipelinePtr},
+        {"tknCreatePipelinesPtr", luaCreatePipelinesPtr},
+        {"tknReloadShaderReflection", luaReloadShaderReflection},
         {"tknDestroyPipelinePtr", luaDestroyPipelinePtr},
+        {"tknCreateComputePipelinePtr", luaCreateComputePipelinePtr},
+        {"tknDestroyComputePipelinePtr", luaDestroyComputePipelinePtr},
         {"tknCreateDrawCallPtr", luaCreateDrawCallPtr},
         {"tknDestroyDrawCallPtr", luaDestroyDrawCallPtr},
+        {"tknSetDrawCallDynamicOffsets", luaSetDrawCallDynamicOffsets},
+        {"tknSetDrawCallPushConstants", luaSetDrawCallPushConstants},
+        {"tknSetDrawCallIndirect", luaSetDrawCallIndirect},
+        {"tknSetDrawCallIndirectStorage", luaSetDrawCallIndirectStorage},
+        {"tknIsDrawIndirectCountSupported", luaIsDrawIndirectCountSupported},
+        {"tknGetDrawCallSortKey", luaGetDrawCallSortKey},
+        {"tknCreateDrawQueuePtr", luaCreateDrawQueuePtr},
+        {"tknDestroyDrawQueuePtr", luaDestroyDrawQueuePtr},
+        {"tknRecordDrawQueuePtr", luaRecordDrawQueuePtr},
         {"tknCreateImagePtr", luaCreateImagePtr},
         {"tknDestroyImagePtr", luaDestroyImagePtr},
         {"tknCreateSamplerPtr", luaCreateSamplerPtr},
@@ -1925,15 +2872,26 @@ void bindFunctions(lua_State *pLuaState)
         {"tknCreateUniformBufferPtr", luaCreateUniformBufferPtr},
         {"tknDestroyUniformBufferPtr", luaDestroyUniformBufferPtr},
         {"tknUpdateUniformBufferPtr", luaUpdateUniformBufferPtr},
+        {"tknCreateDynamicBufferPtr", luaCreateDynamicBufferPtr},
+        {"tknDestroyDynamicBufferPtr", luaDestroyDynamicBufferPtr},
+        {"tknGetDynamicBufferOffset", luaGetDynamicBufferOffset},
+        {"tknCreateStorageBufferPtr", luaCreateStorageBufferPtr},
+        {"tknDestroyStorageBufferPtr", luaDestroyStorageBufferPtr},
         {"tknCreateMeshPtrWithData", luaCreateMeshPtrWithData},
+        {"tknUploadMeshAsync", luaUploadMeshAsync},
+        {"tknUploadImageAsync", luaUploadImageAsync},
+        {"tknIsUploadComplete", luaIsUploadComplete},
+        {"tknWaitUpload", luaWaitUpload},
         {"tknDestroyMeshPtr", luaDestroyMeshPtr},
         {"tknCreateInstancePtr", luaCreateInstancePtr},
         {"tknUpdateInstancePtr", luaUpdateInstancePtr},
         {"tknDestroyInstancePtr", luaDestroyInstancePtr},
+        {"tknSetFrameCamera", luaSetFrameCamera},
         {"tknGetGlobalMaterialPtr", luaGetGlobalMaterialPtr},
         {"tknGetSubpassMaterialPtr", luaGetSubpassMaterialPtr},
         {"tknCreatePipelineMaterialPtr", luaCreatePipelineMaterialPtr},
         {"tknDestroyPipelineMaterialPtr", luaDestroyPipelineMaterialPtr},
+        {"tknCreateComputeMaterialPtr", luaCreateComputeMaterialPtr},
         {"tknUpdateMaterialPtr", luaUpdateMaterialPtr},
         {"tknUpdateMeshPtr", luaUpdateMeshPtr},
         {"tknCreateTknFontLibraryPtr", luaCreateTknFontLibraryPtr},
@@ -1942,11 +2900,23 @@ void bindFunctions(lua_State *pLuaState)
         {"tknDestroyTknFontPtr", luaDestroyTknFontPtr},
         {"tknFlushTknFontPtr", luaFlushTknFontPtr},
         {"tknLoadChar", luaLoadTknChar},
+        {"tknGetMallocCount", luaGetMallocCount},
+        {"tknBeginProfileScope", luaBeginProfileScope},
+        {"tknEndProfileScope", luaEndProfileScope},
+        {"tknSetProfilerEnabled", luaSetProfilerEnabled},
+        {"tknWriteProfileTrace", luaWriteProfileTrace},
         {"tknWaitRenderFence", luaWaitRenderFence},
+        {"tknGetFrameIndex", luaGetFrameIndex},
+        {"tknGetFrameStats", luaGetFrameStats},
+        {"tknSetGpuProfilerEnabled", luaSetGpuProfilerEnabled},
+        {"tknGetGpuProfile", luaGetGpuProfile},
         {"tknBeginRenderPassPtr", luaBeginRenderPassPtr},
         {"tknEndRenderPassPtr", luaEndRenderPassPtr},
         {"tknNextSubpassPtr", luaNextSubpassPtr},
         {"tknRecordDrawCallPtr", luaRecordDrawCallPtr},
+        {"tknDispatch", luaDispatch},
+        {"tknBufferBarrier", luaBufferBarrier},
+        {"tknImageBarrier", luaImageBarrier},
         {"tknSetStencilCompareMask", luaSetStencilCompareMask},
         {"tknSetStencilWriteMask", luaSetStencilWriteMask},
         {"tknSetStencilReference", luaSetStencilReference},
@@ -1955,4 +2925,36 @@ void bindFunctions(lua_State *pLuaState)
     };
     luaL_newlib(pLuaState, regs);
     lua_setglobal(pLuaState, "tkn");
+    luaL_newmetatable(pLuaState, TKN_COMPILED_LAYOUT_METATABLE);
+    lua_pop(pLuaState, 1);
+    luaL_Reg bufferRegs[] = {
+        {"set", luaSetLuaBufferValue},
+        {"get", luaGetLuaBufferValue},
+        {"setField", luaSetLuaBufferField},
+        {NULL, NULL},
+    };
+    luaL_newmetatable(pLuaState, TKN_LUA_BUFFER_METATABLE);
+    luaL_newlib(pLuaState, bufferRegs);
+    lua_setfield(pLuaState, -2, "__index");
+    lua_pushcfunction(pLuaState, luaGetLuaBufferCount);
+    lua_setfield(pLuaState, -2, "__len");
+    lua_pop(pLuaState, 1);
+    luaL_Reg viewRegs[] = {
+        {"set", luaSetLuaViewValue},
+        {"setFloats", luaSetLuaViewFloats},
+        {NULL, NULL},
+    };
+    luaL_newmetatable(pLuaState, TKN_LUA_VIEW_METATABLE);
+    luaL_newlib(pLuaState, viewRegs);
+    lua_setfield(pLuaState, -2, "__index");
+    lua_pop(pLuaState, 1);
+    // Weak keys, a compiled layout lives as long as its format table
+    lua_newtable(pLuaState);
+    lua_createtable(pLuaState, 0, 1);
+    lua_pushstring(pLuaState, "k");
+    lua_setfield(pLuaState, -2, "__mode");
+    lua_setmetatable(pLuaState, -2);
+    lua_setfield(pLuaState, LUA_REGISTRYINDEX, TKN_COMPILED_LAYOUT_CACHE);
+    lua_newtable(pLuaState);
+    lua_setfield(pLuaState, LUA_REGISTRYINDEX, "tknProfileScopeNames");
 }
@@ -230,9 +230,16 @@ debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
 
     NSString *assetsPath =
         [resourcePath stringByAppendingPathComponent:@"assets"];
+    // The bundle is read only, the pipeline cache lives in the app's caches directory
+    NSString *cachePath = [NSSearchPathForDirectoriesInDomains(
+        NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    [[NSFileManager defaultManager] createDirectoryAtPath:cachePath
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:nil];
     self.pTknContext = createTknContextPtr(
-        [assetsPath UTF8String], sizeof(luaLibraries) / sizeof(luaLibraries[0]),
-        luaLibraries, 2, vkSurfaceFormatKHR, VK_PRESENT_MODE_FIFO_KHR,
+        [assetsPath UTF8String], [cachePath UTF8String], sizeof(luaLibraries) / sizeof(luaLibraries[0]),
+        luaLibraries, 3, 2, vkSurfaceFormatKHR, VK_PRESENT_MODE_FIFO_KHR,
         _vkInstance, _vkSurface, swapchainExtent);
 }
 
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <string.h>
+#include "tknCore.h"
+
+// Chained hash set that TknHashSet used before open addressing, kept here as the baseline
+typedef struct ChainedListNode
+{
+    void *data;
+    struct ChainedListNode *pNextNode;
+} ChainedListNode;
+
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t count;
+    size_t dataSize;
+    ChainedListNode **nodePtrs;
+} ChainedHashSet;
+
+typedef struct
+{
+    uint32_t id;
+    uint32_t binding;
+    uint64_t handle;
+    float weight;
+    uint32_t flags;
+} BenchStruct;
+
+static size_t chainedIndex(const void *pData, size_t dataSize, uint32_t capacity)
+{
+    size_t index = 0;
+    memcpy(&index, pData, sizeof(index) < dataSize ? sizeof(index) : dataSize);
+    return index & (capacity - 1);
+}
+
+static ChainedHashSet createChainedHashSet(size_t dataSize)
+{
+    uint32_t capacity = 1u << TKN_DEFAULT_COLLECTION_POWER_OF_TWO;
+    ChainedHashSet chainedHashSet = {
+        .capacity = capacity,
+        .count = 0,
+        .dataSize = dataSize,
+        .nodePtrs = calloc(capacity, sizeof(ChainedListNode *)),
+    };
+    return chainedHashSet;
+}
+
+static void destroyChainedHashSet(ChainedHashSet chainedHashSet)
+{
+    for (uint32_t i = 0; i < chainedHashSet.capacity; i++)
+    {
+        ChainedListNode *node = chainedHashSet.nodePtrs[i];
+        while (node)
+        {
+            ChainedListNode *nextNode = node->pNextNode;
+            free(node->data);
+            free(node);
+            node = nextNode;
+        }
+    }
+    free(chainedHashSet.nodePtrs);
+}
+
+static bool addToChainedHashSet(ChainedHashSet *pChainedHashSet, const void *pData)
+{
+    if (pChainedHashSet->count >= pChainedHashSet->capacity * 3 / 4)
+    {
+        uint32_t newCapacity = pChainedHashSet->capacity * 2;
+        ChainedListNode **newNodePtrs = calloc(newCapacity, sizeof(ChainedListNode *));
+        for (uint32_t i = 0; i < pChainedHashSet->capacity; i++)
+        {
+            ChainedListNode *node = pChainedHashSet->nodePtrs[i];
+            while (node)
+            {
+                size_t newIndex = chainedIndex(node->data, pChainedHashSet->dataSize, newCapacity);
+                ChainedListNode *nextNode = node->pNextNode;
+                node->pNextNode = newNodePtrs[newIndex];
+                newNodePtrs[newIndex] = node;
+                node = nextNode;
+            }
+        }
+        free(pChainedHashSet->nodePtrs);
+        pChainedHashSet->nodePtrs = newNodePtrs;
+        pChainedHashSet->capacity = newCapacity;
+    }
+    size_t index = chainedIndex(pData, pChainedHashSet->dataSize, pChainedHashSet->capacity);
+    for (ChainedListNode *node = pChainedHashSet->nodePtrs[index]; node; node = node->pNextNode)
+    {
+        if (memcmp(node->data, pData, pChainedHashSet->dataSize) == 0)
+            return false;
+    }
+    ChainedListNode *newNode = malloc(sizeof(ChainedListNode));
+    newNode->data = malloc(pChainedHashSet->dataSize);
+    memcpy(newNode->data, pData, pChainedHashSet->dataSize);
+    newNode->pNextNode = pChainedHashSet->nodePtrs[index];
+    pChainedHashSet->nodePtrs[index] = newNode;
+    pChainedHashSet->count++;
+    return true;
+}
+
+static bool containsInChainedHashSet(ChainedHashSet *pChainedHashSet, const void *pData)
+{
+    size_t index = chainedIndex(pData, pChainedHashSet->dataSize, pChainedHashSet->capacity);
+    for (ChainedListNode *node = pChainedHashSet->nodePtrs[index]; node; node = node->pNextNode)
+    {
+        if (memcmp(node->data, pData, pChainedHashSet->dataSize) == 0)
+            return true;
+    }
+    return false;
+}
+
+static void removeFromChainedHashSet(ChainedHashSet *pChainedHashSet, const void *pData)
+{
+    size_t index = chainedIndex(pData, pChainedHashSet->dataSize, pChainedHashSet->capacity);
+    ChainedListNode *node = pChainedHashSet->nodePtrs[index];
+    ChainedListNode *prevNode = NULL;
+    while (node)
+    {
+        if (memcmp(node->data, pData, pChainedHashSet->dataSize) == 0)
+        {
+            if (prevNode)
+                prevNode->pNextNode = node->pNextNode;
+            else
+                pChainedHashSet->nodePtrs[index] = node->pNextNode;
+            free(node->data);
+            free(node);
+            pChainedHashSet->count--;
+            return;
+        }
+        prevNode = node;
+        node = node->pNextNode;
+    }
+}
+
+static double elapsedMilliseconds(clock_t start)
+{
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static void benchKeys(const char *name, const void *keys, size_t keySize, uint32_t keyCount, uint32_t roundCount)
+{
+    double chainedAdd = 0, chainedContains = 0, chainedIterate = 0, chainedRemove = 0;
+    double flatAdd = 0, flatContains = 0, flatIterate = 0, flatRemove = 0;
+    size_t checksum = 0;
+    for (uint32_t round = 0; round < roundCount; round++)
+    {
+        ChainedHashSet chainedHashSet = createChainedHashSet(keySize);
+        clock_t start = clock();
+        for (uint32_t i = 0; i < keyCount; i++)
+            addToChainedHashSet(&chainedHashSet, (const char *)keys + i * keySize);
+        chainedAdd += elapsedMilliseconds(start);
+        start = clock();
+        for (uint32_t i = 0; i < keyCount; i++)
+            checksum += containsInChainedHashSet(&chainedHashSet, (const char *)keys + i * keySize);
+        chainedContains += elapsedMilliseconds(start);
+        start = clock();
+        for (uint32_t i = 0; i < chainedHashSet.capacity; i++)
+        {
+            for (ChainedListNode *node = chainedHashSet.nodePtrs[i]; node; node = node->pNextNode)
+                checksum += *(const unsigned char *)node->data;
+        }
+        chainedIterate += elapsedMilliseconds(start);
+        start = clock();
+        for (uint32_t i = 0; i < keyCount; i++)
+            removeFromChainedHashSet(&chainedHashSet, (const char *)keys + i * keySize);
+        chainedRemove += elapsedMilliseconds(start);
+        destroyChainedHashSet(chainedHashSet);
+
+        TknHashSet tknHashSet = tknCreateHashSet(keySize);
+        start = clock();
+        for (uint32_t i = 0; i < keyCount; i++)
+            tknAddToHashSet(&tknHashSet, (const char *)keys + i * keySize);
+        flatAdd += elapsedMilliseconds(start);
+        start = clock();
+        for (uint32_t i = 0; i < keyCount; i++)
+            checksum += tknContainsInHashSet(&tknHashSet, (const char *)keys + i * keySize);
+        flatContains += elapsedMilliseconds(start);
+        start = clock();
+        for (uint32_t i = 0; i < tknHashSet.count; i++)
+            checksum += *(const unsigned char *)tknGetFromHashSet(&tknHashSet, i);
+        flatIterate += elapsedMilliseconds(start);
+        start = clock();
+        for (uint32_t i = 0; i < keyCount; i++)
+            tknRemoveFromHashSet(&tknHashSet, (const char *)keys + i * keySize);
+        flatRemove += elapsedMilliseconds(start);
+        tknAssert(tknHashSet.count == 0, "Hash set is not empty after removing all keys");
+        tknDestroyHashSet(tknHashSet);
+    }
+    printf("--- %s keys: %u keys x %u rounds ---\n", name, keyCount, roundCount);
+    printf("%-10s %12s %12s %12s %12s\n", "", "add ms", "contains ms", "iterate ms", "remove ms");
+    printf("%-10s %12.3f %12.3f %12.3f %12.3f\n", "chained", chainedAdd, chainedContains, chainedIterate, chainedRemove);
+    printf("%-10s %12.3f %12.3f %12.3f %12.3f\n", "flat", flatAdd, flatContains, flatIterate, flatRemove);
+    printf("checksum=%zu\n", checksum);
+}
+
+int main()
+{
+    const uint32_t keyCount = 100000;
+    const uint32_t roundCount = 5;
+
+    // Heap pointers share their low bits, which is the common key in the engine
+    void **pointerKeys = tknMalloc(sizeof(void *) * keyCount);
+    for (uint32_t i = 0; i < keyCount; i++)
+    {
+        pointerKeys[i] = tknMalloc(48);
+    }
+    benchKeys("pointer", pointerKeys, sizeof(void *), keyCount, roundCount);
+    for (uint32_t i = 0; i < keyCount; i++)
+    {
+        tknFree(pointerKeys[i]);
+    }
+    tknFree(pointerKeys);
+
+    BenchStruct *structKeys = tknMalloc(sizeof(BenchStruct) * keyCount);
+    memset(structKeys, 0, sizeof(BenchStruct) * keyCount);
+    for (uint32_t i = 0; i < keyCount; i++)
+    {
+        structKeys[i] = (BenchStruct){
+            .id = i / 16,
+            .binding = i % 16,
+            .handle = 0x1000ull + i * 256,
+            .weight = (float)i,
+            .flags = 0,
+        };
+    }
+    benchKeys("struct", structKeys, sizeof(BenchStruct), keyCount, roundCount);
+    tknFree(structKeys);
+    return 0;
+}
@@ -3,6 +3,16 @@
 #include "vulkan/vulkan.h"
 
 #define TKN_ARRAY_COUNT(array) (NULL == array) ? 0 : (sizeof(array) / sizeof(array[0]))
+#define TKN_MAX_FRAMES_IN_FLIGHT 3
+#define TKN_DEFAULT_FRAMES_IN_FLIGHT 2
+#define TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT 16
+#define TKN_MAX_GPU_PROFILE_SUBPASS_COUNT 8
+// Dynamic buffer bindings per descriptor set
+#define TKN_MAX_DYNAMIC_OFFSET_COUNT 8
+// Push constant bytes every device supports, larger blocks belong in a buffer
+#define TKN_MAX_PUSH_CONSTANT_SIZE 128
+// The top byte of a draw sort key, so ordering constraints always win over state batching
+#define TKN_DRAW_SORT_KEY_LAYER_SHIFT 56
 
 typedef struct TknGfxContext TknGfxContext;
 typedef struct TknFrame TknFrame;
@@ -10,15 +20,19 @@ typedef struct TknFrame TknFrame;
 typedef struct TknRenderPass TknRenderPass;
 typedef struct TknVertexInputLayout TknVertexInputLayout;
 typedef struct TknPipeline TknPipeline;
+typedef struct TknComputePipeline TknComputePipeline;
 typedef struct TknMaterial TknMaterial;
 typedef struct TknInstance TknInstance;
 typedef struct TknMesh TknMesh;
 typedef struct TknDrawCall TknDrawCall;
+typedef struct TknDrawQueue TknDrawQueue;
 
 typedef struct TknAttachment TknAttachment;
 typedef struct TknImage TknImage;
 typedef struct TknSampler TknSampler;
 typedef struct TknUniformBuffer TknUniformBuffer;
+typedef struct TknDynamicBuffer TknDynamicBuffer;
+typedef struct TknStorageBuffer TknStorageBuffer;
 
 typedef struct
 {
@@ -31,24 +45,42 @@ typedef struct
     TknImage *pTknImage;
 } TknCombinedImageSamplerBinding;
 
+typedef struct
+{
+    TknImage *pTknImage;
+} TknStorageImageBinding;
+
 typedef struct
 {
     TknUniformBuffer *pTknUniformBuffer;
 } TknUniformBufferBinding;
 
+typedef struct
+{
+    TknStorageBuffer *pTknStorageBuffer;
+} TknStorageBufferBinding;
+
+typedef struct
+{
+    TknDynamicBuffer *pTknDynamicBuffer;
+} TknDynamicBufferBinding;
+
 typedef union
 {
     TknSamplerBinding tknSamplerBinding;
     TknCombinedImageSamplerBinding tknCombinedImageSamplerBinding;
     // VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE = 2,
     // VK_DESCRIPTOR_TYPE_STORAGE_IMAGE = 3,
+    TknStorageImageBinding tknStorageImageBinding;
     // VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER = 4,
     // VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER = 5,
     // VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER = 6,
     TknUniformBufferBinding tknUniformBufferBinding;
     // VK_DESCRIPTOR_TYPE_STORAGE_BUFFER = 7,
+    TknStorageBufferBinding tknStorageBufferBinding;
     // VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC = 8,
     // VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC = 9,
+    TknDynamicBufferBinding tknDynamicBufferBinding;
 } TknInputBindingUnion;
 
 typedef struct
@@ -58,6 +90,124 @@ typedef struct
     uint32_t binding;
 } TknInputBinding;
 
+typedef enum
+{
+    TKN_MEMORY_USAGE_MESH,
+    TKN_MEMORY_USAGE_INSTANCE,
+    TKN_MEMORY_USAGE_UNIFORM_BUFFER,
+    TKN_MEMORY_USAGE_DYNAMIC_BUFFER,
+    TKN_MEMORY_USAGE_STORAGE_BUFFER,
+    TKN_MEMORY_USAGE_IMAGE,
+    TKN_MEMORY_USAGE_ATTACHMENT,
+    TKN_MEMORY_USAGE_STAGING,
+    TKN_MAX_MEMORY_USAGE,
+} TknMemoryUsage;
+
+typedef struct
+{
+    uint32_t blockCount;
+    uint32_t dedicatedBlockCount;
+    uint32_t allocationCount;
+    VkDeviceSize blockSize;
+    VkDeviceSize usedSize;
+    VkDeviceSize freeSize;
+    VkDeviceSize largestFreeSize;
+    // 0 when the free space of every block is one range, approaches 1 as it splits into small ranges
+    float fragmentation;
+    VkDeviceSize usageSizes[TKN_MAX_MEMORY_USAGE];
+} TknMemoryStats;
+
+typedef struct
+{
+    // True when a cache file matching this device was loaded at startup
+    bool isLoaded;
+    size_t loadedSize;
+    double loadMilliseconds;
+    // Hits are only reported with VK_EXT_pipeline_creation_feedback, without it every pipeline is a miss
+    bool isFeedbackSupported;
+    uint32_t hitCount;
+    uint32_t missCount;
+    double hitMilliseconds;
+    double missMilliseconds;
+} TknPipelineCacheStats;
+
+typedef struct
+{
+    // Summed over every descriptor set layout
+    uint32_t poolCount;
+    uint32_t setCapacity;
+    // Sets held by live materials
+    uint32_t usedSetCount;
+    // Sets of destroyed materials that frames in flight may still read
+    uint32_t retiredSetCount;
+    // Sets waiting in free lists for the next material, the rest of the capacity was never allocated
+    uint32_t freeSetCount;
+} TknDescriptorPoolStats;
+
+typedef struct
+{
+    // Descriptor sets, vertex buffers and index buffers, counted one per set or buffer
+    uint32_t emittedBindCount;
+    // Binds left out because the same object was already bound at the same slot and offset
+    uint32_t skippedBindCount;
+} TknFrameStats;
+
+typedef struct
+{
+    TknRenderPass *pTknRenderPass;
+    uint32_t subpassCount;
+    double milliseconds;
+    // Only inline subpasses can take timestamps, a secondary subpass following a secondary subpass is counted in the one before it and reports 0
+    double subpassMilliseconds[TKN_MAX_GPU_PROFILE_SUBPASS_COUNT];
+    // Counted over the whole render pass, 0 unless pipeline statistics are enabled
+    uint64_t inputAssemblyVertexCount;
+    uint64_t inputAssemblyPrimitiveCount;
+    uint64_t vertexShaderInvocationCount;
+    uint64_t clippingPrimitiveCount;
+    uint64_t fragmentShaderInvocationCount;
+} TknGpuRenderPassProfile;
+
+typedef struct
+{
+    bool isTimestampSupported;
+    // Needs pipelineStatisticsQuery and inheritedQueries, the latter for subpasses recorded in secondary command buffers
+    bool isPipelineStatisticsSupported;
+    // tknAcquireFramePtr count of the frame the profile was recorded in, 0 until a profiled frame was read back
+    uint32_t frameCount;
+    uint32_t renderPassCount;
+    TknGpuRenderPassProfile tknGpuRenderPassProfiles[TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT];
+} TknGpuProfile;
+
+typedef struct
+{
+    // Draws are recorded in ascending key order, equal keys keep the order they were pushed in
+    uint64_t sortKey;
+    TknDrawCall *pTknDrawCall;
+    // Stencil state for both faces, set before the draw unless the previous draw left the same values
+    bool isStencilSet;
+    uint8_t stencilCompareMask;
+    uint8_t stencilWriteMask;
+    uint8_t stencilReference;
+} TknDrawQueueEntry;
+
+// Everything tknCreatePipelinePtr takes, so a batch of pipelines can be created at once
+typedef struct
+{
+    TknRenderPass *pTknRenderPass;
+    uint32_t subpassIndex;
+    uint32_t spvPathCount;
+    const char **spvPaths;
+    TknVertexInputLayout *pTknMeshVertexInputLayout;
+    TknVertexInputLayout *pTknInstanceVertexInputLayout;
+    VkPipelineInputAssemblyStateCreateInfo vkPipelineInputAssemblyStateCreateInfo;
+    VkPipelineViewportStateCreateInfo vkPipelineViewportStateCreateInfo;
+    VkPipelineRasterizationStateCreateInfo vkPipelineRasterizationStateCreateInfo;
+    VkPipelineMultisampleStateCreateInfo vkPipelineMultisampleStateCreateInfo;
+    VkPipelineDepthStencilStateCreateInfo vkPipelineDepthStencilStateCreateInfo;
+    VkPipelineColorBlendStateCreateInfo vkPipelineColorBlendStateCreateInfo;
+    VkPipelineDynamicStateCreateInfo vkPipelineDynamicStateCreateInfo;
+} TknPipelineCreateInfo;
+
 // ASTC image data
 typedef struct
 {
@@ -73,21 +223,40 @@ void tknDestroyASTCImage(TknASTCImage *tknAstcImage);
 
 VkFormat tknGetSupportedFormat(TknGfxContext *pTknGfxContext, uint32_t candidateCount, VkFormat *candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
-TknGfxContext *tknCreateGfxContextPtr(int targetSwapchainImageCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D tknSwapchainExtent, uint32_t spvPathCount, const char **spvPaths);
+// pipelineCachePath is loaded on creation and written back on destruction, NULL keeps the pipeline cache in memory only
+TknGfxContext *tknCreateGfxContextPtr(int targetSwapchainImageCount, uint32_t frameInFlightCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D tknSwapchainExtent, uint32_t spvPathCount, const char **spvPaths, const char *pipelineCachePath);
 void tknWaitGfxRenderFence(TknGfxContext *pTknGfxContext);
 void tknWaitGfxDeviceIdle(TknGfxContext *pTknGfxContext);
 TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapchainExtent);
 void tknSubmitAndPresentFramePtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame);
 void tknResetFrameSyncPrimitivesPtr(TknGfxContext *pTknGfxContext);
+uint32_t tknGetFrameIndex(TknFrame *pTknFrame);
+// Counts since the frame was acquired
+TknFrameStats tknGetFrameStats(TknFrame *pTknFrame);
 void tknDestroyGfxContextPtr(TknGfxContext *pTknGfxContext);
-void tknBeginRenderPassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknRenderPass *pTknRenderPass);
+TknMemoryStats tknGetMemoryStats(TknGfxContext *pTknGfxContext);
+TknPipelineCacheStats tknGetPipelineCacheStats(TknGfxContext *pTknGfxContext);
+TknDescriptorPoolStats tknGetDescriptorPoolStats(TknGfxContext *pTknGfxContext);
+// Takes effect from the next acquired frame, unsupported queries stay off
+void tknSetGpuProfilerEnabled(TknGfxContext *pTknGfxContext, bool isTimestampEnabled, bool isPipelineStatisticsEnabled);
+// Results of the last profiled frame that finished on the GPU, frames are read back when they are acquired again so nothing waits
+TknGpuProfile tknGetGpuProfile(TknGfxContext *pTknGfxContext);
+// With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the subpass only records draw queues, they are recorded in parallel on workers
+void tknBeginRenderPassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknRenderPass *pTknRenderPass, VkSubpassContents vkSubpassContents);
 void tknEndRenderPassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame);
-void tknNextSubpassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame);
+void tknNextSubpassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, VkSubpassContents vkSubpassContents);
 void tknRecordDrawCallPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknDrawCall *pTknDrawCall);
 void tknSetStencilCompareMask(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, VkStencilFaceFlags faceMask, uint32_t compareMask);
 void tknSetStencilWriteMask(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, VkStencilFaceFlags faceMask, uint32_t writeMask);
 void tknSetStencilReference(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, VkStencilFaceFlags faceMask, uint32_t reference);
 void tknClearAttachments(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, uint32_t clearAttachmentCount, const VkClearAttachment *pClearAttachments, uint32_t clearRectCount, const VkClearRect *pClearRects);
+// Recorded outside render passes with the global set and pTknMaterial bound at the compute bind point.
+// pushConstants fills the pipeline's whole push constant block and may be NULL when it declares none
+void tknDispatch(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknComputePipeline *pTknComputePipeline, TknMaterial *pTknMaterial, const void *pushConstants, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+// Makes the src accesses of earlier commands visible to the dst accesses of later ones, e.g. compute writes before vertex or indirect reads
+void tknBufferBarrier(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknStorageBuffer *pTknStorageBuffer, VkPipelineStageFlags srcVkPipelineStageFlags, VkAccessFlags srcVkAccessFlags, VkPipelineStageFlags dstVkPipelineStageFlags, VkAccessFlags dstVkAccessFlags);
+// Same for an image, which keeps its layout
+void tknImageBarrier(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknImage *pTknImage, VkPipelineStageFlags srcVkPipelineStageFlags, VkAccessFlags srcVkAccessFlags, VkPipelineStageFlags dstVkPipelineStageFlags, VkAccessFlags dstVkAccessFlags);
 
 TknAttachment *tknCreateDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, VkFormat vkFormat, VkImageUsageFlags vkImageUsageFlags, VkImageAspectFlags vkImageAspectFlags, float scaler);
 void tknDestroyDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, TknAttachment *pTknAttachment);
@@ -102,11 +271,39 @@ TknRenderPass *tknCreateRenderPassPtr(TknGfxContext *pTknGfxContext, uint32_t tk
 void tknDestroyRenderPassPtr(TknGfxContext *pTknGfxContext, TknRenderPass *pTknRenderPass);
 
 TknPipeline *tknCreatePipelinePtr(TknGfxContext *pTknGfxContext, TknRenderPass *pTknRenderPass, uint32_t subpassIndex, uint32_t spvPathCount, const char **spvPaths, TknVertexInputLayout *pTknMeshVertexInputLayout, TknVertexInputLayout *pTknInstanceVertexInputLayout, VkPipelineInputAssemblyStateCreateInfo vkPipelineInputAssemblyStateCreateInfo, VkPipelineViewportStateCreateInfo vkPipelineViewportStateCreateInfo, VkPipelineRasterizationStateCreateInfo vkPipelineRasterizationStateCreateInfo, VkPipelineMultisampleStateCreateInfo vkPipelineMultisampleStateCreateInfo, VkPipelineDepthStencilStateCreateInfo vkPipelineDepthStencilStateCreateInfo, VkPipelineColorBlendStateCreateInfo vkPipelineColorBlendStateCreateInfo, VkPipelineDynamicStateCreateInfo vkPipelineDynamicStateCreateInfo);
+// Rereads a shader for hot reload, returns whether its contents changed. Pipelines created afterwards use the new code
+bool tknReloadShaderReflection(TknGfxContext *pTknGfxContext, const char *spvPath);
+// Creates the pipelines in parallel and blocks until all of them are ready, pipelinePtrs receives one per create info
+void tknCreatePipelinesPtr(TknGfxContext *pTknGfxContext, uint32_t pipelineCount, const TknPipelineCreateInfo *tknPipelineCreateInfos, TknPipeline **pipelinePtrs);
 void tknDestroyPipelinePtr(TknGfxContext *pTknGfxContext, TknPipeline *pTknPipeline);
+// One compute shader, its set 2 is reflected like a pipeline set and set 1 must stay unused since compute runs outside subpasses
+TknComputePipeline *tknCreateComputePipelinePtr(TknGfxContext *pTknGfxContext, const char *spvPath);
+void tknDestroyComputePipelinePtr(TknGfxContext *pTknGfxContext, TknComputePipeline *pTknComputePipeline);
 
 TknDrawCall *tknCreateDrawCallPtr(TknGfxContext *pTknGfxContext, TknPipeline *pTknPipeline, TknMaterial *pTknMaterial, TknMesh *pTknMesh, TknInstance *pTknInstance);
 void tknDestroyDrawCallPtr(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall);
+// Byte offsets into the frame copies of the material's dynamic bindings, one per binding in binding order, see tknGetDynamicBufferOffset
+void tknSetDrawCallDynamicOffsets(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, uint32_t dynamicOffsetCount, const uint32_t *dynamicOffsets);
+// Pushed before the draw is recorded, offset and size are in bytes of the pipeline's push constant block
+void tknSetDrawCallPushConstants(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, uint32_t offset, uint32_t size, const void *data);
+// Draws maxDrawCount commands from a storage dynamic buffer of VkDrawIndexedIndirectCommand for indexed meshes, VkDrawIndirectCommand otherwise.
+// The commands are written from C like any dynamic buffer, see tknSetDrawCallIndirectStorage for compute written ones. pCountTknDynamicBuffer holds one uint32_t that caps the count,
+// it needs draw indirect count support, check tknIsDrawIndirectCountSupported and give culled commands an instanceCount of 0 without it. A NULL command buffer goes back to direct draws
+void tknSetDrawCallIndirect(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, TknDynamicBuffer *pCommandTknDynamicBuffer, uint32_t firstCommand, uint32_t maxDrawCount, TknDynamicBuffer *pCountTknDynamicBuffer);
+// Same as tknSetDrawCallIndirect for commands a compute pass writes into tightly packed storage buffers, the count is the first uint32_t of its buffer.
+// The buffers are not flushed from the CPU, so order the writes before the draw with tknBufferBarrier to VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT and the next frame's writes after it
+void tknSetDrawCallIndirectStorage(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, TknStorageBuffer *pCommandTknStorageBuffer, uint32_t firstCommand, uint32_t maxDrawCount, TknStorageBuffer *pCountTknStorageBuffer);
+bool tknIsDrawIndirectCountSupported(TknGfxContext *pTknGfxContext);
+// Layer, then pipeline, material and mesh so draws sharing state sort next to each other, depth in [0, 1] orders the rest front to back.
+// Callers that need a strict order put the layer and a sequence number in the key instead.
+uint64_t tknGetDrawCallSortKey(TknDrawCall *pTknDrawCall, uint8_t layer, float depth);
+TknDrawQueue *tknCreateDrawQueuePtr(TknGfxContext *pTknGfxContext);
+void tknDestroyDrawQueuePtr(TknGfxContext *pTknGfxContext, TknDrawQueue *pTknDrawQueue);
+void tknPushToDrawQueue(TknDrawQueue *pTknDrawQueue, TknDrawQueueEntry tknDrawQueueEntry);
+// Sorts the pushed draws, records them into the current subpass and empties the queue
+void tknRecordDrawQueuePtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknDrawQueue *pTknDrawQueue);
 
+// Images with VK_IMAGE_USAGE_STORAGE_BIT stay in VK_IMAGE_LAYOUT_GENERAL so shaders can both sample and write them
 TknImage *tknCreateImagePtr(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageTiling vkImageTiling, VkImageUsageFlags vkImageUsageFlags, VkMemoryPropertyFlags vkMemoryPropertyFlags, VkImageAspectFlags vkImageAspectFlags, void *data, VkDeviceSize dataSize);
 void tknDestroyImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage);
 void tknUpdateImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage, uint32_t count, void **datas, VkOffset3D *imageOffsets, VkExtent3D *imageExtents, VkDeviceSize *dataSizes);
@@ -116,18 +313,47 @@ void tknDestroySamplerPtr(TknGfxContext *pTknGfxContext, TknSampler *pTknSampler
 TknUniformBuffer *tknCreateUniformBufferPtr(TknGfxContext *pTknGfxContext, const void *data, VkDeviceSize size);
 void tknDestroyUniformBufferPtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer);
 void tknUpdateUniformBufferPtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, const void *data, VkDeviceSize size);
+// Marks size bytes at offset dirty and returns them for the caller to fill before the frame that should see them is recorded.
+// Frames then copy only the written range
+void *tknWriteUniformBufferRangePtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, VkDeviceSize offset, VkDeviceSize size);
+
+// elementCount elements of elementSize bytes shared by many draws, each draw binds one of them through a dynamic offset.
+// vkDescriptorType is VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC or VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, data may be NULL for zeros
+TknDynamicBuffer *tknCreateDynamicBufferPtr(TknGfxContext *pTknGfxContext, VkDescriptorType vkDescriptorType, const void *data, VkDeviceSize elementSize, uint32_t elementCount);
+void tknDestroyDynamicBufferPtr(TknGfxContext *pTknGfxContext, TknDynamicBuffer *pTknDynamicBuffer);
+// Like tknWriteUniformBufferRangePtr over the tightly packed elements, frames copy every element the range touches
+void *tknWriteDynamicBufferRangePtr(TknGfxContext *pTknGfxContext, TknDynamicBuffer *pTknDynamicBuffer, VkDeviceSize offset, VkDeviceSize size);
+// Dynamic offset that selects an element, elements are padded to the device's offset alignment
+uint32_t tknGetDynamicBufferOffset(TknDynamicBuffer *pTknDynamicBuffer, uint32_t elementIndex);
+
+// Device local memory written by shaders, also usable as vertex or indirect buffer. data may be NULL, otherwise it is uploaded before the next frame's work
+TknStorageBuffer *tknCreateStorageBufferPtr(TknGfxContext *pTknGfxContext, const void *data, VkDeviceSize size);
+void tknDestroyStorageBufferPtr(TknGfxContext *pTknGfxContext, TknStorageBuffer *pTknStorageBuffer);
 
 TknMesh *tknCreateMeshPtrWithData(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknMeshVertexInputLayout, void *vertices, uint32_t tknVertexCount, VkIndexType vkIndexType, void *indices, uint32_t tknIndexCount);
 void tknDestroyMeshPtr(TknGfxContext *pTknGfxContext, TknMesh *pTknMesh);
 void tknUpdateMeshPtr(TknGfxContext *pTknGfxContext, TknMesh *pTknMesh, const char *format, const void *vertices, uint32_t tknVertexCount, uint32_t indexType, const void *indices, uint32_t tknIndexCount);
 
+// Uploads on the dedicated transfer queue when the device has one, a ticket of 0 means the upload already went through the graphics queue
+uint64_t tknUploadMeshAsync(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknMeshVertexInputLayout, void *vertices, uint32_t tknVertexCount, VkIndexType vkIndexType, void *indices, uint32_t tknIndexCount, TknMesh **ppTknMesh);
+uint64_t tknUploadImageAsync(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageUsageFlags vkImageUsageFlags, VkImageAspectFlags vkImageAspectFlags, void *data, VkDeviceSize dataSize, TknImage **ppTknImage);
+bool tknIsUploadComplete(TknGfxContext *pTknGfxContext, uint64_t ticket);
+void tknWaitUpload(TknGfxContext *pTknGfxContext, uint64_t ticket);
+
 TknInstance *tknCreateInstancePtr(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknVertexInputLayout, uint32_t tknInstanceCount, void *instances);
 void tknUpdateInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance, void *newData, uint32_t tknInstanceCount);
+// Like tknWriteUniformBufferRangePtr, within the current instances. Valid until the instance count grows past its capacity
+void *tknWriteInstanceRangePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance, VkDeviceSize offset, VkDeviceSize size);
 void tknDestroyInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance);
 
+// Camera of the next acquired frame. Time, frame count and screen size are filled in by the context, all of it lands in GlobalUniform.
+// view and proj are column major 4x4 matrices
+void tknSetFrameCamera(TknGfxContext *pTknGfxContext, const float *view, const float *proj, float nearPlane, float farPlane, float fov);
 TknMaterial *tknGetGlobalMaterialPtr(TknGfxContext *pTknGfxContext);
 TknMaterial *tknGetSubpassMaterialPtr(TknGfxContext *pTknGfxContext, TknRenderPass *pTknRenderPass, uint32_t subpassIndex);
 TknMaterial *tknCreatePipelineMaterialPtr(TknGfxContext *pTknGfxContext, TknPipeline *pTknPipeline);
+// Destroyed with tknDestroyPipelineMaterialPtr
+TknMaterial *tknCreateComputeMaterialPtr(TknGfxContext *pTknGfxContext, TknComputePipeline *pTknComputePipeline);
 void tknDestroyPipelineMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial);
 void tknUpdateMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial, uint32_t inputBindingCount, TknInputBinding *tknInputBindings);
 TknInputBindingUnion tknGetEmptyInputBindingUnion(TknGfxContext *pTknGfxContext, VkDescriptorType vkDescriptorType);
@@ -136,4 +362,22 @@ void tknError(char const *const _Format, ...);
 void tknWarning(const char *format, ...);
 void tknAssert(bool condition, char const *const _Format, ...);
 void *tknMalloc(size_t size);
-void tknFree(void *ptr);
\ No newline at end of file
+void tknFree(void *ptr);
+uint64_t tknGetMallocCount(void);
+// Monotonic wall clock, only differences between two calls are meaningful
+double tknGetTimeMilliseconds(void);
+// Thread local scratch memory, rewind to the marker taken before allocating once the data is consumed
+void *tknAllocateScratch(size_t size);
+size_t tknGetScratchMarker(void);
+void tknRewindScratch(size_t marker);
+// Lock free per thread recording of nested scopes. Begin and end pair on the calling thread, the name must stay valid until the trace is written
+void tknBeginProfileScope(const char *name);
+void tknEndProfileScope(void);
+// Profiles the block that follows, leaving it with break, goto or return loses the end event
+#define TKN_PROFILE_SCOPE(name) \
+    for (int tknProfileScopeOnce = (tknBeginProfileScope(name), 1); tknProfileScopeOnce; tknProfileScopeOnce = (tknEndProfileScope(), 0))
+void tknSetProfilerEnabled(bool isEnabled);
+bool tknWriteProfileTrace(const char *filePath);
+void tknDestroyProfiler(void);
+// Transient memory that stays valid until the frame is acquired again
+void *tknAllocateFrameMemory(TknFrame *pTknFrame, size_t size);
\ No newline at end of file
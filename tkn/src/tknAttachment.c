@@ -11,12 +11,12 @@ TknAttachment *tknCreateDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, VkFo
     };
 
     VkImage vkImage;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     VkImageView vkImageView;
-    tknCreateVkImage(pTknGfxContext, vkExtent3D, vkFormat, VK_IMAGE_TILING_OPTIMAL, vkImageUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vkImageAspectFlags, &vkImage, &vkDeviceMemory, &vkImageView);
+    tknCreateVkImage(pTknGfxContext, vkExtent3D, vkFormat, VK_IMAGE_TILING_OPTIMAL, vkImageUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vkImageAspectFlags, TKN_MEMORY_USAGE_ATTACHMENT, &vkImage, &tknMemoryAllocation, &vkImageView);
     TknDynamicAttachment dynamicAttachment = {
         .vkImage = vkImage,
-        .vkDeviceMemory = vkDeviceMemory,
+        .tknMemoryAllocation = tknMemoryAllocation,
         .vkImageView = vkImageView,
         .vkImageUsageFlags = vkImageUsageFlags,
         .vkImageAspectFlags = vkImageAspectFlags,
@@ -35,13 +35,14 @@ TknAttachment *tknCreateDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, VkFo
 void tknDestroyDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, TknAttachment *pTknAttachment)
 {
     tknAssert(TKN_ATTACHMENT_TYPE_DYNAMIC == pTknAttachment->tknAttachmentType, "TknAttachment type mismatch!");
+    tknWaitGfxFramesInFlight(pTknGfxContext);
     tknRemoveFromHashSet(&pTknGfxContext->tknDynamicAttachmentPtrHashSet, &pTknAttachment);
     TknDynamicAttachment dynamicAttachment = pTknAttachment->tknAttachmentUnion.tknDynamicAttachment;
     tknAssert(0 == dynamicAttachment.tknBindingPtrHashSet.count, "Cannot destroy dynamic attachment with bindings attached!");
     tknDestroyHashSet(dynamicAttachment.tknBindingPtrHashSet);
     tknAssert(0 == pTknAttachment->tknRenderPassPtrHashSet.count, "Cannot destroy dynamic attachment with render passes attached!");
     tknDestroyHashSet(pTknAttachment->tknRenderPassPtrHashSet);
-    tknDestroyVkImage(pTknGfxContext, dynamicAttachment.vkImage, dynamicAttachment.vkDeviceMemory, dynamicAttachment.vkImageView);
+    tknDestroyVkImage(pTknGfxContext, dynamicAttachment.vkImage, dynamicAttachment.tknMemoryAllocation, dynamicAttachment.vkImageView);
     tknFree(pTknAttachment);
 }
 void tknResizeDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, TknAttachment *pTknAttachment)
@@ -54,18 +55,13 @@ void tknResizeDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, TknAttachment
         .height = (uint32_t)(pTknSwapchainAttachment->tknSwapchainExtent.height * pDynamicAttachment->scaler),
         .depth = 1,
     };
-    tknDestroyVkImage(pTknGfxContext, pDynamicAttachment->vkImage, pDynamicAttachment->vkDeviceMemory, pDynamicAttachment->vkImageView);
-    tknCreateVkImage(pTknGfxContext, vkExtent3D, pTknAttachment->vkFormat, VK_IMAGE_TILING_OPTIMAL, pDynamicAttachment->vkImageUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pDynamicAttachment->vkImageAspectFlags, &pDynamicAttachment->vkImage, &pDynamicAttachment->vkDeviceMemory, &pDynamicAttachment->vkImageView);
+    tknDestroyVkImage(pTknGfxContext, pDynamicAttachment->vkImage, pDynamicAttachment->tknMemoryAllocation, pDynamicAttachment->vkImageView);
+    tknCreateVkImage(pTknGfxContext, vkExtent3D, pTknAttachment->vkFormat, VK_IMAGE_TILING_OPTIMAL, pDynamicAttachment->vkImageUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pDynamicAttachment->vkImageAspectFlags, TKN_MEMORY_USAGE_ATTACHMENT, &pDynamicAttachment->vkImage, &pDynamicAttachment->tknMemoryAllocation, &pDynamicAttachment->vkImageView);
 
-    for (uint32_t i = 0; i < pDynamicAttachment->tknBindingPtrHashSet.capacity; i++)
+    for (uint32_t bindingPtrIndex = 0; bindingPtrIndex < pDynamicAttachment->tknBindingPtrHashSet.count; bindingPtrIndex++)
     {
-        TknListNode *node = pDynamicAttachment->tknBindingPtrHashSet.nodePtrs[i];
-        while (node)
-        {
-            TknBinding *pTknBinding = *(TknBinding **)node->data;
-            tknUpdateAttachmentOfMaterialPtr(pTknGfxContext, pTknBinding);
-            node = node->pNextNode;
-        }
+        TknBinding *pTknBinding = *(TknBinding **)tknGetFromHashSet(&pDynamicAttachment->tknBindingPtrHashSet, bindingPtrIndex);
+        tknUpdateAttachmentOfMaterialPtr(pTknGfxContext, pTknBinding);
     }
 }
 TknAttachment *tknCreateFixedAttachmentPtr(TknGfxContext *pTknGfxContext, VkFormat vkFormat, VkImageUsageFlags vkImageUsageFlags, VkImageAspectFlags vkImageAspectFlags, uint32_t width, uint32_t height)
@@ -78,13 +74,13 @@ TknAttachment *tknCreateFixedAttachmentPtr(TknGfxContext *pTknGfxContext, VkForm
     };
 
     VkImage vkImage;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     VkImageView vkImageView;
-    tknCreateVkImage(pTknGfxContext, vkExtent3D, vkFormat, VK_IMAGE_TILING_OPTIMAL, vkImageUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vkImageAspectFlags, &vkImage, &vkDeviceMemory, &vkImageView);
+    tknCreateVkImage(pTknGfxContext, vkExtent3D, vkFormat, VK_IMAGE_TILING_OPTIMAL, vkImageUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vkImageAspectFlags, TKN_MEMORY_USAGE_ATTACHMENT, &vkImage, &tknMemoryAllocation, &vkImageView);
 
     TknFixedAttachment fixedAttachment = {
         .vkImage = vkImage,
-        .vkDeviceMemory = vkDeviceMemory,
+        .tknMemoryAllocation = tknMemoryAllocation,
         .vkImageView = vkImageView,
         .width = width,
         .height = height,
@@ -104,10 +100,11 @@ void tknDestroyFixedAttachmentPtr(TknGfxContext *pTknGfxContext, TknAttachment *
 {
     tknAssert(TKN_ATTACHMENT_TYPE_FIXED == pTknAttachment->tknAttachmentType, "TknAttachment type mismatch!");
     tknAssert(0 == pTknAttachment->tknRenderPassPtrHashSet.count, "Cannot destroy fixed attachment with render passes attached!");
+    tknWaitGfxFramesInFlight(pTknGfxContext);
     tknRemoveFromHashSet(&pTknGfxContext->tknFixedAttachmentPtrHashSet, &pTknAttachment);
     tknDestroyHashSet(pTknAttachment->tknRenderPassPtrHashSet);
     TknFixedAttachment fixedAttachment = pTknAttachment->tknAttachmentUnion.tknFixedAttachment;
-    tknDestroyVkImage(pTknGfxContext, fixedAttachment.vkImage, fixedAttachment.vkDeviceMemory, fixedAttachment.vkImageView);
+    tknDestroyVkImage(pTknGfxContext, fixedAttachment.vkImage, fixedAttachment.tknMemoryAllocation, fixedAttachment.vkImageView);
     tknDestroyHashSet(fixedAttachment.tknBindingPtrHashSet);
     tknFree(pTknAttachment);
 }
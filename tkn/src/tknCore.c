@@ -1,4 +1,22 @@
+#if !defined(_WIN32)
+// clock_gettime and pthreads are POSIX, not C99
+#define _POSIX_C_SOURCE 200112L
+#endif
 #include "tknCore.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(_WIN32)
+#include <windows.h>
+typedef HANDLE TknThread;
+typedef CRITICAL_SECTION TknMutex;
+typedef CONDITION_VARIABLE TknCondition;
+#else
+#include <pthread.h>
+typedef pthread_t TknThread;
+typedef pthread_mutex_t TknMutex;
+typedef pthread_cond_t TknCondition;
+#endif
 
 static void tknInternalError(const char *prefix, const char *format, va_list args)
 {
@@ -41,18 +59,176 @@ void tknAssert(bool condition, const char *format, ...)
     }
 }
 
-// static int allocTimes = 0;
+static uint64_t tknMallocCount = 0;
+static TKN_THREAD_LOCAL TknArena tknScratchArena;
 
 void *tknMalloc(size_t size)
 {
+    // Worker threads allocate too
+#if defined(_MSC_VER)
+    _InterlockedIncrement64((volatile __int64 *)&tknMallocCount);
+#else
+    __atomic_fetch_add(&tknMallocCount, 1, __ATOMIC_RELAXED);
+#endif
     return malloc(size);
 }
 
+uint64_t tknGetMallocCount(void)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)_InterlockedOr64((volatile __int64 *)&tknMallocCount, 0);
+#else
+    return __atomic_load_n(&tknMallocCount, __ATOMIC_RELAXED);
+#endif
+}
+
+double tknGetTimeMilliseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec timespec;
+    clock_gettime(CLOCK_MONOTONIC, &timespec);
+    return (double)timespec.tv_sec * 1000.0 + (double)timespec.tv_nsec / 1000000.0;
+#endif
+}
+
 void tknFree(void *ptr)
 {
     free(ptr);
 }
 
+TknArena tknCreateArena(size_t capacity)
+{
+    TknArena tknArena = {
+        .capacity = capacity,
+        .offset = 0,
+        .overflowSize = 0,
+        .data = tknMalloc(capacity),
+        .pOverflowBlock = NULL,
+    };
+    return tknArena;
+}
+
+static void tknFreeArenaOverflowBlocks(TknArena *pTknArena)
+{
+    void *pOverflowBlock = pTknArena->pOverflowBlock;
+    while (pOverflowBlock)
+    {
+        void *pNextOverflowBlock = *(void **)pOverflowBlock;
+        tknFree(pOverflowBlock);
+        pOverflowBlock = pNextOverflowBlock;
+    }
+    pTknArena->pOverflowBlock = NULL;
+}
+
+void tknDestroyArena(TknArena tknArena)
+{
+    tknFreeArenaOverflowBlocks(&tknArena);
+    tknFree(tknArena.data);
+    tknArena.data = NULL;
+    tknArena.capacity = 0;
+    tknArena.offset = 0;
+}
+
+void *tknAllocateFromArena(TknArena *pTknArena, size_t size)
+{
+    size_t alignedOffset = (pTknArena->offset + TKN_ARENA_ALIGNMENT - 1) & ~(size_t)(TKN_ARENA_ALIGNMENT - 1);
+    if (alignedOffset + size <= pTknArena->capacity)
+    {
+        pTknArena->offset = alignedOffset + size;
+        return pTknArena->data + alignedOffset;
+    }
+    else
+    {
+        // The block header stores the next overflow block, data starts after one alignment unit
+        char *pOverflowBlock = tknMalloc(TKN_ARENA_ALIGNMENT + size);
+        *(void **)pOverflowBlock = pTknArena->pOverflowBlock;
+        pTknArena->pOverflowBlock = pOverflowBlock;
+        pTknArena->overflowSize += TKN_ARENA_ALIGNMENT + size;
+        return pOverflowBlock + TKN_ARENA_ALIGNMENT;
+    }
+}
+
+void tknRewindArena(TknArena *pTknArena, size_t marker)
+{
+    tknAssert(marker <= pTknArena->offset, "Arena marker %zu is beyond offset %zu", marker, pTknArena->offset);
+    pTknArena->offset = marker;
+}
+
+void tknResetArena(TknArena *pTknArena)
+{
+    tknFreeArenaOverflowBlocks(pTknArena);
+    if (pTknArena->overflowSize > 0)
+    {
+        size_t requiredCapacity = pTknArena->capacity + pTknArena->overflowSize;
+        size_t newCapacity = pTknArena->capacity > 0 ? pTknArena->capacity : TKN_DEFAULT_ARENA_SIZE;
+        while (newCapacity < requiredCapacity)
+        {
+            newCapacity *= 2;
+        }
+        tknFree(pTknArena->data);
+        pTknArena->data = tknMalloc(newCapacity);
+        pTknArena->capacity = newCapacity;
+        pTknArena->overflowSize = 0;
+    }
+    else
+    {
+        // Skip
+    }
+    pTknArena->offset = 0;
+}
+
+static TknArena *tknGetScratchArena(void)
+{
+    if (NULL == tknScratchArena.data)
+    {
+        tknScratchArena = tknCreateArena(TKN_DEFAULT_ARENA_SIZE);
+    }
+    else
+    {
+        // Skip
+    }
+    return &tknScratchArena;
+}
+
+void *tknAllocateScratch(size_t size)
+{
+    return tknAllocateFromArena(tknGetScratchArena(), size);
+}
+
+size_t tknGetScratchMarker(void)
+{
+    return tknGetScratchArena()->offset;
+}
+
+void tknRewindScratch(size_t marker)
+{
+    tknRewindArena(tknGetScratchArena(), marker);
+}
+
+void tknResetScratchArena(void)
+{
+    tknResetArena(tknGetScratchArena());
+}
+
+void tknDestroyScratchArena(void)
+{
+    if (NULL != tknScratchArena.data)
+    {
+        tknDestroyArena(tknScratchArena);
+        tknScratchArena = (TknArena){0};
+    }
+    else
+    {
+        // Skip
+    }
+}
+
 TknDynamicArray tknCreateDynamicArray(size_t dataSize, uint32_t maxCount)
 {
     TknDynamicArray tknDynamicArray = {
@@ -166,24 +342,121 @@ bool tknContainsInDynamicArray(TknDynamicArray *pTknDynamicArray, void *pData)
     return false;
 }
 
+static uint64_t tknMixHash(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31;
+    return value;
+}
+
+static uint32_t tknHashData(const void *pData, size_t dataSize)
+{
+    const uint8_t *bytes = pData;
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ dataSize;
+    while (dataSize >= sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 32;
+        bytes += sizeof(word);
+        dataSize -= sizeof(word);
+    }
+    if (dataSize > 0)
+    {
+        uint64_t word = 0;
+        memcpy(&word, bytes, dataSize);
+        hash ^= word;
+    }
+    else
+    {
+        // Skip
+    }
+    hash = tknMixHash(hash);
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+static uint32_t tknGetHashSetMaxCount(uint32_t capacity)
+{
+    return capacity * 3 / 4;
+}
+
+static void tknPlaceHashSetSlot(TknHashSetSlot *slots, uint32_t capacity, TknHashSetSlot slot)
+{
+    uint32_t mask = capacity - 1;
+    uint32_t slotIndex = slot.hash & mask;
+    uint32_t distance = 0;
+    while (slots[slotIndex].index != 0)
+    {
+        uint32_t existingDistance = (slotIndex - (slots[slotIndex].hash & mask)) & mask;
+        if (existingDistance < distance)
+        {
+            // Robin hood: the richer slot gives way to the poorer one
+            TknHashSetSlot existingSlot = slots[slotIndex];
+            slots[slotIndex] = slot;
+            slot = existingSlot;
+            distance = existingDistance;
+        }
+        else
+        {
+            // Skip
+        }
+        slotIndex = (slotIndex + 1) & mask;
+        distance++;
+    }
+    slots[slotIndex] = slot;
+}
+
+static uint32_t tknFindHashSetSlotIndex(TknHashSet *pTknHashSet, const void *pData, uint32_t hash)
+{
+    uint32_t mask = pTknHashSet->capacity - 1;
+    uint32_t slotIndex = hash & mask;
+    uint32_t distance = 0;
+    while (pTknHashSet->slots[slotIndex].index != 0)
+    {
+        TknHashSetSlot slot = pTknHashSet->slots[slotIndex];
+        uint32_t existingDistance = (slotIndex - (slot.hash & mask)) & mask;
+        if (existingDistance < distance)
+        {
+            return UINT32_MAX;
+        }
+        else if (slot.hash == hash && memcmp((char *)pTknHashSet->datas + (slot.index - 1) * pTknHashSet->dataSize, pData, pTknHashSet->dataSize) == 0)
+        {
+            return slotIndex;
+        }
+        else
+        {
+            slotIndex = (slotIndex + 1) & mask;
+            distance++;
+        }
+    }
+    return UINT32_MAX;
+}
+
 TknHashSet tknCreateHashSet(size_t dataSize)
 {
     uint32_t capacity = 1u << TKN_DEFAULT_COLLECTION_POWER_OF_TWO;
     TknHashSet tknHashSet = {
+        .powerOfTwo = TKN_DEFAULT_COLLECTION_POWER_OF_TWO,
         .capacity = capacity,
         .count = 0,
         .dataSize = dataSize,
-        .nodePtrs = tknMalloc(sizeof(TknListNode *) * capacity),
+        .slots = tknMalloc(sizeof(TknHashSetSlot) * capacity),
+        .datas = tknMalloc(dataSize * tknGetHashSetMaxCount(capacity)),
     };
-    memset(tknHashSet.nodePtrs, 0, sizeof(TknListNode *) * capacity);
+    memset(tknHashSet.slots, 0, sizeof(TknHashSetSlot) * capacity);
     return tknHashSet;
 }
 
 void tknDestroyHashSet(TknHashSet tknHashSet)
 {
-    tknClearHashSet(&tknHashSet);
-    tknFree(tknHashSet.nodePtrs);
-    tknHashSet.nodePtrs = NULL;
+    tknFree(tknHashSet.slots);
+    tknFree(tknHashSet.datas);
+    tknHashSet.slots = NULL;
+    tknHashSet.datas = NULL;
     tknHashSet.capacity = 0;
     tknHashSet.count = 0;
     tknHashSet.dataSize = 0;
@@ -191,106 +464,978 @@ void tknDestroyHashSet(TknHashSet tknHashSet)
 
 bool tknAddToHashSet(TknHashSet *pTknHashSet, const void *pData)
 {
-    if (pTknHashSet->count >= pTknHashSet->capacity * 3 / 4)
+    uint32_t hash = tknHashData(pData, pTknHashSet->dataSize);
+    if (tknFindHashSetSlotIndex(pTknHashSet, pData, hash) != UINT32_MAX)
+    {
+        return false;
+    }
+    else
+    {
+        // Skip
+    }
+
+    if (pTknHashSet->count >= tknGetHashSetMaxCount(pTknHashSet->capacity))
     {
         uint32_t newCapacity = pTknHashSet->capacity * 2;
-        TknListNode **newNodePtrs = tknMalloc(sizeof(TknListNode *) * newCapacity);
-        memset(newNodePtrs, 0, sizeof(TknListNode *) * newCapacity);
-        for (uint32_t i = 0; i < pTknHashSet->capacity; i++)
+        TknHashSetSlot *newSlots = tknMalloc(sizeof(TknHashSetSlot) * newCapacity);
+        memset(newSlots, 0, sizeof(TknHashSetSlot) * newCapacity);
+        for (uint32_t slotIndex = 0; slotIndex < pTknHashSet->capacity; slotIndex++)
         {
-            TknListNode *node = pTknHashSet->nodePtrs[i];
-            while (node)
+            if (pTknHashSet->slots[slotIndex].index != 0)
+            {
+                tknPlaceHashSetSlot(newSlots, newCapacity, pTknHashSet->slots[slotIndex]);
+            }
+            else
             {
-                size_t newIndex = 0;
-                memcpy(&newIndex, node->data, sizeof(newIndex) < pTknHashSet->dataSize ? sizeof(newIndex) : pTknHashSet->dataSize);
-                newIndex &= (newCapacity - 1);
-
-                TknListNode *nextNode = node->pNextNode;
-                node->pNextNode = newNodePtrs[newIndex];
-                newNodePtrs[newIndex] = node;
-                node = nextNode;
+                // Skip
             }
         }
-        tknFree(pTknHashSet->nodePtrs);
-        pTknHashSet->nodePtrs = newNodePtrs;
+        void *newDatas = tknMalloc(pTknHashSet->dataSize * tknGetHashSetMaxCount(newCapacity));
+        memcpy(newDatas, pTknHashSet->datas, pTknHashSet->dataSize * pTknHashSet->count);
+        tknFree(pTknHashSet->slots);
+        tknFree(pTknHashSet->datas);
+        pTknHashSet->slots = newSlots;
+        pTknHashSet->datas = newDatas;
         pTknHashSet->capacity = newCapacity;
+        pTknHashSet->powerOfTwo++;
     }
-
-    size_t index = 0;
-    memcpy(&index, pData, sizeof(index) < pTknHashSet->dataSize ? sizeof(index) : pTknHashSet->dataSize);
-    index &= (pTknHashSet->capacity - 1);
-
-    TknListNode *node = pTknHashSet->nodePtrs[index];
-    while (node)
+    else
     {
-        if (memcmp(node->data, pData, pTknHashSet->dataSize) == 0)
-            return false;
-        node = node->pNextNode;
+        // Skip
     }
-    TknListNode *newNode = tknMalloc(sizeof(TknListNode));
-    newNode->data = tknMalloc(pTknHashSet->dataSize);
-    memcpy(newNode->data, pData, pTknHashSet->dataSize);
-    newNode->pNextNode = pTknHashSet->nodePtrs[index];
-    pTknHashSet->nodePtrs[index] = newNode;
+
+    memcpy((char *)pTknHashSet->datas + pTknHashSet->count * pTknHashSet->dataSize, pData, pTknHashSet->dataSize);
     pTknHashSet->count++;
+    TknHashSetSlot slot = {
+        .hash = hash,
+        .index = pTknHashSet->count,
+    };
+    tknPlaceHashSetSlot(pTknHashSet->slots, pTknHashSet->capacity, slot);
     return true;
 }
 
 bool tknContainsInHashSet(TknHashSet *pTknHashSet, const void *pData)
 {
-    size_t index = 0;
-    memcpy(&index, pData, sizeof(index) < pTknHashSet->dataSize ? sizeof(index) : pTknHashSet->dataSize);
-    index &= (pTknHashSet->capacity - 1);
+    uint32_t hash = tknHashData(pData, pTknHashSet->dataSize);
+    return tknFindHashSetSlotIndex(pTknHashSet, pData, hash) != UINT32_MAX;
+}
 
-    TknListNode *node = pTknHashSet->nodePtrs[index];
-    while (node)
+// Dense index of the data for tknGetFromHashSet, UINT32_MAX if absent. It changes when an earlier removal swaps the last key in
+uint32_t tknGetIndexInHashSet(TknHashSet *pTknHashSet, const void *pData)
+{
+    uint32_t hash = tknHashData(pData, pTknHashSet->dataSize);
+    uint32_t slotIndex = tknFindHashSetSlotIndex(pTknHashSet, pData, hash);
+    return UINT32_MAX == slotIndex ? UINT32_MAX : pTknHashSet->slots[slotIndex].index - 1;
+}
+
+void tknRemoveFromHashSet(TknHashSet *pTknHashSet, const void *pData)
+{
+    uint32_t hash = tknHashData(pData, pTknHashSet->dataSize);
+    uint32_t slotIndex = tknFindHashSetSlotIndex(pTknHashSet, pData, hash);
+    if (UINT32_MAX == slotIndex)
     {
-        if (memcmp(node->data, pData, pTknHashSet->dataSize) == 0)
-            return true;
-        node = node->pNextNode;
+        return;
     }
-    return false;
+    else
+    {
+        // Skip
+    }
+    uint32_t mask = pTknHashSet->capacity - 1;
+    uint32_t index = pTknHashSet->slots[slotIndex].index - 1;
+
+    // Backward shift deletion keeps probe sequences intact without tombstones
+    uint32_t nextSlotIndex = (slotIndex + 1) & mask;
+    while (pTknHashSet->slots[nextSlotIndex].index != 0 && ((nextSlotIndex - (pTknHashSet->slots[nextSlotIndex].hash & mask)) & mask) != 0)
+    {
+        pTknHashSet->slots[slotIndex] = pTknHashSet->slots[nextSlotIndex];
+        slotIndex = nextSlotIndex;
+        nextSlotIndex = (nextSlotIndex + 1) & mask;
+    }
+    pTknHashSet->slots[slotIndex] = (TknHashSetSlot){0};
+
+    // Move the last data into the hole to keep datas dense
+    uint32_t lastIndex = pTknHashSet->count - 1;
+    if (index != lastIndex)
+    {
+        void *pLastData = (char *)pTknHashSet->datas + lastIndex * pTknHashSet->dataSize;
+        uint32_t lastSlotIndex = tknHashData(pLastData, pTknHashSet->dataSize) & mask;
+        while (pTknHashSet->slots[lastSlotIndex].index != lastIndex + 1)
+        {
+            lastSlotIndex = (lastSlotIndex + 1) & mask;
+        }
+        pTknHashSet->slots[lastSlotIndex].index = index + 1;
+        memcpy((char *)pTknHashSet->datas + index * pTknHashSet->dataSize, pLastData, pTknHashSet->dataSize);
+    }
+    else
+    {
+        // Skip
+    }
+    pTknHashSet->count--;
 }
 
-void tknRemoveFromHashSet(TknHashSet *pTknHashSet, const void *pData)
+void tknClearHashSet(TknHashSet *pTknHashSet)
 {
-    size_t index = 0;
-    memcpy(&index, pData, sizeof(index) < pTknHashSet->dataSize ? sizeof(index) : pTknHashSet->dataSize);
-    index &= (pTknHashSet->capacity - 1);
+    memset(pTknHashSet->slots, 0, sizeof(TknHashSetSlot) * pTknHashSet->capacity);
+    pTknHashSet->count = 0;
+}
+
+void *tknGetFromHashSet(TknHashSet *pTknHashSet, uint32_t index)
+{
+    tknAssert(index < pTknHashSet->count, "Index %u is out of bounds for count %u\n", index, pTknHashSet->count);
+    return (char *)pTknHashSet->datas + index * pTknHashSet->dataSize;
+}
+
+static uint32_t tknFindLastSetBit(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (uint32_t)index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+static uint32_t tknFindFirstSetBit(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+static void tknMapTlsfSize(uint64_t size, uint32_t *pFirstLevel, uint32_t *pSecondLevel)
+{
+    if (size < TKN_TLSF_SECOND_LEVEL_COUNT)
+    {
+        *pFirstLevel = 0;
+        *pSecondLevel = (uint32_t)size;
+    }
+    else
+    {
+        uint32_t lastBit = tknFindLastSetBit(size);
+        *pFirstLevel = lastBit - TKN_TLSF_SECOND_LEVEL_BITS + 1;
+        *pSecondLevel = (uint32_t)(size >> (lastBit - TKN_TLSF_SECOND_LEVEL_BITS)) - TKN_TLSF_SECOND_LEVEL_COUNT;
+    }
+}
+
+static TknTlsfNode *tknGetTlsfNode(TknTlsf *pTknTlsf, uint32_t nodeIndex)
+{
+    return (TknTlsfNode *)pTknTlsf->tknTlsfNodeDynamicArray.array + nodeIndex;
+}
 
-    TknListNode *node = pTknHashSet->nodePtrs[index];
-    TknListNode *prevNode = NULL;
-    while (node)
+static uint32_t tknCreateTlsfNode(TknTlsf *pTknTlsf, uint64_t offset, uint64_t size)
+{
+    TknTlsfNode tknTlsfNode = {
+        .offset = offset,
+        .size = size,
+        .prevPhysicalIndex = TKN_TLSF_NULL_NODE,
+        .nextPhysicalIndex = TKN_TLSF_NULL_NODE,
+        .prevFreeIndex = TKN_TLSF_NULL_NODE,
+        .nextFreeIndex = TKN_TLSF_NULL_NODE,
+        .isFree = false,
+    };
+    uint32_t nodeIndex;
+    if (pTknTlsf->unusedNodeIndex != TKN_TLSF_NULL_NODE)
     {
-        if (memcmp(node->data, pData, pTknHashSet->dataSize) == 0)
+        nodeIndex = pTknTlsf->unusedNodeIndex;
+        pTknTlsf->unusedNodeIndex = tknGetTlsfNode(pTknTlsf, nodeIndex)->nextFreeIndex;
+        *tknGetTlsfNode(pTknTlsf, nodeIndex) = tknTlsfNode;
+    }
+    else
+    {
+        nodeIndex = pTknTlsf->tknTlsfNodeDynamicArray.count;
+        tknAddToDynamicArray(&pTknTlsf->tknTlsfNodeDynamicArray, &tknTlsfNode);
+    }
+    return nodeIndex;
+}
+
+static void tknReleaseTlsfNode(TknTlsf *pTknTlsf, uint32_t nodeIndex)
+{
+    TknTlsfNode *pTknTlsfNode = tknGetTlsfNode(pTknTlsf, nodeIndex);
+    pTknTlsfNode->isFree = false;
+    pTknTlsfNode->nextFreeIndex = pTknTlsf->unusedNodeIndex;
+    pTknTlsf->unusedNodeIndex = nodeIndex;
+}
+
+static void tknInsertTlsfFreeNode(TknTlsf *pTknTlsf, uint32_t nodeIndex)
+{
+    TknTlsfNode *pTknTlsfNode = tknGetTlsfNode(pTknTlsf, nodeIndex);
+    uint32_t firstLevel, secondLevel;
+    tknMapTlsfSize(pTknTlsfNode->size, &firstLevel, &secondLevel);
+    uint32_t headIndex = pTknTlsf->freeHeadIndices[firstLevel][secondLevel];
+    pTknTlsfNode->isFree = true;
+    pTknTlsfNode->prevFreeIndex = TKN_TLSF_NULL_NODE;
+    pTknTlsfNode->nextFreeIndex = headIndex;
+    if (headIndex != TKN_TLSF_NULL_NODE)
+    {
+        tknGetTlsfNode(pTknTlsf, headIndex)->prevFreeIndex = nodeIndex;
+    }
+    else
+    {
+        // First node of this size class
+    }
+    pTknTlsf->freeHeadIndices[firstLevel][secondLevel] = nodeIndex;
+    pTknTlsf->firstLevelBitmap |= 1ull << firstLevel;
+    pTknTlsf->secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+static void tknRemoveTlsfFreeNode(TknTlsf *pTknTlsf, uint32_t nodeIndex)
+{
+    TknTlsfNode *pTknTlsfNode = tknGetTlsfNode(pTknTlsf, nodeIndex);
+    uint32_t firstLevel, secondLevel;
+    tknMapTlsfSize(pTknTlsfNode->size, &firstLevel, &secondLevel);
+    if (pTknTlsfNode->prevFreeIndex != TKN_TLSF_NULL_NODE)
+    {
+        tknGetTlsfNode(pTknTlsf, pTknTlsfNode->prevFreeIndex)->nextFreeIndex = pTknTlsfNode->nextFreeIndex;
+    }
+    else
+    {
+        pTknTlsf->freeHeadIndices[firstLevel][secondLevel] = pTknTlsfNode->nextFreeIndex;
+        if (TKN_TLSF_NULL_NODE == pTknTlsfNode->nextFreeIndex)
         {
-            if (prevNode)
-                prevNode->pNextNode = node->pNextNode;
+            pTknTlsf->secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (0 == pTknTlsf->secondLevelBitmaps[firstLevel])
+            {
+                pTknTlsf->firstLevelBitmap &= ~(1ull << firstLevel);
+            }
             else
-                pTknHashSet->nodePtrs[index] = node->pNextNode;
-            tknFree(node->data);
-            tknFree(node);
-            pTknHashSet->count--;
-            return;
+            {
+                // Other size classes of this level still have nodes
+            }
+        }
+        else
+        {
+            // Size class still has nodes
         }
-        prevNode = node;
-        node = node->pNextNode;
     }
+    if (pTknTlsfNode->nextFreeIndex != TKN_TLSF_NULL_NODE)
+    {
+        tknGetTlsfNode(pTknTlsf, pTknTlsfNode->nextFreeIndex)->prevFreeIndex = pTknTlsfNode->prevFreeIndex;
+    }
+    else
+    {
+        // Last node of this size class
+    }
+    pTknTlsfNode->isFree = false;
+    pTknTlsfNode->prevFreeIndex = TKN_TLSF_NULL_NODE;
+    pTknTlsfNode->nextFreeIndex = TKN_TLSF_NULL_NODE;
 }
 
-void tknClearHashSet(TknHashSet *pTknHashSet)
+static uint32_t tknFindTlsfFreeNode(TknTlsf *pTknTlsf, uint64_t size)
 {
-    for (size_t i = 0; i < pTknHashSet->capacity; i++)
+    // Round up to the next size class so that any node found is large enough
+    if (size >= TKN_TLSF_SECOND_LEVEL_COUNT)
+    {
+        size += (1ull << (tknFindLastSetBit(size) - TKN_TLSF_SECOND_LEVEL_BITS)) - 1;
+    }
+    else
+    {
+        // Small size classes are exact
+    }
+    uint32_t firstLevel, secondLevel;
+    tknMapTlsfSize(size, &firstLevel, &secondLevel);
+    if (firstLevel >= TKN_TLSF_FIRST_LEVEL_COUNT)
+    {
+        return TKN_TLSF_NULL_NODE;
+    }
+    else
     {
-        TknListNode *node = pTknHashSet->nodePtrs[i];
-        while (node)
+        // Size class exists
+    }
+    uint32_t secondLevelBitmap = pTknTlsf->secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (0 == secondLevelBitmap)
+    {
+        uint64_t firstLevelBitmap = pTknTlsf->firstLevelBitmap & (~0ull << (firstLevel + 1));
+        if (0 == firstLevelBitmap)
+        {
+            return TKN_TLSF_NULL_NODE;
+        }
+        else
         {
-            TknListNode *nextNode = node->pNextNode;
-            tknFree(node->data);
-            tknFree(node);
-            node = nextNode;
+            firstLevel = tknFindFirstSetBit(firstLevelBitmap);
+            secondLevelBitmap = pTknTlsf->secondLevelBitmaps[firstLevel];
         }
-        pTknHashSet->nodePtrs[i] = NULL;
     }
-    pTknHashSet->count = 0;
+    else
+    {
+        // A large enough node is in this level
+    }
+    secondLevel = tknFindFirstSetBit(secondLevelBitmap);
+    return pTknTlsf->freeHeadIndices[firstLevel][secondLevel];
+}
+
+TknTlsf tknCreateTlsf(uint64_t size)
+{
+    tknAssert(size > 0 && tknFindLastSetBit(size) < TKN_TLSF_FIRST_LEVEL_COUNT + TKN_TLSF_SECOND_LEVEL_BITS - 1, "TLSF size %llu is out of range", (unsigned long long)size);
+    TknTlsf tknTlsf = {
+        .size = size,
+        .freeSize = size,
+        .allocationCount = 0,
+        .firstLevelBitmap = 0,
+        .secondLevelBitmaps = {0},
+        .tknTlsfNodeDynamicArray = tknCreateDynamicArray(sizeof(TknTlsfNode), TKN_DEFAULT_COLLECTION_SIZE),
+        .unusedNodeIndex = TKN_TLSF_NULL_NODE,
+    };
+    // TKN_TLSF_NULL_NODE has every bit set
+    memset(tknTlsf.freeHeadIndices, 0xFF, sizeof(tknTlsf.freeHeadIndices));
+    uint32_t nodeIndex = tknCreateTlsfNode(&tknTlsf, 0, size);
+    tknInsertTlsfFreeNode(&tknTlsf, nodeIndex);
+    return tknTlsf;
+}
+
+void tknDestroyTlsf(TknTlsf tknTlsf)
+{
+    tknDestroyDynamicArray(tknTlsf.tknTlsfNodeDynamicArray);
+}
+
+uint32_t tknAllocateFromTlsf(TknTlsf *pTknTlsf, uint64_t size, uint64_t alignment, uint64_t *pOffset)
+{
+    tknAssert(size > 0, "TLSF allocation size must be greater than 0");
+    tknAssert(alignment > 0 && 0 == (alignment & (alignment - 1)), "TLSF alignment %llu is not a power of two", (unsigned long long)alignment);
+    // Searching for the worst case padding keeps the search O(1), unused padding goes back to the free lists
+    uint32_t nodeIndex = tknFindTlsfFreeNode(pTknTlsf, size + alignment - 1);
+    if (TKN_TLSF_NULL_NODE == nodeIndex)
+    {
+        return TKN_TLSF_NULL_NODE;
+    }
+    else
+    {
+        tknRemoveTlsfFreeNode(pTknTlsf, nodeIndex);
+    }
+
+    TknTlsfNode *pTknTlsfNode = tknGetTlsfNode(pTknTlsf, nodeIndex);
+    uint64_t alignedOffset = (pTknTlsfNode->offset + alignment - 1) & ~(alignment - 1);
+    uint64_t paddingSize = alignedOffset - pTknTlsfNode->offset;
+    if (paddingSize > 0)
+    {
+        // The previous physical node is never free because free neighbours are always merged
+        uint32_t paddingIndex = tknCreateTlsfNode(pTknTlsf, pTknTlsfNode->offset, paddingSize);
+        pTknTlsfNode = tknGetTlsfNode(pTknTlsf, nodeIndex);
+        TknTlsfNode *pPaddingNode = tknGetTlsfNode(pTknTlsf, paddingIndex);
+        pPaddingNode->prevPhysicalIndex = pTknTlsfNode->prevPhysicalIndex;
+        pPaddingNode->nextPhysicalIndex = nodeIndex;
+        if (pTknTlsfNode->prevPhysicalIndex != TKN_TLSF_NULL_NODE)
+        {
+            tknGetTlsfNode(pTknTlsf, pTknTlsfNode->prevPhysicalIndex)->nextPhysicalIndex = paddingIndex;
+        }
+        else
+        {
+            // Padding becomes the first node
+        }
+        pTknTlsfNode->prevPhysicalIndex = paddingIndex;
+        pTknTlsfNode->offset = alignedOffset;
+        pTknTlsfNode->size -= paddingSize;
+        tknInsertTlsfFreeNode(pTknTlsf, paddingIndex);
+    }
+    else
+    {
+        // Already aligned
+    }
+
+    uint64_t remainderSize = pTknTlsfNode->size - size;
+    if (remainderSize > 0)
+    {
+        uint32_t remainderIndex = tknCreateTlsfNode(pTknTlsf, alignedOffset + size, remainderSize);
+        pTknTlsfNode = tknGetTlsfNode(pTknTlsf, nodeIndex);
+        TknTlsfNode *pRemainderNode = tknGetTlsfNode(pTknTlsf, remainderIndex);
+        pRemainderNode->prevPhysicalIndex = nodeIndex;
+        pRemainderNode->nextPhysicalIndex = pTknTlsfNode->nextPhysicalIndex;
+        if (pTknTlsfNode->nextPhysicalIndex != TKN_TLSF_NULL_NODE)
+        {
+            tknGetTlsfNode(pTknTlsf, pTknTlsfNode->nextPhysicalIndex)->prevPhysicalIndex = remainderIndex;
+        }
+        else
+        {
+            // Remainder becomes the last node
+        }
+        pTknTlsfNode->nextPhysicalIndex = remainderIndex;
+        pTknTlsfNode->size = size;
+        tknInsertTlsfFreeNode(pTknTlsf, remainderIndex);
+    }
+    else
+    {
+        // Exact fit
+    }
+
+    pTknTlsf->freeSize -= size;
+    pTknTlsf->allocationCount++;
+    *pOffset = alignedOffset;
+    return nodeIndex;
+}
+
+void tknFreeToTlsf(TknTlsf *pTknTlsf, uint32_t nodeIndex)
+{
+    TknTlsfNode *pTknTlsfNode = tknGetTlsfNode(pTknTlsf, nodeIndex);
+    tknAssert(!pTknTlsfNode->isFree, "TLSF node %u is already free", nodeIndex);
+    pTknTlsf->freeSize += pTknTlsfNode->size;
+    pTknTlsf->allocationCount--;
+
+    uint32_t prevIndex = pTknTlsfNode->prevPhysicalIndex;
+    if (prevIndex != TKN_TLSF_NULL_NODE && tknGetTlsfNode(pTknTlsf, prevIndex)->isFree)
+    {
+        TknTlsfNode *pPrevNode = tknGetTlsfNode(pTknTlsf, prevIndex);
+        tknRemoveTlsfFreeNode(pTknTlsf, prevIndex);
+        pTknTlsfNode->offset = pPrevNode->offset;
+        pTknTlsfNode->size += pPrevNode->size;
+        pTknTlsfNode->prevPhysicalIndex = pPrevNode->prevPhysicalIndex;
+        if (pTknTlsfNode->prevPhysicalIndex != TKN_TLSF_NULL_NODE)
+        {
+            tknGetTlsfNode(pTknTlsf, pTknTlsfNode->prevPhysicalIndex)->nextPhysicalIndex = nodeIndex;
+        }
+        else
+        {
+            // Merged node is the first node
+        }
+        tknReleaseTlsfNode(pTknTlsf, prevIndex);
+    }
+    else
+    {
+        // Nothing to merge before
+    }
+
+    uint32_t nextIndex = pTknTlsfNode->nextPhysicalIndex;
+    if (nextIndex != TKN_TLSF_NULL_NODE && tknGetTlsfNode(pTknTlsf, nextIndex)->isFree)
+    {
+        TknTlsfNode *pNextNode = tknGetTlsfNode(pTknTlsf, nextIndex);
+        tknRemoveTlsfFreeNode(pTknTlsf, nextIndex);
+        pTknTlsfNode->size += pNextNode->size;
+        pTknTlsfNode->nextPhysicalIndex = pNextNode->nextPhysicalIndex;
+        if (pTknTlsfNode->nextPhysicalIndex != TKN_TLSF_NULL_NODE)
+        {
+            tknGetTlsfNode(pTknTlsf, pTknTlsfNode->nextPhysicalIndex)->prevPhysicalIndex = nodeIndex;
+        }
+        else
+        {
+            // Merged node is the last node
+        }
+        tknReleaseTlsfNode(pTknTlsf, nextIndex);
+    }
+    else
+    {
+        // Nothing to merge after
+    }
+    tknInsertTlsfFreeNode(pTknTlsf, nodeIndex);
+}
+
+uint64_t tknGetTlsfLargestFreeSize(TknTlsf *pTknTlsf)
+{
+    if (0 == pTknTlsf->firstLevelBitmap)
+    {
+        return 0;
+    }
+    else
+    {
+        // The largest node is in the highest non empty size class
+        uint32_t firstLevel = tknFindLastSetBit(pTknTlsf->firstLevelBitmap);
+        uint32_t secondLevel = tknFindLastSetBit(pTknTlsf->secondLevelBitmaps[firstLevel]);
+        uint64_t largestFreeSize = 0;
+        for (uint32_t nodeIndex = pTknTlsf->freeHeadIndices[firstLevel][secondLevel]; nodeIndex != TKN_TLSF_NULL_NODE; nodeIndex = tknGetTlsfNode(pTknTlsf, nodeIndex)->nextFreeIndex)
+        {
+            uint64_t size = tknGetTlsfNode(pTknTlsf, nodeIndex)->size;
+            largestFreeSize = size > largestFreeSize ? size : largestFreeSize;
+        }
+        return largestFreeSize;
+    }
+}
+
+// Least significant digit first, one byte per pass. Passes where every key has the same byte are skipped,
+// so keys that only differ in a few bytes cost a few passes.
+void tknRadixSort(TknSortItem *tknSortItems, TknSortItem *scratchSortItems, uint32_t count)
+{
+    TknSortItem *source = tknSortItems;
+    TknSortItem *destination = scratchSortItems;
+    for (uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        uint32_t offsets[256] = {0};
+        for (uint32_t itemIndex = 0; itemIndex < count; itemIndex++)
+        {
+            offsets[(source[itemIndex].key >> shift) & 0xFF]++;
+        }
+        uint32_t firstDigit = count > 0 ? (uint32_t)((source[0].key >> shift) & 0xFF) : 0;
+        if (offsets[firstDigit] == count)
+        {
+            // Every key has the same digit, the order would not change
+        }
+        else
+        {
+            uint32_t offset = 0;
+            for (uint32_t digit = 0; digit < 256; digit++)
+            {
+                uint32_t digitCount = offsets[digit];
+                offsets[digit] = offset;
+                offset += digitCount;
+            }
+            for (uint32_t itemIndex = 0; itemIndex < count; itemIndex++)
+            {
+                TknSortItem tknSortItem = source[itemIndex];
+                destination[offsets[(tknSortItem.key >> shift) & 0xFF]++] = tknSortItem;
+            }
+            TknSortItem *swap = source;
+            source = destination;
+            destination = swap;
+        }
+    }
+    if (source != tknSortItems)
+    {
+        memcpy(tknSortItems, source, sizeof(TknSortItem) * count);
+    }
+    else
+    {
+        // Sorted in place
+    }
+}
+
+struct TknWorkerPool
+{
+    uint32_t workerThreadCount;
+    TknThread *threads;
+    TknMutex mutex;
+    TknCondition workCondition;
+    TknCondition doneCondition;
+    // Everything below is guarded by the mutex
+    bool isStopping;
+    uint64_t generation;
+    TknWorkerTask tknWorkerTask;
+    void *pContext;
+    uint32_t taskCount;
+    uint32_t nextTaskIndex;
+    uint32_t busyWorkerThreadCount;
+};
+
+typedef struct
+{
+    TknWorkerPool *pTknWorkerPool;
+    uint32_t workerIndex;
+} TknWorkerThreadArgument;
+
+static void tknLockMutex(TknMutex *pMutex)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(pMutex);
+#else
+    pthread_mutex_lock(pMutex);
+#endif
+}
+
+static void tknUnlockMutex(TknMutex *pMutex)
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(pMutex);
+#else
+    pthread_mutex_unlock(pMutex);
+#endif
+}
+
+static void tknWaitCondition(TknCondition *pCondition, TknMutex *pMutex)
+{
+#if defined(_WIN32)
+    SleepConditionVariableCS(pCondition, pMutex, INFINITE);
+#else
+    pthread_cond_wait(pCondition, pMutex);
+#endif
+}
+
+static void tknBroadcastCondition(TknCondition *pCondition)
+{
+#if defined(_WIN32)
+    WakeAllConditionVariable(pCondition);
+#else
+    pthread_cond_broadcast(pCondition);
+#endif
+}
+
+// Claims and runs tasks until none are left, the mutex is held on entry and on return
+static void tknDrainWorkerPoolTasks(TknWorkerPool *pTknWorkerPool, uint32_t workerIndex)
+{
+    while (pTknWorkerPool->nextTaskIndex < pTknWorkerPool->taskCount)
+    {
+        uint32_t taskIndex = pTknWorkerPool->nextTaskIndex;
+        pTknWorkerPool->nextTaskIndex++;
+        TknWorkerTask tknWorkerTask = pTknWorkerPool->tknWorkerTask;
+        void *pContext = pTknWorkerPool->pContext;
+        tknUnlockMutex(&pTknWorkerPool->mutex);
+        tknWorkerTask(pContext, taskIndex, workerIndex);
+        tknLockMutex(&pTknWorkerPool->mutex);
+    }
+}
+
+static void tknRunWorkerThread(TknWorkerThreadArgument *pTknWorkerThreadArgument)
+{
+    TknWorkerPool *pTknWorkerPool = pTknWorkerThreadArgument->pTknWorkerPool;
+    uint32_t workerIndex = pTknWorkerThreadArgument->workerIndex;
+    tknFree(pTknWorkerThreadArgument);
+
+    uint64_t seenGeneration = 0;
+    tknLockMutex(&pTknWorkerPool->mutex);
+    while (!pTknWorkerPool->isStopping)
+    {
+        if (seenGeneration == pTknWorkerPool->generation)
+        {
+            tknWaitCondition(&pTknWorkerPool->workCondition, &pTknWorkerPool->mutex);
+        }
+        else
+        {
+            seenGeneration = pTknWorkerPool->generation;
+            pTknWorkerPool->busyWorkerThreadCount++;
+            tknDrainWorkerPoolTasks(pTknWorkerPool, workerIndex);
+            pTknWorkerPool->busyWorkerThreadCount--;
+            if (0 == pTknWorkerPool->busyWorkerThreadCount)
+            {
+                tknBroadcastCondition(&pTknWorkerPool->doneCondition);
+            }
+            else
+            {
+                // The last worker out wakes the caller
+            }
+        }
+    }
+    tknUnlockMutex(&pTknWorkerPool->mutex);
+    tknDestroyScratchArena();
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI tknWorkerThreadMain(LPVOID pArgument)
+{
+    tknRunWorkerThread(pArgument);
+    return 0;
+}
+#else
+static void *tknWorkerThreadMain(void *pArgument)
+{
+    tknRunWorkerThread(pArgument);
+    return NULL;
+}
+#endif
+
+// workerThreadCount threads are spawned, the thread calling tknRunOnWorkerPool works as worker 0
+TknWorkerPool *tknCreateWorkerPoolPtr(uint32_t workerThreadCount)
+{
+    TknWorkerPool *pTknWorkerPool = tknMalloc(sizeof(TknWorkerPool));
+    *pTknWorkerPool = (TknWorkerPool){
+        .workerThreadCount = workerThreadCount,
+        .threads = workerThreadCount > 0 ? tknMalloc(sizeof(TknThread) * workerThreadCount) : NULL,
+        .isStopping = false,
+        .generation = 0,
+        .tknWorkerTask = NULL,
+        .pContext = NULL,
+        .taskCount = 0,
+        .nextTaskIndex = 0,
+        .busyWorkerThreadCount = 0,
+    };
+#if defined(_WIN32)
+    InitializeCriticalSection(&pTknWorkerPool->mutex);
+    InitializeConditionVariable(&pTknWorkerPool->workCondition);
+    InitializeConditionVariable(&pTknWorkerPool->doneCondition);
+#else
+    pthread_mutex_init(&pTknWorkerPool->mutex, NULL);
+    pthread_cond_init(&pTknWorkerPool->workCondition, NULL);
+    pthread_cond_init(&pTknWorkerPool->doneCondition, NULL);
+#endif
+    for (uint32_t threadIndex = 0; threadIndex < workerThreadCount; threadIndex++)
+    {
+        TknWorkerThreadArgument *pTknWorkerThreadArgument = tknMalloc(sizeof(TknWorkerThreadArgument));
+        *pTknWorkerThreadArgument = (TknWorkerThreadArgument){
+            .pTknWorkerPool = pTknWorkerPool,
+            .workerIndex = threadIndex + 1,
+        };
+#if defined(_WIN32)
+        pTknWorkerPool->threads[threadIndex] = CreateThread(NULL, 0, tknWorkerThreadMain, pTknWorkerThreadArgument, 0, NULL);
+        tknAssert(NULL != pTknWorkerPool->threads[threadIndex], "Failed to create worker thread %u", threadIndex);
+#else
+        int result = pthread_create(&pTknWorkerPool->threads[threadIndex], NULL, tknWorkerThreadMain, pTknWorkerThreadArgument);
+        tknAssert(0 == result, "Failed to create worker thread %u, error: %d", threadIndex, result);
+#endif
+    }
+    return pTknWorkerPool;
+}
+
+void tknDestroyWorkerPoolPtr(TknWorkerPool *pTknWorkerPool)
+{
+    tknLockMutex(&pTknWorkerPool->mutex);
+    pTknWorkerPool->isStopping = true;
+    tknBroadcastCondition(&pTknWorkerPool->workCondition);
+    tknUnlockMutex(&pTknWorkerPool->mutex);
+    for (uint32_t threadIndex = 0; threadIndex < pTknWorkerPool->workerThreadCount; threadIndex++)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(pTknWorkerPool->threads[threadIndex], INFINITE);
+        CloseHandle(pTknWorkerPool->threads[threadIndex]);
+#else
+        pthread_join(pTknWorkerPool->threads[threadIndex], NULL);
+#endif
+    }
+#if defined(_WIN32)
+    DeleteCriticalSection(&pTknWorkerPool->mutex);
+#else
+    pthread_cond_destroy(&pTknWorkerPool->doneCondition);
+    pthread_cond_destroy(&pTknWorkerPool->workCondition);
+    pthread_mutex_destroy(&pTknWorkerPool->mutex);
+#endif
+    tknFree(pTknWorkerPool->threads);
+    tknFree(pTknWorkerPool);
+}
+
+// Worker 0 plus one per thread, the range of workerIndex passed to tasks
+uint32_t tknGetWorkerCount(TknWorkerPool *pTknWorkerPool)
+{
+    return pTknWorkerPool->workerThreadCount + 1;
+}
+
+// Runs tknWorkerTask for every task index and returns once all of them are done, not reentrant
+void tknRunOnWorkerPool(TknWorkerPool *pTknWorkerPool, uint32_t taskCount, TknWorkerTask tknWorkerTask, void *pContext)
+{
+    tknLockMutex(&pTknWorkerPool->mutex);
+    tknAssert(pTknWorkerPool->nextTaskIndex >= pTknWorkerPool->taskCount, "Worker pool is already running tasks");
+    pTknWorkerPool->tknWorkerTask = tknWorkerTask;
+    pTknWorkerPool->pContext = pContext;
+    pTknWorkerPool->taskCount = taskCount;
+    pTknWorkerPool->nextTaskIndex = 0;
+    if (taskCount > 1)
+    {
+        pTknWorkerPool->generation++;
+        tknBroadcastCondition(&pTknWorkerPool->workCondition);
+    }
+    else
+    {
+        // A single task runs on the caller, waking the threads would only cost a context switch
+    }
+    tknDrainWorkerPoolTasks(pTknWorkerPool, 0);
+    while (pTknWorkerPool->busyWorkerThreadCount > 0)
+    {
+        tknWaitCondition(&pTknWorkerPool->doneCondition, &pTknWorkerPool->mutex);
+    }
+    tknUnlockMutex(&pTknWorkerPool->mutex);
+}
+
+// Filled by its owning thread only, the exporter reads up to the published writeCount
+typedef struct TknProfileThread
+{
+    uint32_t threadId;
+    uint64_t writeCount;
+    // A NULL name marks the end of the innermost open scope
+    const char *eventNames[TKN_PROFILE_EVENT_CAPACITY];
+    double eventMilliseconds[TKN_PROFILE_EVENT_CAPACITY];
+    struct TknProfileThread *pNextTknProfileThread;
+} TknProfileThread;
+
+static bool tknIsProfilerEnabled = false;
+static uint32_t tknProfileThreadCount = 0;
+static TknProfileThread *pTknProfileThreadHead = NULL;
+static TKN_THREAD_LOCAL TknProfileThread *pTknLocalProfileThread = NULL;
+
+static TknProfileThread *tknGetLocalProfileThread(void)
+{
+    if (NULL == pTknLocalProfileThread)
+    {
+        TknProfileThread *pTknProfileThread = tknMalloc(sizeof(TknProfileThread));
+        pTknProfileThread->writeCount = 0;
+#if defined(_MSC_VER)
+        pTknProfileThread->threadId = (uint32_t)_InterlockedIncrement((volatile long *)&tknProfileThreadCount) - 1;
+        // Threads register once, so a retry loop on the list head is cheaper than a lock nobody else needs
+        do
+        {
+            pTknProfileThread->pNextTknProfileThread = pTknProfileThreadHead;
+        } while (_InterlockedCompareExchangePointer((void *volatile *)&pTknProfileThreadHead, pTknProfileThread, pTknProfileThread->pNextTknProfileThread) != pTknProfileThread->pNextTknProfileThread);
+#else
+        pTknProfileThread->threadId = __atomic_fetch_add(&tknProfileThreadCount, 1, __ATOMIC_RELAXED);
+        // Threads register once, so a retry loop on the list head is cheaper than a lock nobody else needs
+        pTknProfileThread->pNextTknProfileThread = __atomic_load_n(&pTknProfileThreadHead, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&pTknProfileThreadHead, &pTknProfileThread->pNextTknProfileThread, pTknProfileThread, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+            // pNextTknProfileThread was reloaded, retry
+        }
+#endif
+        pTknLocalProfileThread = pTknProfileThread;
+    }
+    else
+    {
+        // Skip
+    }
+    return pTknLocalProfileThread;
+}
+
+static void tknWriteProfileEvent(const char *name)
+{
+#if defined(_MSC_VER)
+    bool isEnabled = tknIsProfilerEnabled;
+#else
+    bool isEnabled = __atomic_load_n(&tknIsProfilerEnabled, __ATOMIC_RELAXED);
+#endif
+    if (isEnabled)
+    {
+        TknProfileThread *pTknProfileThread = tknGetLocalProfileThread();
+        uint64_t writeCount = pTknProfileThread->writeCount;
+        uint32_t eventIndex = (uint32_t)(writeCount & (TKN_PROFILE_EVENT_CAPACITY - 1));
+        pTknProfileThread->eventNames[eventIndex] = name;
+        pTknProfileThread->eventMilliseconds[eventIndex] = tknGetTimeMilliseconds();
+        // Publishes the event, the exporter never reads past writeCount
+#if defined(_MSC_VER)
+        _InterlockedExchange64((volatile __int64 *)&pTknProfileThread->writeCount, (__int64)(writeCount + 1));
+#else
+        __atomic_store_n(&pTknProfileThread->writeCount, writeCount + 1, __ATOMIC_RELEASE);
+#endif
+    }
+    else
+    {
+        // Skip
+    }
+}
+
+static uint64_t tknLoadProfileWriteCount(TknProfileThread *pTknProfileThread)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)_InterlockedOr64((volatile __int64 *)&pTknProfileThread->writeCount, 0);
+#else
+    return __atomic_load_n(&pTknProfileThread->writeCount, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void tknBeginProfileScope(const char *name)
+{
+    tknWriteProfileEvent(name);
+}
+
+void tknEndProfileScope(void)
+{
+    tknWriteProfileEvent(NULL);
+}
+
+// Scopes open while switching are recorded as far as they were, the trace viewer leaves them unfinished
+void tknSetProfilerEnabled(bool isEnabled)
+{
+#if defined(_MSC_VER)
+    _InterlockedExchange8((volatile char *)&tknIsProfilerEnabled, (char)isEnabled);
+#else
+    __atomic_store_n(&tknIsProfilerEnabled, isEnabled, __ATOMIC_RELAXED);
+#endif
+}
+
+static void tknWriteJsonString(FILE *file, const char *string)
+{
+    fputc('"', file);
+    for (const char *character = string; *character != '\0'; character++)
+    {
+        if ('"' == *character || '\\' == *character)
+        {
+            fputc('\\', file);
+            fputc(*character, file);
+        }
+        else if ((unsigned char)*character < 0x20)
+        {
+            fprintf(file, "\\u%04x", (unsigned char)*character);
+        }
+        else
+        {
+            fputc(*character, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// Writes the recorded events as Chrome trace JSON, viewable in chrome://tracing or Perfetto.
+// Threads keep recording meanwhile, events they overwrite during the copy are dropped.
+bool tknWriteProfileTrace(const char *filePath)
+{
+    FILE *file = fopen(filePath, "w");
+    if (NULL == file)
+    {
+        tknWarning("Failed to open %s for writing, the profile trace is not saved", filePath);
+        return false;
+    }
+    else
+    {
+        // File opened successfully
+    }
+    const char **eventNames = tknMalloc(sizeof(const char *) * TKN_PROFILE_EVENT_CAPACITY);
+    double *eventMilliseconds = tknMalloc(sizeof(double) * TKN_PROFILE_EVENT_CAPACITY);
+    uint32_t writtenEventCount = 0;
+    fprintf(file, "{\"traceEvents\":[");
+#if defined(_MSC_VER)
+    TknProfileThread *pTknProfileThread = (TknProfileThread *)_InterlockedCompareExchangePointer((void *volatile *)&pTknProfileThreadHead, NULL, NULL);
+#else
+    TknProfileThread *pTknProfileThread = __atomic_load_n(&pTknProfileThreadHead, __ATOMIC_ACQUIRE);
+#endif
+    while (pTknProfileThread != NULL)
+    {
+        uint64_t endCount = tknLoadProfileWriteCount(pTknProfileThread);
+        uint64_t beginCount = endCount > TKN_PROFILE_EVENT_CAPACITY ? endCount - TKN_PROFILE_EVENT_CAPACITY : 0;
+        for (uint64_t eventCount = beginCount; eventCount < endCount; eventCount++)
+        {
+            uint32_t eventIndex = (uint32_t)(eventCount & (TKN_PROFILE_EVENT_CAPACITY - 1));
+            eventNames[eventIndex] = pTknProfileThread->eventNames[eventIndex];
+            eventMilliseconds[eventIndex] = pTknProfileThread->eventMilliseconds[eventIndex];
+        }
+        // Whatever the owner wrote after the first load may have landed on the oldest copied slots
+        uint64_t latestCount = tknLoadProfileWriteCount(pTknProfileThread);
+        if (latestCount > TKN_PROFILE_EVENT_CAPACITY && latestCount - TKN_PROFILE_EVENT_CAPACITY > beginCount)
+        {
+            beginCount = TKN_CLAMP(latestCount - TKN_PROFILE_EVENT_CAPACITY, beginCount, endCount);
+        }
+        else
+        {
+            // Nothing copied was overwritten
+        }
+
+        // Ends whose begins were overwritten are dropped so every remaining pair still matches
+        uint32_t depth = 0;
+        for (uint64_t eventCount = beginCount; eventCount < endCount; eventCount++)
+        {
+            uint32_t eventIndex = (uint32_t)(eventCount & (TKN_PROFILE_EVENT_CAPACITY - 1));
+            const char *name = eventNames[eventIndex];
+            if (NULL == name && 0 == depth)
+            {
+                // Unmatched end
+            }
+            else
+            {
+                fprintf(file, "%s\n{\"ph\":\"%s\",\"pid\":0,\"tid\":%u,\"ts\":%.3f", writtenEventCount > 0 ? "," : "", NULL == name ? "E" : "B", pTknProfileThread->threadId, eventMilliseconds[eventIndex] * 1000.0);
+                if (NULL != name)
+                {
+                    fprintf(file, ",\"name\":");
+                    tknWriteJsonString(file, name);
+                    depth++;
+                }
+                else
+                {
+                    depth--;
+                }
+                fputc('}', file);
+                writtenEventCount++;
+            }
+        }
+        pTknProfileThread = pTknProfileThread->pNextTknProfileThread;
+    }
+    fprintf(file, "\n]}\n");
+    tknFree(eventMilliseconds);
+    tknFree(eventNames);
+    if (0 == fclose(file))
+    {
+        printf("Saved %u profile events to %s\n", writtenEventCount, filePath);
+        return true;
+    }
+    else
+    {
+        tknWarning("Failed to write the profile trace to %s", filePath);
+        return false;
+    }
+}
+
+// Every other thread that recorded events must have exited, their buffers are freed with the rest
+void tknDestroyProfiler(void)
+{
+    tknSetProfilerEnabled(false);
+    TknProfileThread *pTknProfileThread = pTknProfileThreadHead;
+    while (pTknProfileThread != NULL)
+    {
+        TknProfileThread *pNextTknProfileThread = pTknProfileThread->pNextTknProfileThread;
+        tknFree(pTknProfileThread);
+        pTknProfileThread = pNextTknProfileThread;
+    }
+    pTknProfileThreadHead = NULL;
+    tknProfileThreadCount = 0;
+    pTknLocalProfileThread = NULL;
 }
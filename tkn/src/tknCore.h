@@ -15,6 +15,20 @@
 #define TKN_DEFAULT_COLLECTION_SIZE 8
 #define TKN_DEFAULT_COLLECTION_POWER_OF_TWO 7
 #define TKN_MIN_COLLECTION_SIZE 1
+#define TKN_ARENA_ALIGNMENT 16
+#define TKN_DEFAULT_ARENA_SIZE (64 * 1024)
+#define TKN_TLSF_SECOND_LEVEL_BITS 4
+#define TKN_TLSF_SECOND_LEVEL_COUNT (1u << TKN_TLSF_SECOND_LEVEL_BITS)
+#define TKN_TLSF_FIRST_LEVEL_COUNT 48
+#define TKN_TLSF_NULL_NODE UINT32_MAX
+// Events kept per thread, older ones are overwritten. Must be a power of two
+#define TKN_PROFILE_EVENT_CAPACITY (1u << 16)
+
+#if defined(_MSC_VER)
+#define TKN_THREAD_LOCAL __declspec(thread)
+#else
+#define TKN_THREAD_LOCAL __thread
+#endif
 
 typedef struct
 {
@@ -24,27 +38,89 @@ typedef struct
     void *array;
 } TknDynamicArray;
 
-typedef struct TknListNode
+typedef struct
 {
-    void *data;
-    struct TknListNode *pNextNode;
-} TknListNode;
+    uint32_t hash;
+    uint32_t index; // Dense index + 1, 0 means the slot is empty
+} TknHashSetSlot;
 
+// Open addressing hash set with robin hood probing and backward shift deletion.
+// Keys are stored densely in datas[0, count), iterate them with tknGetFromHashSet.
+// Removing swaps the last key into the hole, so iterate backwards when removing while iterating.
 typedef struct
 {
     uint32_t powerOfTwo;
     uint32_t capacity;
     uint32_t count;
     size_t dataSize;
-    TknListNode **nodePtrs;
+    TknHashSetSlot *slots;
+    void *datas;
 } TknHashSet;
 
+// Linear allocator for transient memory. Allocations that do not fit fall back to the heap
+// and the arena grows to cover them on the next reset, so steady state never hits the heap.
+typedef struct
+{
+    size_t capacity;
+    size_t offset;
+    size_t overflowSize;
+    char *data;
+    void *pOverflowBlock;
+} TknArena;
+
+typedef struct
+{
+    uint64_t offset;
+    uint64_t size;
+    uint32_t prevPhysicalIndex;
+    uint32_t nextPhysicalIndex;
+    // Links the free list of the node's size class, or the unused node list once the node is released
+    uint32_t prevFreeIndex;
+    uint32_t nextFreeIndex;
+    bool isFree;
+} TknTlsfNode;
+
+// Two level segregated fit allocator over the range [0, size). Book keeping lives outside the range,
+// so it can manage memory the CPU cannot touch. Allocate and free are O(1), neighbours merge on free.
+typedef struct
+{
+    uint64_t size;
+    uint64_t freeSize;
+    uint32_t allocationCount;
+    uint64_t firstLevelBitmap;
+    uint32_t secondLevelBitmaps[TKN_TLSF_FIRST_LEVEL_COUNT];
+    uint32_t freeHeadIndices[TKN_TLSF_FIRST_LEVEL_COUNT][TKN_TLSF_SECOND_LEVEL_COUNT];
+    TknDynamicArray tknTlsfNodeDynamicArray;
+    uint32_t unusedNodeIndex;
+} TknTlsf;
+
+// Key and payload index, sorting the pairs lets the payload stay where it is
+typedef struct
+{
+    uint64_t key;
+    uint32_t index;
+} TknSortItem;
+
+// Fixed set of threads that fan a batch of independent tasks out, tasks must only touch their own data
+typedef struct TknWorkerPool TknWorkerPool;
+typedef void (*TknWorkerTask)(void *pContext, uint32_t taskIndex, uint32_t workerIndex);
+
+TknArena tknCreateArena(size_t capacity);
+void tknDestroyArena(TknArena tknArena);
+void *tknAllocateFromArena(TknArena *pTknArena, size_t size);
+void tknRewindArena(TknArena *pTknArena, size_t marker);
+void tknResetArena(TknArena *pTknArena);
+void tknResetScratchArena(void);
+void tknDestroyScratchArena(void);
+
 TknHashSet tknCreateHashSet(size_t dataSize);
 void tknDestroyHashSet(TknHashSet tknHashSet);
 bool tknAddToHashSet(TknHashSet *pTknHashSet, const void *pData);
 bool tknContainsInHashSet(TknHashSet *pTknHashSet, const void *pData);
+uint32_t tknGetIndexInHashSet(TknHashSet *pTknHashSet, const void *pData);
 void tknRemoveFromHashSet(TknHashSet *pTknHashSet, const void *pData);
 void tknClearHashSet(TknHashSet *pTknHashSet);
+void *tknGetFromHashSet(TknHashSet *pTknHashSet, uint32_t index);
 
 TknDynamicArray tknCreateDynamicArray(size_t dataSize, uint32_t maxCount);
 void tknDestroyDynamicArray(TknDynamicArray tknDynamicArray);
@@ -55,3 +131,17 @@ void tknRemoveAtIndexFromDynamicArray(TknDynamicArray *pTknDynamicArray, uint32_
 void tknClearDynamicArray(TknDynamicArray *pTknDynamicArray);
 void *tknGetFromDynamicArray(TknDynamicArray *pTknDynamicArray, uint32_t index);
 bool tknContainsInDynamicArray(TknDynamicArray *pTknDynamicArray, void *pData);
+
+TknTlsf tknCreateTlsf(uint64_t size);
+void tknDestroyTlsf(TknTlsf tknTlsf);
+uint32_t tknAllocateFromTlsf(TknTlsf *pTknTlsf, uint64_t size, uint64_t alignment, uint64_t *pOffset);
+void tknFreeToTlsf(TknTlsf *pTknTlsf, uint32_t nodeIndex);
+uint64_t tknGetTlsfLargestFreeSize(TknTlsf *pTknTlsf);
+
+// Stable ascending sort by key, scratchSortItems must hold count items and the result ends up in tknSortItems
+void tknRadixSort(TknSortItem *tknSortItems, TknSortItem *scratchSortItems, uint32_t count);
+
+TknWorkerPool *tknCreateWorkerPoolPtr(uint32_t workerThreadCount);
+void tknDestroyWorkerPoolPtr(TknWorkerPool *pTknWorkerPool);
+uint32_t tknGetWorkerCount(TknWorkerPool *pTknWorkerPool);
+void tknRunOnWorkerPool(TknWorkerPool *pTknWorkerPool, uint32_t taskCount, TknWorkerTask tknWorkerTask, void *pContext);
@@ -0,0 +1,115 @@
+#include "tknGfxCore.h"
+
+static void tknChainDescriptorPool(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet, uint32_t minSetCount)
+{
+    // Double the capacity of the layout so a growing material count creates a logarithmic number of pools
+    uint32_t setCount = pTknDescriptorSet->tknDescriptorSetCapacity < TKN_MAX_DESCRIPTOR_POOL_SET_COUNT ? pTknDescriptorSet->tknDescriptorSetCapacity : TKN_MAX_DESCRIPTOR_POOL_SET_COUNT;
+    setCount = setCount > minSetCount ? setCount : minSetCount;
+
+    size_t scratchMarker = tknGetScratchMarker();
+    uint32_t poolSizeCount = pTknDescriptorSet->vkDescriptorPoolSizeDynamicArray.count;
+    VkDescriptorPoolSize *vkDescriptorPoolSizes = tknAllocateScratch(sizeof(VkDescriptorPoolSize) * (poolSizeCount > 0 ? poolSizeCount : 1));
+    for (uint32_t poolSizeIndex = 0; poolSizeIndex < poolSizeCount; poolSizeIndex++)
+    {
+        vkDescriptorPoolSizes[poolSizeIndex] = *(VkDescriptorPoolSize *)tknGetFromDynamicArray(&pTknDescriptorSet->vkDescriptorPoolSizeDynamicArray, poolSizeIndex);
+        vkDescriptorPoolSizes[poolSizeIndex].descriptorCount *= setCount;
+    }
+    // Sets are recycled through the free list, never freed to the pool, so the pool needs no free bit and cannot fragment
+    VkDescriptorPoolCreateInfo vkDescriptorPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .poolSizeCount = poolSizeCount,
+        .pPoolSizes = vkDescriptorPoolSizes,
+        .maxSets = setCount,
+    };
+    VkDescriptorPool vkDescriptorPool = VK_NULL_HANDLE;
+    tknAssertVkResult(vkCreateDescriptorPool(pTknGfxContext->vkDevice, &vkDescriptorPoolCreateInfo, NULL, &vkDescriptorPool));
+    tknRewindScratch(scratchMarker);
+
+    tknAddToDynamicArray(&pTknDescriptorSet->vkDescriptorPoolDynamicArray, &vkDescriptorPool);
+    pTknDescriptorSet->tknDescriptorSetCapacity += setCount;
+    pTknDescriptorSet->tknPoolRemainingSetCount = setCount;
+    pTknGfxContext->tknDescriptorPoolStats.poolCount++;
+    pTknGfxContext->tknDescriptorPoolStats.setCapacity += setCount;
+}
+
+void tknAllocateVkDescriptorSets(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet, uint32_t vkDescriptorSetCount, VkDescriptorSet *vkDescriptorSets)
+{
+    TknDescriptorPoolStats *pTknDescriptorPoolStats = &pTknGfxContext->tknDescriptorPoolStats;
+    uint32_t recycledCount = 0;
+    TknDynamicArray *pFreeVkDescriptorSetDynamicArray = &pTknDescriptorSet->freeVkDescriptorSetDynamicArray;
+    while (recycledCount < vkDescriptorSetCount && pFreeVkDescriptorSetDynamicArray->count > 0)
+    {
+        uint32_t lastIndex = pFreeVkDescriptorSetDynamicArray->count - 1;
+        vkDescriptorSets[recycledCount] = *(VkDescriptorSet *)tknGetFromDynamicArray(pFreeVkDescriptorSetDynamicArray, lastIndex);
+        tknRemoveAtIndexFromDynamicArray(pFreeVkDescriptorSetDynamicArray, lastIndex);
+        recycledCount++;
+    }
+    pTknDescriptorPoolStats->freeSetCount -= recycledCount;
+
+    uint32_t newCount = vkDescriptorSetCount - recycledCount;
+    if (newCount > 0)
+    {
+        if (pTknDescriptorSet->tknPoolRemainingSetCount < newCount)
+        {
+            // What is left in the last pool is abandoned, pools are sized in whole materials so this only happens after a partial recycle
+            tknChainDescriptorPool(pTknGfxContext, pTknDescriptorSet, newCount);
+        }
+        else
+        {
+            // The last pool still has room
+        }
+        size_t scratchMarker = tknGetScratchMarker();
+        VkDescriptorSetLayout *vkDescriptorSetLayouts = tknAllocateScratch(sizeof(VkDescriptorSetLayout) * newCount);
+        for (uint32_t setIndex = 0; setIndex < newCount; setIndex++)
+        {
+            vkDescriptorSetLayouts[setIndex] = pTknDescriptorSet->vkDescriptorSetLayout;
+        }
+        VkDescriptorPool vkDescriptorPool = *(VkDescriptorPool *)tknGetFromDynamicArray(&pTknDescriptorSet->vkDescriptorPoolDynamicArray, pTknDescriptorSet->vkDescriptorPoolDynamicArray.count - 1);
+        VkDescriptorSetAllocateInfo vkDescriptorSetAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool = vkDescriptorPool,
+            .descriptorSetCount = newCount,
+            .pSetLayouts = vkDescriptorSetLayouts,
+        };
+        tknAssertVkResult(vkAllocateDescriptorSets(pTknGfxContext->vkDevice, &vkDescriptorSetAllocateInfo, vkDescriptorSets + recycledCount));
+        tknRewindScratch(scratchMarker);
+        pTknDescriptorSet->tknPoolRemainingSetCount -= newCount;
+    }
+    else
+    {
+        // Every set came from the free list
+    }
+    pTknDescriptorPoolStats->usedSetCount += vkDescriptorSetCount;
+}
+
+// The frames that read the set must be done, it keeps its stale descriptors until the next material rewrites them
+void tknRecycleVkDescriptorSet(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet, VkDescriptorSet vkDescriptorSet)
+{
+    tknAddToDynamicArray(&pTknDescriptorSet->freeVkDescriptorSetDynamicArray, &vkDescriptorSet);
+    pTknGfxContext->tknDescriptorPoolStats.retiredSetCount--;
+    pTknGfxContext->tknDescriptorPoolStats.freeSetCount++;
+}
+
+// Every material of the layout must be destroyed, frames in flight may still read their sets so the pools are retired
+void tknCleanupDescriptorPools(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet)
+{
+    TknDescriptorPoolStats *pTknDescriptorPoolStats = &pTknGfxContext->tknDescriptorPoolStats;
+    tknForgetRetiredVkDescriptorSets(pTknGfxContext, pTknDescriptorSet);
+    for (uint32_t poolIndex = 0; poolIndex < pTknDescriptorSet->vkDescriptorPoolDynamicArray.count; poolIndex++)
+    {
+        VkDescriptorPool vkDescriptorPool = *(VkDescriptorPool *)tknGetFromDynamicArray(&pTknDescriptorSet->vkDescriptorPoolDynamicArray, poolIndex);
+        tknRetireVkDescriptorPool(pTknGfxContext, vkDescriptorPool);
+    }
+    pTknDescriptorPoolStats->poolCount -= pTknDescriptorSet->vkDescriptorPoolDynamicArray.count;
+    pTknDescriptorPoolStats->setCapacity -= pTknDescriptorSet->tknDescriptorSetCapacity;
+    pTknDescriptorPoolStats->freeSetCount -= pTknDescriptorSet->freeVkDescriptorSetDynamicArray.count;
+    tknDestroyDynamicArray(pTknDescriptorSet->vkDescriptorPoolDynamicArray);
+    tknDestroyDynamicArray(pTknDescriptorSet->freeVkDescriptorSetDynamicArray);
+    pTknDescriptorSet->tknDescriptorSetCapacity = 0;
+    pTknDescriptorSet->tknPoolRemainingSetCount = 0;
+}
+
+TknDescriptorPoolStats tknGetDescriptorPoolStats(TknGfxContext *pTknGfxContext)
+{
+    return pTknGfxContext->tknDescriptorPoolStats;
+}
@@ -33,6 +33,16 @@ TknDrawCall *tknCreateDrawCallPtr(TknGfxContext *pTknGfxContext, TknPipeline *pT
         .pTknMaterial = pTknMaterial,
         .pTknInstance = pTknInstance,
         .pTknMesh = pTknMesh,
+        // Every dynamic binding starts at its first element
+        .dynamicOffsetCount = pTknMaterial->pTknDescriptorSet->tknDynamicOffsetCount,
+        .dynamicOffsets = {0},
+        .pushConstants = {0},
+        .pCommandTknDynamicBuffer = NULL,
+        .firstIndirectCommand = 0,
+        .maxIndirectDrawCount = 0,
+        .pCountTknDynamicBuffer = NULL,
+        .pCommandTknStorageBuffer = NULL,
+        .pCountTknStorageBuffer = NULL,
     };
     if (pTknMaterial != NULL)
         tknAddToHashSet(&pTknMaterial->tknDrawCallPtrHashSet, &pTknDrawCall);
@@ -61,6 +71,145 @@ void tknDestroyDrawCallPtr(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawC
         tknRemoveFromHashSet(&pTknDrawCall->pTknInstance->tknDrawCallPtrHashSet, &pTknDrawCall);
     if (pTknDrawCall->pTknMesh != NULL)
         tknRemoveFromHashSet(&pTknDrawCall->pTknMesh->tknDrawCallPtrHashSet, &pTknDrawCall);
+    tknSetDrawCallIndirect(pTknGfxContext, pTknDrawCall, NULL, 0, 0, NULL);
     *pTknDrawCall = (TknDrawCall){0};
     tknFree(pTknDrawCall);
-}
\ No newline at end of file
+}
+
+void tknSetDrawCallDynamicOffsets(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, uint32_t dynamicOffsetCount, const uint32_t *dynamicOffsets)
+{
+    tknAssert(dynamicOffsetCount == pTknDrawCall->dynamicOffsetCount, "TknDrawCall material has %u dynamic bindings, got %u offsets", pTknDrawCall->dynamicOffsetCount, dynamicOffsetCount);
+    for (uint32_t offsetIndex = 0; offsetIndex < dynamicOffsetCount; offsetIndex++)
+    {
+        pTknDrawCall->dynamicOffsets[offsetIndex] = dynamicOffsets[offsetIndex];
+    }
+}
+
+void tknSetDrawCallPushConstants(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, uint32_t offset, uint32_t size, const void *data)
+{
+    uint32_t pushConstantSize = pTknDrawCall->pTknPipeline->pushConstantSize;
+    // Compared without adding, so a huge offset cannot wrap back into range
+    tknAssert(offset <= pushConstantSize && size <= pushConstantSize - offset, "Push constant range [%u, %u) exceeds the pipeline's %u bytes", offset, offset + size, pushConstantSize);
+    memcpy(pTknDrawCall->pushConstants + offset, data, size);
+}
+
+// Drops the draw call from whichever command and count buffers it reads, both setters start from here
+static void tknDetachDrawCallIndirect(TknDrawCall *pTknDrawCall)
+{
+    if (pTknDrawCall->pCommandTknDynamicBuffer != NULL)
+    {
+        tknRemoveFromHashSet(&pTknDrawCall->pCommandTknDynamicBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+    }
+    else
+    {
+        // Skip
+    }
+    // Command and count buffers are never the same, the dynamic ones differ in element size and the storage ones are asserted apart
+    if (pTknDrawCall->pCountTknDynamicBuffer != NULL)
+    {
+        tknRemoveFromHashSet(&pTknDrawCall->pCountTknDynamicBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+    }
+    else
+    {
+        // Skip
+    }
+    if (pTknDrawCall->pCommandTknStorageBuffer != NULL)
+    {
+        tknRemoveFromHashSet(&pTknDrawCall->pCommandTknStorageBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+    }
+    else
+    {
+        // Skip
+    }
+    if (pTknDrawCall->pCountTknStorageBuffer != NULL)
+    {
+        tknRemoveFromHashSet(&pTknDrawCall->pCountTknStorageBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+    }
+    else
+    {
+        // Skip
+    }
+    pTknDrawCall->pCommandTknDynamicBuffer = NULL;
+    pTknDrawCall->pCountTknDynamicBuffer = NULL;
+    pTknDrawCall->pCommandTknStorageBuffer = NULL;
+    pTknDrawCall->pCountTknStorageBuffer = NULL;
+    pTknDrawCall->firstIndirectCommand = 0;
+    pTknDrawCall->maxIndirectDrawCount = 0;
+}
+
+static VkDeviceSize tknGetIndirectCommandSize(TknDrawCall *pTknDrawCall)
+{
+    bool isIndexed = pTknDrawCall->pTknMesh != NULL && pTknDrawCall->pTknMesh->tknIndexCount > 0;
+    return isIndexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+}
+
+void tknSetDrawCallIndirect(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, TknDynamicBuffer *pCommandTknDynamicBuffer, uint32_t firstCommand, uint32_t maxDrawCount, TknDynamicBuffer *pCountTknDynamicBuffer)
+{
+    tknDetachDrawCallIndirect(pTknDrawCall);
+    if (pCommandTknDynamicBuffer != NULL)
+    {
+        VkDeviceSize commandSize = tknGetIndirectCommandSize(pTknDrawCall);
+        tknAssert(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == pCommandTknDynamicBuffer->vkDescriptorType, "Indirect commands must live in a storage dynamic buffer");
+        tknAssert(commandSize == pCommandTknDynamicBuffer->elementSize, "Indirect command elements are %llu bytes, expected %llu", (unsigned long long)pCommandTknDynamicBuffer->elementSize, (unsigned long long)commandSize);
+        // Compared without adding, so a huge firstCommand cannot wrap back into range
+        tknAssert(maxDrawCount > 0 && firstCommand <= pCommandTknDynamicBuffer->elementCount && maxDrawCount <= pCommandTknDynamicBuffer->elementCount - firstCommand, "Indirect commands [%u, %llu) exceed %u elements", firstCommand, (unsigned long long)firstCommand + maxDrawCount, pCommandTknDynamicBuffer->elementCount);
+        tknAssert(!pTknGfxContext->isMultiDrawIndirectEnabled || maxDrawCount <= pTknGfxContext->vkPhysicalDeviceProperties.limits.maxDrawIndirectCount, "Indirect draw count %u exceeds the device limit", maxDrawCount);
+        tknAddToHashSet(&pCommandTknDynamicBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+        if (pCountTknDynamicBuffer != NULL)
+        {
+            tknAssert(pTknGfxContext->isDrawIndirectCountEnabled, "Indirect draw count buffers need VK_KHR_draw_indirect_count, check tknIsDrawIndirectCountSupported first");
+            tknAssert(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == pCountTknDynamicBuffer->vkDescriptorType && sizeof(uint32_t) == pCountTknDynamicBuffer->elementSize, "Indirect draw count must be a storage dynamic buffer of one uint32_t");
+            tknAddToHashSet(&pCountTknDynamicBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+        }
+        else
+        {
+            // Every command up to maxDrawCount is drawn
+        }
+    }
+    else
+    {
+        tknAssert(NULL == pCountTknDynamicBuffer, "Indirect draw count without indirect commands");
+    }
+    pTknDrawCall->pCommandTknDynamicBuffer = pCommandTknDynamicBuffer;
+    pTknDrawCall->firstIndirectCommand = firstCommand;
+    pTknDrawCall->maxIndirectDrawCount = maxDrawCount;
+    pTknDrawCall->pCountTknDynamicBuffer = pCountTknDynamicBuffer;
+}
+
+void tknSetDrawCallIndirectStorage(TknGfxContext *pTknGfxContext, TknDrawCall *pTknDrawCall, TknStorageBuffer *pCommandTknStorageBuffer, uint32_t firstCommand, uint32_t maxDrawCount, TknStorageBuffer *pCountTknStorageBuffer)
+{
+    tknDetachDrawCallIndirect(pTknDrawCall);
+    if (pCommandTknStorageBuffer != NULL)
+    {
+        VkDeviceSize commandSize = tknGetIndirectCommandSize(pTknDrawCall);
+        // Commands are tightly packed, both command sizes are multiples of 4 as the stride requires
+        VkDeviceSize commandCount = pCommandTknStorageBuffer->size / commandSize;
+        tknAssert(maxDrawCount > 0 && firstCommand <= commandCount && maxDrawCount <= commandCount - firstCommand, "Indirect commands [%u, %llu) exceed %llu commands", firstCommand, (unsigned long long)firstCommand + maxDrawCount, (unsigned long long)commandCount);
+        tknAssert(!pTknGfxContext->isMultiDrawIndirectEnabled || maxDrawCount <= pTknGfxContext->vkPhysicalDeviceProperties.limits.maxDrawIndirectCount, "Indirect draw count %u exceeds the device limit", maxDrawCount);
+        tknAddToHashSet(&pCommandTknStorageBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+        if (pCountTknStorageBuffer != NULL)
+        {
+            tknAssert(pTknGfxContext->isDrawIndirectCountEnabled, "Indirect draw count buffers need VK_KHR_draw_indirect_count, check tknIsDrawIndirectCountSupported first");
+            tknAssert(pCountTknStorageBuffer != pCommandTknStorageBuffer, "Indirect draw count must be a separate storage buffer");
+            tknAssert(pCountTknStorageBuffer->size >= sizeof(uint32_t), "Indirect draw count buffer needs one uint32_t");
+            tknAddToHashSet(&pCountTknStorageBuffer->tknDrawCallPtrHashSet, &pTknDrawCall);
+        }
+        else
+        {
+            // Every command up to maxDrawCount is drawn
+        }
+    }
+    else
+    {
+        tknAssert(NULL == pCountTknStorageBuffer, "Indirect draw count without indirect commands");
+    }
+    pTknDrawCall->pCommandTknStorageBuffer = pCommandTknStorageBuffer;
+    pTknDrawCall->firstIndirectCommand = firstCommand;
+    pTknDrawCall->maxIndirectDrawCount = maxDrawCount;
+    pTknDrawCall->pCountTknStorageBuffer = pCountTknStorageBuffer;
+}
+
+bool tknIsDrawIndirectCountSupported(TknGfxContext *pTknGfxContext)
+{
+    return pTknGfxContext->isDrawIndirectCountEnabled;
+}
@@ -0,0 +1,217 @@
+#include "tknGfxCore.h"
+
+#define TKN_DRAW_SORT_KEY_PIPELINE_BITS 12
+#define TKN_DRAW_SORT_KEY_MATERIAL_BITS 14
+#define TKN_DRAW_SORT_KEY_MESH_BITS 14
+#define TKN_DRAW_SORT_KEY_DEPTH_BITS 16
+
+// Objects have no ids, their addresses are folded instead. A collision only costs batching, never correctness
+static uint64_t tknFoldPointer(const void *pointer, uint32_t bits)
+{
+    uint64_t value = (uint64_t)(uintptr_t)pointer;
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    return value >> (64 - bits);
+}
+
+uint64_t tknGetDrawCallSortKey(TknDrawCall *pTknDrawCall, uint8_t layer, float depth)
+{
+    uint64_t maxDepth = (1ull << TKN_DRAW_SORT_KEY_DEPTH_BITS) - 1;
+    uint64_t quantizedDepth = (uint64_t)(TKN_CLAMP(depth, 0.0f, 1.0f) * (float)maxDepth);
+    uint64_t sortKey = (uint64_t)layer << TKN_DRAW_SORT_KEY_LAYER_SHIFT;
+    uint32_t shift = TKN_DRAW_SORT_KEY_LAYER_SHIFT - TKN_DRAW_SORT_KEY_PIPELINE_BITS;
+    sortKey |= tknFoldPointer(pTknDrawCall->pTknPipeline, TKN_DRAW_SORT_KEY_PIPELINE_BITS) << shift;
+    shift -= TKN_DRAW_SORT_KEY_MATERIAL_BITS;
+    sortKey |= tknFoldPointer(pTknDrawCall->pTknMaterial, TKN_DRAW_SORT_KEY_MATERIAL_BITS) << shift;
+    shift -= TKN_DRAW_SORT_KEY_MESH_BITS;
+    sortKey |= tknFoldPointer(pTknDrawCall->pTknMesh, TKN_DRAW_SORT_KEY_MESH_BITS) << shift;
+    sortKey |= quantizedDepth;
+    return sortKey;
+}
+
+TknDrawQueue *tknCreateDrawQueuePtr(TknGfxContext *pTknGfxContext)
+{
+    TknDrawQueue *pTknDrawQueue = tknMalloc(sizeof(TknDrawQueue));
+    *pTknDrawQueue = (TknDrawQueue){
+        .tknDrawQueueEntryDynamicArray = tknCreateDynamicArray(sizeof(TknDrawQueueEntry), TKN_DEFAULT_COLLECTION_SIZE),
+    };
+    return pTknDrawQueue;
+}
+
+void tknDestroyDrawQueuePtr(TknGfxContext *pTknGfxContext, TknDrawQueue *pTknDrawQueue)
+{
+    tknDestroyDynamicArray(pTknDrawQueue->tknDrawQueueEntryDynamicArray);
+    tknFree(pTknDrawQueue);
+}
+
+// The draw call must live until the queue is recorded
+void tknPushToDrawQueue(TknDrawQueue *pTknDrawQueue, TknDrawQueueEntry tknDrawQueueEntry)
+{
+    tknAddToDynamicArray(&pTknDrawQueue->tknDrawQueueEntryDynamicArray, &tknDrawQueueEntry);
+}
+
+// Dynamic stencil state outlives draws but not command buffers, so only the first entry of a range that sets it has to
+static void tknRecordDrawQueueRange(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknDrawQueue *pTknDrawQueue, const TknSortItem *tknSortItems, uint32_t beginIndex, uint32_t endIndex)
+{
+    TknDynamicArray *pTknDrawQueueEntryDynamicArray = &pTknDrawQueue->tknDrawQueueEntryDynamicArray;
+    bool isStencilKnown = false;
+    uint8_t stencilCompareMask = 0;
+    uint8_t stencilWriteMask = 0;
+    uint8_t stencilReference = 0;
+    VkStencilFaceFlags faceMask = VK_STENCIL_FACE_FRONT_AND_BACK;
+    for (uint32_t sortIndex = beginIndex; sortIndex < endIndex; sortIndex++)
+    {
+        TknDrawQueueEntry *pTknDrawQueueEntry = tknGetFromDynamicArray(pTknDrawQueueEntryDynamicArray, tknSortItems[sortIndex].index);
+        if (pTknDrawQueueEntry->isStencilSet)
+        {
+            if (!isStencilKnown || stencilCompareMask != pTknDrawQueueEntry->stencilCompareMask)
+            {
+                stencilCompareMask = pTknDrawQueueEntry->stencilCompareMask;
+                tknSetStencilCompareMask(pTknGfxContext, pTknFrame, faceMask, stencilCompareMask);
+            }
+            else
+            {
+                // Unchanged
+            }
+            if (!isStencilKnown || stencilWriteMask != pTknDrawQueueEntry->stencilWriteMask)
+            {
+                stencilWriteMask = pTknDrawQueueEntry->stencilWriteMask;
+                tknSetStencilWriteMask(pTknGfxContext, pTknFrame, faceMask, stencilWriteMask);
+            }
+            else
+            {
+                // Unchanged
+            }
+            if (!isStencilKnown || stencilReference != pTknDrawQueueEntry->stencilReference)
+            {
+                stencilReference = pTknDrawQueueEntry->stencilReference;
+                tknSetStencilReference(pTknGfxContext, pTknFrame, faceMask, stencilReference);
+            }
+            else
+            {
+                // Unchanged
+            }
+            isStencilKnown = true;
+        }
+        else
+        {
+            // Keeps whatever the previous draw set
+        }
+        tknRecordDrawCallPtr(pTknGfxContext, pTknFrame, pTknDrawQueueEntry->pTknDrawCall);
+    }
+}
+
+typedef struct
+{
+    TknGfxContext *pTknGfxContext;
+    TknFrame *pTknFrame;
+    TknDrawQueue *pTknDrawQueue;
+    const TknSortItem *tknSortItems;
+    uint32_t entryCount;
+    uint32_t chunkCount;
+    TknFrame *secondaryTknFrames;
+} TknDrawQueueChunkContext;
+
+static void tknRecordDrawQueueChunk(void *pContext, uint32_t chunkIndex, uint32_t workerIndex)
+{
+    TknDrawQueueChunkContext *pTknDrawQueueChunkContext = pContext;
+    uint32_t entryCount = pTknDrawQueueChunkContext->entryCount;
+    uint32_t chunkCount = pTknDrawQueueChunkContext->chunkCount;
+    uint32_t beginIndex = (uint32_t)((uint64_t)entryCount * chunkIndex / chunkCount);
+    uint32_t endIndex = (uint32_t)((uint64_t)entryCount * (chunkIndex + 1) / chunkCount);
+    TknFrame *pSecondaryTknFrame = &pTknDrawQueueChunkContext->secondaryTknFrames[chunkIndex];
+    tknBeginProfileScope("tknRecordDrawQueueChunk");
+    *pSecondaryTknFrame = tknBeginSecondaryFrame(pTknDrawQueueChunkContext->pTknGfxContext, pTknDrawQueueChunkContext->pTknFrame, workerIndex);
+    tknRecordDrawQueueRange(pTknDrawQueueChunkContext->pTknGfxContext, pSecondaryTknFrame, pTknDrawQueueChunkContext->pTknDrawQueue, pTknDrawQueueChunkContext->tknSortItems, beginIndex, endIndex);
+    tknEndSecondaryFrame(pSecondaryTknFrame);
+    tknEndProfileScope();
+}
+
+// Splits the sorted draws into contiguous chunks recorded on workers, executing them in chunk order keeps the sort order
+static void tknRecordDrawQueueSecondary(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknDrawQueue *pTknDrawQueue, const TknSortItem *tknSortItems, uint32_t entryCount)
+{
+    // Flushing instances and marking materials bound write shared state, so it happens here and the workers only read it
+    uint32_t frameIndex = pTknFrame->frameIndex;
+    for (uint32_t entryIndex = 0; entryIndex < entryCount; entryIndex++)
+    {
+        TknDrawCall *pTknDrawCall = ((TknDrawQueueEntry *)tknGetFromDynamicArray(&pTknDrawQueue->tknDrawQueueEntryDynamicArray, entryIndex))->pTknDrawCall;
+        if (pTknDrawCall->pTknMaterial != NULL)
+        {
+            tknMarkMaterialBound(pTknGfxContext, pTknDrawCall->pTknMaterial);
+        }
+        else
+        {
+            // Skip
+        }
+        if (pTknDrawCall->pTknInstance != NULL)
+        {
+            tknFlushInstancePtr(pTknGfxContext, pTknDrawCall->pTknInstance, frameIndex);
+        }
+        else
+        {
+            // Skip
+        }
+    }
+
+    uint32_t workerCount = tknGetWorkerCount(pTknGfxContext->pTknWorkerPool);
+    uint32_t chunkCount = (entryCount + TKN_MIN_SECONDARY_DRAW_COUNT - 1) / TKN_MIN_SECONDARY_DRAW_COUNT;
+    chunkCount = TKN_CLAMP(chunkCount, 1, workerCount);
+    TknDrawQueueChunkContext tknDrawQueueChunkContext = {
+        .pTknGfxContext = pTknGfxContext,
+        .pTknFrame = pTknFrame,
+        .pTknDrawQueue = pTknDrawQueue,
+        .tknSortItems = tknSortItems,
+        .entryCount = entryCount,
+        .chunkCount = chunkCount,
+        .secondaryTknFrames = tknAllocateFrameMemory(pTknFrame, sizeof(TknFrame) * chunkCount),
+    };
+    tknRunOnWorkerPool(pTknGfxContext->pTknWorkerPool, chunkCount, tknRecordDrawQueueChunk, &tknDrawQueueChunkContext);
+
+    VkCommandBuffer *vkCommandBuffers = tknAllocateFrameMemory(pTknFrame, sizeof(VkCommandBuffer) * chunkCount);
+    for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+    {
+        TknFrame *pSecondaryTknFrame = &tknDrawQueueChunkContext.secondaryTknFrames[chunkIndex];
+        vkCommandBuffers[chunkIndex] = pSecondaryTknFrame->vkCommandBuffer;
+        pTknFrame->tknFrameStats.emittedBindCount += pSecondaryTknFrame->tknFrameStats.emittedBindCount;
+        pTknFrame->tknFrameStats.skippedBindCount += pSecondaryTknFrame->tknFrameStats.skippedBindCount;
+    }
+    vkCmdExecuteCommands(pTknFrame->vkCommandBuffer, chunkCount, vkCommandBuffers);
+    tknForgetBoundState(pTknFrame);
+    pTknFrame->pTknPipeline = NULL;
+}
+
+void tknRecordDrawQueuePtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknDrawQueue *pTknDrawQueue)
+{
+    tknBeginProfileScope("tknRecordDrawQueuePtr");
+    TknDynamicArray *pTknDrawQueueEntryDynamicArray = &pTknDrawQueue->tknDrawQueueEntryDynamicArray;
+    uint32_t entryCount = pTknDrawQueueEntryDynamicArray->count;
+    TknSortItem *tknSortItems = tknAllocateFrameMemory(pTknFrame, sizeof(TknSortItem) * entryCount * 2);
+    for (uint32_t entryIndex = 0; entryIndex < entryCount; entryIndex++)
+    {
+        TknDrawQueueEntry *pTknDrawQueueEntry = tknGetFromDynamicArray(pTknDrawQueueEntryDynamicArray, entryIndex);
+        tknSortItems[entryIndex] = (TknSortItem){
+            .key = pTknDrawQueueEntry->sortKey,
+            .index = entryIndex,
+        };
+    }
+    tknRadixSort(tknSortItems, tknSortItems + entryCount, entryCount);
+
+    if (VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS == pTknFrame->vkSubpassContents)
+    {
+        if (entryCount > 0)
+        {
+            tknRecordDrawQueueSecondary(pTknGfxContext, pTknFrame, pTknDrawQueue, tknSortItems, entryCount);
+        }
+        else
+        {
+            // Nothing to execute
+        }
+    }
+    else
+    {
+        tknRecordDrawQueueRange(pTknGfxContext, pTknFrame, pTknDrawQueue, tknSortItems, 0, entryCount);
+    }
+    tknClearDynamicArray(pTknDrawQueueEntryDynamicArray);
+    tknEndProfileScope();
+}
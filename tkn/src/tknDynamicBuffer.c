@@ -0,0 +1,148 @@
+#include "tknGfxCore.h"
+
+static void tknCopyDynamicBufferElements(TknDynamicBuffer *pTknDynamicBuffer, uint32_t frameIndex, uint32_t elementBegin, uint32_t elementEnd)
+{
+    VkDeviceSize elementSize = pTknDynamicBuffer->elementSize;
+    VkDeviceSize elementStride = pTknDynamicBuffer->elementStride;
+    char *frameMapped = (char *)pTknDynamicBuffer->mapped + frameIndex * pTknDynamicBuffer->frameStride;
+    const char *data = pTknDynamicBuffer->data;
+    if (elementStride == elementSize)
+    {
+        memcpy(frameMapped + elementBegin * elementStride, data + elementBegin * elementSize, (elementEnd - elementBegin) * elementSize);
+    }
+    else
+    {
+        // Elements are padded to the offset alignment on the device side only
+        for (uint32_t elementIndex = elementBegin; elementIndex < elementEnd; elementIndex++)
+        {
+            memcpy(frameMapped + elementIndex * elementStride, data + elementIndex * elementSize, elementSize);
+        }
+    }
+}
+
+TknDynamicBuffer *tknCreateDynamicBufferPtr(TknGfxContext *pTknGfxContext, VkDescriptorType vkDescriptorType, const void *data, VkDeviceSize elementSize, uint32_t elementCount)
+{
+    tknAssert(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorType || VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == vkDescriptorType, "Dynamic buffers are uniform or storage buffers, got descriptor type %d", vkDescriptorType);
+    tknAssert(elementSize > 0 && elementCount > 0, "Dynamic buffer needs at least one element");
+    TknDynamicBuffer *pTknDynamicBuffer = tknMalloc(sizeof(TknDynamicBuffer));
+    VkBuffer vkBuffer = VK_NULL_HANDLE;
+    TknMemoryAllocation tknMemoryAllocation;
+    TknHashSet tknBindingPtrHashSet = tknCreateHashSet(sizeof(TknBinding *));
+
+    // Every element starts at an offset a draw can bind, and every frame in flight gets its own copy of all of them
+    VkPhysicalDeviceLimits *pVkPhysicalDeviceLimits = &pTknGfxContext->vkPhysicalDeviceProperties.limits;
+    bool isUniform = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorType;
+    VkDeviceSize alignment = isUniform ? pVkPhysicalDeviceLimits->minUniformBufferOffsetAlignment : pVkPhysicalDeviceLimits->minStorageBufferOffsetAlignment;
+    VkDeviceSize elementStride = alignment > 0 ? (elementSize + alignment - 1) / alignment * alignment : elementSize;
+    VkDeviceSize frameStride = elementStride * elementCount;
+    VkDeviceSize bufferSize = frameStride * pTknGfxContext->tknFrameInFlightCount;
+    // Storage buffers may also hold indirect draw commands and counts
+    VkBufferUsageFlags vkBufferUsageFlags = isUniform ? VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT : VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    tknCreateVkBuffer(pTknGfxContext, bufferSize, vkBufferUsageFlags, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, TKN_MEMORY_USAGE_DYNAMIC_BUFFER, &vkBuffer, &tknMemoryAllocation);
+
+    *pTknDynamicBuffer = (TknDynamicBuffer){
+        .vkDescriptorType = vkDescriptorType,
+        .vkBuffer = vkBuffer,
+        .tknMemoryAllocation = tknMemoryAllocation,
+        .mapped = tknMemoryAllocation.mapped,
+        .tknBindingPtrHashSet = tknBindingPtrHashSet,
+        .tknDrawCallPtrHashSet = tknCreateHashSet(sizeof(TknDrawCall *)),
+        .elementSize = elementSize,
+        .elementStride = elementStride,
+        .elementCount = elementCount,
+        .frameStride = frameStride,
+        .data = tknMalloc(elementSize * elementCount),
+        .dirtyFrameMask = 0,
+        .dirtyElementBegin = 0,
+        .dirtyElementEnd = 0,
+    };
+    if (NULL != data)
+    {
+        memcpy(pTknDynamicBuffer->data, data, elementSize * elementCount);
+    }
+    else
+    {
+        memset(pTknDynamicBuffer->data, 0, elementSize * elementCount);
+    }
+    // No frame can be using a new buffer yet, so every copy is written directly
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        tknCopyDynamicBufferElements(pTknDynamicBuffer, frameIndex, 0, elementCount);
+    }
+    return pTknDynamicBuffer;
+}
+
+void tknDestroyDynamicBufferPtr(TknGfxContext *pTknGfxContext, TknDynamicBuffer *pTknDynamicBuffer)
+{
+    tknAssert(0 == pTknDynamicBuffer->tknDrawCallPtrHashSet.count, "TknDynamicBuffer still has indirect draw calls attached!");
+    tknDestroyHashSet(pTknDynamicBuffer->tknDrawCallPtrHashSet);
+    tknClearBindingPtrHashSet(pTknGfxContext, &pTknDynamicBuffer->tknBindingPtrHashSet);
+    tknDestroyHashSet(pTknDynamicBuffer->tknBindingPtrHashSet);
+    if (pTknDynamicBuffer->dirtyFrameMask != 0)
+    {
+        tknRemoveFromHashSet(&pTknGfxContext->tknDirtyDynamicBufferPtrHashSet, &pTknDynamicBuffer);
+    }
+    else
+    {
+        // Skip
+    }
+    // Frames in flight may still read the buffer through their descriptor sets
+    tknRetireVkBuffer(pTknGfxContext, pTknDynamicBuffer->vkBuffer, pTknDynamicBuffer->tknMemoryAllocation);
+    pTknDynamicBuffer->vkBuffer = VK_NULL_HANDLE;
+    pTknDynamicBuffer->mapped = NULL;
+    tknFree(pTknDynamicBuffer->data);
+    tknFree(pTknDynamicBuffer);
+}
+
+void *tknWriteDynamicBufferRangePtr(TknGfxContext *pTknGfxContext, TknDynamicBuffer *pTknDynamicBuffer, VkDeviceSize offset, VkDeviceSize size)
+{
+    VkDeviceSize elementSize = pTknDynamicBuffer->elementSize;
+    VkDeviceSize dataSize = elementSize * pTknDynamicBuffer->elementCount;
+    // Compared without adding, so a huge offset cannot wrap back into range
+    tknAssert(offset <= dataSize && size <= dataSize - offset, "Range [%llu, %llu) exceeds dynamic buffer size %llu", (unsigned long long)offset, (unsigned long long)(offset + size), (unsigned long long)dataSize);
+    // Frames copy whole elements, the padding between them lives only in the buffer
+    uint32_t firstElement = (uint32_t)(offset / elementSize);
+    uint32_t elementEnd = (uint32_t)((offset + size + elementSize - 1) / elementSize);
+    if (0 == pTknDynamicBuffer->dirtyFrameMask)
+    {
+        tknAddToHashSet(&pTknGfxContext->tknDirtyDynamicBufferPtrHashSet, &pTknDynamicBuffer);
+        pTknDynamicBuffer->dirtyElementBegin = firstElement;
+        pTknDynamicBuffer->dirtyElementEnd = elementEnd;
+    }
+    else
+    {
+        // Some frames have not seen the earlier writes yet, keep them in the range
+        pTknDynamicBuffer->dirtyElementBegin = firstElement < pTknDynamicBuffer->dirtyElementBegin ? firstElement : pTknDynamicBuffer->dirtyElementBegin;
+        pTknDynamicBuffer->dirtyElementEnd = elementEnd > pTknDynamicBuffer->dirtyElementEnd ? elementEnd : pTknDynamicBuffer->dirtyElementEnd;
+    }
+    pTknDynamicBuffer->dirtyFrameMask = tknGetAllFramesMask(pTknGfxContext);
+    return (char *)pTknDynamicBuffer->data + offset;
+}
+
+uint32_t tknGetDynamicBufferOffset(TknDynamicBuffer *pTknDynamicBuffer, uint32_t elementIndex)
+{
+    tknAssert(elementIndex < pTknDynamicBuffer->elementCount, "Element %u exceeds dynamic buffer element count %u", elementIndex, pTknDynamicBuffer->elementCount);
+    return (uint32_t)(elementIndex * pTknDynamicBuffer->elementStride);
+}
+
+void tknFlushDynamicBufferPtr(TknGfxContext *pTknGfxContext, TknDynamicBuffer *pTknDynamicBuffer, uint32_t frameIndex)
+{
+    uint32_t frameMask = 1u << frameIndex;
+    if (pTknDynamicBuffer->dirtyFrameMask & frameMask)
+    {
+        tknCopyDynamicBufferElements(pTknDynamicBuffer, frameIndex, pTknDynamicBuffer->dirtyElementBegin, pTknDynamicBuffer->dirtyElementEnd);
+        pTknDynamicBuffer->dirtyFrameMask &= ~frameMask;
+        if (0 == pTknDynamicBuffer->dirtyFrameMask)
+        {
+            tknRemoveFromHashSet(&pTknGfxContext->tknDirtyDynamicBufferPtrHashSet, &pTknDynamicBuffer);
+        }
+        else
+        {
+            // Other frames still need this data
+        }
+    }
+    else
+    {
+        // Skip
+    }
+}
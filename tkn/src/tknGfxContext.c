@@ -38,6 +38,42 @@ static void tknGetGfxAndPresentQueueFamilyIndices(TknGfxContext *pTknGfxContext,
     }
     tknFree(vkQueueFamilyPropertiesArray);
 }
+// Prefers a family that can only transfer, those map to the copy engines that run beside graphics work
+static uint32_t tknGetTransferQueueFamilyIndex(VkPhysicalDevice vkPhysicalDevice)
+{
+    uint32_t queueFamilyPropertiesCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice, &queueFamilyPropertiesCount, NULL);
+    VkQueueFamilyProperties *vkQueueFamilyPropertiesArray = tknMalloc(queueFamilyPropertiesCount * sizeof(VkQueueFamilyProperties));
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice, &queueFamilyPropertiesCount, vkQueueFamilyPropertiesArray);
+    uint32_t tknTransferQueueFamilyIndex = UINT32_MAX;
+    for (uint32_t queueFamilyPropertiesIndex = 0; queueFamilyPropertiesIndex < queueFamilyPropertiesCount; queueFamilyPropertiesIndex++)
+    {
+        VkQueueFamilyProperties vkQueueFamilyProperties = vkQueueFamilyPropertiesArray[queueFamilyPropertiesIndex];
+        if (vkQueueFamilyProperties.queueCount > 0 && (vkQueueFamilyProperties.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(vkQueueFamilyProperties.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+        {
+            if (!(vkQueueFamilyProperties.queueFlags & VK_QUEUE_COMPUTE_BIT))
+            {
+                tknTransferQueueFamilyIndex = queueFamilyPropertiesIndex;
+                break;
+            }
+            else if (UINT32_MAX == tknTransferQueueFamilyIndex)
+            {
+                // Async compute family, keep looking for a transfer only one
+                tknTransferQueueFamilyIndex = queueFamilyPropertiesIndex;
+            }
+            else
+            {
+                // continue;
+            }
+        }
+        else
+        {
+            // continue;
+        }
+    }
+    tknFree(vkQueueFamilyPropertiesArray);
+    return tknTransferQueueFamilyIndex;
+}
 static void tknPickPhysicalDevice(TknGfxContext *pTknGfxContext, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode)
 {
     uint32_t deviceCount = -1;
@@ -206,6 +242,7 @@ static void tknPickPhysicalDevice(TknGfxContext *pTknGfxContext, VkSurfaceFormat
                 pTknGfxContext->vkPhysicalDevice = vkPhysicalDevice;
                 pTknGfxContext->tknGfxQueueFamilyIndex = tknGfxQueueFamilyIndex;
                 pTknGfxContext->tknPresentQueueFamilyIndex = tknPresentQueueFamilyIndex;
+                pTknGfxContext->tknTransferQueueFamilyIndex = tknGetTransferQueueFamilyIndex(vkPhysicalDevice);
                 pTknGfxContext->vkPhysicalDeviceProperties = deviceProperties;
                 pTknGfxContext->tknSurfaceFormat = targetVkSurfaceFormat;
                 pTknGfxContext->tknPresentMode = targetVkPresentMode;
@@ -227,67 +264,96 @@ static void tknPickPhysicalDevice(TknGfxContext *pTknGfxContext, VkSurfaceFormat
         }
     }
 }
+static bool tknIsDeviceExtensionSupported(VkPhysicalDevice vkPhysicalDevice, const char *extensionName)
+{
+    uint32_t extensionCount = 0;
+    tknAssertVkResult(vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, NULL, &extensionCount, NULL));
+    VkExtensionProperties *extensionProperties = tknMalloc(extensionCount * sizeof(VkExtensionProperties));
+    tknAssertVkResult(vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, NULL, &extensionCount, extensionProperties));
+    bool isSupported = false;
+    for (uint32_t extensionIndex = 0; extensionIndex < extensionCount; extensionIndex++)
+    {
+        isSupported = isSupported || 0 == strcmp(extensionProperties[extensionIndex].extensionName, extensionName);
+    }
+    tknFree(extensionProperties);
+    return isSupported;
+}
 static void tknPopulateLogicalDevice(TknGfxContext *pTknGfxContext)
 {
     VkPhysicalDevice vkPhysicalDevice = pTknGfxContext->vkPhysicalDevice;
     uint32_t tknGfxQueueFamilyIndex = pTknGfxContext->tknGfxQueueFamilyIndex;
     uint32_t tknPresentQueueFamilyIndex = pTknGfxContext->tknPresentQueueFamilyIndex;
+    uint32_t tknTransferQueueFamilyIndex = pTknGfxContext->tknTransferQueueFamilyIndex;
     float queuePriority = 1.0f;
-    VkDeviceQueueCreateInfo *queueCreateInfos;
-    uint32_t queueCount;
-    if (tknGfxQueueFamilyIndex == tknPresentQueueFamilyIndex)
+    // One queue per distinct family, the transfer family is only present when the device has one
+    uint32_t queueFamilyIndices[] = {tknGfxQueueFamilyIndex, tknPresentQueueFamilyIndex, tknTransferQueueFamilyIndex};
+    VkDeviceQueueCreateInfo queueCreateInfos[TKN_ARRAY_COUNT(queueFamilyIndices)];
+    uint32_t queueCount = 0;
+    for (uint32_t familyIndex = 0; familyIndex < TKN_ARRAY_COUNT(queueFamilyIndices); familyIndex++)
     {
-        queueCount = 1;
-        queueCreateInfos = tknMalloc(sizeof(VkDeviceQueueCreateInfo) * queueCount);
-        VkDeviceQueueCreateInfo gfxCreateInfo =
-            {
-                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-                .pNext = NULL,
-                .flags = 0,
-                .queueFamilyIndex = tknGfxQueueFamilyIndex,
-                .queueCount = 1,
-                .pQueuePriorities = &queuePriority,
-            };
-        queueCreateInfos[0] = gfxCreateInfo;
-    }
-    else
-    {
-        queueCount = 2;
-        queueCreateInfos = tknMalloc(sizeof(VkDeviceQueueCreateInfo) * queueCount);
-        VkDeviceQueueCreateInfo gfxCreateInfo =
-            {
+        uint32_t queueFamilyIndex = queueFamilyIndices[familyIndex];
+        bool isSkipped = UINT32_MAX == queueFamilyIndex;
+        for (uint32_t queueIndex = 0; queueIndex < queueCount; queueIndex++)
+        {
+            isSkipped = isSkipped || queueCreateInfos[queueIndex].queueFamilyIndex == queueFamilyIndex;
+        }
+        if (isSkipped)
+        {
+            // Skip
+        }
+        else
+        {
+            queueCreateInfos[queueCount++] = (VkDeviceQueueCreateInfo){
                 .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
                 .pNext = NULL,
                 .flags = 0,
-                .queueFamilyIndex = tknGfxQueueFamilyIndex,
+                .queueFamilyIndex = queueFamilyIndex,
                 .queueCount = 1,
                 .pQueuePriorities = &queuePriority,
             };
-        VkDeviceQueueCreateInfo presentCreateInfo = {
-            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0,
-            .queueFamilyIndex = tknPresentQueueFamilyIndex,
-            .queueCount = 1,
-            .pQueuePriorities = &queuePriority,
-        };
-        queueCreateInfos[0] = gfxCreateInfo;
-        queueCreateInfos[1] = presentCreateInfo;
+        }
     }
 
+    // Pipeline statistics are only profiled, so they are left out when a subpass recorded in secondary command buffers could not count them
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(vkPhysicalDevice, &supportedFeatures);
+    pTknGfxContext->isPipelineStatisticsQueryEnabled = supportedFeatures.pipelineStatisticsQuery && supportedFeatures.inheritedQueries;
+    pTknGfxContext->isMultiDrawIndirectEnabled = supportedFeatures.multiDrawIndirect;
     VkPhysicalDeviceFeatures deviceFeatures =
         {
+            .multiDrawIndirect = pTknGfxContext->isMultiDrawIndirectEnabled,
             .fillModeNonSolid = VK_TRUE,
             .sampleRateShading = VK_TRUE,
+            .pipelineStatisticsQuery = pTknGfxContext->isPipelineStatisticsQueryEnabled,
+            .inheritedQueries = pTknGfxContext->isPipelineStatisticsQueryEnabled,
         };
     char **enabledLayerNames = NULL;
     uint32_t enabledLayerCount = 0;
 
-    char *extensionNames[] = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        "VK_KHR_portability_subset",
-    };
-    uint32_t extensionCount = TKN_ARRAY_COUNT(extensionNames);
+    char *extensionNames[4];
+    uint32_t extensionCount = 0;
+    extensionNames[extensionCount++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    extensionNames[extensionCount++] = "VK_KHR_portability_subset";
+    // Creation feedback only reports pipeline cache hits, it is left out when the driver lacks it
+    pTknGfxContext->isPipelineCreationFeedbackEnabled = tknIsDeviceExtensionSupported(vkPhysicalDevice, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    if (pTknGfxContext->isPipelineCreationFeedbackEnabled)
+    {
+        extensionNames[extensionCount++] = VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME;
+    }
+    else
+    {
+        // Skip
+    }
+    // Indirect draws fall back to their maximum draw count without it
+    pTknGfxContext->isDrawIndirectCountEnabled = tknIsDeviceExtensionSupported(vkPhysicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (pTknGfxContext->isDrawIndirectCountEnabled)
+    {
+        extensionNames[extensionCount++] = VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME;
+    }
+    else
+    {
+        // Skip
+    }
     VkDeviceCreateInfo vkDeviceCreateInfo =
         {
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
@@ -302,9 +368,28 @@ static void tknPopulateLogicalDevice(TknGfxContext *pTknGfxContext)
             .pEnabledFeatures = &deviceFeatures,
         };
     tknAssertVkResult(vkCreateDevice(vkPhysicalDevice, &vkDeviceCreateInfo, NULL, &pTknGfxContext->vkDevice));
+    if (pTknGfxContext->isDrawIndirectCountEnabled)
+    {
+        pTknGfxContext->vkCmdDrawIndirectCountKHR = (PFN_vkCmdDrawIndirectCountKHR)vkGetDeviceProcAddr(pTknGfxContext->vkDevice, "vkCmdDrawIndirectCountKHR");
+        pTknGfxContext->vkCmdDrawIndexedIndirectCountKHR = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(pTknGfxContext->vkDevice, "vkCmdDrawIndexedIndirectCountKHR");
+    }
+    else
+    {
+        pTknGfxContext->vkCmdDrawIndirectCountKHR = NULL;
+        pTknGfxContext->vkCmdDrawIndexedIndirectCountKHR = NULL;
+    }
     vkGetDeviceQueue(pTknGfxContext->vkDevice, tknGfxQueueFamilyIndex, 0, &pTknGfxContext->vkGfxQueue);
     vkGetDeviceQueue(pTknGfxContext->vkDevice, tknPresentQueueFamilyIndex, 0, &pTknGfxContext->vkPresentQueue);
-    tknFree(queueCreateInfos);
+    if (tknTransferQueueFamilyIndex != UINT32_MAX)
+    {
+        vkGetDeviceQueue(pTknGfxContext->vkDevice, tknTransferQueueFamilyIndex, 0, &pTknGfxContext->vkTransferQueue);
+        printf("Using transfer queue family %u\n", tknTransferQueueFamilyIndex);
+    }
+    else
+    {
+        // Uploads stay on the graphics queue
+        pTknGfxContext->vkTransferQueue = VK_NULL_HANDLE;
+    }
 }
 static void tknCleanupLogicalDevice(TknGfxContext *pTknGfxContext)
 {
@@ -500,16 +585,22 @@ static void tknPopulateSignals(TknGfxContext *pTknGfxContext)
         .pNext = NULL,
         .flags = VK_FENCE_CREATE_SIGNALED_BIT,
     };
-    tknAssertVkResult(vkCreateSemaphore(vkDevice, &semaphoreCreateInfo, NULL, &pTknGfxContext->vkImageAvailableSemaphore));
-    tknAssertVkResult(vkCreateSemaphore(vkDevice, &semaphoreCreateInfo, NULL, &pTknGfxContext->vkRenderFinishedSemaphore));
-    tknAssertVkResult(vkCreateFence(vkDevice, &fenceCreateInfo, NULL, &pTknGfxContext->vkRenderFinishedFence));
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        tknAssertVkResult(vkCreateSemaphore(vkDevice, &semaphoreCreateInfo, NULL, &pTknGfxContext->vkImageAvailableSemaphores[frameIndex]));
+        tknAssertVkResult(vkCreateSemaphore(vkDevice, &semaphoreCreateInfo, NULL, &pTknGfxContext->vkRenderFinishedSemaphores[frameIndex]));
+        tknAssertVkResult(vkCreateFence(vkDevice, &fenceCreateInfo, NULL, &pTknGfxContext->vkRenderFinishedFences[frameIndex]));
+    }
 }
 static void tknCleanupSignals(TknGfxContext *pTknGfxContext)
 {
     VkDevice vkDevice = pTknGfxContext->vkDevice;
-    vkDestroySemaphore(vkDevice, pTknGfxContext->vkImageAvailableSemaphore, NULL);
-    vkDestroySemaphore(vkDevice, pTknGfxContext->vkRenderFinishedSemaphore, NULL);
-    vkDestroyFence(vkDevice, pTknGfxContext->vkRenderFinishedFence, NULL);
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        vkDestroySemaphore(vkDevice, pTknGfxContext->vkImageAvailableSemaphores[frameIndex], NULL);
+        vkDestroySemaphore(vkDevice, pTknGfxContext->vkRenderFinishedSemaphores[frameIndex], NULL);
+        vkDestroyFence(vkDevice, pTknGfxContext->vkRenderFinishedFences[frameIndex], NULL);
+    }
 }
 static void tknPopulateCommandPools(TknGfxContext *pTknGfxContext)
 {
@@ -527,29 +618,33 @@ static void tknCleanupCommandPools(TknGfxContext *pTknGfxContext)
 }
 static void tknPopulateVkCommandBuffers(TknGfxContext *pTknGfxContext)
 {
-    TknSwapchainAttachment *pTknSwapchainAttachment = &pTknGfxContext->pTknSwapchainAttachment->tknAttachmentUnion.tknSwapchainAttachment;
-    pTknGfxContext->vkGfxCommandBuffers = tknMalloc(sizeof(VkCommandBuffer) * pTknSwapchainAttachment->tknSwapchainImageCount);
     VkCommandBufferAllocateInfo vkCommandBufferAllocateInfo = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .pNext = NULL,
         .commandPool = pTknGfxContext->vkGfxCommandPool,
         .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = pTknSwapchainAttachment->tknSwapchainImageCount,
+        .commandBufferCount = pTknGfxContext->tknFrameInFlightCount,
     };
     tknAssertVkResult(vkAllocateCommandBuffers(pTknGfxContext->vkDevice, &vkCommandBufferAllocateInfo, pTknGfxContext->vkGfxCommandBuffers));
 }
 static void tknCleanupVkCommandBuffers(TknGfxContext *pTknGfxContext)
 {
-    TknSwapchainAttachment *pTknSwapchainAttachment = &pTknGfxContext->pTknSwapchainAttachment->tknAttachmentUnion.tknSwapchainAttachment;
-    vkFreeCommandBuffers(pTknGfxContext->vkDevice, pTknGfxContext->vkGfxCommandPool, pTknSwapchainAttachment->tknSwapchainImageCount, pTknGfxContext->vkGfxCommandBuffers);
-    tknFree(pTknGfxContext->vkGfxCommandBuffers);
+    vkFreeCommandBuffers(pTknGfxContext->vkDevice, pTknGfxContext->vkGfxCommandPool, pTknGfxContext->tknFrameInFlightCount, pTknGfxContext->vkGfxCommandBuffers);
 }
 
 static void tknSetupGfxResources(TknGfxContext *pTknGfxContext, uint32_t spvPathCount, const char **spvPaths)
 {
+    pTknGfxContext->tknDirtyUniformBufferPtrHashSet = tknCreateHashSet(sizeof(TknUniformBuffer *));
+    pTknGfxContext->tknDirtyDynamicBufferPtrHashSet = tknCreateHashSet(sizeof(TknDynamicBuffer *));
+    pTknGfxContext->tknDirtyInstancePtrHashSet = tknCreateHashSet(sizeof(TknInstance *));
+    pTknGfxContext->tknDirtyMaterialPtrHashSet = tknCreateHashSet(sizeof(TknMaterial *));
+
     // Create empty resources for empty bindings
     uint32_t emptyData = 0;
     pTknGfxContext->pTknEmptyUniformBuffer = tknCreateUniformBufferPtr(pTknGfxContext, &emptyData, sizeof(emptyData));
+    pTknGfxContext->pTknEmptyUniformDynamicBuffer = tknCreateDynamicBufferPtr(pTknGfxContext, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, &emptyData, sizeof(emptyData), 1);
+    pTknGfxContext->pTknEmptyStorageDynamicBuffer = tknCreateDynamicBufferPtr(pTknGfxContext, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, &emptyData, sizeof(emptyData), 1);
+    pTknGfxContext->pTknEmptyStorageBuffer = tknCreateStorageBufferPtr(pTknGfxContext, &emptyData, sizeof(emptyData));
 
     // Create empty sampler with default settings
     VkSamplerCreateInfo samplerCreateInfo = {
@@ -592,35 +687,75 @@ static void tknSetupGfxResources(TknGfxContext *pTknGfxContext, uint32_t spvPath
     pTknGfxContext->tknFixedAttachmentPtrHashSet = tknCreateHashSet(sizeof(TknAttachment *));
     pTknGfxContext->tknRenderPassPtrHashSet = tknCreateHashSet(sizeof(TknRenderPass *));
     SpvReflectShaderModule *spvReflectShaderModules = tknMalloc(sizeof(SpvReflectShaderModule) * spvPathCount);
+    tknLoadShaderReflections(pTknGfxContext, spvPathCount, spvPaths);
     for (uint32_t spvPathIndex = 0; spvPathIndex < spvPathCount; spvPathIndex++)
     {
-        spvReflectShaderModules[spvPathIndex] = tknCreateSpvReflectShaderModule(spvPaths[spvPathIndex]);
+        spvReflectShaderModules[spvPathIndex] = tknGetSpvReflectShaderModule(pTknGfxContext, spvPaths[spvPathIndex]);
     }
     pTknGfxContext->pTknGlobalDescriptorSet = tknCreateDescriptorSetPtr(pTknGfxContext, spvPathCount, spvReflectShaderModules, TKN_GLOBAL_DESCRIPTOR_SET);
-    for (uint32_t spvPathIndex = 0; spvPathIndex < spvPathCount; spvPathIndex++)
+    tknFree(spvReflectShaderModules);
+    TknMaterial *pGlobalMaterial = tknCreateMaterialPtr(pTknGfxContext, pTknGfxContext->pTknGlobalDescriptorSet);
+
+    // Identity camera until tknSetFrameCamera is called
+    pTknGfxContext->tknFrameConstants = (TknFrameConstants){0};
+    for (uint32_t diagonalIndex = 0; diagonalIndex < 4; diagonalIndex++)
     {
-        tknDestroySpvReflectShaderModule(&spvReflectShaderModules[spvPathIndex]);
+        pTknGfxContext->tknFrameConstants.view[diagonalIndex * 5] = 1.0f;
+        pTknGfxContext->tknFrameConstants.proj[diagonalIndex * 5] = 1.0f;
+    }
+    pTknGfxContext->tknStartTimeMilliseconds = tknGetTimeMilliseconds();
+    pTknGfxContext->pTknFrameConstantsDynamicBuffer = tknCreateDynamicBufferPtr(pTknGfxContext, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, &pTknGfxContext->tknFrameConstants, sizeof(TknFrameConstants), 1);
+    if (pTknGfxContext->pTknGlobalDescriptorSet->tknDescriptorCount > 0 && VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == pTknGfxContext->pTknGlobalDescriptorSet->vkDescriptorTypes[0])
+    {
+        // Bound once, each frame reads its own copy through the dynamic offset
+        TknInputBinding tknInputBinding = {
+            .vkDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .tknInputBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer = pTknGfxContext->pTknFrameConstantsDynamicBuffer,
+            .binding = 0,
+        };
+        tknUpdateMaterialPtr(pTknGfxContext, pGlobalMaterial, 1, &tknInputBinding);
+    }
+    else
+    {
+        tknWarning("No shader declares GlobalUniform at global binding 0, frame constants are not bound");
     }
-    tknFree(spvReflectShaderModules);
-    tknCreateMaterialPtr(pTknGfxContext, pTknGfxContext->pTknGlobalDescriptorSet);
 
     pTknGfxContext->tknVertexInputLayoutPtrHashSet = tknCreateHashSet(sizeof(TknVertexInputLayout *));
 
-    pTknGfxContext->pTknFrame = tknMalloc(sizeof(TknFrame));
+    pTknGfxContext->tknFrames = tknMalloc(sizeof(TknFrame) * pTknGfxContext->tknFrameInFlightCount);
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        pTknGfxContext->tknFrames[frameIndex] = (TknFrame){
+            .frameIndex = frameIndex,
+            .vkCommandBuffer = NULL,
+            .swapchainIndex = -1,
+            .pTknRenderPass = NULL,
+            .subpassIndex = -1,
+            .vkSubpassContents = VK_SUBPASS_CONTENTS_INLINE,
+            .pTknPipeline = NULL,
+            .tknArena = tknCreateArena(TKN_DEFAULT_ARENA_SIZE),
+            .boundVkDescriptorSets = {VK_NULL_HANDLE},
+            .boundDynamicOffsets = {0},
+            .boundVertexVkBuffers = {VK_NULL_HANDLE},
+            .boundVertexOffsets = {0},
+            .boundIndexVkBuffer = VK_NULL_HANDLE,
+            .boundVkIndexType = VK_INDEX_TYPE_UINT16,
+            .tknFrameStats = {0},
+        };
+    }
 }
 static void tknTeardownGfxResources(TknGfxContext *pTknGfxContext)
 {
-    tknFree(pTknGfxContext->pTknFrame);
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        tknDestroyArena(pTknGfxContext->tknFrames[frameIndex].tknArena);
+    }
+    tknFree(pTknGfxContext->tknFrames);
 
-    for (uint32_t i = 0; i < pTknGfxContext->tknRenderPassPtrHashSet.capacity; i++)
+    while (pTknGfxContext->tknRenderPassPtrHashSet.count > 0)
     {
-        TknListNode *node = pTknGfxContext->tknRenderPassPtrHashSet.nodePtrs[i];
-        while (node)
-        {
-            TknRenderPass *pTknRenderPass = *(TknRenderPass **)node->data;
-            tknDestroyRenderPassPtr(pTknGfxContext, pTknRenderPass);
-            node = node->pNextNode;
-        }
+        TknRenderPass *pTknRenderPass = *(TknRenderPass **)tknGetFromHashSet(&pTknGfxContext->tknRenderPassPtrHashSet, pTknGfxContext->tknRenderPassPtrHashSet.count - 1);
+        tknDestroyRenderPassPtr(pTknGfxContext, pTknRenderPass);
     }
     tknAssert(pTknGfxContext->tknRenderPassPtrHashSet.count == 0, "Render pass dynamic array should be empty before destroying TknGfxContext.");
     tknDestroyHashSet(pTknGfxContext->tknRenderPassPtrHashSet);
@@ -631,39 +766,30 @@ static void tknTeardownGfxResources(TknGfxContext *pTknGfxContext)
 
     while (pTknGfxContext->tknDynamicAttachmentPtrHashSet.count > 0)
     {
-        TknAttachment *pDynamicAttachment = NULL;
-        for (uint32_t nodeIndex = 0; nodeIndex < pTknGfxContext->tknDynamicAttachmentPtrHashSet.capacity; nodeIndex++)
-        {
-            TknListNode *pNode = pTknGfxContext->tknDynamicAttachmentPtrHashSet.nodePtrs[nodeIndex];
-            while (pNode)
-            {
-                pDynamicAttachment = *(TknAttachment **)pNode->data;
-                pNode = pNode->pNextNode;
-                tknDestroyDynamicAttachmentPtr(pTknGfxContext, pDynamicAttachment);
-            }
-        }
+        TknAttachment *pDynamicAttachment = *(TknAttachment **)tknGetFromHashSet(&pTknGfxContext->tknDynamicAttachmentPtrHashSet, pTknGfxContext->tknDynamicAttachmentPtrHashSet.count - 1);
+        tknDestroyDynamicAttachmentPtr(pTknGfxContext, pDynamicAttachment);
     }
     tknAssert(0 == pTknGfxContext->tknDynamicAttachmentPtrHashSet.count, "Dynamic attachment hash set should be empty before destroying TknGfxContext.");
     tknDestroyHashSet(pTknGfxContext->tknDynamicAttachmentPtrHashSet);
 
-    // Safely destroy all fixed attachments by repeatedly taking the first one
+    // Safely destroy all fixed attachments by repeatedly taking the last one
     while (pTknGfxContext->tknFixedAttachmentPtrHashSet.count > 0)
     {
-        TknAttachment *pFixedAttachment = NULL;
-        for (uint32_t nodeIndex = 0; nodeIndex < pTknGfxContext->tknFixedAttachmentPtrHashSet.capacity; nodeIndex++)
-        {
-            TknListNode *pNode = pTknGfxContext->tknFixedAttachmentPtrHashSet.nodePtrs[nodeIndex];
-            while (pNode)
-            {
-                pFixedAttachment = *(TknAttachment **)pNode->data;
-                pNode = pNode->pNextNode;
-                tknDestroyFixedAttachmentPtr(pTknGfxContext, pFixedAttachment);
-            }
-        }
+        TknAttachment *pFixedAttachment = *(TknAttachment **)tknGetFromHashSet(&pTknGfxContext->tknFixedAttachmentPtrHashSet, pTknGfxContext->tknFixedAttachmentPtrHashSet.count - 1);
+        tknDestroyFixedAttachmentPtr(pTknGfxContext, pFixedAttachment);
     }
     tknAssert(0 == pTknGfxContext->tknFixedAttachmentPtrHashSet.count, "Fixed attachment hash set should be empty before destroying TknGfxContext.");
     tknDestroyHashSet(pTknGfxContext->tknFixedAttachmentPtrHashSet);
 
+    tknDestroyDynamicBufferPtr(pTknGfxContext, pTknGfxContext->pTknFrameConstantsDynamicBuffer);
+    pTknGfxContext->pTknFrameConstantsDynamicBuffer = NULL;
+    tknDestroyDynamicBufferPtr(pTknGfxContext, pTknGfxContext->pTknEmptyUniformDynamicBuffer);
+    pTknGfxContext->pTknEmptyUniformDynamicBuffer = NULL;
+    tknDestroyDynamicBufferPtr(pTknGfxContext, pTknGfxContext->pTknEmptyStorageDynamicBuffer);
+    pTknGfxContext->pTknEmptyStorageDynamicBuffer = NULL;
+    tknDestroyStorageBufferPtr(pTknGfxContext, pTknGfxContext->pTknEmptyStorageBuffer);
+    pTknGfxContext->pTknEmptyStorageBuffer = NULL;
+
     if (pTknGfxContext->pTknEmptyUniformBuffer)
     {
         tknDestroyUniformBufferPtr(pTknGfxContext, pTknGfxContext->pTknEmptyUniformBuffer);
@@ -683,9 +809,18 @@ static void tknTeardownGfxResources(TknGfxContext *pTknGfxContext)
         tknDestroyImagePtr(pTknGfxContext, pTknGfxContext->pTknEmptyImage);
         pTknGfxContext->pTknEmptyImage = NULL;
     }
+
+    tknAssert(0 == pTknGfxContext->tknDirtyMaterialPtrHashSet.count, "Dirty material hash set should be empty before destroying TknGfxContext.");
+    tknDestroyHashSet(pTknGfxContext->tknDirtyMaterialPtrHashSet);
+    tknAssert(0 == pTknGfxContext->tknDirtyInstancePtrHashSet.count, "Dirty instance hash set should be empty before destroying TknGfxContext.");
+    tknDestroyHashSet(pTknGfxContext->tknDirtyInstancePtrHashSet);
+    tknAssert(0 == pTknGfxContext->tknDirtyUniformBufferPtrHashSet.count, "Dirty uniform buffer hash set should be empty before destroying TknGfxContext.");
+    tknDestroyHashSet(pTknGfxContext->tknDirtyUniformBufferPtrHashSet);
+    tknAssert(0 == pTknGfxContext->tknDirtyDynamicBufferPtrHashSet.count, "Dirty dynamic buffer hash set should be empty before destroying TknGfxContext.");
+    tknDestroyHashSet(pTknGfxContext->tknDirtyDynamicBufferPtrHashSet);
 }
 
-TknGfxContext *tknCreateGfxContextPtr(int targetSwapchainImageCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D tknSwapchainExtent, uint32_t spvPathCount, const char **spvPaths)
+TknGfxContext *tknCreateGfxContextPtr(int targetSwapchainImageCount, uint32_t frameInFlightCount, VkSurfaceFormatKHR targetVkSurfaceFormat, VkPresentModeKHR targetVkPresentMode, VkInstance vkInstance, VkSurfaceKHR vkSurface, VkExtent2D tknSwapchainExtent, uint32_t spvPathCount, const char **spvPaths, const char *pipelineCachePath)
 {
     TknGfxContext *pTknGfxContext = tknMalloc(sizeof(TknGfxContext));
     *pTknGfxContext = (TknGfxContext){
@@ -697,22 +832,68 @@ TknGfxContext *tknCreateGfxContextPtr(int targetSwapchainImageCount, VkSurfaceFo
         .vkPhysicalDeviceProperties = {},
         .tknGfxQueueFamilyIndex = UINT32_MAX,
         .tknPresentQueueFamilyIndex = UINT32_MAX,
+        .tknTransferQueueFamilyIndex = UINT32_MAX,
 
         .tknSurfaceFormat = {},
         .tknPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR,
 
         .vkDevice = VK_NULL_HANDLE,
+        .isPipelineCreationFeedbackEnabled = false,
+        .isPipelineStatisticsQueryEnabled = false,
+        .isMultiDrawIndirectEnabled = false,
+        .isDrawIndirectCountEnabled = false,
+        .vkCmdDrawIndirectCountKHR = NULL,
+        .vkCmdDrawIndexedIndirectCountKHR = NULL,
         .vkGfxQueue = VK_NULL_HANDLE,
         .vkPresentQueue = VK_NULL_HANDLE,
+        .vkTransferQueue = VK_NULL_HANDLE,
+
+        .vkPhysicalDeviceMemoryProperties = {},
+        .tknMemoryBlockPtrDynamicArray = {},
+        .tknMemoryUsageSizes = {},
 
         .pTknSwapchainAttachment = NULL,
 
-        .vkImageAvailableSemaphore = VK_NULL_HANDLE,
-        .vkRenderFinishedSemaphore = VK_NULL_HANDLE,
-        .vkRenderFinishedFence = VK_NULL_HANDLE,
+        .tknFrameInFlightCount = TKN_CLAMP(frameInFlightCount, 1, TKN_MAX_FRAMES_IN_FLIGHT),
+        .tknFrameIndex = 0,
+        .vkImageAvailableSemaphores = {},
+        .vkRenderFinishedSemaphores = {},
+        .vkRenderFinishedFences = {},
 
         .vkGfxCommandPool = VK_NULL_HANDLE,
-        .vkGfxCommandBuffers = NULL,
+        .vkGfxCommandBuffers = {},
+
+        .vkPipelineCache = VK_NULL_HANDLE,
+        .pipelineCachePath = NULL,
+        .tknPipelineCacheStats = {},
+        .tknDescriptorPoolStats = {},
+        .pTknWorkerPool = NULL,
+        .tknSecondaryCommandPools = NULL,
+        .tknTimestampValidBits = 0,
+        .isGpuTimestampEnabled = false,
+        .isGpuPipelineStatisticsEnabled = false,
+        .tknGpuProfilerFrames = {},
+        .tknGpuProfile = {},
+        .tknShaderReflectionPtrDynamicArray = {},
+        .tknShaderReflectionPathHashSet = {},
+        .tknShaderReflectionHitCount = 0,
+
+        .tknStagingVkBuffer = VK_NULL_HANDLE,
+        .tknStagingMemoryAllocation = {0},
+        .tknStagingSliceSize = 0,
+        .tknStagingOffset = 0,
+        .vkUploadCommandBuffers = {},
+        .isUploadRecording = false,
+
+        .vkTransferCommandPool = VK_NULL_HANDLE,
+        .tknTransferDynamicArray = {},
+        .tknNextUploadTicket = 1,
+
+        .tknRetiredResourceDynamicArray = {},
+        .tknSubmitSerial = 0,
+        .tknFrameSubmitSerials = {},
+        .tknCompletedSubmitSerial = 0,
+        .isFrameRecording = false,
 
         .tknDynamicAttachmentPtrHashSet = {},
         .tknRenderPassPtrHashSet = {},
@@ -720,10 +901,19 @@ TknGfxContext *tknCreateGfxContextPtr(int targetSwapchainImageCount, VkSurfaceFo
     };
     tknPickPhysicalDevice(pTknGfxContext, targetVkSurfaceFormat, targetVkPresentMode);
     tknPopulateLogicalDevice(pTknGfxContext);
+    tknPopulateMemoryAllocator(pTknGfxContext);
+    tknPopulatePipelineCache(pTknGfxContext, pipelineCachePath);
+    pTknGfxContext->pTknWorkerPool = tknCreateWorkerPoolPtr(TKN_DEFAULT_WORKER_THREAD_COUNT);
+    tknPopulateShaderReflections(pTknGfxContext);
     tknCreateSwapchainAttachmentPtr(pTknGfxContext, tknSwapchainExtent, targetSwapchainImageCount);
     tknPopulateSignals(pTknGfxContext);
+    tknPopulateRetiredResources(pTknGfxContext);
     tknPopulateCommandPools(pTknGfxContext);
+    tknPopulateSecondaryCommandPools(pTknGfxContext);
+    tknPopulateGpuProfiler(pTknGfxContext);
     tknPopulateVkCommandBuffers(pTknGfxContext);
+    tknPopulateStagingRing(pTknGfxContext);
+    tknPopulateTransfers(pTknGfxContext);
     tknSetupGfxResources(pTknGfxContext, spvPathCount, spvPaths);
     return pTknGfxContext;
 }
@@ -732,13 +922,92 @@ void tknDestroyGfxContextPtr(TknGfxContext *pTknGfxContext)
     tknAssertVkResult(vkDeviceWaitIdle(pTknGfxContext->vkDevice));
 
     tknTeardownGfxResources(pTknGfxContext);
+    tknCleanupShaderReflections(pTknGfxContext);
+    tknCleanupTransfers(pTknGfxContext);
+    tknCleanupStagingRing(pTknGfxContext);
+    // After the staging ring, the flushed uploads may still reference retired buffers
+    tknCleanupRetiredResources(pTknGfxContext);
     tknCleanupVkCommandBuffers(pTknGfxContext);
+    tknCleanupGpuProfiler(pTknGfxContext);
+    tknCleanupSecondaryCommandPools(pTknGfxContext);
     tknCleanupCommandPools(pTknGfxContext);
     tknCleanupSignals(pTknGfxContext);
     tknDestroySwapchainAttachmentPtr(pTknGfxContext);
+    tknCleanupMemoryAllocator(pTknGfxContext);
+    tknDestroyWorkerPoolPtr(pTknGfxContext->pTknWorkerPool);
+    tknCleanupPipelineCache(pTknGfxContext);
     tknCleanupLogicalDevice(pTknGfxContext);
     tknFree(pTknGfxContext);
+    tknDestroyScratchArena();
+}
+static void tknFlushFrameResources(TknGfxContext *pTknGfxContext, uint32_t frameIndex)
+{
+    // Iterate backwards, flushing the last frame of a resource removes it from the dirty set
+    for (uint32_t uniformBufferPtrIndex = pTknGfxContext->tknDirtyUniformBufferPtrHashSet.count; uniformBufferPtrIndex > 0; uniformBufferPtrIndex--)
+    {
+        TknUniformBuffer *pTknUniformBuffer = *(TknUniformBuffer **)tknGetFromHashSet(&pTknGfxContext->tknDirtyUniformBufferPtrHashSet, uniformBufferPtrIndex - 1);
+        tknFlushUniformBufferPtr(pTknGfxContext, pTknUniformBuffer, frameIndex);
+    }
+    for (uint32_t dynamicBufferPtrIndex = pTknGfxContext->tknDirtyDynamicBufferPtrHashSet.count; dynamicBufferPtrIndex > 0; dynamicBufferPtrIndex--)
+    {
+        TknDynamicBuffer *pTknDynamicBuffer = *(TknDynamicBuffer **)tknGetFromHashSet(&pTknGfxContext->tknDirtyDynamicBufferPtrHashSet, dynamicBufferPtrIndex - 1);
+        tknFlushDynamicBufferPtr(pTknGfxContext, pTknDynamicBuffer, frameIndex);
+    }
+    for (uint32_t instancePtrIndex = pTknGfxContext->tknDirtyInstancePtrHashSet.count; instancePtrIndex > 0; instancePtrIndex--)
+    {
+        TknInstance *pTknInstance = *(TknInstance **)tknGetFromHashSet(&pTknGfxContext->tknDirtyInstancePtrHashSet, instancePtrIndex - 1);
+        tknFlushInstancePtr(pTknGfxContext, pTknInstance, frameIndex);
+    }
+    for (uint32_t materialPtrIndex = pTknGfxContext->tknDirtyMaterialPtrHashSet.count; materialPtrIndex > 0; materialPtrIndex--)
+    {
+        TknMaterial *pTknMaterial = *(TknMaterial **)tknGetFromHashSet(&pTknGfxContext->tknDirtyMaterialPtrHashSet, materialPtrIndex - 1);
+        tknFlushMaterialPtr(pTknGfxContext, pTknMaterial, frameIndex);
+    }
+}
+// The subpass or render pass changed, every set is rebound with the next draw
+static void tknForgetBoundDescriptorSets(TknFrame *pTknFrame)
+{
+    for (uint32_t setIndex = 0; setIndex < TKN_MAX_DESCRIPTOR_SET; setIndex++)
+    {
+        pTknFrame->boundVkDescriptorSets[setIndex] = VK_NULL_HANDLE;
+    }
+}
+
+// A new command buffer starts with nothing bound, and a primary one knows nothing after executing secondaries
+void tknForgetBoundState(TknFrame *pTknFrame)
+{
+    tknForgetBoundDescriptorSets(pTknFrame);
+    for (uint32_t bindingIndex = 0; bindingIndex < TKN_MAX_VERTEX_BINDING_DESCRIPTION; bindingIndex++)
+    {
+        pTknFrame->boundVertexVkBuffers[bindingIndex] = VK_NULL_HANDLE;
+        pTknFrame->boundVertexOffsets[bindingIndex] = 0;
+    }
+    pTknFrame->boundIndexVkBuffer = VK_NULL_HANDLE;
+    pTknFrame->boundVkIndexType = VK_INDEX_TYPE_UINT16;
+}
+
+// The frame's copy is written in full from the latest camera, no dirty tracking needed since every field may change each frame
+static void tknWriteFrameConstants(TknGfxContext *pTknGfxContext, uint32_t frameIndex, VkExtent2D tknSwapchainExtent)
+{
+    TknFrameConstants *pTknFrameConstants = &pTknGfxContext->tknFrameConstants;
+    pTknFrameConstants->time = (float)((tknGetTimeMilliseconds() - pTknGfxContext->tknStartTimeMilliseconds) / 1000.0);
+    pTknFrameConstants->frameCount = (int32_t)pTknGfxContext->tknFrameCount;
+    pTknFrameConstants->screenWidth = (int32_t)tknSwapchainExtent.width;
+    pTknFrameConstants->screenHeight = (int32_t)tknSwapchainExtent.height;
+    TknDynamicBuffer *pTknDynamicBuffer = pTknGfxContext->pTknFrameConstantsDynamicBuffer;
+    memcpy((char *)pTknDynamicBuffer->mapped + frameIndex * pTknDynamicBuffer->frameStride, pTknFrameConstants, sizeof(TknFrameConstants));
 }
+
+void tknSetFrameCamera(TknGfxContext *pTknGfxContext, const float *view, const float *proj, float nearPlane, float farPlane, float fov)
+{
+    TknFrameConstants *pTknFrameConstants = &pTknGfxContext->tknFrameConstants;
+    memcpy(pTknFrameConstants->view, view, sizeof(pTknFrameConstants->view));
+    memcpy(pTknFrameConstants->proj, proj, sizeof(pTknFrameConstants->proj));
+    pTknFrameConstants->nearPlane = nearPlane;
+    pTknFrameConstants->farPlane = farPlane;
+    pTknFrameConstants->fov = fov;
+}
+
 TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapchainExtent)
 {
     TknSwapchainAttachment *pTknSwapchainAttachment = &pTknGfxContext->pTknSwapchainAttachment->tknAttachmentUnion.tknSwapchainAttachment;
@@ -746,6 +1015,17 @@ TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapch
     pTknGfxContext->tknFrameCount++;
     uint32_t swapchainIndex = pTknGfxContext->tknFrameCount % pTknSwapchainAttachment->tknSwapchainImageCount;
     VkDevice vkDevice = pTknGfxContext->vkDevice;
+    uint32_t frameIndex = pTknGfxContext->tknFrameIndex;
+    TknFrame *pTknFrame = &pTknGfxContext->tknFrames[frameIndex];
+    // The GPU must be done with this frame's command buffer and per-frame copies before they are reused
+    tknWaitGfxRenderFence(pTknGfxContext);
+    tknReleaseRetiredResources(pTknGfxContext, frameIndex);
+    tknResetSecondaryCommandPools(pTknGfxContext, frameIndex);
+    tknResetArena(&pTknFrame->tknArena);
+    tknResetScratchArena();
+    tknFlushFrameResources(pTknGfxContext, frameIndex);
+    tknWriteFrameConstants(pTknGfxContext, frameIndex, tknSwapchainExtent);
+    tknRetireTransfers(pTknGfxContext, false);
 
     if (tknSwapchainExtent.width != pTknSwapchainAttachment->tknSwapchainExtent.width || tknSwapchainExtent.height != pTknSwapchainAttachment->tknSwapchainExtent.height)
     {
@@ -758,41 +1038,26 @@ TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapch
 
         TknDynamicArray dirtyRenderPassPtrDynamicArray = tknCreateDynamicArray(sizeof(TknRenderPass *), TKN_DEFAULT_COLLECTION_SIZE);
 
-        for (uint32_t i = 0; i < pTknGfxContext->tknDynamicAttachmentPtrHashSet.capacity; i++)
+        for (uint32_t attachmentPtrIndex = 0; attachmentPtrIndex < pTknGfxContext->tknDynamicAttachmentPtrHashSet.count; attachmentPtrIndex++)
         {
-            TknListNode *pDynamicAttachmentPtrNode = pTknGfxContext->tknDynamicAttachmentPtrHashSet.nodePtrs[i];
-            while (pDynamicAttachmentPtrNode)
+            TknAttachment *pDynamicAttachment = *(TknAttachment **)tknGetFromHashSet(&pTknGfxContext->tknDynamicAttachmentPtrHashSet, attachmentPtrIndex);
+            tknResizeDynamicAttachmentPtr(pTknGfxContext, pDynamicAttachment);
+            for (uint32_t renderPassPtrIndex = 0; renderPassPtrIndex < pDynamicAttachment->tknRenderPassPtrHashSet.count; renderPassPtrIndex++)
             {
-                TknAttachment *pDynamicAttachment = *(TknAttachment **)pDynamicAttachmentPtrNode->data;
-                tknResizeDynamicAttachmentPtr(pTknGfxContext, pDynamicAttachment);
-                for (uint32_t i = 0; i < pDynamicAttachment->tknRenderPassPtrHashSet.capacity; i++)
+                TknRenderPass *pTknRenderPass = *(TknRenderPass **)tknGetFromHashSet(&pDynamicAttachment->tknRenderPassPtrHashSet, renderPassPtrIndex);
+                if (!tknContainsInDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass))
                 {
-                    TknListNode *renderPassPtrNode = pDynamicAttachment->tknRenderPassPtrHashSet.nodePtrs[i];
-                    while (renderPassPtrNode)
-                    {
-                        TknRenderPass *pTknRenderPass = *(TknRenderPass **)renderPassPtrNode->data;
-                        if (!tknContainsInDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass))
-                        {
-                            tknAddToDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass);
-                        }
-                        renderPassPtrNode = renderPassPtrNode->pNextNode;
-                    }
+                    tknAddToDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass);
                 }
-                pDynamicAttachmentPtrNode = pDynamicAttachmentPtrNode->pNextNode;
             }
         }
 
-        for (uint32_t i = 0; i < pTknGfxContext->pTknSwapchainAttachment->tknRenderPassPtrHashSet.capacity; i++)
+        for (uint32_t renderPassPtrIndex = 0; renderPassPtrIndex < pTknGfxContext->pTknSwapchainAttachment->tknRenderPassPtrHashSet.count; renderPassPtrIndex++)
         {
-            TknListNode *renderPassPtrNode = pTknGfxContext->pTknSwapchainAttachment->tknRenderPassPtrHashSet.nodePtrs[i];
-            while (renderPassPtrNode)
+            TknRenderPass *pTknRenderPass = *(TknRenderPass **)tknGetFromHashSet(&pTknGfxContext->pTknSwapchainAttachment->tknRenderPassPtrHashSet, renderPassPtrIndex);
+            if (!tknContainsInDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass))
             {
-                TknRenderPass *pTknRenderPass = *(TknRenderPass **)renderPassPtrNode->data;
-                if (!tknContainsInDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass))
-                {
-                    tknAddToDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass);
-                }
-                renderPassPtrNode = renderPassPtrNode->pNextNode;
+                tknAddToDynamicArray(&dirtyRenderPassPtrDynamicArray, &pTknRenderPass);
             }
         }
         for (uint32_t renderPassIndex = 0; renderPassIndex < dirtyRenderPassPtrDynamicArray.count; renderPassIndex++)
@@ -801,16 +1066,16 @@ TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapch
             tknRepopulateFramebuffers(pTknGfxContext, pTknRenderPass);
         }
         tknDestroyDynamicArray(dirtyRenderPassPtrDynamicArray);
-        pTknGfxContext->pTknFrame->vkCommandBuffer = NULL;
-        pTknGfxContext->pTknFrame->swapchainIndex = -1;
-        pTknGfxContext->pTknFrame->pTknRenderPass = NULL;
-        pTknGfxContext->pTknFrame->subpassIndex = -1;
-        pTknGfxContext->pTknFrame->pTknPipeline = NULL;
+        pTknFrame->vkCommandBuffer = NULL;
+        pTknFrame->swapchainIndex = -1;
+        pTknFrame->pTknRenderPass = NULL;
+        pTknFrame->subpassIndex = -1;
+        pTknFrame->pTknPipeline = NULL;
         return NULL;
     }
     else
     {
-        VkResult result = vkAcquireNextImageKHR(vkDevice, pTknSwapchainAttachment->vkSwapchain, UINT64_MAX, pTknGfxContext->vkImageAvailableSemaphore, VK_NULL_HANDLE, &swapchainIndex);
+        VkResult result = vkAcquireNextImageKHR(vkDevice, pTknSwapchainAttachment->vkSwapchain, UINT64_MAX, pTknGfxContext->vkImageAvailableSemaphores[frameIndex], VK_NULL_HANDLE, &swapchainIndex);
         if (result != VK_SUCCESS)
         {
             if (VK_ERROR_OUT_OF_DATE_KHR == result || VK_SUBOPTIMAL_KHR == result)
@@ -818,22 +1083,17 @@ TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapch
                 printf("Recreate swapchain because of result: %d\n", result);
                 tknUpdateSwapchainAttachmentPtr(pTknGfxContext, pTknSwapchainAttachment->tknSwapchainExtent);
 
-                for (uint32_t i = 0; i < pTknGfxContext->tknRenderPassPtrHashSet.capacity; i++)
+                for (uint32_t renderPassPtrIndex = 0; renderPassPtrIndex < pTknGfxContext->tknRenderPassPtrHashSet.count; renderPassPtrIndex++)
                 {
-                    TknListNode *node = pTknGfxContext->tknRenderPassPtrHashSet.nodePtrs[i];
-                    while (node)
+                    TknRenderPass *pTknRenderPass = *(TknRenderPass **)tknGetFromHashSet(&pTknGfxContext->tknRenderPassPtrHashSet, renderPassPtrIndex);
+                    TknAttachment *pTknSwapchainAttachment = tknGetSwapchainAttachmentPtr(pTknGfxContext);
+                    if (tknContainsInHashSet(&pTknSwapchainAttachment->tknRenderPassPtrHashSet, &pTknRenderPass))
+                    {
+                        tknRepopulateFramebuffers(pTknGfxContext, pTknRenderPass);
+                    }
+                    else
                     {
-                        TknRenderPass *pTknRenderPass = *(TknRenderPass **)node->data;
-                        TknAttachment *pTknSwapchainAttachment = tknGetSwapchainAttachmentPtr(pTknGfxContext);
-                        if (tknContainsInHashSet(&pTknSwapchainAttachment->tknRenderPassPtrHashSet, &pTknRenderPass))
-                        {
-                            tknRepopulateFramebuffers(pTknGfxContext, pTknRenderPass);
-                        }
-                        else
-                        {
-                            // Don't need to recreate framebuffers
-                        }
-                        node = node->pNextNode;
+                        // Don't need to recreate framebuffers
                     }
                 }
             }
@@ -841,18 +1101,17 @@ TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapch
             {
                 tknAssertVkResult(result);
             }
-            pTknGfxContext->pTknFrame->vkCommandBuffer = NULL;
-            pTknGfxContext->pTknFrame->swapchainIndex = -1;
-            pTknGfxContext->pTknFrame->pTknRenderPass = NULL;
-            pTknGfxContext->pTknFrame->subpassIndex = -1;
-            pTknGfxContext->pTknFrame->pTknPipeline = NULL;
+            pTknFrame->vkCommandBuffer = NULL;
+            pTknFrame->swapchainIndex = -1;
+            pTknFrame->pTknRenderPass = NULL;
+            pTknFrame->subpassIndex = -1;
+            pTknFrame->pTknPipeline = NULL;
             return NULL;
         }
         else
         {
             // Acquired image successfully, proceed with rendering
-            tknAssertVkResult(vkResetFences(vkDevice, 1, &pTknGfxContext->vkRenderFinishedFence));
-            VkCommandBuffer vkCommandBuffer = pTknGfxContext->vkGfxCommandBuffers[swapchainIndex];
+            VkCommandBuffer vkCommandBuffer = pTknGfxContext->vkGfxCommandBuffers[frameIndex];
             VkCommandBufferBeginInfo vkCommandBufferBeginInfo =
                 {
                     .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -862,12 +1121,17 @@ TknFrame *tknAcquireFramePtr(TknGfxContext *pTknGfxContext, VkExtent2D tknSwapch
                 };
             tknAssertVkResult(vkBeginCommandBuffer(vkCommandBuffer, &vkCommandBufferBeginInfo));
 
-            pTknGfxContext->pTknFrame->vkCommandBuffer = vkCommandBuffer;
-            pTknGfxContext->pTknFrame->swapchainIndex = swapchainIndex;
-            pTknGfxContext->pTknFrame->pTknRenderPass = NULL;
-            pTknGfxContext->pTknFrame->subpassIndex = -1;
-            pTknGfxContext->pTknFrame->pTknPipeline = NULL;
-            return pTknGfxContext->pTknFrame;
+            pTknFrame->vkCommandBuffer = vkCommandBuffer;
+            tknBeginGpuProfilerFrame(pTknGfxContext, pTknFrame);
+            pTknFrame->swapchainIndex = swapchainIndex;
+            pTknFrame->pTknRenderPass = NULL;
+            pTknFrame->subpassIndex = -1;
+            pTknFrame->vkSubpassContents = VK_SUBPASS_CONTENTS_INLINE;
+            pTknFrame->pTknPipeline = NULL;
+            tknForgetBoundState(pTknFrame);
+            pTknFrame->tknFrameStats = (TknFrameStats){0};
+            pTknGfxContext->isFrameRecording = true;
+            return pTknFrame;
         }
     }
 }
@@ -875,28 +1139,47 @@ void tknSubmitAndPresentFramePtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFr
 {
     TknSwapchainAttachment *pTknSwapchainAttachment = &pTknGfxContext->pTknSwapchainAttachment->tknAttachmentUnion.tknSwapchainAttachment;
 
+    uint32_t frameIndex = pTknFrame->frameIndex;
     tknAssertVkResult(vkEndCommandBuffer(pTknFrame->vkCommandBuffer));
-    // Submit
+    // Submit, the fence is only reset here so that it is never left unsignaled without pending work
+    VkFence vkRenderFinishedFence = pTknGfxContext->vkRenderFinishedFences[frameIndex];
+    tknAssertVkResult(vkResetFences(pTknGfxContext->vkDevice, 1, &vkRenderFinishedFence));
+    // Uploads recorded during this frame go first in the same submission, their slice of the staging ring is fenced with the frame
+    VkCommandBuffer vkCommandBuffers[2];
+    uint32_t commandBufferCount = 0;
+    VkCommandBuffer vkUploadCommandBuffer = tknEndUploadCommandBuffer(pTknGfxContext);
+    if (vkUploadCommandBuffer != NULL)
+    {
+        vkCommandBuffers[commandBufferCount++] = vkUploadCommandBuffer;
+    }
+    else
+    {
+        // Nothing uploaded this frame
+    }
+    vkCommandBuffers[commandBufferCount++] = pTknFrame->vkCommandBuffer;
     VkSubmitInfo submitInfo = {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
         .pNext = NULL,
         .waitSemaphoreCount = 1,
-        .pWaitSemaphores = (VkSemaphore[]){pTknGfxContext->vkImageAvailableSemaphore},
+        .pWaitSemaphores = (VkSemaphore[]){pTknGfxContext->vkImageAvailableSemaphores[frameIndex]},
         .pWaitDstStageMask = (VkPipelineStageFlags[]){VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT},
-        .commandBufferCount = 1,
-        .pCommandBuffers = &pTknFrame->vkCommandBuffer,
+        .commandBufferCount = commandBufferCount,
+        .pCommandBuffers = vkCommandBuffers,
         .signalSemaphoreCount = 1,
-        .pSignalSemaphores = (VkSemaphore[]){pTknGfxContext->vkRenderFinishedSemaphore},
+        .pSignalSemaphores = (VkSemaphore[]){pTknGfxContext->vkRenderFinishedSemaphores[frameIndex]},
     };
 
-    tknAssertVkResult(vkQueueSubmit(pTknGfxContext->vkGfxQueue, 1, &submitInfo, pTknGfxContext->vkRenderFinishedFence));
+    tknAssertVkResult(vkQueueSubmit(pTknGfxContext->vkGfxQueue, 1, &submitInfo, vkRenderFinishedFence));
+    pTknGfxContext->isFrameRecording = false;
+    tknSubmitRetiredResources(pTknGfxContext, frameIndex);
+    pTknGfxContext->tknFrameIndex = (frameIndex + 1) % pTknGfxContext->tknFrameInFlightCount;
 
     // Present
     VkPresentInfoKHR presentInfo = {
         .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
         .pNext = NULL,
         .waitSemaphoreCount = 1,
-        .pWaitSemaphores = (VkSemaphore[]){pTknGfxContext->vkRenderFinishedSemaphore},
+        .pWaitSemaphores = (VkSemaphore[]){pTknGfxContext->vkRenderFinishedSemaphores[frameIndex]},
         .swapchainCount = 1,
         .pSwapchains = (VkSwapchainKHR[]){pTknSwapchainAttachment->vkSwapchain},
         .pImageIndices = &pTknFrame->swapchainIndex,
@@ -913,6 +1196,21 @@ void tknSubmitAndPresentFramePtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFr
     }
 }
 
+void *tknAllocateFrameMemory(TknFrame *pTknFrame, size_t size)
+{
+    return tknAllocateFromArena(&pTknFrame->tknArena, size);
+}
+
+uint32_t tknGetFrameIndex(TknFrame *pTknFrame)
+{
+    return pTknFrame->frameIndex;
+}
+
+TknFrameStats tknGetFrameStats(TknFrame *pTknFrame)
+{
+    return pTknFrame->tknFrameStats;
+}
+
 void tknResetFrameSyncPrimitivesPtr(TknGfxContext *pTknGfxContext)
 {
     VkDevice vkDevice = pTknGfxContext->vkDevice;
@@ -921,27 +1219,143 @@ void tknResetFrameSyncPrimitivesPtr(TknGfxContext *pTknGfxContext)
     tknPopulateSignals(pTknGfxContext);
 }
 
+// Only waits for the frame that is about to be recorded, the other frames in flight keep running on the GPU
 void tknWaitGfxRenderFence(TknGfxContext *pTknGfxContext)
 {
-    tknAssertVkResult(vkWaitForFences(pTknGfxContext->vkDevice, 1, &pTknGfxContext->vkRenderFinishedFence, VK_TRUE, UINT64_MAX));
+    tknAssertVkResult(vkWaitForFences(pTknGfxContext->vkDevice, 1, &pTknGfxContext->vkRenderFinishedFences[pTknGfxContext->tknFrameIndex], VK_TRUE, UINT64_MAX));
+}
+// Needed before destroying objects that are not retired, such as attachments and pipelines
+void tknWaitGfxFramesInFlight(TknGfxContext *pTknGfxContext)
+{
+    tknRetireTransfers(pTknGfxContext, true);
+    tknFlushUploads(pTknGfxContext);
+    tknAssertVkResult(vkWaitForFences(pTknGfxContext->vkDevice, pTknGfxContext->tknFrameInFlightCount, pTknGfxContext->vkRenderFinishedFences, VK_TRUE, UINT64_MAX));
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        tknReleaseRetiredResources(pTknGfxContext, frameIndex);
+    }
+}
+uint32_t tknGetAllFramesMask(TknGfxContext *pTknGfxContext)
+{
+    return (1u << pTknGfxContext->tknFrameInFlightCount) - 1;
 }
 void tknWaitGfxDeviceIdle(TknGfxContext *pTknGfxContext)
 {
     tknAssertVkResult(vkDeviceWaitIdle(pTknGfxContext->vkDevice));
 }
 
-void tknBeginRenderPassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknRenderPass *pTknRenderPass)
+// Binds each run of consecutive sets that differ from what is bound, along with the dynamic offsets of the sets in the run.
+// drawOffsets are the element offsets of the pipeline set
+static void tknBindDescriptorSets(TknFrame *pTknFrame, VkPipelineLayout vkPipelineLayout, uint32_t setCount, TknMaterial *const *tknMaterialPtrs, uint32_t drawOffsetCount, const uint32_t *drawOffsets)
+{
+    uint32_t frameIndex = pTknFrame->frameIndex;
+    VkDescriptorSet vkDescriptorSets[TKN_MAX_DESCRIPTOR_SET];
+    uint32_t dynamicOffsets[TKN_MAX_DESCRIPTOR_SET * TKN_MAX_DYNAMIC_OFFSET_COUNT];
+    uint32_t dynamicOffsetCount = 0;
+    uint32_t firstChangedSetIndex = UINT32_MAX;
+    for (uint32_t setIndex = 0; setIndex <= setCount; setIndex++)
+    {
+        bool isChanged = false;
+        if (setIndex < setCount)
+        {
+            vkDescriptorSets[setIndex] = tknMaterialPtrs[setIndex]->vkDescriptorSets[frameIndex];
+            isChanged = vkDescriptorSets[setIndex] != pTknFrame->boundVkDescriptorSets[setIndex];
+            if (TKN_PIPELINE_DESCRIPTOR_SET == setIndex && drawOffsetCount > 0 && !isChanged)
+            {
+                // Same set at another element
+                isChanged = 0 != memcmp(drawOffsets, pTknFrame->boundDynamicOffsets, sizeof(uint32_t) * drawOffsetCount);
+            }
+            else
+            {
+                // Sets other than the pipeline set always take the same offsets within a frame
+            }
+        }
+        else
+        {
+            // Past the last set, flushes the pending run
+        }
+        if (isChanged)
+        {
+            pTknFrame->boundVkDescriptorSets[setIndex] = vkDescriptorSets[setIndex];
+            pTknFrame->tknFrameStats.emittedBindCount++;
+            if (TKN_PIPELINE_DESCRIPTOR_SET == setIndex && drawOffsetCount > 0)
+            {
+                memcpy(pTknFrame->boundDynamicOffsets, drawOffsets, sizeof(uint32_t) * drawOffsetCount);
+                dynamicOffsetCount += tknGetMaterialDynamicOffsets(tknMaterialPtrs[setIndex], frameIndex, drawOffsets, &dynamicOffsets[dynamicOffsetCount]);
+            }
+            else
+            {
+                dynamicOffsetCount += tknGetMaterialDynamicOffsets(tknMaterialPtrs[setIndex], frameIndex, NULL, &dynamicOffsets[dynamicOffsetCount]);
+            }
+            if (UINT32_MAX == firstChangedSetIndex)
+            {
+                firstChangedSetIndex = setIndex;
+            }
+            else
+            {
+                // Extends the current run
+            }
+        }
+        else
+        {
+            if (UINT32_MAX != firstChangedSetIndex)
+            {
+                vkCmdBindDescriptorSets(pTknFrame->vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipelineLayout, firstChangedSetIndex, setIndex - firstChangedSetIndex, &vkDescriptorSets[firstChangedSetIndex], dynamicOffsetCount, dynamicOffsets);
+                firstChangedSetIndex = UINT32_MAX;
+                dynamicOffsetCount = 0;
+            }
+            else
+            {
+                // No run pending
+            }
+            if (setIndex < setCount)
+            {
+                pTknFrame->tknFrameStats.skippedBindCount++;
+            }
+            else
+            {
+                // Past the last set
+            }
+        }
+    }
+}
+
+static void tknBindVertexBuffers(TknFrame *pTknFrame, uint32_t bindingCount, const VkBuffer *vkBuffers, const VkDeviceSize *offsets)
+{
+    for (uint32_t bindingIndex = 0; bindingIndex < bindingCount; bindingIndex++)
+    {
+        if (vkBuffers[bindingIndex] != pTknFrame->boundVertexVkBuffers[bindingIndex] || offsets[bindingIndex] != pTknFrame->boundVertexOffsets[bindingIndex])
+        {
+            vkCmdBindVertexBuffers(pTknFrame->vkCommandBuffer, bindingIndex, 1, &vkBuffers[bindingIndex], &offsets[bindingIndex]);
+            pTknFrame->boundVertexVkBuffers[bindingIndex] = vkBuffers[bindingIndex];
+            pTknFrame->boundVertexOffsets[bindingIndex] = offsets[bindingIndex];
+            pTknFrame->tknFrameStats.emittedBindCount++;
+        }
+        else
+        {
+            pTknFrame->tknFrameStats.skippedBindCount++;
+        }
+    }
+}
+
+static void tknBindIndexBuffer(TknFrame *pTknFrame, VkBuffer vkBuffer, VkIndexType vkIndexType)
+{
+    if (vkBuffer != pTknFrame->boundIndexVkBuffer || vkIndexType != pTknFrame->boundVkIndexType)
+    {
+        vkCmdBindIndexBuffer(pTknFrame->vkCommandBuffer, vkBuffer, 0, vkIndexType);
+        pTknFrame->boundIndexVkBuffer = vkBuffer;
+        pTknFrame->boundVkIndexType = vkIndexType;
+        pTknFrame->tknFrameStats.emittedBindCount++;
+    }
+    else
+    {
+        pTknFrame->tknFrameStats.skippedBindCount++;
+    }
+}
+
+// Dynamic viewport and scissor covering the render area, secondary command buffers do not inherit them
+void tknSetRenderAreaViewport(VkCommandBuffer vkCommandBuffer, TknRenderPass *pTknRenderPass)
 {
-    VkRenderPassBeginInfo renderPassBeginInfo = {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .pNext = NULL,
-        .renderPass = pTknRenderPass->vkRenderPass,
-        .framebuffer = pTknRenderPass->vkFramebuffers[pTknFrame->swapchainIndex],
-        .renderArea = pTknRenderPass->tknRenderArea,
-        .clearValueCount = pTknRenderPass->tknAttachmentCount,
-        .pClearValues = pTknRenderPass->vkClearValues,
-    };
-    vkCmdBeginRenderPass(pTknFrame->vkCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
     VkViewport vkViewport = {
         .x = 0.0f,
         .y = 0.0f,
@@ -950,35 +1364,197 @@ void tknBeginRenderPassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, T
         .minDepth = 0.0f,
         .maxDepth = 1.0f,
     };
-    vkCmdSetViewport(pTknFrame->vkCommandBuffer, 0, 1, &vkViewport);
+    vkCmdSetViewport(vkCommandBuffer, 0, 1, &vkViewport);
 
     VkRect2D scissor = {
         .offset = {0, 0},
         .extent = pTknRenderPass->tknRenderArea.extent,
     };
-    vkCmdSetScissor(pTknFrame->vkCommandBuffer, 0, 1, &scissor);
+    vkCmdSetScissor(vkCommandBuffer, 0, 1, &scissor);
+}
+
+void tknBeginRenderPassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknRenderPass *pTknRenderPass, VkSubpassContents vkSubpassContents)
+{
+    VkRenderPassBeginInfo renderPassBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .pNext = NULL,
+        .renderPass = pTknRenderPass->vkRenderPass,
+        .framebuffer = pTknRenderPass->vkFramebuffers[pTknFrame->swapchainIndex],
+        .renderArea = pTknRenderPass->tknRenderArea,
+        .clearValueCount = pTknRenderPass->tknAttachmentCount,
+        .pClearValues = pTknRenderPass->vkClearValues,
+    };
+    tknBeginGpuRenderPassProfile(pTknGfxContext, pTknFrame, pTknRenderPass);
+    vkCmdBeginRenderPass(pTknFrame->vkCommandBuffer, &renderPassBeginInfo, vkSubpassContents);
+    tknSetRenderAreaViewport(pTknFrame->vkCommandBuffer, pTknRenderPass);
 
     pTknFrame->pTknRenderPass = pTknRenderPass;
     pTknFrame->subpassIndex = 0;
+    pTknFrame->vkSubpassContents = vkSubpassContents;
     pTknFrame->pTknPipeline = NULL;
+    tknForgetBoundDescriptorSets(pTknFrame);
 }
 
 void tknEndRenderPassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame)
 {
     vkCmdEndRenderPass(pTknFrame->vkCommandBuffer);
+    tknEndGpuRenderPassProfile(pTknGfxContext, pTknFrame);
     pTknFrame->pTknRenderPass = NULL;
     pTknFrame->subpassIndex = 0;
+    pTknFrame->vkSubpassContents = VK_SUBPASS_CONTENTS_INLINE;
     pTknFrame->pTknPipeline = NULL;
 }
 
-void tknNextSubpassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame)
+void tknNextSubpassPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, VkSubpassContents vkSubpassContents)
 {
     tknAssert(pTknFrame->pTknRenderPass != NULL, "Cannot go to next subpass when no render pass is active.");
     tknAssert(pTknFrame->subpassIndex + 1 < pTknFrame->pTknRenderPass->tknSubpassCount, "Cannot go to next subpass, already at last subpass.");
 
-    vkCmdNextSubpass(pTknFrame->vkCommandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+    // Subpasses recorded in secondary command buffers take no commands of their own, the boundary is timestamped on the inline side
+    uint32_t nextSubpassIndex = pTknFrame->subpassIndex + 1;
+    if (VK_SUBPASS_CONTENTS_INLINE == pTknFrame->vkSubpassContents)
+    {
+        tknWriteGpuSubpassTimestamp(pTknGfxContext, pTknFrame, nextSubpassIndex);
+    }
+    else
+    {
+        // Written after the transition if the next subpass is inline
+    }
+    vkCmdNextSubpass(pTknFrame->vkCommandBuffer, vkSubpassContents);
+    if (VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS == pTknFrame->vkSubpassContents && VK_SUBPASS_CONTENTS_INLINE == vkSubpassContents)
+    {
+        tknWriteGpuSubpassTimestamp(pTknGfxContext, pTknFrame, nextSubpassIndex);
+        // Executed secondaries leave the dynamic state undefined
+        tknSetRenderAreaViewport(pTknFrame->vkCommandBuffer, pTknFrame->pTknRenderPass);
+    }
+    else
+    {
+        // Viewport and scissor are still the ones set at the beginning of the render pass
+    }
     pTknFrame->subpassIndex += 1;
+    pTknFrame->vkSubpassContents = vkSubpassContents;
     pTknFrame->pTknPipeline = NULL;
+    tknForgetBoundDescriptorSets(pTknFrame);
+}
+
+// Commands are read from the frame's copy of the buffer, a compute pass writing them must finish before the subpass
+static void tknRecordIndirectDrawCall(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknDrawCall *pTknDrawCall)
+{
+    uint32_t frameIndex = pTknFrame->frameIndex;
+    VkCommandBuffer vkCommandBuffer = pTknFrame->vkCommandBuffer;
+    TknMesh *pTknMesh = pTknDrawCall->pTknMesh;
+    TknInstance *pTknInstance = pTknDrawCall->pTknInstance;
+    bool isIndexed = false;
+    if (pTknMesh != NULL)
+    {
+        if (pTknInstance != NULL)
+        {
+            // Commands pick their instances with firstInstance, every written instance of the frame is bound
+            tknFlushInstancePtr(pTknGfxContext, pTknInstance, frameIndex);
+            VkBuffer vertexBuffers[] = {pTknMesh->tknVertexVkBuffer, pTknInstance->tknInstanceVkBuffer};
+            VkDeviceSize offsets[] = {0, (VkDeviceSize)frameIndex * pTknInstance->tknMaxInstanceCount * pTknInstance->pTknVertexInputLayout->stride};
+            tknBindVertexBuffers(pTknFrame, 2, vertexBuffers, offsets);
+        }
+        else
+        {
+            VkBuffer vertexBuffers[] = {pTknMesh->tknVertexVkBuffer};
+            VkDeviceSize offsets[] = {0};
+            tknBindVertexBuffers(pTknFrame, 1, vertexBuffers, offsets);
+        }
+        isIndexed = pTknMesh->tknIndexCount > 0;
+        if (isIndexed)
+        {
+            tknBindIndexBuffer(pTknFrame, pTknMesh->tknIndexVkBuffer, pTknMesh->vkIndexType);
+        }
+        else
+        {
+            // Skip
+        }
+    }
+    else
+    {
+        // Vertices come from gl_VertexIndex
+    }
+
+    VkBuffer commandVkBuffer = VK_NULL_HANDLE;
+    VkDeviceSize commandOffset = 0;
+    uint32_t commandStride = 0;
+    VkBuffer countVkBuffer = VK_NULL_HANDLE;
+    VkDeviceSize countOffset = 0;
+    TknDynamicBuffer *pCommandTknDynamicBuffer = pTknDrawCall->pCommandTknDynamicBuffer;
+    if (pCommandTknDynamicBuffer != NULL)
+    {
+        commandVkBuffer = pCommandTknDynamicBuffer->vkBuffer;
+        commandOffset = frameIndex * pCommandTknDynamicBuffer->frameStride + tknGetDynamicBufferOffset(pCommandTknDynamicBuffer, pTknDrawCall->firstIndirectCommand);
+        // Elements are padded to the storage offset alignment, which keeps the stride a multiple of 4
+        commandStride = (uint32_t)pCommandTknDynamicBuffer->elementStride;
+        TknDynamicBuffer *pCountTknDynamicBuffer = pTknDrawCall->pCountTknDynamicBuffer;
+        if (pCountTknDynamicBuffer != NULL)
+        {
+            countVkBuffer = pCountTknDynamicBuffer->vkBuffer;
+            countOffset = frameIndex * pCountTknDynamicBuffer->frameStride;
+        }
+        else
+        {
+            // Skip
+        }
+    }
+    else
+    {
+        // A compute pass wrote the commands, one copy serves every frame
+        TknStorageBuffer *pCommandTknStorageBuffer = pTknDrawCall->pCommandTknStorageBuffer;
+        commandStride = isIndexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+        commandVkBuffer = pCommandTknStorageBuffer->vkBuffer;
+        commandOffset = (VkDeviceSize)pTknDrawCall->firstIndirectCommand * commandStride;
+        if (pTknDrawCall->pCountTknStorageBuffer != NULL)
+        {
+            countVkBuffer = pTknDrawCall->pCountTknStorageBuffer->vkBuffer;
+        }
+        else
+        {
+            // Skip
+        }
+    }
+    uint32_t maxDrawCount = pTknDrawCall->maxIndirectDrawCount;
+    // Both setters only accept a count buffer when the count extension is enabled
+    if (countVkBuffer != VK_NULL_HANDLE)
+    {
+        if (isIndexed)
+        {
+            pTknGfxContext->vkCmdDrawIndexedIndirectCountKHR(vkCommandBuffer, commandVkBuffer, commandOffset, countVkBuffer, countOffset, maxDrawCount, commandStride);
+        }
+        else
+        {
+            pTknGfxContext->vkCmdDrawIndirectCountKHR(vkCommandBuffer, commandVkBuffer, commandOffset, countVkBuffer, countOffset, maxDrawCount, commandStride);
+        }
+    }
+    else if (pTknGfxContext->isMultiDrawIndirectEnabled)
+    {
+        if (isIndexed)
+        {
+            vkCmdDrawIndexedIndirect(vkCommandBuffer, commandVkBuffer, commandOffset, maxDrawCount, commandStride);
+        }
+        else
+        {
+            vkCmdDrawIndirect(vkCommandBuffer, commandVkBuffer, commandOffset, maxDrawCount, commandStride);
+        }
+    }
+    else
+    {
+        // One draw per command, the bound state is shared so this is still cheap to record
+        for (uint32_t drawIndex = 0; drawIndex < maxDrawCount; drawIndex++)
+        {
+            VkDeviceSize drawOffset = commandOffset + (VkDeviceSize)drawIndex * commandStride;
+            if (isIndexed)
+            {
+                vkCmdDrawIndexedIndirect(vkCommandBuffer, commandVkBuffer, drawOffset, 1, commandStride);
+            }
+            else
+            {
+                vkCmdDrawIndirect(vkCommandBuffer, commandVkBuffer, drawOffset, 1, commandStride);
+            }
+        }
+    }
 }
 
 void tknRecordDrawCallPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknDrawCall *pTknDrawCall)
@@ -987,6 +1563,12 @@ void tknRecordDrawCallPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, Tk
     tknAssert(pTknFrame->subpassIndex < pTknFrame->pTknRenderPass->tknSubpassCount, "Invalid subpass index in current render pass.");
     tknAssert(pTknDrawCall->pTknPipeline->pTknRenderPass == pTknFrame->pTknRenderPass, "Draw call's pipeline render pass does not match current frame render pass.");
     tknAssert(pTknDrawCall->pTknPipeline->subpassIndex == pTknFrame->subpassIndex, "Draw call's pipeline subpass index does not match current frame subpass index.");
+    tknAssert(VK_SUBPASS_CONTENTS_INLINE == pTknFrame->vkSubpassContents, "Draw calls of a subpass with secondary command buffers must go through a draw queue.");
+    if (pTknDrawCall->pTknMesh != NULL && pTknDrawCall->pTknMesh->tknUploadTicket != 0)
+    {
+        // The transfer queue still owns the mesh
+        return;
+    }
     TknMaterial *pGlobalMaterial = tknGetGlobalMaterialPtr(pTknGfxContext);
     TknMaterial *pSubpassMaterial = tknGetSubpassMaterialPtr(pTknGfxContext, pTknFrame->pTknRenderPass, pTknFrame->subpassIndex);
     TknPipeline *pTknPipeline = pTknDrawCall->pTknPipeline;
@@ -995,38 +1577,79 @@ void tknRecordDrawCallPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, Tk
     if (pTknPipeline != pTknFrame->pTknPipeline)
     {
         vkCmdBindPipeline(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pTknPipeline->vkPipeline);
+        // Pipelines of a subpass share the global and subpass set layouts, only the pipeline set is disturbed by a new layout
+        if (NULL == pTknFrame->pTknPipeline || pTknPipeline->vkPipelineLayout != pTknFrame->pTknPipeline->vkPipelineLayout)
+        {
+            pTknFrame->boundVkDescriptorSets[TKN_PIPELINE_DESCRIPTOR_SET] = VK_NULL_HANDLE;
+        }
+        else
+        {
+            // Same layout, everything stays bound
+        }
+        // Layouts are only compatible for any set when their push constant ranges are identical
+        if (NULL != pTknFrame->pTknPipeline && (pTknPipeline->pushConstantVkShaderStageFlags != pTknFrame->pTknPipeline->pushConstantVkShaderStageFlags || pTknPipeline->pushConstantSize != pTknFrame->pTknPipeline->pushConstantSize))
+        {
+            tknForgetBoundDescriptorSets(pTknFrame);
+        }
+        else
+        {
+            // Same push constant range
+        }
         pTknFrame->pTknPipeline = pTknPipeline;
     }
-    VkDescriptorSet *vkDescriptorSets = tknMalloc(sizeof(VkDescriptorSet) * TKN_MAX_DESCRIPTOR_SET);
-    vkDescriptorSets[TKN_GLOBAL_DESCRIPTOR_SET] = pGlobalMaterial->vkDescriptorSet;
-    vkDescriptorSets[TKN_SUBPASS_DESCRIPTOR_SET] = pSubpassMaterial->vkDescriptorSet;
+    uint32_t frameIndex = pTknFrame->frameIndex;
+    TknMaterial *tknMaterialPtrs[TKN_MAX_DESCRIPTOR_SET];
+    tknMaterialPtrs[TKN_GLOBAL_DESCRIPTOR_SET] = pGlobalMaterial;
+    tknMaterialPtrs[TKN_SUBPASS_DESCRIPTOR_SET] = pSubpassMaterial;
     if (pTknDrawCall->pTknMaterial != NULL)
     {
-        vkDescriptorSets[TKN_PIPELINE_DESCRIPTOR_SET] = pTknDrawCall->pTknMaterial->vkDescriptorSet;
-        vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pTknPipeline->vkPipelineLayout, 0, TKN_MAX_DESCRIPTOR_SET, vkDescriptorSets, 0, NULL);
+        tknMarkMaterialBound(pTknGfxContext, pTknDrawCall->pTknMaterial);
+        tknMaterialPtrs[TKN_PIPELINE_DESCRIPTOR_SET] = pTknDrawCall->pTknMaterial;
+        tknBindDescriptorSets(pTknFrame, pTknPipeline->vkPipelineLayout, TKN_MAX_DESCRIPTOR_SET, tknMaterialPtrs, pTknDrawCall->dynamicOffsetCount, pTknDrawCall->dynamicOffsets);
+    }
+    else
+    {
+        tknBindDescriptorSets(pTknFrame, pTknPipeline->vkPipelineLayout, TKN_MAX_DESCRIPTOR_SET - 1, tknMaterialPtrs, 0, NULL);
+    }
+    if (pTknPipeline->pushConstantSize > 0)
+    {
+        vkCmdPushConstants(vkCommandBuffer, pTknPipeline->vkPipelineLayout, pTknPipeline->pushConstantVkShaderStageFlags, 0, pTknPipeline->pushConstantSize, pTknDrawCall->pushConstants);
     }
     else
     {
-        vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pTknPipeline->vkPipelineLayout, 0, TKN_MAX_DESCRIPTOR_SET - 1, vkDescriptorSets, 0, NULL);
+        // Skip
     }
-    tknFree(vkDescriptorSets);
     TknMesh *pTknMesh = pTknDrawCall->pTknMesh;
-    if (pTknMesh != NULL)
+    if (pTknDrawCall->pCommandTknDynamicBuffer != NULL || pTknDrawCall->pCommandTknStorageBuffer != NULL)
+    {
+        tknRecordIndirectDrawCall(pTknGfxContext, pTknFrame, pTknDrawCall);
+    }
+    else if (pTknMesh != NULL)
     {
-        if (pTknDrawCall->pTknInstance != NULL && pTknDrawCall->pTknInstance->tknInstanceCount > 0)
+        TknInstance *pTknInstance = pTknDrawCall->pTknInstance;
+        if (pTknInstance != NULL)
+        {
+            tknFlushInstancePtr(pTknGfxContext, pTknInstance, frameIndex);
+        }
+        else
+        {
+            // Skip
+        }
+        if (pTknInstance != NULL && pTknInstance->tknFrameInstanceCounts[frameIndex] > 0)
         {
             tknAssert(pTknDrawCall->pTknMesh->tknVertexCount > 0, "TknMesh has no vertices");
-            VkBuffer vertexBuffers[] = {pTknMesh->tknVertexVkBuffer, pTknDrawCall->pTknInstance->tknInstanceVkBuffer};
-            VkDeviceSize offsets[] = {0, 0};
-            vkCmdBindVertexBuffers(vkCommandBuffer, 0, 2, vertexBuffers, offsets);
+            uint32_t tknInstanceCount = pTknInstance->tknFrameInstanceCounts[frameIndex];
+            VkBuffer vertexBuffers[] = {pTknMesh->tknVertexVkBuffer, pTknInstance->tknInstanceVkBuffer};
+            VkDeviceSize offsets[] = {0, (VkDeviceSize)frameIndex * pTknInstance->tknMaxInstanceCount * pTknInstance->pTknVertexInputLayout->stride};
+            tknBindVertexBuffers(pTknFrame, 2, vertexBuffers, offsets);
             if (pTknMesh->tknIndexCount > 0)
             {
-                vkCmdBindIndexBuffer(vkCommandBuffer, pTknMesh->tknIndexVkBuffer, 0, pTknMesh->vkIndexType);
-                vkCmdDrawIndexed(vkCommandBuffer, pTknMesh->tknIndexCount, pTknDrawCall->pTknInstance->tknInstanceCount, 0, 0, 0);
+                tknBindIndexBuffer(pTknFrame, pTknMesh->tknIndexVkBuffer, pTknMesh->vkIndexType);
+                vkCmdDrawIndexed(vkCommandBuffer, pTknMesh->tknIndexCount, tknInstanceCount, 0, 0, 0);
             }
             else
             {
-                vkCmdDraw(vkCommandBuffer, pTknMesh->tknVertexCount, pTknDrawCall->pTknInstance->tknInstanceCount, 0, 0);
+                vkCmdDraw(vkCommandBuffer, pTknMesh->tknVertexCount, tknInstanceCount, 0, 0);
             }
         }
         else
@@ -1034,11 +1657,11 @@ void tknRecordDrawCallPtr(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, Tk
             // Simple case: only bind vertex buffer (no instancing)
             VkBuffer vertexBuffers[] = {pTknMesh->tknVertexVkBuffer};
             VkDeviceSize offsets[] = {0};
-            vkCmdBindVertexBuffers(vkCommandBuffer, 0, 1, vertexBuffers, offsets);
+            tknBindVertexBuffers(pTknFrame, 1, vertexBuffers, offsets);
 
             if (pTknMesh->tknIndexCount > 0)
             {
-                vkCmdBindIndexBuffer(vkCommandBuffer, pTknMesh->tknIndexVkBuffer, 0, pTknMesh->vkIndexType);
+                tknBindIndexBuffer(pTknFrame, pTknMesh->tknIndexVkBuffer, pTknMesh->vkIndexType);
                 vkCmdDrawIndexed(vkCommandBuffer, pTknMesh->tknIndexCount, 1, 0, 0, 0);
             }
             else
@@ -1072,3 +1695,81 @@ void tknClearAttachments(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, uin
 {
     vkCmdClearAttachments(pTknFrame->vkCommandBuffer, clearAttachmentCount, pClearAttachments, clearRectCount, pClearRects);
 }
+
+void tknDispatch(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknComputePipeline *pTknComputePipeline, TknMaterial *pTknMaterial, const void *pushConstants, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    tknAssert(NULL == pTknFrame->pTknRenderPass, "Cannot dispatch while a render pass is active.");
+    tknAssert(NULL == pTknMaterial || pTknMaterial->pTknDescriptorSet == pTknComputePipeline->pTknPipelineDescriptorSet, "Material was not created for this compute pipeline.");
+    tknAssert(NULL != pTknMaterial || 0 == pTknComputePipeline->pTknPipelineDescriptorSet->tknDescriptorCount, "Compute pipeline declares pipeline set bindings but no material was given.");
+    VkCommandBuffer vkCommandBuffer = pTknFrame->vkCommandBuffer;
+    VkPipelineLayout vkPipelineLayout = pTknComputePipeline->vkPipelineLayout;
+    uint32_t frameIndex = pTknFrame->frameIndex;
+    // The compute bind point has its own pipeline and sets, what the frame tracks for draws stays valid
+    vkCmdBindPipeline(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pTknComputePipeline->vkPipeline);
+    uint32_t dynamicOffsets[TKN_MAX_DYNAMIC_OFFSET_COUNT];
+    TknMaterial *pGlobalMaterial = tknGetGlobalMaterialPtr(pTknGfxContext);
+    uint32_t dynamicOffsetCount = tknGetMaterialDynamicOffsets(pGlobalMaterial, frameIndex, NULL, dynamicOffsets);
+    vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipelineLayout, TKN_GLOBAL_DESCRIPTOR_SET, 1, &pGlobalMaterial->vkDescriptorSets[frameIndex], dynamicOffsetCount, dynamicOffsets);
+    if (NULL != pTknMaterial)
+    {
+        tknMarkMaterialBound(pTknGfxContext, pTknMaterial);
+        dynamicOffsetCount = tknGetMaterialDynamicOffsets(pTknMaterial, frameIndex, NULL, dynamicOffsets);
+        vkCmdBindDescriptorSets(vkCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipelineLayout, TKN_PIPELINE_DESCRIPTOR_SET, 1, &pTknMaterial->vkDescriptorSets[frameIndex], dynamicOffsetCount, dynamicOffsets);
+    }
+    else
+    {
+        // Skip
+    }
+    if (pTknComputePipeline->pushConstantSize > 0)
+    {
+        tknAssert(NULL != pushConstants, "Compute pipeline declares %u bytes of push constants but none were given.", pTknComputePipeline->pushConstantSize);
+        vkCmdPushConstants(vkCommandBuffer, vkPipelineLayout, pTknComputePipeline->pushConstantVkShaderStageFlags, 0, pTknComputePipeline->pushConstantSize, pushConstants);
+    }
+    else
+    {
+        // Skip
+    }
+    vkCmdDispatch(vkCommandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void tknBufferBarrier(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknStorageBuffer *pTknStorageBuffer, VkPipelineStageFlags srcVkPipelineStageFlags, VkAccessFlags srcVkAccessFlags, VkPipelineStageFlags dstVkPipelineStageFlags, VkAccessFlags dstVkAccessFlags)
+{
+    tknAssert(NULL == pTknFrame->pTknRenderPass, "Cannot record a buffer barrier while a render pass is active.");
+    VkBufferMemoryBarrier vkBufferMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = srcVkAccessFlags,
+        .dstAccessMask = dstVkAccessFlags,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = pTknStorageBuffer->vkBuffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    };
+    vkCmdPipelineBarrier(pTknFrame->vkCommandBuffer, srcVkPipelineStageFlags, dstVkPipelineStageFlags, 0, 0, NULL, 1, &vkBufferMemoryBarrier, 0, NULL);
+}
+
+void tknImageBarrier(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknImage *pTknImage, VkPipelineStageFlags srcVkPipelineStageFlags, VkAccessFlags srcVkAccessFlags, VkPipelineStageFlags dstVkPipelineStageFlags, VkAccessFlags dstVkAccessFlags)
+{
+    tknAssert(NULL == pTknFrame->pTknRenderPass, "Cannot record an image barrier while a render pass is active.");
+    tknAssert(0 == pTknImage->tknUploadTicket, "The transfer queue still owns the image.");
+    VkImageMemoryBarrier vkImageMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = srcVkAccessFlags,
+        .dstAccessMask = dstVkAccessFlags,
+        .oldLayout = pTknImage->vkImageLayout,
+        .newLayout = pTknImage->vkImageLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = pTknImage->vkImage,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+    vkCmdPipelineBarrier(pTknFrame->vkCommandBuffer, srcVkPipelineStageFlags, dstVkPipelineStageFlags, 0, 0, NULL, 0, NULL, 1, &vkImageMemoryBarrier);
+}
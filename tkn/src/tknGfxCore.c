@@ -5,97 +5,24 @@ void tknAssertVkResult(VkResult vkResult)
     tknAssert(vkResult == VK_SUCCESS, "Vulkan error: %d", vkResult);
 }
 
-SpvReflectShaderModule tknCreateSpvReflectShaderModule(const char *filePath)
+void tknClearBindingPtrHashSet(TknGfxContext *pTknGfxContext, TknHashSet *pTknBindingPtrHashSet)
 {
-    FILE *file = fopen(filePath, "rb");
-    if (!file)
+    // Iterate backwards because updating the material removes the binding from this set
+    for (uint32_t bindingPtrIndex = pTknBindingPtrHashSet->count; bindingPtrIndex > 0; bindingPtrIndex--)
     {
-        tknError("Failed to open file: %s\n", filePath);
-    }
-    else
-    {
-        // File opened successfully
-    }
-    fseek(file, 0, SEEK_END);
-    size_t shaderSize = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    if (shaderSize % 4 != 0)
-    {
-        fclose(file);
-        tknError("Invalid SPIR-V file size: %s\n", filePath);
-    }
-    else
-    {
-        // Valid SPIR-V file size
-    }
-    void *shaderCode = tknMalloc(shaderSize);
-    size_t bytesRead = fread(shaderCode, 1, shaderSize, file);
-
-    fclose(file);
-
-    if (bytesRead != shaderSize)
-    {
-        tknError("Failed to read entire file: %s\n", filePath);
-    }
-    else
-    {
-        // File read successfully
-    }
-    SpvReflectShaderModule spvReflectShaderModule;
-    SpvReflectResult spvReflectResult = spvReflectCreateShaderModule(shaderSize, shaderCode, &spvReflectShaderModule);
-    tknAssert(spvReflectResult == SPV_REFLECT_RESULT_SUCCESS, "Failed to reflect shader module: %s", filePath);
-    tknFree(shaderCode);
-
-    return spvReflectShaderModule;
-}
-void tknDestroySpvReflectShaderModule(SpvReflectShaderModule *pSpvReflectShaderModule)
-{
-    spvReflectDestroyShaderModule(pSpvReflectShaderModule);
-}
-
-static uint32_t tknGetMemoryTypeIndex(VkPhysicalDevice vkPhysicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags memoryPropertyFlags)
-{
-    VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
-    vkGetPhysicalDeviceMemoryProperties(vkPhysicalDevice, &physicalDeviceMemoryProperties);
-    for (uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryTypeCount; i++)
-    {
-        if ((typeFilter & (1 << i)) && (physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)
-        {
-            return i;
-        }
-        else
-        {
-            // Memory type doesn't match requirements
-        }
-    }
-    tknError("Failed to get suitable memory type!");
-    return UINT32_MAX;
-}
-
-void tknClearBindingPtrHashSet(TknGfxContext *pTknGfxContext, TknHashSet tknBindingPtrHashSet)
-{
-    for (uint32_t i = 0; i < tknBindingPtrHashSet.capacity; i++)
-    {
-        TknListNode *node = tknBindingPtrHashSet.nodePtrs[i];
-        while (node)
-        {
-            TknBinding *pTknBinding = *(TknBinding **)node->data;
-            node = node->pNextNode;
-            TknInputBinding tknInputBinding = {
-                .vkDescriptorType = pTknBinding->vkDescriptorType,
-                .tknInputBindingUnion = tknGetEmptyInputBindingUnion(pTknGfxContext, pTknBinding->vkDescriptorType),
-                .binding = pTknBinding->binding,
-            };
-            tknUpdateMaterialPtr(pTknGfxContext, pTknBinding->pTknMaterial, 1, &tknInputBinding);
-        }
+        TknBinding *pTknBinding = *(TknBinding **)tknGetFromHashSet(pTknBindingPtrHashSet, bindingPtrIndex - 1);
+        TknInputBinding tknInputBinding = {
+            .vkDescriptorType = pTknBinding->vkDescriptorType,
+            .tknInputBindingUnion = tknGetEmptyInputBindingUnion(pTknGfxContext, pTknBinding->vkDescriptorType),
+            .binding = pTknBinding->binding,
+        };
+        tknUpdateMaterialPtr(pTknGfxContext, pTknBinding->pTknMaterial, 1, &tknInputBinding);
     }
 }
 
-void tknCreateVkImage(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageTiling vkImageTiling, VkImageUsageFlags vkImageUsageFlags, VkMemoryPropertyFlags vkMemoryPropertyFlags, VkImageAspectFlags vkImageAspectFlags, VkImage *pVkImage, VkDeviceMemory *pVkDeviceMemory, VkImageView *pVkImageView)
+void tknCreateVkImage(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageTiling vkImageTiling, VkImageUsageFlags vkImageUsageFlags, VkMemoryPropertyFlags vkMemoryPropertyFlags, VkImageAspectFlags vkImageAspectFlags, TknMemoryUsage tknMemoryUsage, VkImage *pVkImage, TknMemoryAllocation *pTknMemoryAllocation, VkImageView *pVkImageView)
 {
     VkDevice vkDevice = pTknGfxContext->vkDevice;
-    VkPhysicalDevice vkPhysicalDevice = pTknGfxContext->vkPhysicalDevice;
     VkImageCreateInfo imageCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
         .pNext = NULL,
@@ -116,15 +43,8 @@ void tknCreateVkImage(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFo
     tknAssertVkResult(vkCreateImage(vkDevice, &imageCreateInfo, NULL, pVkImage));
     VkMemoryRequirements memoryRequirements;
     vkGetImageMemoryRequirements(vkDevice, *pVkImage, &memoryRequirements);
-    uint32_t memoryTypeIndex = tknGetMemoryTypeIndex(vkPhysicalDevice, memoryRequirements.memoryTypeBits, vkMemoryPropertyFlags);
-    VkMemoryAllocateInfo memoryAllocateInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = NULL,
-        .allocationSize = memoryRequirements.size,
-        .memoryTypeIndex = memoryTypeIndex,
-    };
-    tknAssertVkResult(vkAllocateMemory(vkDevice, &memoryAllocateInfo, NULL, pVkDeviceMemory));
-    tknAssertVkResult(vkBindImageMemory(vkDevice, *pVkImage, *pVkDeviceMemory, 0));
+    *pTknMemoryAllocation = tknAllocateMemory(pTknGfxContext, memoryRequirements, vkMemoryPropertyFlags, VK_IMAGE_TILING_LINEAR == vkImageTiling, tknMemoryUsage);
+    tknAssertVkResult(vkBindImageMemory(vkDevice, *pVkImage, pTknMemoryAllocation->vkDeviceMemory, pTknMemoryAllocation->offset));
 
     VkComponentMapping components = {
         .r = VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -151,18 +71,17 @@ void tknCreateVkImage(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFo
     };
     tknAssertVkResult(vkCreateImageView(vkDevice, &imageViewCreateInfo, NULL, pVkImageView));
 }
-void tknDestroyVkImage(TknGfxContext *pTknGfxContext, VkImage vkImage, VkDeviceMemory vkDeviceMemory, VkImageView vkImageView)
+void tknDestroyVkImage(TknGfxContext *pTknGfxContext, VkImage vkImage, TknMemoryAllocation tknMemoryAllocation, VkImageView vkImageView)
 {
     VkDevice vkDevice = pTknGfxContext->vkDevice;
     vkDestroyImageView(vkDevice, vkImageView, NULL);
     vkDestroyImage(vkDevice, vkImage, NULL);
-    vkFreeMemory(vkDevice, vkDeviceMemory, NULL);
+    tknFreeMemory(pTknGfxContext, tknMemoryAllocation);
 }
 
-void tknCreateVkBuffer(TknGfxContext *pTknGfxContext, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkBuffer *pVkBuffer, VkDeviceMemory *pVkDeviceMemory)
+void tknCreateVkBuffer(TknGfxContext *pTknGfxContext, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, TknMemoryUsage tknMemoryUsage, VkBuffer *pVkBuffer, TknMemoryAllocation *pTknMemoryAllocation)
 {
     VkDevice vkDevice = pTknGfxContext->vkDevice;
-    VkPhysicalDevice vkPhysicalDevice = pTknGfxContext->vkPhysicalDevice;
     VkBufferCreateInfo bufferCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .pNext = NULL,
@@ -176,21 +95,14 @@ void tknCreateVkBuffer(TknGfxContext *pTknGfxContext, VkDeviceSize bufferSize, V
     tknAssertVkResult(vkCreateBuffer(vkDevice, &bufferCreateInfo, NULL, pVkBuffer));
     VkMemoryRequirements memoryRequirements;
     vkGetBufferMemoryRequirements(vkDevice, *pVkBuffer, &memoryRequirements);
-    uint32_t memoryTypeIndex = tknGetMemoryTypeIndex(vkPhysicalDevice, memoryRequirements.memoryTypeBits, memoryPropertyFlags);
-    VkMemoryAllocateInfo memoryAllocateInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = NULL,
-        .allocationSize = memoryRequirements.size,
-        .memoryTypeIndex = memoryTypeIndex,
-    };
-    tknAssertVkResult(vkAllocateMemory(vkDevice, &memoryAllocateInfo, NULL, pVkDeviceMemory));
-    tknAssertVkResult(vkBindBufferMemory(vkDevice, *pVkBuffer, *pVkDeviceMemory, 0));
+    *pTknMemoryAllocation = tknAllocateMemory(pTknGfxContext, memoryRequirements, memoryPropertyFlags, true, tknMemoryUsage);
+    tknAssertVkResult(vkBindBufferMemory(vkDevice, *pVkBuffer, pTknMemoryAllocation->vkDeviceMemory, pTknMemoryAllocation->offset));
 }
-void tknDestroyVkBuffer(TknGfxContext *pTknGfxContext, VkBuffer vkBuffer, VkDeviceMemory vkDeviceMemory)
+void tknDestroyVkBuffer(TknGfxContext *pTknGfxContext, VkBuffer vkBuffer, TknMemoryAllocation tknMemoryAllocation)
 {
     VkDevice vkDevice = pTknGfxContext->vkDevice;
     vkDestroyBuffer(vkDevice, vkBuffer, NULL);
-    vkFreeMemory(vkDevice, vkDeviceMemory, NULL);
+    tknFreeMemory(pTknGfxContext, tknMemoryAllocation);
 }
 TknVertexInputLayout *tknCreateVertexInputLayoutPtr(TknGfxContext *pTknGfxContext, uint32_t tknAttributeCount, const char **names, uint32_t *sizes)
 {
@@ -241,6 +153,34 @@ void tknDestroyVertexInputLayoutPtr(TknGfxContext *pTknGfxContext, TknVertexInpu
     tknFree(pTknVertexInputLayout);
 }
 
+static bool tknIsDynamicBlockName(const char *typeName)
+{
+    static const char dynamicSuffix[] = "Dynamic";
+    size_t suffixLength = sizeof(dynamicSuffix) - 1;
+    size_t typeNameLength = NULL != typeName ? strlen(typeName) : 0;
+    return typeNameLength >= suffixLength && 0 == strcmp(typeName + typeNameLength - suffixLength, dynamicSuffix);
+}
+
+// SPIR-V has no dynamic buffers, the engine picks them: uniform buffers of the global set change every frame and are bound once,
+// and blocks whose type name ends in Dynamic are shared by many draws, each offsetting to its own element
+static VkDescriptorType tknGetSetDescriptorType(uint32_t set, SpvReflectDescriptorBinding *pSpvReflectDescriptorBinding)
+{
+    VkDescriptorType vkDescriptorType = (VkDescriptorType)pSpvReflectDescriptorBinding->descriptor_type;
+    bool isDynamicBlock = NULL != pSpvReflectDescriptorBinding->type_description && tknIsDynamicBlockName(pSpvReflectDescriptorBinding->type_description->type_name);
+    if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == vkDescriptorType && (TKN_GLOBAL_DESCRIPTOR_SET == set || isDynamicBlock))
+    {
+        return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    }
+    else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER == vkDescriptorType && isDynamicBlock)
+    {
+        return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    }
+    else
+    {
+        return vkDescriptorType;
+    }
+}
+
 TknDescriptorSet *tknCreateDescriptorSetPtr(TknGfxContext *pTknGfxContext, uint32_t spvReflectShaderModuleCount, SpvReflectShaderModule *spvReflectShaderModules, uint32_t set)
 {
     TknDescriptorSet *pTknDescriptorSet = tknMalloc(sizeof(TknDescriptorSet));
@@ -308,7 +248,7 @@ TknDescriptorSet *tknCreateDescriptorSetPtr(TknGfxContext *pTknGfxContext, uint3
                     uint32_t binding = pSpvReflectDescriptorBinding->binding;
                     if (VK_DESCRIPTOR_TYPE_MAX_ENUM == vkDescriptorSetLayoutBindings[binding].descriptorType)
                     {
-                        VkDescriptorType vkDescriptorType = (VkDescriptorType)pSpvReflectDescriptorBinding->descriptor_type;
+                        VkDescriptorType vkDescriptorType = tknGetSetDescriptorType(set, pSpvReflectDescriptorBinding);
 
                         VkDescriptorSetLayoutBinding vkDescriptorSetLayoutBinding = {
                             .binding = binding,
@@ -349,7 +289,7 @@ TknDescriptorSet *tknCreateDescriptorSetPtr(TknGfxContext *pTknGfxContext, uint3
                     }
                     else
                     {
-                        tknAssert(vkDescriptorSetLayoutBindings[binding].descriptorType == (VkDescriptorType)pSpvReflectDescriptorBinding->descriptor_type, "Incompatible descriptor binding");
+                        tknAssert(vkDescriptorSetLayoutBindings[binding].descriptorType == tknGetSetDescriptorType(set, pSpvReflectDescriptorBinding), "Incompatible descriptor binding");
                         vkDescriptorSetLayoutBindings[binding].stageFlags |= (VkShaderStageFlags)spvReflectShaderModule.shader_stage;
                         vkDescriptorSetLayoutBindings[binding].descriptorCount = pSpvReflectDescriptorBinding->count > vkDescriptorSetLayoutBindings[binding].descriptorCount ? pSpvReflectDescriptorBinding->count : vkDescriptorSetLayoutBindings[binding].descriptorCount;
                     }
@@ -364,6 +304,40 @@ TknDescriptorSet *tknCreateDescriptorSetPtr(TknGfxContext *pTknGfxContext, uint3
         }
     }
 
+    uint32_t tknDynamicOffsetCount = 0;
+    for (uint32_t binding = 0; binding < tknBindingCount; binding++)
+    {
+        if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorTypes[binding] || VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == vkDescriptorTypes[binding])
+        {
+            tknAssert(1 == vkDescriptorSetLayoutBindings[binding].descriptorCount, "Dynamic buffer arrays are not supported (binding %u)", binding);
+            tknDynamicOffsetCount++;
+        }
+        else
+        {
+            // Skip
+        }
+    }
+    tknAssert(tknDynamicOffsetCount <= TKN_MAX_DYNAMIC_OFFSET_COUNT, "Set %u has %u dynamic bindings, at most %u are supported", set, tknDynamicOffsetCount, TKN_MAX_DYNAMIC_OFFSET_COUNT);
+    if (TKN_GLOBAL_DESCRIPTOR_SET == set)
+    {
+        // Compute pipelines bind the global set too, but it is reflected from the graphics shaders given to the context
+        for (uint32_t binding = 0; binding < tknBindingCount; binding++)
+        {
+            if (VK_DESCRIPTOR_TYPE_MAX_ENUM != vkDescriptorTypes[binding])
+            {
+                vkDescriptorSetLayoutBindings[binding].stageFlags |= VK_SHADER_STAGE_COMPUTE_BIT;
+            }
+            else
+            {
+                // Skip
+            }
+        }
+    }
+    else
+    {
+        // Skip
+    }
+
     VkDevice vkDevice = pTknGfxContext->vkDevice;
     VkDescriptorSetLayoutCreateInfo vkDescriptorSetLayoutCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -378,39 +352,25 @@ TknDescriptorSet *tknCreateDescriptorSetPtr(TknGfxContext *pTknGfxContext, uint3
         .vkDescriptorPoolSizeDynamicArray = vkDescriptorPoolSizeDynamicArray,
         .tknDescriptorCount = tknBindingCount,
         .vkDescriptorTypes = vkDescriptorTypes,
+        .tknDynamicOffsetCount = tknDynamicOffsetCount,
         .tknMaterialPtrHashSet = tknMaterialPtrHashSet,
+        .vkDescriptorPoolDynamicArray = tknCreateDynamicArray(sizeof(VkDescriptorPool), TKN_DEFAULT_COLLECTION_SIZE),
+        .tknDescriptorSetCapacity = 0,
+        .tknPoolRemainingSetCount = 0,
+        .freeVkDescriptorSetDynamicArray = tknCreateDynamicArray(sizeof(VkDescriptorSet), TKN_DEFAULT_COLLECTION_SIZE),
     };
     return pTknDescriptorSet;
 }
 void tknDestroyDescriptorSetPtr(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet)
 {
-    // Safely destroy all materials by repeatedly taking the first one
+    // Safely destroy all materials by repeatedly taking the last one
     while (pTknDescriptorSet->tknMaterialPtrHashSet.count > 0)
     {
-        TknMaterial *pTknMaterial = NULL;
-        for (uint32_t nodeIndex = 0; nodeIndex < pTknDescriptorSet->tknMaterialPtrHashSet.capacity; nodeIndex++)
-        {
-            TknListNode *pNode = pTknDescriptorSet->tknMaterialPtrHashSet.nodePtrs[nodeIndex];
-            if (pNode)
-            {
-                pTknMaterial = *(TknMaterial **)pNode->data;
-                break;
-            }
-            else
-            {
-                // No node at this index
-            }
-        }
-        if (pTknMaterial)
-        {
-            tknDestroyMaterialPtr(pTknGfxContext, pTknMaterial);
-        }
-        else
-        {
-            break; // Safety check to avoid infinite loop
-        }
+        TknMaterial *pTknMaterial = *(TknMaterial **)tknGetFromHashSet(&pTknDescriptorSet->tknMaterialPtrHashSet, pTknDescriptorSet->tknMaterialPtrHashSet.count - 1);
+        tknDestroyMaterialPtr(pTknGfxContext, pTknMaterial);
     }
     tknDestroyHashSet(pTknDescriptorSet->tknMaterialPtrHashSet);
+    tknCleanupDescriptorPools(pTknGfxContext, pTknDescriptorSet);
     VkDevice vkDevice = pTknGfxContext->vkDevice;
     vkDestroyDescriptorSetLayout(vkDevice, pTknDescriptorSet->vkDescriptorSetLayout, NULL);
     tknDestroyDynamicArray(pTknDescriptorSet->vkDescriptorPoolSizeDynamicArray);
@@ -4,6 +4,139 @@
 #include "tknCore.h"
 #include <spirv_reflect.h>
 
+#define TKN_DEFAULT_MEMORY_BLOCK_SIZE (64ull * 1024 * 1024)
+#define TKN_DEFAULT_STAGING_SLICE_SIZE (8ull * 1024 * 1024)
+#define TKN_DEFAULT_WORKER_THREAD_COUNT 3
+// Fewer draws than this per secondary command buffer cost more in recording overhead than they gain in parallelism
+#define TKN_MIN_SECONDARY_DRAW_COUNT 32
+// Descriptor pools of a layout double in size as materials are created, up to this many sets per pool
+#define TKN_MAX_DESCRIPTOR_POOL_SET_COUNT 1024
+
+// One VkDeviceMemory that resources are sub-allocated from, host visible blocks stay mapped for their lifetime
+typedef struct
+{
+    VkDeviceMemory vkDeviceMemory;
+    VkDeviceSize size;
+    uint32_t memoryTypeIndex;
+    bool isLinear;
+    bool isDedicated;
+    void *mapped;
+    TknTlsf tknTlsf;
+} TknMemoryBlock;
+
+typedef struct
+{
+    TknMemoryBlock *pTknMemoryBlock;
+    uint32_t tlsfNodeIndex;
+    VkDeviceMemory vkDeviceMemory;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    void *mapped;
+    TknMemoryUsage tknMemoryUsage;
+} TknMemoryAllocation;
+
+// Secondary command buffers of one worker for one frame in flight, reset together when the frame is acquired
+typedef struct
+{
+    VkCommandPool vkCommandPool;
+    // Allocated on demand and kept, the first usedCount are recorded this frame
+    TknDynamicArray vkCommandBufferDynamicArray;
+    uint32_t usedCount;
+} TknSecondaryCommandPool;
+
+typedef struct
+{
+    TknRenderPass *pTknRenderPass;
+    uint32_t subpassCount;
+    // Timestamp query of each subpass start, UINT32_MAX when the subpass could not take one
+    uint32_t subpassTimestampIndices[TKN_MAX_GPU_PROFILE_SUBPASS_COUNT];
+    uint32_t endTimestampIndex;
+} TknGpuProfilerRenderPass;
+
+// Queries of one frame in flight, reset at the start of its command buffer
+typedef struct
+{
+    VkQueryPool timestampVkQueryPool;
+    // One query per render pass
+    VkQueryPool statisticsVkQueryPool;
+    bool isTimestampEnabled;
+    bool isPipelineStatisticsEnabled;
+    uint32_t frameCount;
+    uint32_t timestampCount;
+    uint32_t renderPassCount;
+    TknGpuProfilerRenderPass tknGpuProfilerRenderPasses[TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT];
+} TknGpuProfilerFrame;
+
+// Outcome of one pipeline creation, gathered on workers and folded into the stats afterwards
+typedef struct
+{
+    bool isHit;
+    double milliseconds;
+} TknPipelineCacheResult;
+
+// Staging space and the command buffer to record the copies into, see tknBeginUpload
+typedef struct
+{
+    VkCommandBuffer vkCommandBuffer;
+    VkBuffer vkBuffer;
+    VkDeviceSize offset;
+    void *mapped;
+    bool isSingleTime;
+    TknMemoryAllocation tknMemoryAllocation;
+} TknUpload;
+
+// An upload running on the dedicated transfer queue, ownership moves to the graphics queue when it is retired
+typedef struct
+{
+    uint64_t ticket;
+    VkFence vkFence;
+    VkCommandBuffer vkCommandBuffer;
+    VkBuffer stagingVkBuffer;
+    TknMemoryAllocation stagingMemoryAllocation;
+    TknMesh *pTknMesh;
+    TknImage *pTknImage;
+} TknTransfer;
+
+typedef enum
+{
+    TKN_RETIRED_RESOURCE_BUFFER,
+    TKN_RETIRED_RESOURCE_IMAGE,
+    TKN_RETIRED_RESOURCE_SAMPLER,
+    TKN_RETIRED_RESOURCE_DESCRIPTOR_POOL,
+    TKN_RETIRED_RESOURCE_DESCRIPTOR_SET,
+} TknRetiredResourceType;
+
+typedef struct TknDescriptorSet TknDescriptorSet;
+
+// Parsed .spv file, spirv_reflect keeps the code, descriptor bindings, interface variables and stage
+typedef struct
+{
+    char *path;
+    uint64_t pathHash;
+    uint64_t contentHash;
+    bool isParsed;
+    // Whether the last parse found new contents
+    bool isChanged;
+    SpvReflectShaderModule spvReflectShaderModule;
+} TknShaderReflection;
+
+// A Vulkan object that is no longer referenced by the CPU side but may still be read by frames in flight
+typedef struct
+{
+    TknRetiredResourceType tknRetiredResourceType;
+    VkBuffer vkBuffer;
+    VkImage vkImage;
+    VkImageView vkImageView;
+    VkSampler vkSampler;
+    VkDescriptorPool vkDescriptorPool;
+    // Descriptor sets go back to the free list of their layout instead of being freed
+    TknDescriptorSet *pTknDescriptorSet;
+    VkDescriptorSet vkDescriptorSet;
+    TknMemoryAllocation tknMemoryAllocation;
+    // Serial of the last submission when it was retired
+    uint64_t retireSerial;
+} TknRetiredResource;
+
 struct TknSampler
 {
     VkSampler vkSampler;
@@ -13,63 +146,81 @@ struct TknSampler
 struct TknImage
 {
     VkImage vkImage;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     VkImageView vkImageView;
+    // Layout between uploads and the one descriptors use, GENERAL for storage images
+    VkImageLayout vkImageLayout;
     TknHashSet tknBindingPtrHashSet;
+    // Non zero while the transfer queue still owns the image
+    uint64_t tknUploadTicket;
 };
 
 struct TknUniformBuffer
 {
     VkBuffer vkBuffer;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     void *mapped;
     TknHashSet tknBindingPtrHashSet;
     VkDeviceSize size;
+    // Each frame in flight owns a copy at frameIndex * frameStride, written from data when the frame is acquired
+    VkDeviceSize frameStride;
+    void *data;
+    uint32_t dirtyFrameMask;
+    // Bytes written since every frame was last flushed, frames copy only this range
+    VkDeviceSize dirtyOffset;
+    VkDeviceSize dirtyEnd;
 };
 struct TknStorageBuffer
 {
     VkBuffer vkBuffer;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     TknHashSet tknBindingPtrHashSet;
+    TknHashSet tknDrawCallPtrHashSet;
     VkDeviceSize size;
 };
 
 struct TknUniformTexelBuffer
 {
     VkBuffer vkBuffer;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     TknHashSet tknBindingPtrHashSet;
     VkDeviceSize size;
 };
 struct TknStorageTexelBuffer
 {
     VkBuffer vkBuffer;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     TknHashSet tknBindingPtrHashSet;
     VkDeviceSize size;
 };
 
-struct TknUniformDynamicBuffer
-{
-    VkBuffer vkBuffer;
-    VkDeviceMemory vkDeviceMemory;
-    void *mapped;
-    TknHashSet tknBindingPtrHashSet;
-    VkDeviceSize size;
-};
-struct TknStorageDynamicBuffer
+// Uniform or storage elements picked per draw by dynamic offset
+struct TknDynamicBuffer
 {
+    VkDescriptorType vkDescriptorType;
     VkBuffer vkBuffer;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     void *mapped;
     TknHashSet tknBindingPtrHashSet;
-    VkDeviceSize size;
+    // Draw calls reading their indirect commands or draw count from this buffer
+    TknHashSet tknDrawCallPtrHashSet;
+    // Descriptor range, elements sit elementStride apart in the buffer and elementSize apart in data
+    VkDeviceSize elementSize;
+    VkDeviceSize elementStride;
+    uint32_t elementCount;
+    // Each frame in flight owns a copy of every element at frameIndex * frameStride, written from data when the frame is acquired
+    VkDeviceSize frameStride;
+    void *data;
+    uint32_t dirtyFrameMask;
+    // Elements written since every frame was last flushed
+    uint32_t dirtyElementBegin;
+    uint32_t dirtyElementEnd;
 };
 
 typedef struct
 {
     VkImage vkImage;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     VkImageView vkImageView;
     uint32_t width;
     uint32_t height;
@@ -78,7 +229,7 @@ typedef struct
 typedef struct
 {
     VkImage vkImage;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
     VkImageView vkImageView;
     float32_t scaler;
     VkImageUsageFlags vkImageUsageFlags;
@@ -125,13 +276,16 @@ typedef union
     TknCombinedImageSamplerBinding tknCombinedImageSamplerBinding;
     // VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE = 2,
     // VK_DESCRIPTOR_TYPE_STORAGE_IMAGE = 3,
+    TknStorageImageBinding tknStorageImageBinding;
     // VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER = 4,
     // VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER = 5,
     // VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER = 6,
     TknUniformBufferBinding tknUniformBufferBinding;
     // VK_DESCRIPTOR_TYPE_STORAGE_BUFFER = 7,
+    TknStorageBufferBinding tknStorageBufferBinding;
     // VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC = 8,
     // VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC = 9,
+    TknDynamicBufferBinding tknDynamicBufferBinding;
     // VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT = 10,
     TknInputAttachmentBinding tknInputAttachmentBinding;
 } TknBindingUnion;
@@ -144,14 +298,23 @@ typedef struct
     uint32_t binding;
 } TknBinding;
 
-typedef struct
+struct TknDescriptorSet
 {
     VkDescriptorSetLayout vkDescriptorSetLayout;
+    // Descriptors of one set, pools are sized in multiples of it
     TknDynamicArray vkDescriptorPoolSizeDynamicArray;
     uint32_t tknDescriptorCount;
     VkDescriptorType *vkDescriptorTypes;
+    // Dynamic bindings, each takes one offset when the set is bound
+    uint32_t tknDynamicOffsetCount;
     TknHashSet tknMaterialPtrHashSet;
-} TknDescriptorSet;
+    // Materials of this layout allocate from the last pool, full pools stay chained until the layout is destroyed
+    TknDynamicArray vkDescriptorPoolDynamicArray;
+    uint32_t tknDescriptorSetCapacity;
+    uint32_t tknPoolRemainingSetCount;
+    // Sets of destroyed materials whose frames are done, reused before the pool hands out new ones
+    TknDynamicArray freeVkDescriptorSetDynamicArray;
+};
 
 typedef enum
 {
@@ -174,33 +337,45 @@ struct TknInstance
 {
     TknVertexInputLayout *pTknVertexInputLayout;
     VkBuffer tknInstanceVkBuffer;
-    VkDeviceMemory tknInstanceVkDeviceMemory;
+    TknMemoryAllocation tknInstanceMemoryAllocation;
     void *tknInstanceMappedBuffer;
     uint32_t tknInstanceCount;
     uint32_t tknMaxInstanceCount;
     TknHashSet tknDrawCallPtrHashSet;
+    // Each frame in flight owns tknMaxInstanceCount instances at frameIndex, written from instances when the frame is acquired
+    void *instances;
+    uint32_t tknFrameInstanceCounts[TKN_MAX_FRAMES_IN_FLIGHT];
+    uint32_t dirtyFrameMask;
+    // Bytes written since every frame was last flushed, frames copy only this range
+    VkDeviceSize dirtyOffset;
+    VkDeviceSize dirtyEnd;
 };
 
 struct TknMesh
 {
     TknVertexInputLayout *pTknVertexInputLayout;
     VkBuffer tknVertexVkBuffer;
-    VkDeviceMemory tknVertexVkDeviceMemory;
+    TknMemoryAllocation tknVertexMemoryAllocation;
     uint32_t tknVertexCount;
 
     VkIndexType vkIndexType;
     VkBuffer tknIndexVkBuffer;
-    VkDeviceMemory tknIndexVkDeviceMemory;
+    TknMemoryAllocation tknIndexMemoryAllocation;
     uint32_t tknIndexCount;
     TknHashSet tknDrawCallPtrHashSet;
+    // Non zero while the transfer queue still owns the buffers, draw calls skip the mesh until then
+    uint64_t tknUploadTicket;
 };
 
 struct TknMaterial
 {
-    VkDescriptorSet vkDescriptorSet;
+    // One descriptor set per frame in flight, rewritten from pTknBindings when the frame is acquired
+    VkDescriptorSet vkDescriptorSets[TKN_MAX_FRAMES_IN_FLIGHT];
+    uint32_t dirtyFrameMask;
+    // Submit serial of the last frame that bound a set, that set is not rewritten while the frame records
+    uint64_t boundSubmitSerial;
     uint32_t tknBindingCount;
     TknBinding *pTknBindings;
-    VkDescriptorPool vkDescriptorPool;
     TknDescriptorSet *pTknDescriptorSet;
     TknHashSet tknDrawCallPtrHashSet;
 };
@@ -211,6 +386,24 @@ struct TknDrawCall
     TknMaterial *pTknMaterial;
     TknInstance *pTknInstance;
     TknMesh *pTknMesh;
+    // Element offsets of the material's dynamic bindings, the frame copy is added when recording
+    uint32_t dynamicOffsetCount;
+    uint32_t dynamicOffsets[TKN_MAX_DYNAMIC_OFFSET_COUNT];
+    // The pipeline's whole push constant block, pushed with every draw
+    uint8_t pushConstants[TKN_MAX_PUSH_CONSTANT_SIZE];
+    // Set by tknSetDrawCallIndirect, the draws then come from commands in the frame's copy instead of the mesh and instance counts
+    TknDynamicBuffer *pCommandTknDynamicBuffer;
+    uint32_t firstIndirectCommand;
+    uint32_t maxIndirectDrawCount;
+    TknDynamicBuffer *pCountTknDynamicBuffer;
+    // Set by tknSetDrawCallIndirectStorage instead, for commands a compute pass writes, never set together with the dynamic buffers
+    TknStorageBuffer *pCommandTknStorageBuffer;
+    TknStorageBuffer *pCountTknStorageBuffer;
+};
+
+struct TknDrawQueue
+{
+    TknDynamicArray tknDrawQueueEntryDynamicArray;
 };
 
 typedef enum
@@ -226,6 +419,9 @@ struct TknPipeline
     VkPipeline vkPipeline;
     TknDescriptorSet *pTknPipelineDescriptorSet;
     VkPipelineLayout vkPipelineLayout;
+    // One range from offset 0 covering the push constant blocks of every stage, 0 when no stage declares one
+    VkShaderStageFlags pushConstantVkShaderStageFlags;
+    uint32_t pushConstantSize;
     TknRenderPass *pTknRenderPass;
     uint32_t subpassIndex;
 
@@ -234,6 +430,17 @@ struct TknPipeline
     TknHashSet tknDrawCallPtrHashSet;  // Only track which drawcalls belong to this pipeline
 };
 
+struct TknComputePipeline
+{
+    VkPipeline vkPipeline;
+    TknDescriptorSet *pTknPipelineDescriptorSet;
+    // Stands in for the subpass set so the global and pipeline sets keep their numbers
+    VkDescriptorSetLayout emptyVkDescriptorSetLayout;
+    VkPipelineLayout vkPipelineLayout;
+    VkShaderStageFlags pushConstantVkShaderStageFlags;
+    uint32_t pushConstantSize;
+};
+
 struct TknSubpass
 {
     TknDescriptorSet *pTknSubpassDescriptorSet;
@@ -253,6 +460,20 @@ struct TknRenderPass
     struct TknSubpass *pTknSubpasses;
 };
 
+// Mirrors GlobalUniform in global.glsl, std140 packs it without padding
+typedef struct
+{
+    float view[16];
+    float proj[16];
+    float nearPlane;
+    float farPlane;
+    float fov;
+    float time;
+    int32_t frameCount;
+    int32_t screenWidth;
+    int32_t screenHeight;
+} TknFrameConstants;
+
 struct TknGfxContext
 {
     uint32_t tknFrameCount;
@@ -263,22 +484,82 @@ struct TknGfxContext
     VkPhysicalDeviceProperties vkPhysicalDeviceProperties;
     uint32_t tknGfxQueueFamilyIndex;
     uint32_t tknPresentQueueFamilyIndex;
+    // UINT32_MAX when the device has no transfer only queue family
+    uint32_t tknTransferQueueFamilyIndex;
     VkSurfaceFormatKHR tknSurfaceFormat;
     VkPresentModeKHR tknPresentMode;
 
     VkDevice vkDevice;
+    bool isPipelineCreationFeedbackEnabled;
+    bool isPipelineStatisticsQueryEnabled;
+    // Without multi draw every indirect command is recorded as its own draw
+    bool isMultiDrawIndirectEnabled;
+    // Indirect draws read their draw count from a buffer only with VK_KHR_draw_indirect_count
+    bool isDrawIndirectCountEnabled;
+    PFN_vkCmdDrawIndirectCountKHR vkCmdDrawIndirectCountKHR;
+    PFN_vkCmdDrawIndexedIndirectCountKHR vkCmdDrawIndexedIndirectCountKHR;
     VkQueue vkGfxQueue;
     VkQueue vkPresentQueue;
+    VkQueue vkTransferQueue;
+
+    VkPhysicalDeviceMemoryProperties vkPhysicalDeviceMemoryProperties;
+    TknDynamicArray tknMemoryBlockPtrDynamicArray;
+    VkDeviceSize tknMemoryUsageSizes[TKN_MAX_MEMORY_USAGE];
 
     VkSurfaceCapabilitiesKHR vkSurfaceCapabilities;
     TknAttachment *pTknSwapchainAttachment;
 
-    VkSemaphore vkImageAvailableSemaphore;
-    VkSemaphore vkRenderFinishedSemaphore;
-    VkFence vkRenderFinishedFence;
+    uint32_t tknFrameInFlightCount;
+    uint32_t tknFrameIndex;
+    VkSemaphore vkImageAvailableSemaphores[TKN_MAX_FRAMES_IN_FLIGHT];
+    VkSemaphore vkRenderFinishedSemaphores[TKN_MAX_FRAMES_IN_FLIGHT];
+    VkFence vkRenderFinishedFences[TKN_MAX_FRAMES_IN_FLIGHT];
 
     VkCommandPool vkGfxCommandPool;
-    VkCommandBuffer *vkGfxCommandBuffers;
+    VkCommandBuffer vkGfxCommandBuffers[TKN_MAX_FRAMES_IN_FLIGHT];
+
+    VkPipelineCache vkPipelineCache;
+    char *pipelineCachePath;
+    TknPipelineCacheStats tknPipelineCacheStats;
+    TknDescriptorPoolStats tknDescriptorPoolStats;
+    // Builds batches of pipelines and records secondary command buffers in parallel
+    TknWorkerPool *pTknWorkerPool;
+    // Command pools are single threaded, so every worker gets its own per frame in flight, indexed frameIndex * worker count + workerIndex
+    TknSecondaryCommandPool *tknSecondaryCommandPools;
+
+    // GPU profiler, disabled until tknSetGpuProfilerEnabled
+    uint32_t tknTimestampValidBits;
+    bool isGpuTimestampEnabled;
+    bool isGpuPipelineStatisticsEnabled;
+    TknGpuProfilerFrame tknGpuProfilerFrames[TKN_MAX_FRAMES_IN_FLIGHT];
+    TknGpuProfile tknGpuProfile;
+
+    // Every shader reflected so far, shared by descriptor sets and pipelines
+    TknDynamicArray tknShaderReflectionPtrDynamicArray;
+    // Path hashes in the same order as the reflections, looked up instead of scanning the array
+    TknHashSet tknShaderReflectionPathHashSet;
+    uint32_t tknShaderReflectionHitCount;
+
+    // Every frame in flight owns one slice of the staging ring, its uploads are submitted ahead of its graphics work
+    VkBuffer tknStagingVkBuffer;
+    TknMemoryAllocation tknStagingMemoryAllocation;
+    VkDeviceSize tknStagingSliceSize;
+    VkDeviceSize tknStagingOffset;
+    VkCommandBuffer vkUploadCommandBuffers[TKN_MAX_FRAMES_IN_FLIGHT];
+    bool isUploadRecording;
+
+    VkCommandPool vkTransferCommandPool;
+    TknDynamicArray tknTransferDynamicArray;
+    uint64_t tknNextUploadTicket;
+
+    // Destroyed resources in retirement order, each freed once a submission made after its retirement is done
+    TknDynamicArray tknRetiredResourceDynamicArray;
+    // Serial of the last frame submission, of each frame's last submission and of the newest one known to be done
+    uint64_t tknSubmitSerial;
+    uint64_t tknFrameSubmitSerials[TKN_MAX_FRAMES_IN_FLIGHT];
+    uint64_t tknCompletedSubmitSerial;
+    // Between a successful acquire and the submit, descriptor writes then go only to sets the frame has not bound
+    bool isFrameRecording;
 
     TknHashSet tknDynamicAttachmentPtrHashSet;
     TknHashSet tknFixedAttachmentPtrHashSet;
@@ -291,27 +572,81 @@ struct TknGfxContext
     TknUniformBuffer *pTknEmptyUniformBuffer;
     TknSampler *pTknEmptySampler;
     TknImage *pTknEmptyImage;
+    TknStorageBuffer *pTknEmptyStorageBuffer;
+
+    TknDynamicBuffer *pTknEmptyUniformDynamicBuffer;
+    TknDynamicBuffer *pTknEmptyStorageDynamicBuffer;
 
-    TknFrame *pTknFrame;
+    // Bound once to the global material, the copy of each frame is written when the frame is acquired
+    TknDynamicBuffer *pTknFrameConstantsDynamicBuffer;
+    TknFrameConstants tknFrameConstants;
+    double tknStartTimeMilliseconds;
+
+    // Resources whose per-frame copies are stale, flushed when each frame is acquired
+    TknHashSet tknDirtyUniformBufferPtrHashSet;
+    TknHashSet tknDirtyDynamicBufferPtrHashSet;
+    TknHashSet tknDirtyInstancePtrHashSet;
+    TknHashSet tknDirtyMaterialPtrHashSet;
+
+    TknFrame *tknFrames;
 };
 
 struct TknFrame
 {
+    uint32_t frameIndex;
     VkCommandBuffer vkCommandBuffer;
     uint32_t swapchainIndex;
     TknRenderPass *pTknRenderPass;
     uint32_t subpassIndex;
+    // Secondary subpasses only take draw queues, their draws are recorded on workers and executed from here
+    VkSubpassContents vkSubpassContents;
     TknPipeline *pTknPipeline;
+    TknArena tknArena;
+    // What the command buffer has bound, binds of the same object at the same slot are skipped
+    VkDescriptorSet boundVkDescriptorSets[TKN_MAX_DESCRIPTOR_SET];
+    // Draw offsets of the bound pipeline set, the other sets always take the same offsets within a frame
+    uint32_t boundDynamicOffsets[TKN_MAX_DYNAMIC_OFFSET_COUNT];
+    VkBuffer boundVertexVkBuffers[TKN_MAX_VERTEX_BINDING_DESCRIPTION];
+    VkDeviceSize boundVertexOffsets[TKN_MAX_VERTEX_BINDING_DESCRIPTION];
+    VkBuffer boundIndexVkBuffer;
+    VkIndexType boundVkIndexType;
+    TknFrameStats tknFrameStats;
 };
 
 
 void tknAssertVkResult(VkResult vkResult);
-
-SpvReflectShaderModule tknCreateSpvReflectShaderModule(const char *filePath);
-void tknDestroySpvReflectShaderModule(SpvReflectShaderModule *pSpvReflectShaderModule);
-
-void tknCreateVkBuffer(TknGfxContext *pTknGfxContext, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkBuffer *pVkBuffer, VkDeviceMemory *pVkDeviceMemory);
-void tknDestroyVkBuffer(TknGfxContext *pTknGfxContext, VkBuffer vkBuffer, VkDeviceMemory vkDeviceMemory);
+void tknWaitGfxFramesInFlight(TknGfxContext *pTknGfxContext);
+uint32_t tknGetAllFramesMask(TknGfxContext *pTknGfxContext);
+
+void tknForgetBoundState(TknFrame *pTknFrame);
+void tknSetRenderAreaViewport(VkCommandBuffer vkCommandBuffer, TknRenderPass *pTknRenderPass);
+
+void tknPopulateGpuProfiler(TknGfxContext *pTknGfxContext);
+void tknCleanupGpuProfiler(TknGfxContext *pTknGfxContext);
+void tknBeginGpuProfilerFrame(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame);
+void tknBeginGpuRenderPassProfile(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknRenderPass *pTknRenderPass);
+void tknWriteGpuSubpassTimestamp(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, uint32_t subpassIndex);
+void tknEndGpuRenderPassProfile(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame);
+VkQueryPipelineStatisticFlags tknGetActivePipelineStatisticFlags(TknGfxContext *pTknGfxContext, uint32_t frameIndex);
+
+void tknPopulateSecondaryCommandPools(TknGfxContext *pTknGfxContext);
+void tknCleanupSecondaryCommandPools(TknGfxContext *pTknGfxContext);
+void tknResetSecondaryCommandPools(TknGfxContext *pTknGfxContext, uint32_t frameIndex);
+TknFrame tknBeginSecondaryFrame(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, uint32_t workerIndex);
+void tknEndSecondaryFrame(TknFrame *pSecondaryTknFrame);
+
+void tknPopulateShaderReflections(TknGfxContext *pTknGfxContext);
+void tknCleanupShaderReflections(TknGfxContext *pTknGfxContext);
+void tknLoadShaderReflections(TknGfxContext *pTknGfxContext, uint32_t spvPathCount, const char **spvPaths);
+SpvReflectShaderModule tknGetSpvReflectShaderModule(TknGfxContext *pTknGfxContext, const char *spvPath);
+
+void tknPopulateMemoryAllocator(TknGfxContext *pTknGfxContext);
+void tknCleanupMemoryAllocator(TknGfxContext *pTknGfxContext);
+TknMemoryAllocation tknAllocateMemory(TknGfxContext *pTknGfxContext, VkMemoryRequirements vkMemoryRequirements, VkMemoryPropertyFlags vkMemoryPropertyFlags, bool isLinear, TknMemoryUsage tknMemoryUsage);
+void tknFreeMemory(TknGfxContext *pTknGfxContext, TknMemoryAllocation tknMemoryAllocation);
+
+void tknCreateVkBuffer(TknGfxContext *pTknGfxContext, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags, TknMemoryUsage tknMemoryUsage, VkBuffer *pVkBuffer, TknMemoryAllocation *pTknMemoryAllocation);
+void tknDestroyVkBuffer(TknGfxContext *pTknGfxContext, VkBuffer vkBuffer, TknMemoryAllocation tknMemoryAllocation);
 
 TknDescriptorSet *tknCreateDescriptorSetPtr(TknGfxContext *pTknGfxContext, uint32_t spvReflectShaderModuleCount, SpvReflectShaderModule *spvReflectShaderModules, uint32_t set);
 void tknDestroyDescriptorSetPtr(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet);
@@ -322,16 +657,58 @@ void tknRepopulateFramebuffers(TknGfxContext *pTknGfxContext, TknRenderPass *pTk
 
 TknMaterial *tknCreateMaterialPtr(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet);
 void tknDestroyMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial);
+void tknMarkMaterialDirty(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial);
+void tknFlushMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial, uint32_t frameIndex);
+void tknMarkMaterialBound(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial);
+uint32_t tknGetMaterialDynamicOffsets(TknMaterial *pTknMaterial, uint32_t frameIndex, const uint32_t *drawOffsets, uint32_t *dynamicOffsets);
+void tknFlushUniformBufferPtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, uint32_t frameIndex);
+void tknFlushDynamicBufferPtr(TknGfxContext *pTknGfxContext, TknDynamicBuffer *pTknDynamicBuffer, uint32_t frameIndex);
+void tknFlushInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance, uint32_t frameIndex);
 
 void tknResizeDynamicAttachmentPtr(TknGfxContext *pTknGfxContext, TknAttachment *pTknAttachment);
 void tknBindAttachmentsToMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial);
 void tknUnbindAttachmentsFromMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial);
 void tknUpdateAttachmentOfMaterialPtr(TknGfxContext *pTknGfxContext, TknBinding *pTknBinding);
 TknInputBindingUnion tknGetEmptyInputBindingUnion(TknGfxContext *pTknGfxContext, VkDescriptorType vkDescriptorType);
-void tknClearBindingPtrHashSet(TknGfxContext *pTknGfxContext, TknHashSet tknBindingPtrHashSet);
-
-void tknCreateVkImage(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageTiling vkImageTiling, VkImageUsageFlags vkImageUsageFlags, VkMemoryPropertyFlags vkMemoryPropertyFlags, VkImageAspectFlags vkImageAspectFlags, VkImage *pVkImage, VkDeviceMemory *pVkDeviceMemory, VkImageView *pVkImageView);
-void tknDestroyVkImage(TknGfxContext *pTknGfxContext, VkImage vkImage, VkDeviceMemory vkDeviceMemory, VkImageView vkImageView);
+void tknClearBindingPtrHashSet(TknGfxContext *pTknGfxContext, TknHashSet *pTknBindingPtrHashSet);
+
+void tknCreateVkImage(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageTiling vkImageTiling, VkImageUsageFlags vkImageUsageFlags, VkMemoryPropertyFlags vkMemoryPropertyFlags, VkImageAspectFlags vkImageAspectFlags, TknMemoryUsage tknMemoryUsage, VkImage *pVkImage, TknMemoryAllocation *pTknMemoryAllocation, VkImageView *pVkImageView);
+void tknDestroyVkImage(TknGfxContext *pTknGfxContext, VkImage vkImage, TknMemoryAllocation tknMemoryAllocation, VkImageView vkImageView);
+VkImageLayout tknGetImageLayout(VkImageUsageFlags vkImageUsageFlags);
+
+void tknPopulateStagingRing(TknGfxContext *pTknGfxContext);
+void tknCleanupStagingRing(TknGfxContext *pTknGfxContext);
+TknUpload tknBeginUpload(TknGfxContext *pTknGfxContext, VkDeviceSize size);
+void tknEndUpload(TknGfxContext *pTknGfxContext, TknUpload tknUpload);
+VkCommandBuffer tknEndUploadCommandBuffer(TknGfxContext *pTknGfxContext);
+void tknFlushUploads(TknGfxContext *pTknGfxContext);
+
+void tknPopulateTransfers(TknGfxContext *pTknGfxContext);
+void tknCleanupTransfers(TknGfxContext *pTknGfxContext);
+void tknRetireTransfers(TknGfxContext *pTknGfxContext, bool wait);
+
+void tknPopulatePipelineCache(TknGfxContext *pTknGfxContext, const char *pipelineCachePath);
+void tknCleanupPipelineCache(TknGfxContext *pTknGfxContext);
+VkPipeline tknCreateVkGraphicsPipeline(TknGfxContext *pTknGfxContext, VkGraphicsPipelineCreateInfo vkGraphicsPipelineCreateInfo, TknPipelineCacheResult *pTknPipelineCacheResult);
+VkPipeline tknCreateVkComputePipeline(TknGfxContext *pTknGfxContext, VkComputePipelineCreateInfo vkComputePipelineCreateInfo, TknPipelineCacheResult *pTknPipelineCacheResult);
+void tknRecordPipelineCacheResult(TknGfxContext *pTknGfxContext, TknPipelineCacheResult tknPipelineCacheResult);
+
+void tknPopulateRetiredResources(TknGfxContext *pTknGfxContext);
+void tknCleanupRetiredResources(TknGfxContext *pTknGfxContext);
+void tknSubmitRetiredResources(TknGfxContext *pTknGfxContext, uint32_t frameIndex);
+void tknReleaseRetiredResources(TknGfxContext *pTknGfxContext, uint32_t frameIndex);
+void tknRetireVkBuffer(TknGfxContext *pTknGfxContext, VkBuffer vkBuffer, TknMemoryAllocation tknMemoryAllocation);
+void tknRetireVkImage(TknGfxContext *pTknGfxContext, VkImage vkImage, TknMemoryAllocation tknMemoryAllocation, VkImageView vkImageView);
+void tknRetireVkSampler(TknGfxContext *pTknGfxContext, VkSampler vkSampler);
+void tknRetireVkDescriptorPool(TknGfxContext *pTknGfxContext, VkDescriptorPool vkDescriptorPool);
+void tknRetireVkDescriptorSet(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet, VkDescriptorSet vkDescriptorSet);
+void tknForgetRetiredVkDescriptorSets(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet);
+
+void tknAllocateVkDescriptorSets(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet, uint32_t vkDescriptorSetCount, VkDescriptorSet *vkDescriptorSets);
+void tknRecycleVkDescriptorSet(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet, VkDescriptorSet vkDescriptorSet);
+void tknCleanupDescriptorPools(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet);
+
+TknMesh *tknCreateEmptyMeshPtr(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknVertexInputLayout, uint32_t tknVertexCount, VkIndexType vkIndexType, uint32_t tknIndexCount);
 
 VkCommandBuffer tknBeginSingleTimeCommands(TknGfxContext *pTknGfxContext);
 void tknEndSingleTimeCommands(TknGfxContext *pTknGfxContext, VkCommandBuffer vkCommandBuffer);
\ No newline at end of file
@@ -0,0 +1,380 @@
+#include "tknGfxCore.h"
+
+// Every subpass start plus the render pass end
+#define TKN_MAX_GPU_PROFILE_TIMESTAMP_COUNT (TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT * (TKN_MAX_GPU_PROFILE_SUBPASS_COUNT + 1))
+#define TKN_GPU_PROFILE_PIPELINE_STATISTIC_COUNT 5
+
+static const VkQueryPipelineStatisticFlags tknGpuProfilePipelineStatisticFlags =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+void tknPopulateGpuProfiler(TknGfxContext *pTknGfxContext)
+{
+    VkPhysicalDevice vkPhysicalDevice = pTknGfxContext->vkPhysicalDevice;
+    uint32_t queueFamilyPropertiesCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice, &queueFamilyPropertiesCount, NULL);
+    VkQueueFamilyProperties *vkQueueFamilyPropertiesArray = tknMalloc(sizeof(VkQueueFamilyProperties) * queueFamilyPropertiesCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice, &queueFamilyPropertiesCount, vkQueueFamilyPropertiesArray);
+    pTknGfxContext->tknTimestampValidBits = vkQueueFamilyPropertiesArray[pTknGfxContext->tknGfxQueueFamilyIndex].timestampValidBits;
+    tknFree(vkQueueFamilyPropertiesArray);
+
+    pTknGfxContext->isGpuTimestampEnabled = false;
+    pTknGfxContext->isGpuPipelineStatisticsEnabled = false;
+    pTknGfxContext->tknGpuProfile = (TknGpuProfile){
+        .isTimestampSupported = pTknGfxContext->tknTimestampValidBits > 0,
+        .isPipelineStatisticsSupported = pTknGfxContext->isPipelineStatisticsQueryEnabled,
+        .frameCount = 0,
+        .renderPassCount = 0,
+    };
+
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        TknGpuProfilerFrame *pTknGpuProfilerFrame = &pTknGfxContext->tknGpuProfilerFrames[frameIndex];
+        *pTknGpuProfilerFrame = (TknGpuProfilerFrame){
+            .timestampVkQueryPool = VK_NULL_HANDLE,
+            .statisticsVkQueryPool = VK_NULL_HANDLE,
+            .isTimestampEnabled = false,
+            .isPipelineStatisticsEnabled = false,
+            .frameCount = 0,
+            .timestampCount = 0,
+            .renderPassCount = 0,
+        };
+        if (pTknGfxContext->tknGpuProfile.isTimestampSupported)
+        {
+            VkQueryPoolCreateInfo vkQueryPoolCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = NULL,
+                .flags = 0,
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = TKN_MAX_GPU_PROFILE_TIMESTAMP_COUNT,
+                .pipelineStatistics = 0,
+            };
+            tknAssertVkResult(vkCreateQueryPool(vkDevice, &vkQueryPoolCreateInfo, NULL, &pTknGpuProfilerFrame->timestampVkQueryPool));
+        }
+        else
+        {
+            // The gfx queue cannot write timestamps
+        }
+        if (pTknGfxContext->tknGpuProfile.isPipelineStatisticsSupported)
+        {
+            VkQueryPoolCreateInfo vkQueryPoolCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = NULL,
+                .flags = 0,
+                .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                .queryCount = TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT,
+                .pipelineStatistics = tknGpuProfilePipelineStatisticFlags,
+            };
+            tknAssertVkResult(vkCreateQueryPool(vkDevice, &vkQueryPoolCreateInfo, NULL, &pTknGpuProfilerFrame->statisticsVkQueryPool));
+        }
+        else
+        {
+            // The device lacks pipelineStatisticsQuery or inheritedQueries
+        }
+    }
+}
+
+void tknCleanupGpuProfiler(TknGfxContext *pTknGfxContext)
+{
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        TknGpuProfilerFrame *pTknGpuProfilerFrame = &pTknGfxContext->tknGpuProfilerFrames[frameIndex];
+        vkDestroyQueryPool(pTknGfxContext->vkDevice, pTknGpuProfilerFrame->timestampVkQueryPool, NULL);
+        vkDestroyQueryPool(pTknGfxContext->vkDevice, pTknGpuProfilerFrame->statisticsVkQueryPool, NULL);
+        pTknGpuProfilerFrame->timestampVkQueryPool = VK_NULL_HANDLE;
+        pTknGpuProfilerFrame->statisticsVkQueryPool = VK_NULL_HANDLE;
+    }
+}
+
+static double tknGetTimestampMilliseconds(TknGfxContext *pTknGfxContext, uint64_t beginTimestamp, uint64_t endTimestamp)
+{
+    uint32_t validBits = pTknGfxContext->tknTimestampValidBits;
+    uint64_t validMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+    uint64_t delta = (endTimestamp - beginTimestamp) & validMask;
+    return (double)delta * pTknGfxContext->vkPhysicalDeviceProperties.limits.timestampPeriod / 1000000.0;
+}
+
+// The frame's fence has signaled, so the queries are either available or were never written
+static void tknReadGpuProfilerFrame(TknGfxContext *pTknGfxContext, TknGpuProfilerFrame *pTknGpuProfilerFrame)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    uint64_t timestamps[TKN_MAX_GPU_PROFILE_TIMESTAMP_COUNT];
+    bool isTimestampRead = false;
+    if (pTknGpuProfilerFrame->isTimestampEnabled && pTknGpuProfilerFrame->timestampCount > 0)
+    {
+        VkResult vkResult = vkGetQueryPoolResults(vkDevice, pTknGpuProfilerFrame->timestampVkQueryPool, 0, pTknGpuProfilerFrame->timestampCount,
+                                                  sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        if (VK_NOT_READY == vkResult)
+        {
+            tknWarning("GPU timestamps of frame %u are not ready, skipping them", pTknGpuProfilerFrame->frameCount);
+        }
+        else
+        {
+            tknAssertVkResult(vkResult);
+            isTimestampRead = true;
+        }
+    }
+    else
+    {
+        // No timestamps recorded
+    }
+    uint64_t statistics[TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT][TKN_GPU_PROFILE_PIPELINE_STATISTIC_COUNT];
+    bool isStatisticsRead = false;
+    if (pTknGpuProfilerFrame->isPipelineStatisticsEnabled && pTknGpuProfilerFrame->renderPassCount > 0)
+    {
+        VkResult vkResult = vkGetQueryPoolResults(vkDevice, pTknGpuProfilerFrame->statisticsVkQueryPool, 0, pTknGpuProfilerFrame->renderPassCount,
+                                                  sizeof(statistics), statistics, sizeof(statistics[0]), VK_QUERY_RESULT_64_BIT);
+        if (VK_NOT_READY == vkResult)
+        {
+            tknWarning("GPU pipeline statistics of frame %u are not ready, skipping them", pTknGpuProfilerFrame->frameCount);
+        }
+        else
+        {
+            tknAssertVkResult(vkResult);
+            isStatisticsRead = true;
+        }
+    }
+    else
+    {
+        // No statistics recorded
+    }
+
+    if (isTimestampRead || isStatisticsRead)
+    {
+        TknGpuProfile *pTknGpuProfile = &pTknGfxContext->tknGpuProfile;
+        pTknGpuProfile->frameCount = pTknGpuProfilerFrame->frameCount;
+        pTknGpuProfile->renderPassCount = pTknGpuProfilerFrame->renderPassCount;
+        for (uint32_t renderPassIndex = 0; renderPassIndex < pTknGpuProfilerFrame->renderPassCount; renderPassIndex++)
+        {
+            TknGpuProfilerRenderPass *pTknGpuProfilerRenderPass = &pTknGpuProfilerFrame->tknGpuProfilerRenderPasses[renderPassIndex];
+            TknGpuRenderPassProfile *pTknGpuRenderPassProfile = &pTknGpuProfile->tknGpuRenderPassProfiles[renderPassIndex];
+            *pTknGpuRenderPassProfile = (TknGpuRenderPassProfile){
+                .pTknRenderPass = pTknGpuProfilerRenderPass->pTknRenderPass,
+                .subpassCount = pTknGpuProfilerRenderPass->subpassCount,
+            };
+            if (isTimestampRead)
+            {
+                uint32_t beginTimestampIndex = pTknGpuProfilerRenderPass->subpassTimestampIndices[0];
+                uint32_t endTimestampIndex = pTknGpuProfilerRenderPass->endTimestampIndex;
+                pTknGpuRenderPassProfile->milliseconds = tknGetTimestampMilliseconds(pTknGfxContext, timestamps[beginTimestampIndex], timestamps[endTimestampIndex]);
+                // A subpass lasts until the next timestamp taken after it, later subpasses without one are folded into it
+                for (uint32_t subpassIndex = 0; subpassIndex < pTknGpuProfilerRenderPass->subpassCount; subpassIndex++)
+                {
+                    uint32_t timestampIndex = pTknGpuProfilerRenderPass->subpassTimestampIndices[subpassIndex];
+                    if (timestampIndex != UINT32_MAX)
+                    {
+                        uint32_t nextTimestampIndex = endTimestampIndex;
+                        for (uint32_t nextSubpassIndex = subpassIndex + 1; nextSubpassIndex < pTknGpuProfilerRenderPass->subpassCount; nextSubpassIndex++)
+                        {
+                            if (pTknGpuProfilerRenderPass->subpassTimestampIndices[nextSubpassIndex] != UINT32_MAX)
+                            {
+                                nextTimestampIndex = pTknGpuProfilerRenderPass->subpassTimestampIndices[nextSubpassIndex];
+                                break;
+                            }
+                            else
+                            {
+                                // Keep looking
+                            }
+                        }
+                        pTknGpuRenderPassProfile->subpassMilliseconds[subpassIndex] = tknGetTimestampMilliseconds(pTknGfxContext, timestamps[timestampIndex], timestamps[nextTimestampIndex]);
+                    }
+                    else
+                    {
+                        // Counted in an earlier subpass
+                    }
+                }
+            }
+            else
+            {
+                // Timing stays 0
+            }
+            if (isStatisticsRead)
+            {
+                // Results come in the bit order of the enabled flags
+                pTknGpuRenderPassProfile->inputAssemblyVertexCount = statistics[renderPassIndex][0];
+                pTknGpuRenderPassProfile->inputAssemblyPrimitiveCount = statistics[renderPassIndex][1];
+                pTknGpuRenderPassProfile->vertexShaderInvocationCount = statistics[renderPassIndex][2];
+                pTknGpuRenderPassProfile->clippingPrimitiveCount = statistics[renderPassIndex][3];
+                pTknGpuRenderPassProfile->fragmentShaderInvocationCount = statistics[renderPassIndex][4];
+            }
+            else
+            {
+                // Counts stay 0
+            }
+        }
+    }
+    else
+    {
+        // Keep the last profile
+    }
+}
+
+// Called right after the frame's command buffer began, the previous use of this frame index has finished on the GPU
+void tknBeginGpuProfilerFrame(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame)
+{
+    TknGpuProfilerFrame *pTknGpuProfilerFrame = &pTknGfxContext->tknGpuProfilerFrames[pTknFrame->frameIndex];
+    tknReadGpuProfilerFrame(pTknGfxContext, pTknGpuProfilerFrame);
+
+    pTknGpuProfilerFrame->isTimestampEnabled = pTknGfxContext->isGpuTimestampEnabled;
+    pTknGpuProfilerFrame->isPipelineStatisticsEnabled = pTknGfxContext->isGpuPipelineStatisticsEnabled;
+    pTknGpuProfilerFrame->frameCount = pTknGfxContext->tknFrameCount;
+    pTknGpuProfilerFrame->timestampCount = 0;
+    pTknGpuProfilerFrame->renderPassCount = 0;
+    if (pTknGpuProfilerFrame->isTimestampEnabled)
+    {
+        vkCmdResetQueryPool(pTknFrame->vkCommandBuffer, pTknGpuProfilerFrame->timestampVkQueryPool, 0, TKN_MAX_GPU_PROFILE_TIMESTAMP_COUNT);
+    }
+    else
+    {
+        // Skip
+    }
+    if (pTknGpuProfilerFrame->isPipelineStatisticsEnabled)
+    {
+        vkCmdResetQueryPool(pTknFrame->vkCommandBuffer, pTknGpuProfilerFrame->statisticsVkQueryPool, 0, TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT);
+    }
+    else
+    {
+        // Skip
+    }
+}
+
+static TknGpuProfilerRenderPass *tknGetCurrentGpuProfilerRenderPass(TknGpuProfilerFrame *pTknGpuProfilerFrame, TknFrame *pTknFrame)
+{
+    if (pTknGpuProfilerFrame->renderPassCount > 0)
+    {
+        TknGpuProfilerRenderPass *pTknGpuProfilerRenderPass = &pTknGpuProfilerFrame->tknGpuProfilerRenderPasses[pTknGpuProfilerFrame->renderPassCount - 1];
+        return pTknGpuProfilerRenderPass->pTknRenderPass == pTknFrame->pTknRenderPass ? pTknGpuProfilerRenderPass : NULL;
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+static uint32_t tknWriteGpuTimestamp(TknGpuProfilerFrame *pTknGpuProfilerFrame, TknFrame *pTknFrame)
+{
+    uint32_t timestampIndex = pTknGpuProfilerFrame->timestampCount;
+    vkCmdWriteTimestamp(pTknFrame->vkCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pTknGpuProfilerFrame->timestampVkQueryPool, timestampIndex);
+    pTknGpuProfilerFrame->timestampCount++;
+    return timestampIndex;
+}
+
+// Called before vkCmdBeginRenderPass, render passes beyond TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT are not profiled
+void tknBeginGpuRenderPassProfile(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, TknRenderPass *pTknRenderPass)
+{
+    TknGpuProfilerFrame *pTknGpuProfilerFrame = &pTknGfxContext->tknGpuProfilerFrames[pTknFrame->frameIndex];
+    if ((pTknGpuProfilerFrame->isTimestampEnabled || pTknGpuProfilerFrame->isPipelineStatisticsEnabled) &&
+        pTknGpuProfilerFrame->renderPassCount < TKN_MAX_GPU_PROFILE_RENDER_PASS_COUNT)
+    {
+        uint32_t renderPassIndex = pTknGpuProfilerFrame->renderPassCount;
+        TknGpuProfilerRenderPass *pTknGpuProfilerRenderPass = &pTknGpuProfilerFrame->tknGpuProfilerRenderPasses[renderPassIndex];
+        *pTknGpuProfilerRenderPass = (TknGpuProfilerRenderPass){
+            .pTknRenderPass = pTknRenderPass,
+            .subpassCount = TKN_CLAMP(pTknRenderPass->tknSubpassCount, 0, TKN_MAX_GPU_PROFILE_SUBPASS_COUNT),
+            .endTimestampIndex = UINT32_MAX,
+        };
+        for (uint32_t subpassIndex = 0; subpassIndex < TKN_MAX_GPU_PROFILE_SUBPASS_COUNT; subpassIndex++)
+        {
+            pTknGpuProfilerRenderPass->subpassTimestampIndices[subpassIndex] = UINT32_MAX;
+        }
+        if (pTknGpuProfilerFrame->isTimestampEnabled)
+        {
+            pTknGpuProfilerRenderPass->subpassTimestampIndices[0] = tknWriteGpuTimestamp(pTknGpuProfilerFrame, pTknFrame);
+        }
+        else
+        {
+            // Skip
+        }
+        if (pTknGpuProfilerFrame->isPipelineStatisticsEnabled)
+        {
+            vkCmdBeginQuery(pTknFrame->vkCommandBuffer, pTknGpuProfilerFrame->statisticsVkQueryPool, renderPassIndex, 0);
+        }
+        else
+        {
+            // Skip
+        }
+        pTknGpuProfilerFrame->renderPassCount++;
+    }
+    else
+    {
+        // Not profiled
+    }
+}
+
+// Called at a subpass boundary on the inline side, the subpass index is the one starting
+void tknWriteGpuSubpassTimestamp(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, uint32_t subpassIndex)
+{
+    TknGpuProfilerFrame *pTknGpuProfilerFrame = &pTknGfxContext->tknGpuProfilerFrames[pTknFrame->frameIndex];
+    TknGpuProfilerRenderPass *pTknGpuProfilerRenderPass = tknGetCurrentGpuProfilerRenderPass(pTknGpuProfilerFrame, pTknFrame);
+    if (pTknGpuProfilerFrame->isTimestampEnabled && pTknGpuProfilerRenderPass != NULL && subpassIndex < pTknGpuProfilerRenderPass->subpassCount)
+    {
+        pTknGpuProfilerRenderPass->subpassTimestampIndices[subpassIndex] = tknWriteGpuTimestamp(pTknGpuProfilerFrame, pTknFrame);
+    }
+    else
+    {
+        // Not profiled
+    }
+}
+
+// Called after vkCmdEndRenderPass, while the frame still references the render pass
+void tknEndGpuRenderPassProfile(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame)
+{
+    TknGpuProfilerFrame *pTknGpuProfilerFrame = &pTknGfxContext->tknGpuProfilerFrames[pTknFrame->frameIndex];
+    TknGpuProfilerRenderPass *pTknGpuProfilerRenderPass = tknGetCurrentGpuProfilerRenderPass(pTknGpuProfilerFrame, pTknFrame);
+    if (pTknGpuProfilerRenderPass != NULL && UINT32_MAX == pTknGpuProfilerRenderPass->endTimestampIndex)
+    {
+        if (pTknGpuProfilerFrame->isTimestampEnabled)
+        {
+            pTknGpuProfilerRenderPass->endTimestampIndex = tknWriteGpuTimestamp(pTknGpuProfilerFrame, pTknFrame);
+        }
+        else
+        {
+            // Skip
+        }
+        if (pTknGpuProfilerFrame->isPipelineStatisticsEnabled)
+        {
+            vkCmdEndQuery(pTknFrame->vkCommandBuffer, pTknGpuProfilerFrame->statisticsVkQueryPool, pTknGpuProfilerFrame->renderPassCount - 1);
+        }
+        else
+        {
+            // Skip
+        }
+    }
+    else
+    {
+        // Not profiled
+    }
+}
+
+// Secondary command buffers must declare the statistics of the query active in their render pass
+VkQueryPipelineStatisticFlags tknGetActivePipelineStatisticFlags(TknGfxContext *pTknGfxContext, uint32_t frameIndex)
+{
+    return pTknGfxContext->tknGpuProfilerFrames[frameIndex].isPipelineStatisticsEnabled ? tknGpuProfilePipelineStatisticFlags : 0;
+}
+
+// Takes effect from the next acquired frame, unsupported parts stay disabled
+void tknSetGpuProfilerEnabled(TknGfxContext *pTknGfxContext, bool isTimestampEnabled, bool isPipelineStatisticsEnabled)
+{
+    pTknGfxContext->isGpuTimestampEnabled = isTimestampEnabled && pTknGfxContext->tknGpuProfile.isTimestampSupported;
+    pTknGfxContext->isGpuPipelineStatisticsEnabled = isPipelineStatisticsEnabled && pTknGfxContext->tknGpuProfile.isPipelineStatisticsSupported;
+    if (isTimestampEnabled != pTknGfxContext->isGpuTimestampEnabled || isPipelineStatisticsEnabled != pTknGfxContext->isGpuPipelineStatisticsEnabled)
+    {
+        tknWarning("GPU profiler: timestamps %s, pipeline statistics %s on this device",
+                   pTknGfxContext->tknGpuProfile.isTimestampSupported ? "supported" : "unsupported",
+                   pTknGfxContext->tknGpuProfile.isPipelineStatisticsSupported ? "supported" : "unsupported");
+    }
+    else
+    {
+        // Everything requested is available
+    }
+}
+
+// Results lag behind by the number of frames in flight, frameCount tells which frame they belong to
+TknGpuProfile tknGetGpuProfile(TknGfxContext *pTknGfxContext)
+{
+    return pTknGfxContext->tknGpuProfile;
+}
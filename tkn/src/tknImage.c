@@ -1,20 +1,28 @@
 #include "tknGfxCore.h"
 
+// Storage images cannot be in SHADER_READ_ONLY_OPTIMAL, GENERAL serves both sampling and storage so they never change layout between passes
+VkImageLayout tknGetImageLayout(VkImageUsageFlags vkImageUsageFlags)
+{
+    return (vkImageUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
 TknImage *tknCreateImagePtr(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageTiling vkImageTiling, VkImageUsageFlags vkImageUsageFlags, VkMemoryPropertyFlags vkMemoryPropertyFlags, VkImageAspectFlags vkImageAspectFlags, void *data, VkDeviceSize dataSize)
 {
     TknImage *pTknImage = tknMalloc(sizeof(TknImage));
     VkImage vkImage;
     VkImageView vkImageView;
-    VkDeviceMemory vkDeviceMemory;
+    TknMemoryAllocation tknMemoryAllocation;
 
     // Create the Vulkan image
-    tknCreateVkImage(pTknGfxContext, vkExtent3D, vkFormat, vkImageTiling, vkImageUsageFlags, vkMemoryPropertyFlags, vkImageAspectFlags, &vkImage, &vkDeviceMemory, &vkImageView);
+    tknCreateVkImage(pTknGfxContext, vkExtent3D, vkFormat, vkImageTiling, vkImageUsageFlags, vkMemoryPropertyFlags, vkImageAspectFlags, TKN_MEMORY_USAGE_IMAGE, &vkImage, &tknMemoryAllocation, &vkImageView);
 
     TknImage image = {
         .vkImage = vkImage,
-        .vkDeviceMemory = vkDeviceMemory,
+        .tknMemoryAllocation = tknMemoryAllocation,
         .vkImageView = vkImageView,
+        .vkImageLayout = tknGetImageLayout(vkImageUsageFlags),
         .tknBindingPtrHashSet = tknCreateHashSet(sizeof(TknBinding *)),
+        .tknUploadTicket = 0,
     };
     *pTknImage = image;
 
@@ -25,21 +33,10 @@ TknImage *tknCreateImagePtr(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D
         uint32_t width = vkExtent3D.width;
         uint32_t height = vkExtent3D.height;
 
-        // Create staging buffer
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        tknCreateVkBuffer(pTknGfxContext, dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                       &stagingBuffer, &stagingBufferMemory);
-
-        // Copy data to staging buffer
-        void *mappedData;
-        vkMapMemory(pTknGfxContext->vkDevice, stagingBufferMemory, 0, dataSize, 0, &mappedData);
-        memcpy(mappedData, data, (size_t)dataSize);
-        vkUnmapMemory(pTknGfxContext->vkDevice, stagingBufferMemory);
-
-        // Begin command buffer - all operations in one submission
-        VkCommandBuffer commandBuffer = tknBeginSingleTimeCommands(pTknGfxContext);
+        // Copy data to the staging ring, the commands run before the next frame's graphics work
+        TknUpload tknUpload = tknBeginUpload(pTknGfxContext, dataSize);
+        memcpy(tknUpload.mapped, data, (size_t)dataSize);
+        VkCommandBuffer commandBuffer = tknUpload.vkCommandBuffer;
 
         // Transition image layout for transfer (UNDEFINED -> TRANSFER_DST)
         VkImageMemoryBarrier barrier1 = {};
@@ -64,7 +61,7 @@ TknImage *tknCreateImagePtr(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D
 
         // Copy buffer to image
         VkBufferImageCopy region = {};
-        region.bufferOffset = 0;
+        region.bufferOffset = tknUpload.offset;
         region.bufferRowLength = 0;
         region.bufferImageHeight = 0;
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -74,13 +71,13 @@ TknImage *tknCreateImagePtr(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D
         region.imageOffset = (VkOffset3D){0, 0, 0};
         region.imageExtent = (VkExtent3D){width, height, 1};
 
-        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, pTknImage->vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        vkCmdCopyBufferToImage(commandBuffer, tknUpload.vkBuffer, pTknImage->vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
-        // Transition image layout for shader access (TRANSFER_DST -> SHADER_READ_ONLY)
+        // Transition image layout for shader access (TRANSFER_DST -> SHADER_READ_ONLY or GENERAL)
         VkImageMemoryBarrier barrier2 = {};
         barrier2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier2.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier2.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier2.newLayout = pTknImage->vkImageLayout;
         barrier2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         barrier2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         barrier2.image = pTknImage->vkImage;
@@ -94,24 +91,21 @@ TknImage *tknCreateImagePtr(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D
 
         vkCmdPipelineBarrier(commandBuffer,
                              VK_PIPELINE_STAGE_TRANSFER_BIT,
-                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                              0, 0, NULL, 0, NULL, 1, &barrier2);
 
-        // Submit all commands once
-        tknEndSingleTimeCommands(pTknGfxContext, commandBuffer);
-
-        // Clean up staging buffer
-        tknDestroyVkBuffer(pTknGfxContext, stagingBuffer, stagingBufferMemory);
+        tknEndUpload(pTknGfxContext, tknUpload);
     }
     else
     {
-        // Empty image - transition from UNDEFINED to SHADER_READ_ONLY for initial state
-        VkCommandBuffer commandBuffer = tknBeginSingleTimeCommands(pTknGfxContext);
+        // Empty image - transition from UNDEFINED to its shader layout for initial state
+        TknUpload tknUpload = tknBeginUpload(pTknGfxContext, 0);
+        VkCommandBuffer commandBuffer = tknUpload.vkCommandBuffer;
 
         VkImageMemoryBarrier barrier = {};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout = pTknImage->vkImageLayout;
         barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         barrier.image = pTknImage->vkImage;
@@ -125,18 +119,21 @@ TknImage *tknCreateImagePtr(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D
 
         vkCmdPipelineBarrier(commandBuffer,
                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                              0, 0, NULL, 0, NULL, 1, &barrier);
 
-        tknEndSingleTimeCommands(pTknGfxContext, commandBuffer);
+        tknEndUpload(pTknGfxContext, tknUpload);
     }
     return pTknImage;
 }
 void tknDestroyImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage)
 {
-    tknClearBindingPtrHashSet(pTknGfxContext, pTknImage->tknBindingPtrHashSet);
+    // Retiring the transfer touches the image, so it has to finish first
+    tknWaitUpload(pTknGfxContext, pTknImage->tknUploadTicket);
+    tknClearBindingPtrHashSet(pTknGfxContext, &pTknImage->tknBindingPtrHashSet);
     tknDestroyHashSet(pTknImage->tknBindingPtrHashSet);
-    tknDestroyVkImage(pTknGfxContext, pTknImage->vkImage, pTknImage->vkDeviceMemory, pTknImage->vkImageView);
+    // Frames in flight may still sample the image
+    tknRetireVkImage(pTknGfxContext, pTknImage->vkImage, pTknImage->tknMemoryAllocation, pTknImage->vkImageView);
     tknFree(pTknImage);
 }
 void tknUpdateImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage, uint32_t count, void **datas, VkOffset3D *imageOffsets, VkExtent3D *imageExtents, VkDeviceSize *dataSizes)
@@ -148,16 +145,9 @@ void tknUpdateImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage, uint3
         totalSize += dataSizes[i];
     }
 
-    // Create staging buffer
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    tknCreateVkBuffer(pTknGfxContext, totalSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                   &stagingBuffer, &stagingBufferMemory);
-
-    // Copy all data to staging buffer
-    void *mappedData;
-    vkMapMemory(pTknGfxContext->vkDevice, stagingBufferMemory, 0, totalSize, 0, &mappedData);
+    // Copy all data to the staging ring
+    TknUpload tknUpload = tknBeginUpload(pTknGfxContext, totalSize);
+    void *mappedData = tknUpload.mapped;
     
     VkDeviceSize currentOffset = 0;
     for (uint32_t i = 0; i < count; i++)
@@ -165,16 +155,15 @@ void tknUpdateImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage, uint3
         memcpy((char *)mappedData + currentOffset, datas[i], (size_t)dataSizes[i]);
         currentOffset += dataSizes[i];
     }
-    
-    vkUnmapMemory(pTknGfxContext->vkDevice, stagingBufferMemory);
 
-    // Begin command buffer - all operations in one submission
-    VkCommandBuffer commandBuffer = tknBeginSingleTimeCommands(pTknGfxContext);
 
-    // Transition image layout for transfer (SHADER_READ_ONLY -> TRANSFER_DST)
+    // Recorded ahead of the next frame's graphics work
+    VkCommandBuffer commandBuffer = tknUpload.vkCommandBuffer;
+
+    // Transition image layout for transfer (SHADER_READ_ONLY or GENERAL -> TRANSFER_DST)
     VkImageMemoryBarrier barrier1 = {};
     barrier1.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier1.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier1.oldLayout = pTknImage->vkImageLayout;
     barrier1.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     barrier1.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier1.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
@@ -188,13 +177,14 @@ void tknUpdateImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage, uint3
     barrier1.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
     vkCmdPipelineBarrier(commandBuffer,
-                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                          VK_PIPELINE_STAGE_TRANSFER_BIT,
                          0, 0, NULL, 0, NULL, 1, &barrier1);
 
     // Build all copy regions
-    VkBufferImageCopy *regions = tknMalloc(sizeof(VkBufferImageCopy) * count);
-    currentOffset = 0;
+    size_t scratchMarker = tknGetScratchMarker();
+    VkBufferImageCopy *regions = tknAllocateScratch(sizeof(VkBufferImageCopy) * count);
+    currentOffset = tknUpload.offset;
     
     for (uint32_t i = 0; i < count; i++)
     {
@@ -212,16 +202,16 @@ void tknUpdateImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage, uint3
     }
 
     // Copy all regions in one command
-    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, pTknImage->vkImage, 
+    vkCmdCopyBufferToImage(commandBuffer, tknUpload.vkBuffer, pTknImage->vkImage, 
                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, count, regions);
 
-    tknFree(regions);
+    tknRewindScratch(scratchMarker);
 
-    // Transition image layout back to shader access (TRANSFER_DST -> SHADER_READ_ONLY)
+    // Transition image layout back to shader access (TRANSFER_DST -> SHADER_READ_ONLY or GENERAL)
     VkImageMemoryBarrier barrier2 = {};
     barrier2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier2.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier2.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier2.newLayout = pTknImage->vkImageLayout;
     barrier2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier2.image = pTknImage->vkImage;
@@ -235,12 +225,8 @@ void tknUpdateImagePtr(TknGfxContext *pTknGfxContext, TknImage *pTknImage, uint3
 
     vkCmdPipelineBarrier(commandBuffer,
                          VK_PIPELINE_STAGE_TRANSFER_BIT,
-                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                          0, 0, NULL, 0, NULL, 1, &barrier2);
 
-    // Submit all commands once
-    tknEndSingleTimeCommands(pTknGfxContext, commandBuffer);
-
-    // Clean up staging buffer
-    tknDestroyVkBuffer(pTknGfxContext, stagingBuffer, stagingBufferMemory);
+    tknEndUpload(pTknGfxContext, tknUpload);
 }
\ No newline at end of file
@@ -1,5 +1,59 @@
 #include "tknGfxCore.h"
 
+static void tknCreateInstanceVkBuffer(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance)
+{
+    // Every frame in flight owns tknMaxInstanceCount instances, frame N lives at N * tknMaxInstanceCount
+    VkDeviceSize bufferSize = (VkDeviceSize)pTknInstance->tknMaxInstanceCount * pTknInstance->pTknVertexInputLayout->stride * pTknGfxContext->tknFrameInFlightCount;
+    tknCreateVkBuffer(pTknGfxContext, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, TKN_MEMORY_USAGE_INSTANCE, &pTknInstance->tknInstanceVkBuffer, &pTknInstance->tknInstanceMemoryAllocation);
+    pTknInstance->tknInstanceMappedBuffer = pTknInstance->tknInstanceMemoryAllocation.mapped;
+    pTknInstance->instances = tknMalloc((size_t)pTknInstance->tknMaxInstanceCount * pTknInstance->pTknVertexInputLayout->stride);
+}
+static void tknRetireInstanceVkBuffer(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance)
+{
+    // Frames in flight may still read the old buffer
+    tknRetireVkBuffer(pTknGfxContext, pTknInstance->tknInstanceVkBuffer, pTknInstance->tknInstanceMemoryAllocation);
+    tknFree(pTknInstance->instances);
+    pTknInstance->tknInstanceVkBuffer = VK_NULL_HANDLE;
+    pTknInstance->tknInstanceMemoryAllocation = (TknMemoryAllocation){0};
+    pTknInstance->tknInstanceMappedBuffer = NULL;
+    pTknInstance->instances = NULL;
+}
+static void tknWriteInstanceFrames(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance)
+{
+    // No frame can be using a new buffer yet, so every copy is written directly, even in the middle of a frame
+    VkDeviceSize frameSize = (VkDeviceSize)pTknInstance->tknMaxInstanceCount * pTknInstance->pTknVertexInputLayout->stride;
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        memcpy((char *)pTknInstance->tknInstanceMappedBuffer + frameIndex * frameSize, pTknInstance->instances, (size_t)pTknInstance->tknInstanceCount * pTknInstance->pTknVertexInputLayout->stride);
+        pTknInstance->tknFrameInstanceCounts[frameIndex] = pTknInstance->tknInstanceCount;
+    }
+    if (pTknInstance->dirtyFrameMask != 0)
+    {
+        tknRemoveFromHashSet(&pTknGfxContext->tknDirtyInstancePtrHashSet, &pTknInstance);
+        pTknInstance->dirtyFrameMask = 0;
+    }
+    else
+    {
+        // Skip
+    }
+}
+static void tknMarkInstanceDirty(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance, VkDeviceSize offset, VkDeviceSize end)
+{
+    if (0 == pTknInstance->dirtyFrameMask)
+    {
+        tknAddToHashSet(&pTknGfxContext->tknDirtyInstancePtrHashSet, &pTknInstance);
+        pTknInstance->dirtyOffset = offset;
+        pTknInstance->dirtyEnd = end;
+    }
+    else
+    {
+        // Some frames have not seen the earlier writes yet, keep them in the range
+        pTknInstance->dirtyOffset = offset < pTknInstance->dirtyOffset ? offset : pTknInstance->dirtyOffset;
+        pTknInstance->dirtyEnd = end > pTknInstance->dirtyEnd ? end : pTknInstance->dirtyEnd;
+    }
+    pTknInstance->dirtyFrameMask = tknGetAllFramesMask(pTknGfxContext);
+}
+
 TknInstance *tknCreateInstancePtr(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknVertexInputLayout, uint32_t tknInstanceCount, void *instances)
 {
     TknInstance *pTknInstance = tknMalloc(sizeof(TknInstance));
@@ -8,33 +62,51 @@ TknInstance *tknCreateInstancePtr(TknGfxContext *pTknGfxContext, TknVertexInputL
     *pTknInstance = (TknInstance){
         .pTknVertexInputLayout = pTknVertexInputLayout,
         .tknInstanceVkBuffer = VK_NULL_HANDLE,
-        .tknInstanceVkDeviceMemory = VK_NULL_HANDLE,
+        .tknInstanceMemoryAllocation = {0},
         .tknInstanceMappedBuffer = NULL,
         .tknInstanceCount = tknInstanceCount,
         .tknMaxInstanceCount = tknInstanceCount,
         .tknDrawCallPtrHashSet = tknDrawCallPtrHashSet,
+        .instances = NULL,
+        .tknFrameInstanceCounts = {},
+        .dirtyFrameMask = 0,
+        .dirtyOffset = 0,
+        .dirtyEnd = 0,
     };
-    
+
     if (tknInstanceCount > 0)
     {
-        VkDeviceSize bufferSize = tknInstanceCount * pTknVertexInputLayout->stride;
-        tknCreateVkBuffer(pTknGfxContext, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &pTknInstance->tknInstanceVkBuffer, &pTknInstance->tknInstanceVkDeviceMemory);
-        vkMapMemory(pTknGfxContext->vkDevice, pTknInstance->tknInstanceVkDeviceMemory, 0, bufferSize, 0, &pTknInstance->tknInstanceMappedBuffer);
-        memcpy(pTknInstance->tknInstanceMappedBuffer, instances, bufferSize);
+        VkDeviceSize instancesSize = tknInstanceCount * pTknVertexInputLayout->stride;
+        tknCreateInstanceVkBuffer(pTknGfxContext, pTknInstance);
+        memcpy(pTknInstance->instances, instances, instancesSize);
+        // No frame can be using a new buffer yet, so every copy is written directly
+        for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+        {
+            memcpy((char *)pTknInstance->tknInstanceMappedBuffer + frameIndex * instancesSize, instances, instancesSize);
+            pTknInstance->tknFrameInstanceCounts[frameIndex] = tknInstanceCount;
+        }
     }
     else
     {
         // Resources already initialized to NULL/0 above
     }
-    
+
     return pTknInstance;
 }
 void tknDestroyInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance)
 {
     tknAssert(0 == pTknInstance->tknDrawCallPtrHashSet.count, "TknInstance still has draw calls attached!");
-    if (pTknInstance->tknInstanceCount > 0)
+    if (pTknInstance->dirtyFrameMask != 0)
     {
-        tknDestroyVkBuffer(pTknGfxContext, pTknInstance->tknInstanceVkBuffer, pTknInstance->tknInstanceVkDeviceMemory);
+        tknRemoveFromHashSet(&pTknGfxContext->tknDirtyInstancePtrHashSet, &pTknInstance);
+    }
+    else
+    {
+        // Skip
+    }
+    if (pTknInstance->tknMaxInstanceCount > 0)
+    {
+        tknRetireInstanceVkBuffer(pTknGfxContext, pTknInstance);
     }
     else
     {
@@ -45,18 +117,18 @@ void tknDestroyInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInsta
 }
 void tknUpdateInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance, void *newData, uint32_t tknInstanceCount)
 {
-    VkDevice vkDevice = pTknGfxContext->vkDevice;
     VkDeviceSize newBufferSize = pTknInstance->pTknVertexInputLayout->stride * tknInstanceCount;
-    
+    bool isNewBuffer = false;
+
     if (0 == pTknInstance->tknMaxInstanceCount)
     {
         if (tknInstanceCount > 0)
         {
             pTknInstance->tknMaxInstanceCount = tknInstanceCount;
             pTknInstance->tknInstanceCount = tknInstanceCount;
-            tknCreateVkBuffer(pTknGfxContext, newBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &pTknInstance->tknInstanceVkBuffer, &pTknInstance->tknInstanceVkDeviceMemory);
-            vkMapMemory(vkDevice, pTknInstance->tknInstanceVkDeviceMemory, 0, newBufferSize, 0, &pTknInstance->tknInstanceMappedBuffer);
-            memcpy(pTknInstance->tknInstanceMappedBuffer, newData, newBufferSize);
+            tknCreateInstanceVkBuffer(pTknGfxContext, pTknInstance);
+            memcpy(pTknInstance->instances, newData, newBufferSize);
+            isNewBuffer = true;
         }
         else
         {
@@ -72,16 +144,66 @@ void tknUpdateInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstan
         else if (tknInstanceCount <= pTknInstance->tknMaxInstanceCount)
         {
             pTknInstance->tknInstanceCount = tknInstanceCount;
-            memcpy(pTknInstance->tknInstanceMappedBuffer, newData, newBufferSize);
+            memcpy(pTknInstance->instances, newData, newBufferSize);
         }
         else
         {
-            tknDestroyVkBuffer(pTknGfxContext, pTknInstance->tknInstanceVkBuffer, pTknInstance->tknInstanceVkDeviceMemory);
+            tknRetireInstanceVkBuffer(pTknGfxContext, pTknInstance);
             pTknInstance->tknMaxInstanceCount = tknInstanceCount;
             pTknInstance->tknInstanceCount = tknInstanceCount;
-            tknCreateVkBuffer(pTknGfxContext, newBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &pTknInstance->tknInstanceVkBuffer, &pTknInstance->tknInstanceVkDeviceMemory);
-            vkMapMemory(vkDevice, pTknInstance->tknInstanceVkDeviceMemory, 0, newBufferSize, 0, &pTknInstance->tknInstanceMappedBuffer);
-            memcpy(pTknInstance->tknInstanceMappedBuffer, newData, newBufferSize);
+            tknCreateInstanceVkBuffer(pTknGfxContext, pTknInstance);
+            memcpy(pTknInstance->instances, newData, newBufferSize);
+            isNewBuffer = true;
         }
     }
+    if (isNewBuffer)
+    {
+        tknWriteInstanceFrames(pTknGfxContext, pTknInstance);
+    }
+    else
+    {
+        tknMarkInstanceDirty(pTknGfxContext, pTknInstance, 0, newBufferSize);
+    }
+}
+void *tknWriteInstanceRangePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance, VkDeviceSize offset, VkDeviceSize size)
+{
+    VkDeviceSize instancesSize = (VkDeviceSize)pTknInstance->tknInstanceCount * pTknInstance->pTknVertexInputLayout->stride;
+    // Compared without adding, so a huge offset cannot wrap back into range
+    tknAssert(offset <= instancesSize && size <= instancesSize - offset, "Range [%llu, %llu) exceeds instance data size %llu", (unsigned long long)offset, (unsigned long long)(offset + size), (unsigned long long)instancesSize);
+    tknMarkInstanceDirty(pTknGfxContext, pTknInstance, offset, offset + size);
+    return (char *)pTknInstance->instances + offset;
+}
+void tknFlushInstancePtr(TknGfxContext *pTknGfxContext, TknInstance *pTknInstance, uint32_t frameIndex)
+{
+    uint32_t frameMask = 1u << frameIndex;
+    if (pTknInstance->dirtyFrameMask & frameMask)
+    {
+        // Instances past the current count are never drawn
+        VkDeviceSize instancesSize = (VkDeviceSize)pTknInstance->tknInstanceCount * pTknInstance->pTknVertexInputLayout->stride;
+        VkDeviceSize dirtyOffset = pTknInstance->dirtyOffset;
+        VkDeviceSize dirtyEnd = pTknInstance->dirtyEnd < instancesSize ? pTknInstance->dirtyEnd : instancesSize;
+        if (dirtyOffset < dirtyEnd)
+        {
+            VkDeviceSize frameSize = (VkDeviceSize)pTknInstance->tknMaxInstanceCount * pTknInstance->pTknVertexInputLayout->stride;
+            memcpy((char *)pTknInstance->tknInstanceMappedBuffer + frameIndex * frameSize + dirtyOffset, (char *)pTknInstance->instances + dirtyOffset, (size_t)(dirtyEnd - dirtyOffset));
+        }
+        else
+        {
+            // Nothing to copy
+        }
+        pTknInstance->tknFrameInstanceCounts[frameIndex] = pTknInstance->tknInstanceCount;
+        pTknInstance->dirtyFrameMask &= ~frameMask;
+        if (0 == pTknInstance->dirtyFrameMask)
+        {
+            tknRemoveFromHashSet(&pTknGfxContext->tknDirtyInstancePtrHashSet, &pTknInstance);
+        }
+        else
+        {
+            // Other frames still need this data
+        }
+    }
+    else
+    {
+        // Skip
+    }
 }
@@ -2,10 +2,8 @@
 TknMaterial *tknCreateMaterialPtr(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet)
 {
     TknMaterial *pTknMaterial = tknMalloc(sizeof(TknMaterial));
-    VkDescriptorSet vkDescriptorSet = VK_NULL_HANDLE;
     uint32_t tknDescriptorCount = pTknDescriptorSet->tknDescriptorCount;
     TknBinding *bindings = tknMalloc(sizeof(TknBinding) * tknDescriptorCount);
-    VkDescriptorPool vkDescriptorPool = VK_NULL_HANDLE;
 
     for (uint32_t descriptorIndex = 0; descriptorIndex < tknDescriptorCount; descriptorIndex++)
     {
@@ -18,33 +16,20 @@ TknMaterial *tknCreateMaterialPtr(TknGfxContext *pTknGfxContext, TknDescriptorSe
         // Explicitly zero out the entire binding union
         memset(&bindings[descriptorIndex].tknBindingUnion, 0, sizeof(bindings[descriptorIndex].tknBindingUnion));
     }
-    VkDescriptorPoolCreateInfo vkDescriptorPoolCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-        .poolSizeCount = pTknDescriptorSet->vkDescriptorPoolSizeDynamicArray.count,
-        .pPoolSizes = pTknDescriptorSet->vkDescriptorPoolSizeDynamicArray.array,
-        .maxSets = 1,
-    };
-    VkDevice vkDevice = pTknGfxContext->vkDevice;
-    tknAssertVkResult(vkCreateDescriptorPool(vkDevice, &vkDescriptorPoolCreateInfo, NULL, &vkDescriptorPool));
-
-    VkDescriptorSetAllocateInfo vkDescriptorSetAllocateInfo = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-        .descriptorPool = vkDescriptorPool,
-        .descriptorSetCount = 1,
-        .pSetLayouts = &pTknDescriptorSet->vkDescriptorSetLayout,
-    };
-
-    tknAssertVkResult(vkAllocateDescriptorSets(vkDevice, &vkDescriptorSetAllocateInfo, &vkDescriptorSet));
-    TknHashSet tknDrawCallPtrHashSet = tknCreateHashSet(sizeof(TknDrawCall *));
     *pTknMaterial = (TknMaterial){
-        .vkDescriptorSet = vkDescriptorSet,
+        .vkDescriptorSets = {},
+        .dirtyFrameMask = 0,
+        .boundSubmitSerial = 0,
         .tknBindingCount = tknDescriptorCount,
         .pTknBindings = bindings,
-        .vkDescriptorPool = vkDescriptorPool,
         .pTknDescriptorSet = pTknDescriptorSet,
-        .tknDrawCallPtrHashSet = tknDrawCallPtrHashSet,
+        .tknDrawCallPtrHashSet = tknCreateHashSet(sizeof(TknDrawCall *)),
     };
+    // One descriptor set per frame in flight, carved out of the pools shared by the layout
+    tknAllocateVkDescriptorSets(pTknGfxContext, pTknDescriptorSet, pTknGfxContext->tknFrameInFlightCount, pTknMaterial->vkDescriptorSets);
     tknAddToHashSet(&pTknDescriptorSet->tknMaterialPtrHashSet, &pTknMaterial);
+    // Input attachments are left empty until they are bound, every other binding gets written below
+    tknMarkMaterialDirty(pTknGfxContext, pTknMaterial);
     
     // Initialize all bindings with empty resources using tknUpdateMaterialPtr
     uint32_t inputBindingCount = 0;
@@ -79,7 +64,6 @@ TknMaterial *tknCreateMaterialPtr(TknGfxContext *pTknGfxContext, TknDescriptorSe
 void tknDestroyMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial)
 {
     tknAssert(0 == pTknMaterial->tknDrawCallPtrHashSet.count, "TknMaterial still has draw calls attached!");
-    VkDevice vkDevice = pTknGfxContext->vkDevice;
     uint32_t inputBindingCount = 0;
     TknInputBinding *tknInputBindings = tknMalloc(sizeof(TknInputBinding) * pTknMaterial->tknBindingCount);
     for (uint32_t binding = 0; binding < pTknMaterial->tknBindingCount; binding++)
@@ -122,7 +106,16 @@ void tknDestroyMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMater
             }
             else if (VK_DESCRIPTOR_TYPE_STORAGE_IMAGE == vkDescriptorType)
             {
-                tknError("Storage image not yet implemented");
+                TknImage *pTknImage = pTknBinding->tknBindingUnion.tknStorageImageBinding.pTknImage;
+                if (NULL == pTknImage)
+                {
+                    // Nothing
+                }
+                else
+                {
+                    // Current image deref descriptor
+                    tknRemoveFromHashSet(&pTknImage->tknBindingPtrHashSet, &pTknBinding);
+                }
             }
             else if (VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER == vkDescriptorType)
             {
@@ -147,15 +140,29 @@ void tknDestroyMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMater
             }
             else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER == vkDescriptorType)
             {
-                tknError("Storage buffer not yet implemented");
-            }
-            else if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorType)
-            {
-                tknError("Uniform buffer dynamic not yet implemented");
+                TknStorageBuffer *pTknStorageBuffer = pTknBinding->tknBindingUnion.tknStorageBufferBinding.pTknStorageBuffer;
+                if (NULL == pTknStorageBuffer)
+                {
+                    // Nothing
+                }
+                else
+                {
+                    // Current storage buffer deref descriptor
+                    tknRemoveFromHashSet(&pTknStorageBuffer->tknBindingPtrHashSet, &pTknBinding);
+                }
             }
-            else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == vkDescriptorType)
+            else if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorType || VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == vkDescriptorType)
             {
-                tknError("Storage buffer dynamic not yet implemented");
+                TknDynamicBuffer *pTknDynamicBuffer = pTknBinding->tknBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer;
+                if (NULL == pTknDynamicBuffer)
+                {
+                    // Nothing
+                }
+                else
+                {
+                    // Current dynamic buffer deref descriptor
+                    tknRemoveFromHashSet(&pTknDynamicBuffer->tknBindingPtrHashSet, &pTknBinding);
+                }
             }
             else
             {
@@ -178,85 +185,56 @@ void tknDestroyMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMater
     tknFree(tknInputBindings);
 
     tknRemoveFromHashSet(&pTknMaterial->pTknDescriptorSet->tknMaterialPtrHashSet, &pTknMaterial);
+    if (pTknMaterial->dirtyFrameMask != 0)
+    {
+        tknRemoveFromHashSet(&pTknGfxContext->tknDirtyMaterialPtrHashSet, &pTknMaterial);
+    }
+    else
+    {
+        // Skip
+    }
     tknDestroyHashSet(pTknMaterial->tknDrawCallPtrHashSet);
-    // Destroying the descriptor pool automatically frees all descriptor sets allocated from it
-    vkDestroyDescriptorPool(vkDevice, pTknMaterial->vkDescriptorPool, NULL);
+    // Frames in flight may still have the descriptor sets bound, they return to the free list once those frames are done
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        tknRetireVkDescriptorSet(pTknGfxContext, pTknMaterial->pTknDescriptorSet, pTknMaterial->vkDescriptorSets[frameIndex]);
+    }
     tknFree(pTknMaterial->pTknBindings);
     tknFree(pTknMaterial);
 }
 
 void tknBindAttachmentsToMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial)
 {
-    uint32_t vkWriteDescriptorSetCount = 0;
+    bool hasInputAttachment = false;
     for (uint32_t binding = 0; binding < pTknMaterial->tknBindingCount; binding++)
     {
         TknBinding *pTknBinding = &pTknMaterial->pTknBindings[binding];
         if (pTknBinding->vkDescriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
         {
-            vkWriteDescriptorSetCount++;
+            TknAttachment *pInputAttachment = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment;
+            tknAssert(pInputAttachment != NULL, "TknBinding %d is not bound to an attachment", binding);
+            if (TKN_ATTACHMENT_TYPE_DYNAMIC == pInputAttachment->tknAttachmentType)
+            {
+                tknAddToHashSet(&pInputAttachment->tknAttachmentUnion.tknDynamicAttachment.tknBindingPtrHashSet, &pTknBinding);
+            }
+            else if (TKN_ATTACHMENT_TYPE_FIXED == pInputAttachment->tknAttachmentType)
+            {
+                tknAddToHashSet(&pInputAttachment->tknAttachmentUnion.tknFixedAttachment.tknBindingPtrHashSet, &pTknBinding);
+            }
+            else
+            {
+                tknError("Swapchain attachment cannot be used as input attachment (attachment type: %d)", pInputAttachment->tknAttachmentType);
+            }
+            hasInputAttachment = true;
         }
         else
         {
             // Skip
         }
     }
-    if (vkWriteDescriptorSetCount > 0)
+    if (hasInputAttachment)
     {
-        uint32_t vkWriteDescriptorSetIndex = 0;
-        VkWriteDescriptorSet *vkWriteDescriptorSets = tknMalloc(sizeof(VkWriteDescriptorSet) * vkWriteDescriptorSetCount);
-        VkDescriptorImageInfo *vkDescriptorImageInfos = tknMalloc(sizeof(VkDescriptorImageInfo) * vkWriteDescriptorSetCount);
-        VkDescriptorType vkDescriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
-        for (uint32_t binding = 0; binding < pTknMaterial->tknBindingCount; binding++)
-        {
-            TknBinding *pTknBinding = &pTknMaterial->pTknBindings[binding];
-            if (pTknBinding->vkDescriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
-            {
-                TknAttachment *pInputAttachment = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment;
-                tknAssert(pInputAttachment != NULL, "TknBinding %d is not bound to an attachment", binding);
-                VkImageView vkImageView = VK_NULL_HANDLE;
-                if (TKN_ATTACHMENT_TYPE_DYNAMIC == pInputAttachment->tknAttachmentType)
-                {
-                    vkImageView = pInputAttachment->tknAttachmentUnion.tknDynamicAttachment.vkImageView;
-                    tknAddToHashSet(&pInputAttachment->tknAttachmentUnion.tknDynamicAttachment.tknBindingPtrHashSet, &pTknBinding);
-                }
-                else if (TKN_ATTACHMENT_TYPE_FIXED == pInputAttachment->tknAttachmentType)
-                {
-                    vkImageView = pInputAttachment->tknAttachmentUnion.tknFixedAttachment.vkImageView;
-                    tknAddToHashSet(&pInputAttachment->tknAttachmentUnion.tknFixedAttachment.tknBindingPtrHashSet, &pTknBinding);
-                }
-                else
-                {
-                    tknError("Swapchain attachment cannot be used as input attachment (attachment type: %d)", pInputAttachment->tknAttachmentType);
-                }
-
-                vkDescriptorImageInfos[vkWriteDescriptorSetIndex] = (VkDescriptorImageInfo){
-                    .sampler = VK_NULL_HANDLE,
-                    .imageView = vkImageView,
-                    .imageLayout = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.vkImageLayout,
-                };
-
-                vkWriteDescriptorSets[vkWriteDescriptorSetIndex] = (VkWriteDescriptorSet){
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = pTknMaterial->vkDescriptorSet,
-                    .dstBinding = binding,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = vkDescriptorType,
-                    .pImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetIndex],
-                    .pBufferInfo = VK_NULL_HANDLE,
-                    .pTexelBufferView = VK_NULL_HANDLE,
-                };
-                vkWriteDescriptorSetIndex++;
-            }
-            else
-            {
-                // Skip
-            }
-        }
-        VkDevice vkDevice = pTknGfxContext->vkDevice;
-        vkUpdateDescriptorSets(vkDevice, vkWriteDescriptorSetCount, vkWriteDescriptorSets, 0, NULL);
-        tknFree(vkDescriptorImageInfos);
-        tknFree(vkWriteDescriptorSets);
+        tknMarkMaterialDirty(pTknGfxContext, pTknMaterial);
     }
     else
     {
@@ -265,118 +243,327 @@ void tknBindAttachmentsToMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial
 }
 void tknUnbindAttachmentsFromMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial)
 {
-    uint32_t vkWriteDescriptorSetCount = 0;
+    bool hasInputAttachment = false;
     for (uint32_t binding = 0; binding < pTknMaterial->tknBindingCount; binding++)
     {
         TknBinding *pTknBinding = &pTknMaterial->pTknBindings[binding];
         if (pTknBinding->vkDescriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
         {
-            vkWriteDescriptorSetCount++;
+            TknAttachment *pTknAttachment = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment;
+            tknAssert(pTknAttachment != NULL, "TknBinding %d is not bound to an attachment", binding);
+            pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment = NULL;
+
+            if (TKN_ATTACHMENT_TYPE_DYNAMIC == pTknAttachment->tknAttachmentType)
+            {
+                tknRemoveFromHashSet(&pTknAttachment->tknAttachmentUnion.tknDynamicAttachment.tknBindingPtrHashSet, &pTknBinding);
+            }
+            else if (TKN_ATTACHMENT_TYPE_FIXED == pTknAttachment->tknAttachmentType)
+            {
+                tknRemoveFromHashSet(&pTknAttachment->tknAttachmentUnion.tknFixedAttachment.tknBindingPtrHashSet, &pTknBinding);
+            }
+            else
+            {
+                tknError("Swapchain attachment cannot be used as input attachment (attachment type: %d)", pTknAttachment->tknAttachmentType);
+            }
+            hasInputAttachment = true;
         }
         else
         {
             // Skip
         }
     }
-    if (vkWriteDescriptorSetCount > 0)
+    if (hasInputAttachment)
+    {
+        // Unbound input attachments are written with the empty image
+        tknMarkMaterialDirty(pTknGfxContext, pTknMaterial);
+    }
+    else
+    {
+        return;
+    }
+}
+void tknUpdateAttachmentOfMaterialPtr(TknGfxContext *pTknGfxContext, TknBinding *pTknBinding)
+{
+    tknAssert(pTknBinding->vkDescriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, "TknBinding is not an input attachment");
+    tknAssert(pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment != NULL, "TknBinding is not bound to an attachment");
+    tknMarkMaterialDirty(pTknGfxContext, pTknBinding->pTknMaterial);
+}
+
+void tknMarkMaterialDirty(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial)
+{
+    if (0 == pTknMaterial->dirtyFrameMask)
+    {
+        tknAddToHashSet(&pTknGfxContext->tknDirtyMaterialPtrHashSet, &pTknMaterial);
+    }
+    else
+    {
+        // Already waiting for a flush
+    }
+    pTknMaterial->dirtyFrameMask = tknGetAllFramesMask(pTknGfxContext);
+    if (pTknGfxContext->isFrameRecording && pTknMaterial->boundSubmitSerial != pTknGfxContext->tknSubmitSerial + 1)
     {
-        uint32_t vkWriteDescriptorSetIndex = 0;
-        VkWriteDescriptorSet *vkWriteDescriptorSets = tknMalloc(sizeof(VkWriteDescriptorSet) * vkWriteDescriptorSetCount);
-        VkDescriptorImageInfo *vkDescriptorImageInfos = tknMalloc(sizeof(VkDescriptorImageInfo) * vkWriteDescriptorSetCount);
+        // The recording frame has not bound its set and its previous submission is done, so the set can take the write now
+        tknFlushMaterialPtr(pTknGfxContext, pTknMaterial, pTknGfxContext->tknFrameIndex);
+    }
+    else
+    {
+        // Written when the frame is acquired next time, a bound set must not change before the command buffer is submitted
+    }
+}
+
+// Called before a frame binds the material, draw queue workers find it already marked so only the main thread writes
+void tknMarkMaterialBound(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial)
+{
+    uint64_t recordingSubmitSerial = pTknGfxContext->tknSubmitSerial + 1;
+    if (pTknMaterial->boundSubmitSerial != recordingSubmitSerial)
+    {
+        pTknMaterial->boundSubmitSerial = recordingSubmitSerial;
+    }
+    else
+    {
+        // Skip
+    }
+}
+
+// Rewrites the whole descriptor set of one frame from the binding state, so no write is ever done on a set in flight
+void tknFlushMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial, uint32_t frameIndex)
+{
+    uint32_t frameMask = 1u << frameIndex;
+    if (pTknMaterial->dirtyFrameMask & frameMask)
+    {
+        uint32_t vkWriteDescriptorSetCount = 0;
+        size_t scratchMarker = tknGetScratchMarker();
+        VkWriteDescriptorSet *vkWriteDescriptorSets = tknAllocateScratch(sizeof(VkWriteDescriptorSet) * pTknMaterial->tknBindingCount);
+        VkDescriptorImageInfo *vkDescriptorImageInfos = tknAllocateScratch(sizeof(VkDescriptorImageInfo) * pTknMaterial->tknBindingCount);
+        VkDescriptorBufferInfo *vkDescriptorBufferInfos = tknAllocateScratch(sizeof(VkDescriptorBufferInfo) * pTknMaterial->tknBindingCount);
         for (uint32_t binding = 0; binding < pTknMaterial->tknBindingCount; binding++)
         {
             TknBinding *pTknBinding = &pTknMaterial->pTknBindings[binding];
-            if (pTknBinding->vkDescriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
+            VkDescriptorType vkDescriptorType = pTknBinding->vkDescriptorType;
+            VkDescriptorImageInfo *pVkDescriptorImageInfo = NULL;
+            VkDescriptorBufferInfo *pVkDescriptorBufferInfo = NULL;
+            if (VK_DESCRIPTOR_TYPE_SAMPLER == vkDescriptorType)
+            {
+                TknSampler *pTknSampler = pTknBinding->tknBindingUnion.tknSamplerBinding.pTknSampler;
+                if (NULL != pTknSampler)
+                {
+                    pVkDescriptorImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetCount];
+                    *pVkDescriptorImageInfo = (VkDescriptorImageInfo){
+                        .sampler = pTknSampler->vkSampler,
+                        .imageView = VK_NULL_HANDLE,
+                        .imageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    };
+                }
+                else
+                {
+                    // Skip
+                }
+            }
+            else if (VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER == vkDescriptorType)
+            {
+                TknSampler *pTknSampler = pTknBinding->tknBindingUnion.tknCombinedImageSamplerBinding.pTknSampler;
+                TknImage *pTknImage = pTknBinding->tknBindingUnion.tknCombinedImageSamplerBinding.pTknImage;
+                if (NULL != pTknSampler && NULL != pTknImage)
+                {
+                    pVkDescriptorImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetCount];
+                    *pVkDescriptorImageInfo = (VkDescriptorImageInfo){
+                        .sampler = pTknSampler->vkSampler,
+                        .imageView = pTknImage->vkImageView,
+                        .imageLayout = pTknImage->vkImageLayout,
+                    };
+                }
+                else
+                {
+                    // Skip
+                }
+            }
+            else if (VK_DESCRIPTOR_TYPE_STORAGE_IMAGE == vkDescriptorType)
+            {
+                TknImage *pTknImage = pTknBinding->tknBindingUnion.tknStorageImageBinding.pTknImage;
+                if (NULL != pTknImage)
+                {
+                    pVkDescriptorImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetCount];
+                    *pVkDescriptorImageInfo = (VkDescriptorImageInfo){
+                        .sampler = VK_NULL_HANDLE,
+                        .imageView = pTknImage->vkImageView,
+                        .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                    };
+                }
+                else
+                {
+                    // Skip
+                }
+            }
+            else if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == vkDescriptorType)
+            {
+                TknUniformBuffer *pTknUniformBuffer = pTknBinding->tknBindingUnion.tknUniformBufferBinding.pTknUniformBuffer;
+                if (NULL != pTknUniformBuffer)
+                {
+                    pVkDescriptorBufferInfo = &vkDescriptorBufferInfos[vkWriteDescriptorSetCount];
+                    *pVkDescriptorBufferInfo = (VkDescriptorBufferInfo){
+                        .buffer = pTknUniformBuffer->vkBuffer,
+                        .offset = frameIndex * pTknUniformBuffer->frameStride,
+                        .range = pTknUniformBuffer->size,
+                    };
+                }
+                else
+                {
+                    // Skip
+                }
+            }
+            else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER == vkDescriptorType)
+            {
+                TknStorageBuffer *pTknStorageBuffer = pTknBinding->tknBindingUnion.tknStorageBufferBinding.pTknStorageBuffer;
+                if (NULL != pTknStorageBuffer)
+                {
+                    // Shared by every frame, shaders order their accesses with barriers
+                    pVkDescriptorBufferInfo = &vkDescriptorBufferInfos[vkWriteDescriptorSetCount];
+                    *pVkDescriptorBufferInfo = (VkDescriptorBufferInfo){
+                        .buffer = pTknStorageBuffer->vkBuffer,
+                        .offset = 0,
+                        .range = pTknStorageBuffer->size,
+                    };
+                }
+                else
+                {
+                    // Skip
+                }
+            }
+            else if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorType || VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == vkDescriptorType)
+            {
+                TknDynamicBuffer *pTknDynamicBuffer = pTknBinding->tknBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer;
+                if (NULL != pTknDynamicBuffer)
+                {
+                    // One element wide, the frame copy and the element are picked by the dynamic offset when the set is bound
+                    pVkDescriptorBufferInfo = &vkDescriptorBufferInfos[vkWriteDescriptorSetCount];
+                    *pVkDescriptorBufferInfo = (VkDescriptorBufferInfo){
+                        .buffer = pTknDynamicBuffer->vkBuffer,
+                        .offset = 0,
+                        .range = pTknDynamicBuffer->elementSize,
+                    };
+                }
+                else
+                {
+                    // Skip
+                }
+            }
+            else if (VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT == vkDescriptorType)
             {
                 TknAttachment *pTknAttachment = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment;
-                tknAssert(pTknAttachment != NULL, "TknBinding %d is not bound to an attachment", binding);
-                pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment = NULL;
-
-                if (TKN_ATTACHMENT_TYPE_DYNAMIC == pTknAttachment->tknAttachmentType)
+                VkImageView vkImageView = VK_NULL_HANDLE;
+                VkImageLayout vkImageLayout = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.vkImageLayout;
+                if (NULL == pTknAttachment)
                 {
-                    tknRemoveFromHashSet(&pTknAttachment->tknAttachmentUnion.tknDynamicAttachment.tknBindingPtrHashSet, &pTknBinding);
+                    vkImageView = pTknGfxContext->pTknEmptyImage->vkImageView;
+                    vkImageLayout = VK_IMAGE_LAYOUT_GENERAL;
+                }
+                else if (TKN_ATTACHMENT_TYPE_DYNAMIC == pTknAttachment->tknAttachmentType)
+                {
+                    vkImageView = pTknAttachment->tknAttachmentUnion.tknDynamicAttachment.vkImageView;
                 }
                 else if (TKN_ATTACHMENT_TYPE_FIXED == pTknAttachment->tknAttachmentType)
                 {
-                    tknRemoveFromHashSet(&pTknAttachment->tknAttachmentUnion.tknFixedAttachment.tknBindingPtrHashSet, &pTknBinding);
+                    vkImageView = pTknAttachment->tknAttachmentUnion.tknFixedAttachment.vkImageView;
                 }
                 else
                 {
                     tknError("Swapchain attachment cannot be used as input attachment (attachment type: %d)", pTknAttachment->tknAttachmentType);
                 }
-                VkImageView vkImageView = pTknGfxContext->pTknEmptyImage->vkImageView;
-                vkDescriptorImageInfos[vkWriteDescriptorSetIndex] = (VkDescriptorImageInfo){
+                pVkDescriptorImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetCount];
+                *pVkDescriptorImageInfo = (VkDescriptorImageInfo){
                     .sampler = VK_NULL_HANDLE,
                     .imageView = vkImageView,
-                    .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                    .imageLayout = vkImageLayout,
                 };
-                vkWriteDescriptorSets[vkWriteDescriptorSetIndex] = (VkWriteDescriptorSet){
+            }
+            else
+            {
+                // Unsupported types are rejected when the material is updated
+            }
+
+            if (NULL != pVkDescriptorImageInfo || NULL != pVkDescriptorBufferInfo)
+            {
+                vkWriteDescriptorSets[vkWriteDescriptorSetCount] = (VkWriteDescriptorSet){
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = pTknMaterial->vkDescriptorSet,
+                    .dstSet = pTknMaterial->vkDescriptorSets[frameIndex],
                     .dstBinding = binding,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
-                    .pImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetIndex],
-                    .pBufferInfo = VK_NULL_HANDLE,
-                    .pTexelBufferView = VK_NULL_HANDLE,
+                    .descriptorType = vkDescriptorType,
+                    .pImageInfo = pVkDescriptorImageInfo,
+                    .pBufferInfo = pVkDescriptorBufferInfo,
+                    .pTexelBufferView = NULL,
                 };
-                vkWriteDescriptorSetIndex++;
+                vkWriteDescriptorSetCount++;
             }
             else
             {
                 // Skip
             }
         }
-        VkDevice vkDevice = pTknGfxContext->vkDevice;
-        vkUpdateDescriptorSets(vkDevice, vkWriteDescriptorSetCount, vkWriteDescriptorSets, 0, NULL);
-        tknFree(vkDescriptorImageInfos);
-        tknFree(vkWriteDescriptorSets);
+        if (vkWriteDescriptorSetCount > 0)
+        {
+            vkUpdateDescriptorSets(pTknGfxContext->vkDevice, vkWriteDescriptorSetCount, vkWriteDescriptorSets, 0, NULL);
+        }
+        else
+        {
+            // Skip
+        }
+        tknRewindScratch(scratchMarker);
+
+        pTknMaterial->dirtyFrameMask &= ~frameMask;
+        if (0 == pTknMaterial->dirtyFrameMask)
+        {
+            tknRemoveFromHashSet(&pTknGfxContext->tknDirtyMaterialPtrHashSet, &pTknMaterial);
+        }
+        else
+        {
+            // Other frames still need this write
+        }
     }
     else
     {
-        return;
+        // Skip
     }
 }
-void tknUpdateAttachmentOfMaterialPtr(TknGfxContext *pTknGfxContext, TknBinding *pTknBinding)
-{
-    tknAssert(pTknBinding->vkDescriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, "TknBinding is not an input attachment");
-    tknAssert(pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment != NULL, "TknBinding is not bound to an attachment");
 
-    TknAttachment *pTknAttachment = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.pTknAttachment;
-    VkImageView vkImageView = VK_NULL_HANDLE;
-
-    if (TKN_ATTACHMENT_TYPE_DYNAMIC == pTknAttachment->tknAttachmentType)
-    {
-        vkImageView = pTknAttachment->tknAttachmentUnion.tknDynamicAttachment.vkImageView;
-    }
-    else if (TKN_ATTACHMENT_TYPE_FIXED == pTknAttachment->tknAttachmentType)
+// Offsets of the dynamic bindings in binding order, each selects the copy of the frame plus the draw's element.
+// drawOffsets may be NULL when every binding uses its first element
+uint32_t tknGetMaterialDynamicOffsets(TknMaterial *pTknMaterial, uint32_t frameIndex, const uint32_t *drawOffsets, uint32_t *dynamicOffsets)
+{
+    uint32_t dynamicOffsetCount = 0;
+    if (pTknMaterial->pTknDescriptorSet->tknDynamicOffsetCount > 0)
     {
-        vkImageView = pTknAttachment->tknAttachmentUnion.tknFixedAttachment.vkImageView;
+        for (uint32_t binding = 0; binding < pTknMaterial->tknBindingCount; binding++)
+        {
+            TknBinding *pTknBinding = &pTknMaterial->pTknBindings[binding];
+            if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == pTknBinding->vkDescriptorType || VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == pTknBinding->vkDescriptorType)
+            {
+                TknDynamicBuffer *pTknDynamicBuffer = pTknBinding->tknBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer;
+                uint32_t drawOffset = NULL != drawOffsets ? drawOffsets[dynamicOffsetCount] : 0;
+                if (NULL != pTknDynamicBuffer)
+                {
+                    tknAssert(drawOffset + pTknDynamicBuffer->elementSize <= pTknDynamicBuffer->frameStride, "Dynamic offset %u of binding %u is past the last element", drawOffset, binding);
+                    dynamicOffsets[dynamicOffsetCount] = (uint32_t)(frameIndex * pTknDynamicBuffer->frameStride) + drawOffset;
+                }
+                else
+                {
+                    // Unbound bindings still take an offset, zero stays within any buffer
+                    dynamicOffsets[dynamicOffsetCount] = 0;
+                }
+                dynamicOffsetCount++;
+            }
+            else
+            {
+                // Skip
+            }
+        }
     }
     else
     {
-        tknError("Swapchain attachment cannot be used as input attachment (attachment type: %d)", pTknAttachment->tknAttachmentType);
+        // Skip
     }
-
-    VkDescriptorImageInfo vkDescriptorImageInfo = {
-        .sampler = VK_NULL_HANDLE,
-        .imageView = vkImageView,
-        .imageLayout = pTknBinding->tknBindingUnion.tknInputAttachmentBinding.vkImageLayout,
-    };
-    VkWriteDescriptorSet vkWriteDescriptorSet = {
-        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = pTknBinding->pTknMaterial->vkDescriptorSet,
-        .dstBinding = pTknBinding->binding,
-        .dstArrayElement = 0,
-        .descriptorCount = 1,
-        .descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
-        .pImageInfo = &vkDescriptorImageInfo,
-        .pBufferInfo = VK_NULL_HANDLE,
-        .pTexelBufferView = VK_NULL_HANDLE,
-    };
-    VkDevice vkDevice = pTknGfxContext->vkDevice;
-    vkUpdateDescriptorSets(vkDevice, 1, &vkWriteDescriptorSet, 0, NULL);
+    return dynamicOffsetCount;
 }
 
 TknMaterial *tknGetGlobalMaterialPtr(TknGfxContext *pTknGfxContext)
@@ -384,21 +571,8 @@ TknMaterial *tknGetGlobalMaterialPtr(TknGfxContext *pTknGfxContext)
     tknAssert(pTknGfxContext->pTknGlobalDescriptorSet != NULL, "Global descriptor set is NULL");
     TknHashSet tknMaterialPtrHashSet = pTknGfxContext->pTknGlobalDescriptorSet->tknMaterialPtrHashSet;
     tknAssert(tknMaterialPtrHashSet.count == 1, "TknMaterial pointer hashset count is not 1");
-    for (uint32_t nodeIndex = 0; nodeIndex < tknMaterialPtrHashSet.capacity; nodeIndex++)
-    {
-        TknListNode *node = tknMaterialPtrHashSet.nodePtrs[nodeIndex];
-        if (node)
-        {
-            TknMaterial *pTknMaterial = *(TknMaterial **)node->data;
-            return pTknMaterial;
-        }
-        else
-        {
-            // Continue searching
-        }
-    }
-    tknError("Failed to find global material");
-    return NULL;
+    TknMaterial *pTknMaterial = *(TknMaterial **)tknGetFromHashSet(&tknMaterialPtrHashSet, 0);
+    return pTknMaterial;
 }
 TknMaterial *tknGetSubpassMaterialPtr(TknGfxContext *pTknGfxContext, TknRenderPass *pTknRenderPass, uint32_t subpassIndex)
 {
@@ -407,27 +581,19 @@ TknMaterial *tknGetSubpassMaterialPtr(TknGfxContext *pTknGfxContext, TknRenderPa
     tknAssert(pTknRenderPass->pTknSubpasses[subpassIndex].pTknSubpassDescriptorSet != NULL, "Subpass descriptor set is NULL");
     tknAssert(pTknRenderPass->pTknSubpasses[subpassIndex].pTknSubpassDescriptorSet->tknMaterialPtrHashSet.count == 1, "TknMaterial pointer hashset count is not 1");
     TknHashSet tknMaterialPtrHashSet = pTknRenderPass->pTknSubpasses[subpassIndex].pTknSubpassDescriptorSet->tknMaterialPtrHashSet;
-    for (uint32_t nodeIndex = 0; nodeIndex < tknMaterialPtrHashSet.capacity; nodeIndex++)
-    {
-        TknListNode *node = tknMaterialPtrHashSet.nodePtrs[nodeIndex];
-        if (node)
-        {
-            TknMaterial *pTknMaterial = *(TknMaterial **)node->data;
-            return pTknMaterial;
-        }
-        else
-        {
-            // Continue searching
-        }
-    }
-    tknError("Failed to find subpass material");
-    return NULL;
+    TknMaterial *pTknMaterial = *(TknMaterial **)tknGetFromHashSet(&tknMaterialPtrHashSet, 0);
+    return pTknMaterial;
 }
 TknMaterial *tknCreatePipelineMaterialPtr(TknGfxContext *pTknGfxContext, TknPipeline *pTknPipeline)
 {
     TknMaterial *pTknMaterial = tknCreateMaterialPtr(pTknGfxContext, pTknPipeline->pTknPipelineDescriptorSet);
     return pTknMaterial;
 }
+TknMaterial *tknCreateComputeMaterialPtr(TknGfxContext *pTknGfxContext, TknComputePipeline *pTknComputePipeline)
+{
+    TknMaterial *pTknMaterial = tknCreateMaterialPtr(pTknGfxContext, pTknComputePipeline->pTknPipelineDescriptorSet);
+    return pTknMaterial;
+}
 void tknDestroyPipelineMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMaterial)
 {
     tknDestroyMaterialPtr(pTknGfxContext, pTknMaterial);
@@ -438,10 +604,7 @@ void tknUpdateMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMateri
     if (inputBindingCount > 0)
     {
         tknAssert(NULL != pTknMaterial, "TknMaterial must not be NULL");
-        uint32_t vkWriteDescriptorSetCount = 0;
-        VkWriteDescriptorSet *vkWriteDescriptorSets = tknMalloc(sizeof(VkWriteDescriptorSet) * inputBindingCount);
-        VkDescriptorImageInfo *vkDescriptorImageInfos = tknMalloc(sizeof(VkDescriptorImageInfo) * inputBindingCount);
-        VkDescriptorBufferInfo *vkDescriptorBufferInfos = tknMalloc(sizeof(VkDescriptorBufferInfo) * inputBindingCount);
+        bool isChanged = false;
         for (uint32_t bindingIndex = 0; bindingIndex < inputBindingCount; bindingIndex++)
         {
             TknInputBinding tknInputBinding = tknInputBindings[bindingIndex];
@@ -490,25 +653,8 @@ void tknUpdateMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMateri
                     {
                         // New sampler ref descriptor
                         tknAddToHashSet(&pInputSampler->tknBindingPtrHashSet, &pTknBinding);
-                        vkDescriptorImageInfos[vkWriteDescriptorSetCount] = (VkDescriptorImageInfo){
-                            .sampler = pInputSampler->vkSampler,
-                            .imageView = VK_NULL_HANDLE,
-                            .imageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                        };
                     }
-                    VkWriteDescriptorSet vkWriteDescriptorSet = {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .dstSet = pTknMaterial->vkDescriptorSet,
-                        .dstBinding = binding,
-                        .dstArrayElement = 0,
-                        .descriptorCount = 1,
-                        .descriptorType = vkDescriptorType,
-                        .pImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetCount],
-                        .pBufferInfo = NULL,
-                        .pTexelBufferView = NULL,
-                    };
-                    vkWriteDescriptorSets[vkWriteDescriptorSetCount] = vkWriteDescriptorSet;
-                    vkWriteDescriptorSetCount++;
+                    isChanged = true;
                 }
             }
             else if (VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER == vkDescriptorType)
@@ -547,26 +693,8 @@ void tknUpdateMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMateri
                         // Add new references
                         tknAddToHashSet(&pInputSampler->tknBindingPtrHashSet, &pTknBinding);
                         tknAddToHashSet(&pInputImage->tknBindingPtrHashSet, &pTknBinding);
-                        
-                        vkDescriptorImageInfos[vkWriteDescriptorSetCount] = (VkDescriptorImageInfo){
-                            .sampler = pInputSampler->vkSampler,
-                            .imageView = pInputImage->vkImageView,
-                            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                        };
                     }
-                    VkWriteDescriptorSet vkWriteDescriptorSet = {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .dstSet = pTknMaterial->vkDescriptorSet,
-                        .dstBinding = binding,
-                        .dstArrayElement = 0,
-                        .descriptorCount = 1,
-                        .descriptorType = vkDescriptorType,
-                        .pImageInfo = &vkDescriptorImageInfos[vkWriteDescriptorSetCount],
-                        .pBufferInfo = NULL,
-                        .pTexelBufferView = NULL,
-                    };
-                    vkWriteDescriptorSets[vkWriteDescriptorSetCount] = vkWriteDescriptorSet;
-                    vkWriteDescriptorSetCount++;
+                    isChanged = true;
                 }
             }
             else if (VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE == vkDescriptorType)
@@ -575,7 +703,36 @@ void tknUpdateMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMateri
             }
             else if (VK_DESCRIPTOR_TYPE_STORAGE_IMAGE == vkDescriptorType)
             {
-                tknError("Storage image not yet implemented");
+                TknImage *pInputImage = tknInputBinding.tknInputBindingUnion.tknStorageImageBinding.pTknImage;
+                TknImage *pTknImage = pTknBinding->tknBindingUnion.tknStorageImageBinding.pTknImage;
+                if (pInputImage == pTknImage)
+                {
+                    // No change, skip
+                }
+                else
+                {
+                    if (NULL == pTknImage)
+                    {
+                        // Nothing
+                    }
+                    else
+                    {
+                        // Current image deref descriptor
+                        tknRemoveFromHashSet(&pTknImage->tknBindingPtrHashSet, &pTknBinding);
+                    }
+                    pTknBinding->tknBindingUnion.tknStorageImageBinding.pTknImage = pInputImage;
+                    if (NULL == pInputImage)
+                    {
+                        tknError("Cannot bind NULL storage image");
+                    }
+                    else
+                    {
+                        tknAssert(VK_IMAGE_LAYOUT_GENERAL == pInputImage->vkImageLayout, "Storage image binding %u needs an image created with VK_IMAGE_USAGE_STORAGE_BIT", binding);
+                        // New image ref descriptor
+                        tknAddToHashSet(&pInputImage->tknBindingPtrHashSet, &pTknBinding);
+                    }
+                    isChanged = true;
+                }
             }
             else if (VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER == vkDescriptorType)
             {
@@ -613,52 +770,89 @@ void tknUpdateMaterialPtr(TknGfxContext *pTknGfxContext, TknMaterial *pTknMateri
                     {
                         // New uniform buffer ref descriptor
                         tknAddToHashSet(&pInputUniformBuffer->tknBindingPtrHashSet, &pTknBinding);
-                        vkDescriptorBufferInfos[vkWriteDescriptorSetCount] = (VkDescriptorBufferInfo){
-                            .buffer = pInputUniformBuffer->vkBuffer,
-                            .offset = 0,
-                            .range = pInputUniformBuffer->size,
-                        };
                     }
-                    VkWriteDescriptorSet vkWriteDescriptorSet = {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .dstSet = pTknMaterial->vkDescriptorSet,
-                        .dstBinding = binding,
-                        .dstArrayElement = 0,
-                        .descriptorCount = 1,
-                        .descriptorType = vkDescriptorType,
-                        .pImageInfo = NULL,
-                        .pBufferInfo = &vkDescriptorBufferInfos[vkWriteDescriptorSetCount],
-                        .pTexelBufferView = NULL,
-                    };
-                    vkWriteDescriptorSets[vkWriteDescriptorSetCount] = vkWriteDescriptorSet;
-                    vkWriteDescriptorSetCount++;
+                    isChanged = true;
                 }
             }
             else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER == vkDescriptorType)
             {
-                tknError("Storage buffer not yet implemented");
-            }
-            else if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorType)
-            {
-                tknError("Uniform buffer dynamic not yet implemented");
+                TknStorageBuffer *pInputStorageBuffer = tknInputBinding.tknInputBindingUnion.tknStorageBufferBinding.pTknStorageBuffer;
+                TknStorageBuffer *pTknStorageBuffer = pTknBinding->tknBindingUnion.tknStorageBufferBinding.pTknStorageBuffer;
+                if (pInputStorageBuffer == pTknStorageBuffer)
+                {
+                    // No change, skip
+                }
+                else
+                {
+                    if (NULL == pTknStorageBuffer)
+                    {
+                        // Nothing
+                    }
+                    else
+                    {
+                        // Current storage buffer deref descriptor
+                        tknRemoveFromHashSet(&pTknStorageBuffer->tknBindingPtrHashSet, &pTknBinding);
+                    }
+                    pTknBinding->tknBindingUnion.tknStorageBufferBinding.pTknStorageBuffer = pInputStorageBuffer;
+                    if (NULL == pInputStorageBuffer)
+                    {
+                        tknError("Cannot bind NULL storage buffer");
+                    }
+                    else
+                    {
+                        // New storage buffer ref descriptor
+                        tknAddToHashSet(&pInputStorageBuffer->tknBindingPtrHashSet, &pTknBinding);
+                    }
+                    isChanged = true;
+                }
             }
-            else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == vkDescriptorType)
+            else if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == vkDescriptorType || VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == vkDescriptorType)
             {
-                tknError("Storage buffer dynamic not yet implemented");
+                TknDynamicBuffer *pInputDynamicBuffer = tknInputBinding.tknInputBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer;
+                TknDynamicBuffer *pTknDynamicBuffer = pTknBinding->tknBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer;
+                if (pInputDynamicBuffer == pTknDynamicBuffer)
+                {
+                    // No change, skip
+                }
+                else
+                {
+                    if (NULL == pTknDynamicBuffer)
+                    {
+                        // Nothing
+                    }
+                    else
+                    {
+                        // Current dynamic buffer deref descriptor
+                        tknRemoveFromHashSet(&pTknDynamicBuffer->tknBindingPtrHashSet, &pTknBinding);
+                    }
+                    pTknBinding->tknBindingUnion.tknDynamicBufferBinding.pTknDynamicBuffer = pInputDynamicBuffer;
+                    if (NULL == pInputDynamicBuffer)
+                    {
+                        tknError("Cannot bind NULL dynamic buffer");
+                    }
+                    else
+                    {
+                        tknAssert(pInputDynamicBuffer->vkDescriptorType == vkDescriptorType, "Dynamic buffer of descriptor type %d bound to binding of type %d", pInputDynamicBuffer->vkDescriptorType, vkDescriptorType);
+                        // New dynamic buffer ref descriptor
+                        tknAddToHashSet(&pInputDynamicBuffer->tknBindingPtrHashSet, &pTknBinding);
+                    }
+                    isChanged = true;
+                }
             }
             else
             {
                 tknError("Unsupported descriptor type: %d", vkDescriptorType);
             }
         }
-        if (vkWriteDescriptorSetCount > 0)
+        if (isChanged)
         {
-            VkDevice vkDevice = pTknGfxContext->vkDevice;
-            vkUpdateDescriptorSets(vkDevice, vkWriteDescriptorSetCount, vkWriteDescriptorSets, 0, NULL);
+            // Descriptor sets are written per frame once each frame is acquired
+            tknMarkMaterialDirty(pTknGfxContext, pTknMaterial);
+        }
+        else
+        {
+            // Skip
         }
-        tknFree(vkDescriptorBufferInfos);
-        tknFree(vkDescriptorImageInfos);
-        tknFree(vkWriteDescriptorSets);
     }
     else
     {
@@ -683,9 +877,21 @@ TknInputBindingUnion tknGetEmptyInputBindingUnion(TknGfxContext *pTknGfxContext,
         emptyUnion.tknCombinedImageSamplerBinding.pTknSampler = pTknGfxContext->pTknEmptySampler;
         emptyUnion.tknCombinedImageSamplerBinding.pTknImage = pTknGfxContext->pTknEmptyImage;
         break;
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        emptyUnion.tknStorageImageBinding.pTknImage = pTknGfxContext->pTknEmptyImage;
+        break;
     case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
         emptyUnion.tknUniformBufferBinding.pTknUniformBuffer = pTknGfxContext->pTknEmptyUniformBuffer;
         break;
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        emptyUnion.tknStorageBufferBinding.pTknStorageBuffer = pTknGfxContext->pTknEmptyStorageBuffer;
+        break;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        emptyUnion.tknDynamicBufferBinding.pTknDynamicBuffer = pTknGfxContext->pTknEmptyUniformDynamicBuffer;
+        break;
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+        emptyUnion.tknDynamicBufferBinding.pTknDynamicBuffer = pTknGfxContext->pTknEmptyStorageDynamicBuffer;
+        break;
 
     default:
         // For unsupported types, default to uniform buffer as a safe fallback
@@ -0,0 +1,248 @@
+#include "tknGfxCore.h"
+
+static uint32_t tknGetMemoryTypeIndex(TknGfxContext *pTknGfxContext, uint32_t typeFilter, VkMemoryPropertyFlags memoryPropertyFlags)
+{
+    VkPhysicalDeviceMemoryProperties *pVkPhysicalDeviceMemoryProperties = &pTknGfxContext->vkPhysicalDeviceMemoryProperties;
+    for (uint32_t i = 0; i < pVkPhysicalDeviceMemoryProperties->memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (pVkPhysicalDeviceMemoryProperties->memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)
+        {
+            return i;
+        }
+        else
+        {
+            // Memory type doesn't match requirements
+        }
+    }
+    tknError("Failed to get suitable memory type!");
+    return UINT32_MAX;
+}
+
+static VkDeviceSize tknGetMemoryBlockSize(TknGfxContext *pTknGfxContext, uint32_t memoryTypeIndex)
+{
+    uint32_t heapIndex = pTknGfxContext->vkPhysicalDeviceMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    VkDeviceSize heapSize = pTknGfxContext->vkPhysicalDeviceMemoryProperties.memoryHeaps[heapIndex].size;
+    // Small heaps, such as device local host visible memory without resizable BAR, get smaller blocks
+    VkDeviceSize blockSize = TKN_DEFAULT_MEMORY_BLOCK_SIZE;
+    while (blockSize > heapSize / 8 && blockSize > 1024 * 1024)
+    {
+        blockSize /= 2;
+    }
+    return blockSize;
+}
+
+static TknMemoryBlock *tknCreateMemoryBlockPtr(TknGfxContext *pTknGfxContext, VkDeviceSize size, uint32_t memoryTypeIndex, bool isLinear, bool isDedicated)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    TknMemoryBlock *pTknMemoryBlock = tknMalloc(sizeof(TknMemoryBlock));
+    VkDeviceMemory vkDeviceMemory = VK_NULL_HANDLE;
+    VkMemoryAllocateInfo memoryAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = NULL,
+        .allocationSize = size,
+        .memoryTypeIndex = memoryTypeIndex,
+    };
+    tknAssertVkResult(vkAllocateMemory(vkDevice, &memoryAllocateInfo, NULL, &vkDeviceMemory));
+
+    void *mapped = NULL;
+    if (pTknGfxContext->vkPhysicalDeviceMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        // Memory can only be mapped once, so the whole block is mapped and shared by its allocations
+        tknAssertVkResult(vkMapMemory(vkDevice, vkDeviceMemory, 0, VK_WHOLE_SIZE, 0, &mapped));
+    }
+    else
+    {
+        // Device only memory
+    }
+
+    *pTknMemoryBlock = (TknMemoryBlock){
+        .vkDeviceMemory = vkDeviceMemory,
+        .size = size,
+        .memoryTypeIndex = memoryTypeIndex,
+        .isLinear = isLinear,
+        .isDedicated = isDedicated,
+        .mapped = mapped,
+        .tknTlsf = isDedicated ? (TknTlsf){0} : tknCreateTlsf(size),
+    };
+    tknAddToDynamicArray(&pTknGfxContext->tknMemoryBlockPtrDynamicArray, &pTknMemoryBlock);
+    return pTknMemoryBlock;
+}
+
+static void tknDestroyMemoryBlockPtr(TknGfxContext *pTknGfxContext, TknMemoryBlock *pTknMemoryBlock)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    tknRemoveFromDynamicArray(&pTknGfxContext->tknMemoryBlockPtrDynamicArray, &pTknMemoryBlock);
+    if (pTknMemoryBlock->mapped != NULL)
+    {
+        vkUnmapMemory(vkDevice, pTknMemoryBlock->vkDeviceMemory);
+    }
+    else
+    {
+        // Skip
+    }
+    vkFreeMemory(vkDevice, pTknMemoryBlock->vkDeviceMemory, NULL);
+    if (pTknMemoryBlock->isDedicated)
+    {
+        // Dedicated blocks have no free list
+    }
+    else
+    {
+        tknDestroyTlsf(pTknMemoryBlock->tknTlsf);
+    }
+    tknFree(pTknMemoryBlock);
+}
+
+void tknPopulateMemoryAllocator(TknGfxContext *pTknGfxContext)
+{
+    vkGetPhysicalDeviceMemoryProperties(pTknGfxContext->vkPhysicalDevice, &pTknGfxContext->vkPhysicalDeviceMemoryProperties);
+    pTknGfxContext->tknMemoryBlockPtrDynamicArray = tknCreateDynamicArray(sizeof(TknMemoryBlock *), TKN_DEFAULT_COLLECTION_SIZE);
+    memset(pTknGfxContext->tknMemoryUsageSizes, 0, sizeof(pTknGfxContext->tknMemoryUsageSizes));
+}
+
+void tknCleanupMemoryAllocator(TknGfxContext *pTknGfxContext)
+{
+    while (pTknGfxContext->tknMemoryBlockPtrDynamicArray.count > 0)
+    {
+        TknMemoryBlock *pTknMemoryBlock = *(TknMemoryBlock **)tknGetFromDynamicArray(&pTknGfxContext->tknMemoryBlockPtrDynamicArray, pTknGfxContext->tknMemoryBlockPtrDynamicArray.count - 1);
+        tknAssert(!pTknMemoryBlock->isDedicated && 0 == pTknMemoryBlock->tknTlsf.allocationCount, "Device memory is still allocated before destroying TknGfxContext.");
+        tknDestroyMemoryBlockPtr(pTknGfxContext, pTknMemoryBlock);
+    }
+    tknDestroyDynamicArray(pTknGfxContext->tknMemoryBlockPtrDynamicArray);
+}
+
+TknMemoryAllocation tknAllocateMemory(TknGfxContext *pTknGfxContext, VkMemoryRequirements vkMemoryRequirements, VkMemoryPropertyFlags vkMemoryPropertyFlags, bool isLinear, TknMemoryUsage tknMemoryUsage)
+{
+    uint32_t memoryTypeIndex = tknGetMemoryTypeIndex(pTknGfxContext, vkMemoryRequirements.memoryTypeBits, vkMemoryPropertyFlags);
+    VkDeviceSize blockSize = tknGetMemoryBlockSize(pTknGfxContext, memoryTypeIndex);
+    // Linear and optimal resources only need separate blocks when they could alias within bufferImageGranularity
+    isLinear = pTknGfxContext->vkPhysicalDeviceProperties.limits.bufferImageGranularity > 1 ? isLinear : false;
+
+    TknMemoryBlock *pTknMemoryBlock = NULL;
+    uint32_t tlsfNodeIndex = TKN_TLSF_NULL_NODE;
+    uint64_t offset = 0;
+    if (vkMemoryRequirements.size > blockSize / 2)
+    {
+        // Large resources get their own block instead of splitting the shared ones
+        pTknMemoryBlock = tknCreateMemoryBlockPtr(pTknGfxContext, vkMemoryRequirements.size, memoryTypeIndex, isLinear, true);
+    }
+    else
+    {
+        for (uint32_t blockIndex = 0; blockIndex < pTknGfxContext->tknMemoryBlockPtrDynamicArray.count; blockIndex++)
+        {
+            TknMemoryBlock *pCandidateBlock = *(TknMemoryBlock **)tknGetFromDynamicArray(&pTknGfxContext->tknMemoryBlockPtrDynamicArray, blockIndex);
+            if (!pCandidateBlock->isDedicated && memoryTypeIndex == pCandidateBlock->memoryTypeIndex && isLinear == pCandidateBlock->isLinear)
+            {
+                tlsfNodeIndex = tknAllocateFromTlsf(&pCandidateBlock->tknTlsf, vkMemoryRequirements.size, vkMemoryRequirements.alignment, &offset);
+                if (tlsfNodeIndex != TKN_TLSF_NULL_NODE)
+                {
+                    pTknMemoryBlock = pCandidateBlock;
+                    break;
+                }
+                else
+                {
+                    // Block is too full or fragmented
+                }
+            }
+            else
+            {
+                // Skip
+            }
+        }
+        if (NULL == pTknMemoryBlock)
+        {
+            pTknMemoryBlock = tknCreateMemoryBlockPtr(pTknGfxContext, blockSize, memoryTypeIndex, isLinear, false);
+            tlsfNodeIndex = tknAllocateFromTlsf(&pTknMemoryBlock->tknTlsf, vkMemoryRequirements.size, vkMemoryRequirements.alignment, &offset);
+            tknAssert(tlsfNodeIndex != TKN_TLSF_NULL_NODE, "Failed to allocate %llu bytes from a new memory block", (unsigned long long)vkMemoryRequirements.size);
+        }
+        else
+        {
+            // Allocated from an existing block
+        }
+    }
+
+    pTknGfxContext->tknMemoryUsageSizes[tknMemoryUsage] += vkMemoryRequirements.size;
+    TknMemoryAllocation tknMemoryAllocation = {
+        .pTknMemoryBlock = pTknMemoryBlock,
+        .tlsfNodeIndex = tlsfNodeIndex,
+        .vkDeviceMemory = pTknMemoryBlock->vkDeviceMemory,
+        .offset = offset,
+        .size = vkMemoryRequirements.size,
+        .mapped = NULL == pTknMemoryBlock->mapped ? NULL : (char *)pTknMemoryBlock->mapped + offset,
+        .tknMemoryUsage = tknMemoryUsage,
+    };
+    return tknMemoryAllocation;
+}
+
+void tknFreeMemory(TknGfxContext *pTknGfxContext, TknMemoryAllocation tknMemoryAllocation)
+{
+    TknMemoryBlock *pTknMemoryBlock = tknMemoryAllocation.pTknMemoryBlock;
+    pTknGfxContext->tknMemoryUsageSizes[tknMemoryAllocation.tknMemoryUsage] -= tknMemoryAllocation.size;
+    if (pTknMemoryBlock->isDedicated)
+    {
+        tknDestroyMemoryBlockPtr(pTknGfxContext, pTknMemoryBlock);
+    }
+    else
+    {
+        tknFreeToTlsf(&pTknMemoryBlock->tknTlsf, tknMemoryAllocation.tlsfNodeIndex);
+        if (0 == pTknMemoryBlock->tknTlsf.allocationCount)
+        {
+            // Keep the last empty block of each kind so create/destroy loops do not allocate device memory every time
+            bool hasOtherBlock = false;
+            for (uint32_t blockIndex = 0; blockIndex < pTknGfxContext->tknMemoryBlockPtrDynamicArray.count; blockIndex++)
+            {
+                TknMemoryBlock *pOtherBlock = *(TknMemoryBlock **)tknGetFromDynamicArray(&pTknGfxContext->tknMemoryBlockPtrDynamicArray, blockIndex);
+                if (pOtherBlock != pTknMemoryBlock && !pOtherBlock->isDedicated && pOtherBlock->memoryTypeIndex == pTknMemoryBlock->memoryTypeIndex && pOtherBlock->isLinear == pTknMemoryBlock->isLinear)
+                {
+                    hasOtherBlock = true;
+                    break;
+                }
+                else
+                {
+                    // Skip
+                }
+            }
+            if (hasOtherBlock)
+            {
+                tknDestroyMemoryBlockPtr(pTknGfxContext, pTknMemoryBlock);
+            }
+            else
+            {
+                // Keep it
+            }
+        }
+        else
+        {
+            // Block still in use
+        }
+    }
+}
+
+TknMemoryStats tknGetMemoryStats(TknGfxContext *pTknGfxContext)
+{
+    TknMemoryStats tknMemoryStats = {0};
+    VkDeviceSize largestFreeSizeSum = 0;
+    for (uint32_t blockIndex = 0; blockIndex < pTknGfxContext->tknMemoryBlockPtrDynamicArray.count; blockIndex++)
+    {
+        TknMemoryBlock *pTknMemoryBlock = *(TknMemoryBlock **)tknGetFromDynamicArray(&pTknGfxContext->tknMemoryBlockPtrDynamicArray, blockIndex);
+        tknMemoryStats.blockCount++;
+        tknMemoryStats.blockSize += pTknMemoryBlock->size;
+        if (pTknMemoryBlock->isDedicated)
+        {
+            tknMemoryStats.dedicatedBlockCount++;
+            tknMemoryStats.allocationCount++;
+            tknMemoryStats.usedSize += pTknMemoryBlock->size;
+        }
+        else
+        {
+            VkDeviceSize largestFreeSize = tknGetTlsfLargestFreeSize(&pTknMemoryBlock->tknTlsf);
+            tknMemoryStats.allocationCount += pTknMemoryBlock->tknTlsf.allocationCount;
+            tknMemoryStats.usedSize += pTknMemoryBlock->size - pTknMemoryBlock->tknTlsf.freeSize;
+            tknMemoryStats.freeSize += pTknMemoryBlock->tknTlsf.freeSize;
+            tknMemoryStats.largestFreeSize = largestFreeSize > tknMemoryStats.largestFreeSize ? largestFreeSize : tknMemoryStats.largestFreeSize;
+            largestFreeSizeSum += largestFreeSize;
+        }
+    }
+    tknMemoryStats.fragmentation = tknMemoryStats.freeSize > 0 ? 1.0f - (float)((double)largestFreeSizeSum / (double)tknMemoryStats.freeSize) : 0.0f;
+    memcpy(tknMemoryStats.usageSizes, pTknGfxContext->tknMemoryUsageSizes, sizeof(tknMemoryStats.usageSizes));
+    return tknMemoryStats;
+}
@@ -1,112 +1,110 @@
 #include "tknGfxCore.h"
 
-static void tknCopyVkBuffer(TknGfxContext *pTknGfxContext, VkBuffer srcVkBuffer, VkBuffer dstVkBuffer, VkDeviceSize size)
+static void tknUploadToVkBuffer(TknGfxContext *pTknGfxContext, const void *data, VkBuffer dstVkBuffer, VkDeviceSize size)
 {
-    VkCommandBuffer vkCommandBuffer = tknBeginSingleTimeCommands(pTknGfxContext);
+    TknUpload tknUpload = tknBeginUpload(pTknGfxContext, size);
+    memcpy(tknUpload.mapped, data, (size_t)size);
 
     VkBufferCopy vkBufferCopy = {
-        .srcOffset = 0,
+        .srcOffset = tknUpload.offset,
         .dstOffset = 0,
         .size = size
     };
-    vkCmdCopyBuffer(vkCommandBuffer, srcVkBuffer, dstVkBuffer, 1, &vkBufferCopy);
+    vkCmdCopyBuffer(tknUpload.vkCommandBuffer, tknUpload.vkBuffer, dstVkBuffer, 1, &vkBufferCopy);
 
-    tknEndSingleTimeCommands(pTknGfxContext, vkCommandBuffer);
+    tknEndUpload(pTknGfxContext, tknUpload);
 }
 
-static bool tknCreateBufferWithData(TknGfxContext *pTknGfxContext, void *data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer *pBuffer, VkDeviceMemory *pDeviceMemory)
+static void tknCreateMeshVkBuffer(TknGfxContext *pTknGfxContext, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer *pBuffer, TknMemoryAllocation *pTknMemoryAllocation)
 {
     if (size == 0)
     {
         *pBuffer = VK_NULL_HANDLE;
-        *pDeviceMemory = VK_NULL_HANDLE;
-        return true;
+        *pTknMemoryAllocation = (TknMemoryAllocation){0};
+    }
+    else
+    {
+        tknCreateVkBuffer(pTknGfxContext, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TKN_MEMORY_USAGE_MESH, pBuffer, pTknMemoryAllocation);
     }
-    
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    
-    // Create staging buffer
-    tknCreateVkBuffer(pTknGfxContext, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                   &stagingBuffer, &stagingBufferMemory);
-    
-    // Copy data to staging buffer
-    void *mappedData;
-    VkDevice vkDevice = pTknGfxContext->vkDevice;
-    vkMapMemory(vkDevice, stagingBufferMemory, 0, size, 0, &mappedData);
-    memcpy(mappedData, data, (size_t)size);
-    vkUnmapMemory(vkDevice, stagingBufferMemory);
-    
-    // Create device local buffer
-    tknCreateVkBuffer(pTknGfxContext, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, 
-                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pBuffer, pDeviceMemory);
-    
-    // Copy from staging to device local buffer
-    tknCopyVkBuffer(pTknGfxContext, stagingBuffer, *pBuffer, size);
-    
-    // Clean up staging buffer
-    tknDestroyVkBuffer(pTknGfxContext, stagingBuffer, stagingBufferMemory);
-    
-    return true;
 }
 
-TknMesh *tknCreateMeshPtrWithData(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknVertexInputLayout, void *vertices, uint32_t tknVertexCount, VkIndexType vkIndexType, void *indices, uint32_t tknIndexCount)
+// Device local buffers without contents, filled by tknCreateMeshPtrWithData or tknUploadMeshAsync
+TknMesh *tknCreateEmptyMeshPtr(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknVertexInputLayout, uint32_t tknVertexCount, VkIndexType vkIndexType, uint32_t tknIndexCount)
 {
     TknMesh *pTknMesh = tknMalloc(sizeof(TknMesh));
     VkBuffer tknVertexVkBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory tknVertexVkDeviceMemory = VK_NULL_HANDLE;
+    TknMemoryAllocation tknVertexMemoryAllocation = {0};
     VkBuffer tknIndexVkBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory tknIndexVkDeviceMemory = VK_NULL_HANDLE;
+    TknMemoryAllocation tknIndexMemoryAllocation = {0};
 
     // Create vertex buffer
     VkDeviceSize vertexSize = tknVertexCount * pTknVertexInputLayout->stride;
-    tknCreateBufferWithData(pTknGfxContext, vertices, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
-                        &tknVertexVkBuffer, &tknVertexVkDeviceMemory);
+    tknCreateMeshVkBuffer(pTknGfxContext, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &tknVertexVkBuffer, &tknVertexMemoryAllocation);
 
     // Create index buffer if needed
     if (tknIndexCount > 0)
     {
         size_t indexSize = (vkIndexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
         VkDeviceSize indexBufferSize = tknIndexCount * indexSize;
-        tknCreateBufferWithData(pTknGfxContext, indices, indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 
-                            &tknIndexVkBuffer, &tknIndexVkDeviceMemory);
+        tknCreateMeshVkBuffer(pTknGfxContext, indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &tknIndexVkBuffer, &tknIndexMemoryAllocation);
     }
 
     TknHashSet tknDrawCallPtrHashSet = tknCreateHashSet(sizeof(TknDrawCall *));
     *pTknMesh = (TknMesh){
         .tknVertexVkBuffer = tknVertexVkBuffer,
-        .tknVertexVkDeviceMemory = tknVertexVkDeviceMemory,
+        .tknVertexMemoryAllocation = tknVertexMemoryAllocation,
         .tknVertexCount = tknVertexCount,
         .tknIndexVkBuffer = tknIndexVkBuffer,
-        .tknIndexVkDeviceMemory = tknIndexVkDeviceMemory,
+        .tknIndexMemoryAllocation = tknIndexMemoryAllocation,
         .tknIndexCount = tknIndexCount,
         .pTknVertexInputLayout = pTknVertexInputLayout,
         .vkIndexType = vkIndexType,
         .tknDrawCallPtrHashSet = tknDrawCallPtrHashSet,
+        .tknUploadTicket = 0,
     };
     tknAddToHashSet(&pTknVertexInputLayout->tknReferencePtrHashSet, &pTknMesh);
     return pTknMesh;
 }
 
+TknMesh *tknCreateMeshPtrWithData(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknVertexInputLayout, void *vertices, uint32_t tknVertexCount, VkIndexType vkIndexType, void *indices, uint32_t tknIndexCount)
+{
+    TknMesh *pTknMesh = tknCreateEmptyMeshPtr(pTknGfxContext, pTknVertexInputLayout, tknVertexCount, vkIndexType, tknIndexCount);
+    // Copy through the staging ring, the copies run before the next frame's graphics work
+    if (pTknMesh->tknVertexVkBuffer != VK_NULL_HANDLE)
+    {
+        tknUploadToVkBuffer(pTknGfxContext, vertices, pTknMesh->tknVertexVkBuffer, tknVertexCount * pTknVertexInputLayout->stride);
+    }
+    if (pTknMesh->tknIndexVkBuffer != VK_NULL_HANDLE)
+    {
+        size_t indexSize = (vkIndexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+        tknUploadToVkBuffer(pTknGfxContext, indices, pTknMesh->tknIndexVkBuffer, tknIndexCount * indexSize);
+    }
+    return pTknMesh;
+}
+
 void tknDestroyMeshPtr(TknGfxContext *pTknGfxContext, TknMesh *pTknMesh)
 {
     tknAssert(0 == pTknMesh->tknDrawCallPtrHashSet.count, "TknMesh still has draw calls attached!");
+    // Retiring the transfer touches the mesh, so it has to finish first
+    tknWaitUpload(pTknGfxContext, pTknMesh->tknUploadTicket);
     tknDestroyHashSet(pTknMesh->tknDrawCallPtrHashSet);
     tknRemoveFromHashSet(&pTknMesh->pTknVertexInputLayout->tknReferencePtrHashSet, &pTknMesh);
-    if (pTknMesh->tknVertexVkBuffer != VK_NULL_HANDLE && pTknMesh->tknVertexVkDeviceMemory != VK_NULL_HANDLE)
+    if (pTknMesh->tknVertexVkBuffer != VK_NULL_HANDLE)
     {
-        tknDestroyVkBuffer(pTknGfxContext, pTknMesh->tknVertexVkBuffer, pTknMesh->tknVertexVkDeviceMemory);
+        tknRetireVkBuffer(pTknGfxContext, pTknMesh->tknVertexVkBuffer, pTknMesh->tknVertexMemoryAllocation);
     }
-    if (pTknMesh->tknIndexVkBuffer != VK_NULL_HANDLE && pTknMesh->tknIndexVkDeviceMemory != VK_NULL_HANDLE)
+    if (pTknMesh->tknIndexVkBuffer != VK_NULL_HANDLE)
     {
-        tknDestroyVkBuffer(pTknGfxContext, pTknMesh->tknIndexVkBuffer, pTknMesh->tknIndexVkDeviceMemory);
+        tknRetireVkBuffer(pTknGfxContext, pTknMesh->tknIndexVkBuffer, pTknMesh->tknIndexMemoryAllocation);
     }
     tknFree(pTknMesh);
 }
 
 void tknUpdateMeshPtr(TknGfxContext *pTknGfxContext, TknMesh *pTknMesh, const char *format, const void *vertices, uint32_t tknVertexCount, uint32_t indexType, const void *indices, uint32_t tknIndexCount)
 {
+    // The graphics queue has to own the buffers before it can copy into them
+    tknWaitUpload(pTknGfxContext, pTknMesh->tknUploadTicket);
     // Update vertex buffer if vertices provided
     if (vertices && tknVertexCount > 0)
     {
@@ -116,36 +114,19 @@ void tknUpdateMeshPtr(TknGfxContext *pTknGfxContext, TknMesh *pTknMesh, const ch
         // Check if we need to recreate the vertex buffer
         if (pTknMesh->tknVertexVkBuffer == VK_NULL_HANDLE || vertexSize > currentVertexSize)
         {
-            // Destroy existing buffer if it exists
+            // Retire existing buffer if it exists, frames in flight may still read it
             if (pTknMesh->tknVertexVkBuffer != VK_NULL_HANDLE)
             {
-                tknDestroyVkBuffer(pTknGfxContext, pTknMesh->tknVertexVkBuffer, pTknMesh->tknVertexVkDeviceMemory);
+                tknRetireVkBuffer(pTknGfxContext, pTknMesh->tknVertexVkBuffer, pTknMesh->tknVertexMemoryAllocation);
             }
 
             // Create new vertex buffer
             tknCreateVkBuffer(pTknGfxContext, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pTknMesh->tknVertexVkBuffer, &pTknMesh->tknVertexVkDeviceMemory);
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TKN_MEMORY_USAGE_MESH, &pTknMesh->tknVertexVkBuffer, &pTknMesh->tknVertexMemoryAllocation);
         }
 
-        // Create staging buffer and copy data
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        tknCreateVkBuffer(pTknGfxContext, vertexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                       &stagingBuffer, &stagingBufferMemory);
-
-        // Copy data to staging buffer
-        void *mappedData;
-        VkDevice vkDevice = pTknGfxContext->vkDevice;
-        vkMapMemory(vkDevice, stagingBufferMemory, 0, vertexSize, 0, &mappedData);
-        memcpy(mappedData, vertices, (size_t)vertexSize);
-        vkUnmapMemory(vkDevice, stagingBufferMemory);
-
-        // Copy from staging to device local buffer
-        tknCopyVkBuffer(pTknGfxContext, stagingBuffer, pTknMesh->tknVertexVkBuffer, vertexSize);
-
-        // Clean up staging buffer
-        tknDestroyVkBuffer(pTknGfxContext, stagingBuffer, stagingBufferMemory);
+        // Copy through the staging ring
+        tknUploadToVkBuffer(pTknGfxContext, vertices, pTknMesh->tknVertexVkBuffer, vertexSize);
 
         // Update vertex count
         pTknMesh->tknVertexCount = tknVertexCount;
@@ -167,36 +148,19 @@ void tknUpdateMeshPtr(TknGfxContext *pTknGfxContext, TknMesh *pTknMesh, const ch
         // Check if we need to recreate the index buffer
         if (pTknMesh->tknIndexVkBuffer == VK_NULL_HANDLE || indexBufferSize > currentIndexSize || vkIndexType != pTknMesh->vkIndexType)
         {
-            // Destroy existing buffer if it exists
+            // Retire existing buffer if it exists, frames in flight may still read it
             if (pTknMesh->tknIndexVkBuffer != VK_NULL_HANDLE)
             {
-                tknDestroyVkBuffer(pTknGfxContext, pTknMesh->tknIndexVkBuffer, pTknMesh->tknIndexVkDeviceMemory);
+                tknRetireVkBuffer(pTknGfxContext, pTknMesh->tknIndexVkBuffer, pTknMesh->tknIndexMemoryAllocation);
             }
 
             // Create new index buffer
             tknCreateVkBuffer(pTknGfxContext, indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pTknMesh->tknIndexVkBuffer, &pTknMesh->tknIndexVkDeviceMemory);
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TKN_MEMORY_USAGE_MESH, &pTknMesh->tknIndexVkBuffer, &pTknMesh->tknIndexMemoryAllocation);
         }
 
-        // Create staging buffer and copy data
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        tknCreateVkBuffer(pTknGfxContext, indexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                       &stagingBuffer, &stagingBufferMemory);
-
-        // Copy data to staging buffer
-        void *mappedData;
-        VkDevice vkDevice = pTknGfxContext->vkDevice;
-        vkMapMemory(vkDevice, stagingBufferMemory, 0, indexBufferSize, 0, &mappedData);
-        memcpy(mappedData, indices, (size_t)indexBufferSize);
-        vkUnmapMemory(vkDevice, stagingBufferMemory);
-
-        // Copy from staging to device local buffer
-        tknCopyVkBuffer(pTknGfxContext, stagingBuffer, pTknMesh->tknIndexVkBuffer, indexBufferSize);
-
-        // Clean up staging buffer
-        tknDestroyVkBuffer(pTknGfxContext, stagingBuffer, stagingBufferMemory);
+        // Copy through the staging ring
+        tknUploadToVkBuffer(pTknGfxContext, indices, pTknMesh->tknIndexVkBuffer, indexBufferSize);
 
         // Update index type and count
         pTknMesh->vkIndexType = vkIndexType;
@@ -124,9 +124,45 @@ static void tknUpdateVkVertexInputAttributeDescriptions(TknVertexInputLayout ver
     }
 }
 
-TknPipeline *tknCreatePipelinePtr(TknGfxContext *pTknGfxContext, TknRenderPass *pTknRenderPass, uint32_t subpassIndex, uint32_t spvPathCount, const char **spvPaths, TknVertexInputLayout *pTknMeshVertexInputLayout, TknVertexInputLayout *pTknInstanceVertexInputLayout, VkPipelineInputAssemblyStateCreateInfo vkPipelineInputAssemblyStateCreateInfo, VkPipelineViewportStateCreateInfo vkPipelineViewportStateCreateInfo, VkPipelineRasterizationStateCreateInfo vkPipelineRasterizationStateCreateInfo, VkPipelineMultisampleStateCreateInfo vkPipelineMultisampleStateCreateInfo, VkPipelineDepthStencilStateCreateInfo vkPipelineDepthStencilStateCreateInfo, VkPipelineColorBlendStateCreateInfo vkPipelineColorBlendStateCreateInfo, VkPipelineDynamicStateCreateInfo vkPipelineDynamicStateCreateInfo)
+// Reflection, shader modules, layouts and the pipeline itself, touches nothing shared so it runs on any worker
+// Stages may declare different members of one push constant block, a single range over all of them keeps the layout simple and every stage covered
+static VkPushConstantRange tknGetPushConstantRange(TknGfxContext *pTknGfxContext, uint32_t spvReflectShaderModuleCount, SpvReflectShaderModule *spvReflectShaderModules)
+{
+    VkPushConstantRange vkPushConstantRange = {
+        .stageFlags = 0,
+        .offset = 0,
+        .size = 0,
+    };
+    for (uint32_t spvReflectShaderModuleIndex = 0; spvReflectShaderModuleIndex < spvReflectShaderModuleCount; spvReflectShaderModuleIndex++)
+    {
+        SpvReflectShaderModule *pSpvReflectShaderModule = &spvReflectShaderModules[spvReflectShaderModuleIndex];
+        for (uint32_t blockIndex = 0; blockIndex < pSpvReflectShaderModule->push_constant_block_count; blockIndex++)
+        {
+            SpvReflectBlockVariable *pSpvReflectBlockVariable = &pSpvReflectShaderModule->push_constant_blocks[blockIndex];
+            // Member offsets are absolute in push constant space
+            for (uint32_t memberIndex = 0; memberIndex < pSpvReflectBlockVariable->member_count; memberIndex++)
+            {
+                SpvReflectBlockVariable *pMember = &pSpvReflectBlockVariable->members[memberIndex];
+                uint32_t memberEnd = pMember->offset + pMember->size;
+                vkPushConstantRange.size = memberEnd > vkPushConstantRange.size ? memberEnd : vkPushConstantRange.size;
+            }
+            vkPushConstantRange.stageFlags |= (VkShaderStageFlags)pSpvReflectShaderModule->shader_stage;
+        }
+    }
+    uint32_t maxPushConstantsSize = pTknGfxContext->vkPhysicalDeviceProperties.limits.maxPushConstantsSize;
+    tknAssert(vkPushConstantRange.size <= TKN_MAX_PUSH_CONSTANT_SIZE, "Push constant block of %u bytes exceeds %u bytes", vkPushConstantRange.size, TKN_MAX_PUSH_CONSTANT_SIZE);
+    tknAssert(vkPushConstantRange.size <= maxPushConstantsSize, "Push constant block of %u bytes exceeds the device limit of %u bytes", vkPushConstantRange.size, maxPushConstantsSize);
+    return vkPushConstantRange;
+}
+
+static void tknBuildPipeline(TknGfxContext *pTknGfxContext, const TknPipelineCreateInfo *pTknPipelineCreateInfo, TknPipeline *pTknPipeline, TknPipelineCacheResult *pTknPipelineCacheResult)
 {
-    TknPipeline *pTknPipeline = tknMalloc(sizeof(TknPipeline));
+    TknRenderPass *pTknRenderPass = pTknPipelineCreateInfo->pTknRenderPass;
+    uint32_t subpassIndex = pTknPipelineCreateInfo->subpassIndex;
+    uint32_t spvPathCount = pTknPipelineCreateInfo->spvPathCount;
+    const char **spvPaths = pTknPipelineCreateInfo->spvPaths;
+    TknVertexInputLayout *pTknMeshVertexInputLayout = pTknPipelineCreateInfo->pTknMeshVertexInputLayout;
+    TknVertexInputLayout *pTknInstanceVertexInputLayout = pTknPipelineCreateInfo->pTknInstanceVertexInputLayout;
     SpvReflectShaderModule *spvReflectShaderModules = tknMalloc(sizeof(SpvReflectShaderModule) * spvPathCount);
     VkShaderStageFlagBits vkShaderStageFlagBits = 0;
     VkPipelineShaderStageCreateInfo *pipelineShaderStageCreateInfos = tknMalloc(sizeof(VkPipelineShaderStageCreateInfo) * spvPathCount);
@@ -137,7 +173,7 @@ TknPipeline *tknCreatePipelinePtr(TknGfxContext *pTknGfxContext, TknRenderPass *
     VkDevice vkDevice = pTknGfxContext->vkDevice;
     for (uint32_t spvPathIndex = 0; spvPathIndex < spvPathCount; spvPathIndex++)
     {
-        spvReflectShaderModules[spvPathIndex] = tknCreateSpvReflectShaderModule(spvPaths[spvPathIndex]);
+        spvReflectShaderModules[spvPathIndex] = tknGetSpvReflectShaderModule(pTknGfxContext, spvPaths[spvPathIndex]);
         SpvReflectShaderModule spvReflectShaderModule = spvReflectShaderModules[spvPathIndex];
 
         if (VK_SHADER_STAGE_VERTEX_BIT == (VkShaderStageFlagBits)spvReflectShaderModule.shader_stage)
@@ -254,14 +290,15 @@ TknPipeline *tknCreatePipelinePtr(TknGfxContext *pTknGfxContext, TknRenderPass *
     vkDescriptorSetLayouts[TKN_GLOBAL_DESCRIPTOR_SET] = pTknGfxContext->pTknGlobalDescriptorSet->vkDescriptorSetLayout;
     vkDescriptorSetLayouts[TKN_SUBPASS_DESCRIPTOR_SET] = pTknRenderPass->pTknSubpasses[subpassIndex].pTknSubpassDescriptorSet->vkDescriptorSetLayout;
     vkDescriptorSetLayouts[TKN_PIPELINE_DESCRIPTOR_SET] = pTknPipelineDescriptorSet->vkDescriptorSetLayout;
+    VkPushConstantRange vkPushConstantRange = tknGetPushConstantRange(pTknGfxContext, spvPathCount, spvReflectShaderModules);
     VkPipelineLayoutCreateInfo vkPipelineLayoutCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .pNext = NULL,
         .flags = 0,
         .setLayoutCount = TKN_MAX_DESCRIPTOR_SET,
         .pSetLayouts = vkDescriptorSetLayouts,
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = NULL,
+        .pushConstantRangeCount = vkPushConstantRange.size > 0 ? 1 : 0,
+        .pPushConstantRanges = vkPushConstantRange.size > 0 ? &vkPushConstantRange : NULL,
     };
     tknAssertVkResult(vkCreatePipelineLayout(vkDevice, &vkPipelineLayoutCreateInfo, NULL, &vkPipelineLayout));
     VkPipeline vkPipeline = VK_NULL_HANDLE;
@@ -272,25 +309,21 @@ TknPipeline *tknCreatePipelinePtr(TknGfxContext *pTknGfxContext, TknRenderPass *
         .stageCount = spvPathCount,
         .pStages = pipelineShaderStageCreateInfos,
         .pVertexInputState = &vkPipelineVertexInputStateCreateInfo,
-        .pInputAssemblyState = &vkPipelineInputAssemblyStateCreateInfo,
+        .pInputAssemblyState = &pTknPipelineCreateInfo->vkPipelineInputAssemblyStateCreateInfo,
         .pTessellationState = NULL,
-        .pViewportState = &vkPipelineViewportStateCreateInfo,
-        .pRasterizationState = &vkPipelineRasterizationStateCreateInfo,
-        .pMultisampleState = &vkPipelineMultisampleStateCreateInfo,
-        .pDepthStencilState = &vkPipelineDepthStencilStateCreateInfo,
-        .pColorBlendState = &vkPipelineColorBlendStateCreateInfo,
-        .pDynamicState = &vkPipelineDynamicStateCreateInfo,
+        .pViewportState = &pTknPipelineCreateInfo->vkPipelineViewportStateCreateInfo,
+        .pRasterizationState = &pTknPipelineCreateInfo->vkPipelineRasterizationStateCreateInfo,
+        .pMultisampleState = &pTknPipelineCreateInfo->vkPipelineMultisampleStateCreateInfo,
+        .pDepthStencilState = &pTknPipelineCreateInfo->vkPipelineDepthStencilStateCreateInfo,
+        .pColorBlendState = &pTknPipelineCreateInfo->vkPipelineColorBlendStateCreateInfo,
+        .pDynamicState = &pTknPipelineCreateInfo->vkPipelineDynamicStateCreateInfo,
         .layout = vkPipelineLayout,
         .renderPass = pTknRenderPass->vkRenderPass,
         .subpass = subpassIndex,
         .basePipelineHandle = VK_NULL_HANDLE,
         .basePipelineIndex = 0,
     };
-    tknAssertVkResult(vkCreateGraphicsPipelines(vkDevice, NULL, 1, &vkGraphicsPipelineCreateInfo, NULL, &vkPipeline));
-    for (uint32_t spvPathIndex = 0; spvPathIndex < spvPathCount; spvPathIndex++)
-    {
-        tknDestroySpvReflectShaderModule(&spvReflectShaderModules[spvPathIndex]);
-    }
+    vkPipeline = tknCreateVkGraphicsPipeline(pTknGfxContext, vkGraphicsPipelineCreateInfo, pTknPipelineCacheResult);
     tknFree(spvReflectShaderModules);
     tknFree(vkVertexInputBindingDescriptions);
     tknFree(vkVertexInputAttributeDescriptions);
@@ -305,35 +338,109 @@ TknPipeline *tknCreatePipelinePtr(TknGfxContext *pTknGfxContext, TknRenderPass *
         .pTknPipelineDescriptorSet = pTknPipelineDescriptorSet,
         .vkPipeline = vkPipeline,
         .vkPipelineLayout = vkPipelineLayout,
+        .pushConstantVkShaderStageFlags = vkPushConstantRange.stageFlags,
+        .pushConstantSize = vkPushConstantRange.size,
         .pTknRenderPass = pTknRenderPass,
         .subpassIndex = subpassIndex,
         .pTknMeshVertexInputLayout = pTknMeshVertexInputLayout,
         .pTknInstanceVertexInputLayout = pTknInstanceVertexInputLayout,
         .tknDrawCallPtrHashSet = tknDrawCallPtrHashSet,
     };
-    tknAddToHashSet(&pTknRenderPass->pTknSubpasses[subpassIndex].tknPipelinePtrHashSet, &pTknPipeline);
-    if (NULL != pTknMeshVertexInputLayout)
-        tknAddToHashSet(&pTknMeshVertexInputLayout->tknReferencePtrHashSet, &pTknPipeline);
-    if (NULL != pTknInstanceVertexInputLayout)
-        tknAddToHashSet(&pTknInstanceVertexInputLayout->tknReferencePtrHashSet, &pTknPipeline);
+}
+
+typedef struct
+{
+    TknGfxContext *pTknGfxContext;
+    const TknPipelineCreateInfo *tknPipelineCreateInfos;
+    TknPipeline **pipelinePtrs;
+    TknPipelineCacheResult *tknPipelineCacheResults;
+} TknPipelineBatch;
+
+static void tknBuildPipelineTask(void *pContext, uint32_t taskIndex, uint32_t workerIndex)
+{
+    TknPipelineBatch *pTknPipelineBatch = pContext;
+    TKN_PROFILE_SCOPE("tknBuildPipeline")
+    {
+        tknBuildPipeline(pTknPipelineBatch->pTknGfxContext, &pTknPipelineBatch->tknPipelineCreateInfos[taskIndex], pTknPipelineBatch->pipelinePtrs[taskIndex], &pTknPipelineBatch->tknPipelineCacheResults[taskIndex]);
+    }
+}
+
+// Builds every pipeline on the context's worker pool and returns once all of them are ready.
+// The pipelines share the pipeline cache, registering them with their subpasses and layouts stays on the calling thread.
+void tknCreatePipelinesPtr(TknGfxContext *pTknGfxContext, uint32_t pipelineCount, const TknPipelineCreateInfo *tknPipelineCreateInfos, TknPipeline **pipelinePtrs)
+{
+    // Reflect every shader of the batch up front, the workers then only read the cache
+    uint32_t spvPathCount = 0;
+    for (uint32_t pipelineIndex = 0; pipelineIndex < pipelineCount; pipelineIndex++)
+    {
+        spvPathCount += tknPipelineCreateInfos[pipelineIndex].spvPathCount;
+    }
+    const char **spvPaths = tknMalloc(sizeof(const char *) * spvPathCount);
+    uint32_t spvPathOffset = 0;
+    for (uint32_t pipelineIndex = 0; pipelineIndex < pipelineCount; pipelineIndex++)
+    {
+        memcpy(spvPaths + spvPathOffset, tknPipelineCreateInfos[pipelineIndex].spvPaths, sizeof(const char *) * tknPipelineCreateInfos[pipelineIndex].spvPathCount);
+        spvPathOffset += tknPipelineCreateInfos[pipelineIndex].spvPathCount;
+    }
+    tknLoadShaderReflections(pTknGfxContext, spvPathCount, spvPaths);
+    tknFree(spvPaths);
+
+    TknPipelineCacheResult *tknPipelineCacheResults = tknMalloc(sizeof(TknPipelineCacheResult) * pipelineCount);
+    for (uint32_t pipelineIndex = 0; pipelineIndex < pipelineCount; pipelineIndex++)
+    {
+        pipelinePtrs[pipelineIndex] = tknMalloc(sizeof(TknPipeline));
+    }
+    TknPipelineBatch tknPipelineBatch = {
+        .pTknGfxContext = pTknGfxContext,
+        .tknPipelineCreateInfos = tknPipelineCreateInfos,
+        .pipelinePtrs = pipelinePtrs,
+        .tknPipelineCacheResults = tknPipelineCacheResults,
+    };
+    tknRunOnWorkerPool(pTknGfxContext->pTknWorkerPool, pipelineCount, tknBuildPipelineTask, &tknPipelineBatch);
 
+    for (uint32_t pipelineIndex = 0; pipelineIndex < pipelineCount; pipelineIndex++)
+    {
+        TknPipeline *pTknPipeline = pipelinePtrs[pipelineIndex];
+        tknRecordPipelineCacheResult(pTknGfxContext, tknPipelineCacheResults[pipelineIndex]);
+        tknAddToHashSet(&pTknPipeline->pTknRenderPass->pTknSubpasses[pTknPipeline->subpassIndex].tknPipelinePtrHashSet, &pTknPipeline);
+        if (NULL != pTknPipeline->pTknMeshVertexInputLayout)
+            tknAddToHashSet(&pTknPipeline->pTknMeshVertexInputLayout->tknReferencePtrHashSet, &pTknPipeline);
+        if (NULL != pTknPipeline->pTknInstanceVertexInputLayout)
+            tknAddToHashSet(&pTknPipeline->pTknInstanceVertexInputLayout->tknReferencePtrHashSet, &pTknPipeline);
+    }
+    tknFree(tknPipelineCacheResults);
+}
+
+TknPipeline *tknCreatePipelinePtr(TknGfxContext *pTknGfxContext, TknRenderPass *pTknRenderPass, uint32_t subpassIndex, uint32_t spvPathCount, const char **spvPaths, TknVertexInputLayout *pTknMeshVertexInputLayout, TknVertexInputLayout *pTknInstanceVertexInputLayout, VkPipelineInputAssemblyStateCreateInfo vkPipelineInputAssemblyStateCreateInfo, VkPipelineViewportStateCreateInfo vkPipelineViewportStateCreateInfo, VkPipelineRasterizationStateCreateInfo vkPipelineRasterizationStateCreateInfo, VkPipelineMultisampleStateCreateInfo vkPipelineMultisampleStateCreateInfo, VkPipelineDepthStencilStateCreateInfo vkPipelineDepthStencilStateCreateInfo, VkPipelineColorBlendStateCreateInfo vkPipelineColorBlendStateCreateInfo, VkPipelineDynamicStateCreateInfo vkPipelineDynamicStateCreateInfo)
+{
+    TknPipelineCreateInfo tknPipelineCreateInfo = {
+        .pTknRenderPass = pTknRenderPass,
+        .subpassIndex = subpassIndex,
+        .spvPathCount = spvPathCount,
+        .spvPaths = spvPaths,
+        .pTknMeshVertexInputLayout = pTknMeshVertexInputLayout,
+        .pTknInstanceVertexInputLayout = pTknInstanceVertexInputLayout,
+        .vkPipelineInputAssemblyStateCreateInfo = vkPipelineInputAssemblyStateCreateInfo,
+        .vkPipelineViewportStateCreateInfo = vkPipelineViewportStateCreateInfo,
+        .vkPipelineRasterizationStateCreateInfo = vkPipelineRasterizationStateCreateInfo,
+        .vkPipelineMultisampleStateCreateInfo = vkPipelineMultisampleStateCreateInfo,
+        .vkPipelineDepthStencilStateCreateInfo = vkPipelineDepthStencilStateCreateInfo,
+        .vkPipelineColorBlendStateCreateInfo = vkPipelineColorBlendStateCreateInfo,
+        .vkPipelineDynamicStateCreateInfo = vkPipelineDynamicStateCreateInfo,
+    };
+    TknPipeline *pTknPipeline = NULL;
+    tknCreatePipelinesPtr(pTknGfxContext, 1, &tknPipelineCreateInfo, &pTknPipeline);
     return pTknPipeline;
 }
 void tknDestroyPipelinePtr(TknGfxContext *pTknGfxContext, TknPipeline *pTknPipeline)
 {
-    for (size_t i = 0; i < pTknPipeline->tknDrawCallPtrHashSet.capacity; i++)
+    tknWaitGfxFramesInFlight(pTknGfxContext);
+    // Destroying a draw call removes it from this set
+    while (pTknPipeline->tknDrawCallPtrHashSet.count > 0)
     {
-        TknListNode *node = pTknPipeline->tknDrawCallPtrHashSet.nodePtrs[i];
-        while (node)
-        {
-            TknListNode *nextNode = node->pNextNode;
-            TknDrawCall *pTknDrawCall = *(TknDrawCall **)node->data;
-            tknDestroyDrawCallPtr(pTknGfxContext, pTknDrawCall);
-            node = nextNode;
-        }
-        pTknPipeline->tknDrawCallPtrHashSet.nodePtrs[i] = NULL;
+        TknDrawCall *pTknDrawCall = *(TknDrawCall **)tknGetFromHashSet(&pTknPipeline->tknDrawCallPtrHashSet, pTknPipeline->tknDrawCallPtrHashSet.count - 1);
+        tknDestroyDrawCallPtr(pTknGfxContext, pTknDrawCall);
     }
-    pTknPipeline->tknDrawCallPtrHashSet.count = 0;
 
     VkDevice vkDevice = pTknGfxContext->vkDevice;
     tknRemoveFromHashSet(&pTknPipeline->pTknRenderPass->pTknSubpasses[pTknPipeline->subpassIndex].tknPipelinePtrHashSet, &pTknPipeline);
@@ -349,3 +456,94 @@ void tknDestroyPipelinePtr(TknGfxContext *pTknGfxContext, TknPipeline *pTknPipel
     vkDestroyPipelineLayout(vkDevice, pTknPipeline->vkPipelineLayout, NULL);
     tknFree(pTknPipeline);
 }
+
+TknComputePipeline *tknCreateComputePipelinePtr(TknGfxContext *pTknGfxContext, const char *spvPath)
+{
+    tknLoadShaderReflections(pTknGfxContext, 1, &spvPath);
+    SpvReflectShaderModule spvReflectShaderModule = tknGetSpvReflectShaderModule(pTknGfxContext, spvPath);
+    tknAssert(VK_SHADER_STAGE_COMPUTE_BIT == (VkShaderStageFlagBits)spvReflectShaderModule.shader_stage, "%s is not a compute shader", spvPath);
+    for (uint32_t setIndex = 0; setIndex < spvReflectShaderModule.descriptor_set_count; setIndex++)
+    {
+        tknAssert(TKN_SUBPASS_DESCRIPTOR_SET != spvReflectShaderModule.descriptor_sets[setIndex].set, "Compute shader %s declares the subpass set %u", spvPath, TKN_SUBPASS_DESCRIPTOR_SET);
+    }
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    VkShaderModuleCreateInfo vkShaderModuleCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .codeSize = spvReflectGetCodeSize(&spvReflectShaderModule),
+        .pCode = spvReflectGetCode(&spvReflectShaderModule),
+    };
+    VkShaderModule shaderModule;
+    tknAssertVkResult(vkCreateShaderModule(vkDevice, &vkShaderModuleCreateInfo, NULL, &shaderModule));
+
+    TknDescriptorSet *pTknPipelineDescriptorSet = tknCreateDescriptorSetPtr(pTknGfxContext, 1, &spvReflectShaderModule, TKN_PIPELINE_DESCRIPTOR_SET);
+    VkDescriptorSetLayoutCreateInfo emptyVkDescriptorSetLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 0,
+        .pBindings = NULL,
+    };
+    VkDescriptorSetLayout emptyVkDescriptorSetLayout = VK_NULL_HANDLE;
+    tknAssertVkResult(vkCreateDescriptorSetLayout(vkDevice, &emptyVkDescriptorSetLayoutCreateInfo, NULL, &emptyVkDescriptorSetLayout));
+    VkDescriptorSetLayout vkDescriptorSetLayouts[TKN_MAX_DESCRIPTOR_SET];
+    vkDescriptorSetLayouts[TKN_GLOBAL_DESCRIPTOR_SET] = pTknGfxContext->pTknGlobalDescriptorSet->vkDescriptorSetLayout;
+    vkDescriptorSetLayouts[TKN_SUBPASS_DESCRIPTOR_SET] = emptyVkDescriptorSetLayout;
+    vkDescriptorSetLayouts[TKN_PIPELINE_DESCRIPTOR_SET] = pTknPipelineDescriptorSet->vkDescriptorSetLayout;
+    VkPushConstantRange vkPushConstantRange = tknGetPushConstantRange(pTknGfxContext, 1, &spvReflectShaderModule);
+    VkPipelineLayoutCreateInfo vkPipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .setLayoutCount = TKN_MAX_DESCRIPTOR_SET,
+        .pSetLayouts = vkDescriptorSetLayouts,
+        .pushConstantRangeCount = vkPushConstantRange.size > 0 ? 1 : 0,
+        .pPushConstantRanges = vkPushConstantRange.size > 0 ? &vkPushConstantRange : NULL,
+    };
+    VkPipelineLayout vkPipelineLayout;
+    tknAssertVkResult(vkCreatePipelineLayout(vkDevice, &vkPipelineLayoutCreateInfo, NULL, &vkPipelineLayout));
+
+    VkComputePipelineCreateInfo vkComputePipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shaderModule,
+            .pName = spvReflectShaderModule.entry_point_name,
+            .pSpecializationInfo = NULL,
+        },
+        .layout = vkPipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = 0,
+    };
+    TknPipelineCacheResult tknPipelineCacheResult;
+    VkPipeline vkPipeline = tknCreateVkComputePipeline(pTknGfxContext, vkComputePipelineCreateInfo, &tknPipelineCacheResult);
+    tknRecordPipelineCacheResult(pTknGfxContext, tknPipelineCacheResult);
+    vkDestroyShaderModule(vkDevice, shaderModule, NULL);
+
+    TknComputePipeline *pTknComputePipeline = tknMalloc(sizeof(TknComputePipeline));
+    *pTknComputePipeline = (TknComputePipeline){
+        .vkPipeline = vkPipeline,
+        .pTknPipelineDescriptorSet = pTknPipelineDescriptorSet,
+        .emptyVkDescriptorSetLayout = emptyVkDescriptorSetLayout,
+        .vkPipelineLayout = vkPipelineLayout,
+        .pushConstantVkShaderStageFlags = vkPushConstantRange.stageFlags,
+        .pushConstantSize = vkPushConstantRange.size,
+    };
+    return pTknComputePipeline;
+}
+
+void tknDestroyComputePipelinePtr(TknGfxContext *pTknGfxContext, TknComputePipeline *pTknComputePipeline)
+{
+    tknWaitGfxFramesInFlight(pTknGfxContext);
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    // Destroys the materials created for the pipeline as well
+    tknDestroyDescriptorSetPtr(pTknGfxContext, pTknComputePipeline->pTknPipelineDescriptorSet);
+    vkDestroyPipeline(vkDevice, pTknComputePipeline->vkPipeline, NULL);
+    vkDestroyPipelineLayout(vkDevice, pTknComputePipeline->vkPipelineLayout, NULL);
+    vkDestroyDescriptorSetLayout(vkDevice, pTknComputePipeline->emptyVkDescriptorSetLayout, NULL);
+    tknFree(pTknComputePipeline);
+}
@@ -0,0 +1,237 @@
+#include "tknGfxCore.h"
+
+// Returns the file contents when the header matches this device, NULL otherwise
+static void *tknLoadPipelineCacheData(TknGfxContext *pTknGfxContext, const char *filePath, size_t *pDataSize)
+{
+    *pDataSize = 0;
+    FILE *file = fopen(filePath, "rb");
+    if (NULL == file)
+    {
+        printf("No pipeline cache at %s, pipelines are compiled from scratch\n", filePath);
+        return NULL;
+    }
+    else
+    {
+        // File opened successfully
+    }
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (fileSize < (long)sizeof(VkPipelineCacheHeaderVersionOne))
+    {
+        fclose(file);
+        tknWarning("Pipeline cache %s is too small, ignoring it", filePath);
+        return NULL;
+    }
+    else
+    {
+        // Large enough for the header
+    }
+    void *data = tknMalloc((size_t)fileSize);
+    size_t bytesRead = fread(data, 1, (size_t)fileSize, file);
+    fclose(file);
+
+    // The header layout is fixed by the spec, a cache from another driver or device is rejected by us rather than the driver
+    VkPipelineCacheHeaderVersionOne vkPipelineCacheHeader;
+    memcpy(&vkPipelineCacheHeader, data, sizeof(vkPipelineCacheHeader));
+    VkPhysicalDeviceProperties *pVkPhysicalDeviceProperties = &pTknGfxContext->vkPhysicalDeviceProperties;
+    if (bytesRead != (size_t)fileSize ||
+        vkPipelineCacheHeader.headerSize < sizeof(VkPipelineCacheHeaderVersionOne) ||
+        vkPipelineCacheHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        vkPipelineCacheHeader.vendorID != pVkPhysicalDeviceProperties->vendorID ||
+        vkPipelineCacheHeader.deviceID != pVkPhysicalDeviceProperties->deviceID ||
+        0 != memcmp(vkPipelineCacheHeader.pipelineCacheUUID, pVkPhysicalDeviceProperties->pipelineCacheUUID, VK_UUID_SIZE))
+    {
+        tknWarning("Pipeline cache %s does not match this device or driver, ignoring it", filePath);
+        tknFree(data);
+        return NULL;
+    }
+    else
+    {
+        *pDataSize = (size_t)fileSize;
+        return data;
+    }
+}
+
+static void tknSavePipelineCacheData(TknGfxContext *pTknGfxContext, const char *filePath)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    size_t dataSize = 0;
+    tknAssertVkResult(vkGetPipelineCacheData(vkDevice, pTknGfxContext->vkPipelineCache, &dataSize, NULL));
+    void *data = tknMalloc(dataSize);
+    tknAssertVkResult(vkGetPipelineCacheData(vkDevice, pTknGfxContext->vkPipelineCache, &dataSize, data));
+
+    // Write next to the target and rename, so a crash while writing never leaves a truncated cache behind
+    char tempFilePath[FILENAME_MAX];
+    snprintf(tempFilePath, FILENAME_MAX, "%s.tmp", filePath);
+    FILE *file = fopen(tempFilePath, "wb");
+    if (NULL == file)
+    {
+        tknWarning("Failed to open %s for writing, the pipeline cache is not saved", tempFilePath);
+    }
+    else
+    {
+        size_t bytesWritten = fwrite(data, 1, dataSize, file);
+        bool isWritten = 0 == fclose(file) && bytesWritten == dataSize;
+        remove(filePath);
+        if (isWritten && 0 == rename(tempFilePath, filePath))
+        {
+            printf("Saved %zu bytes of pipeline cache to %s\n", dataSize, filePath);
+        }
+        else
+        {
+            remove(tempFilePath);
+            tknWarning("Failed to write the pipeline cache to %s", filePath);
+        }
+    }
+    tknFree(data);
+}
+
+// pipelineCachePath may be NULL, the cache then only lives as long as the context
+void tknPopulatePipelineCache(TknGfxContext *pTknGfxContext, const char *pipelineCachePath)
+{
+    double startMilliseconds = tknGetTimeMilliseconds();
+    size_t initialDataSize = 0;
+    void *initialData = NULL;
+    if (pipelineCachePath != NULL)
+    {
+        size_t pathSize = strlen(pipelineCachePath) + 1;
+        pTknGfxContext->pipelineCachePath = tknMalloc(pathSize);
+        memcpy(pTknGfxContext->pipelineCachePath, pipelineCachePath, pathSize);
+        initialData = tknLoadPipelineCacheData(pTknGfxContext, pipelineCachePath, &initialDataSize);
+    }
+    else
+    {
+        pTknGfxContext->pipelineCachePath = NULL;
+    }
+
+    VkPipelineCacheCreateInfo vkPipelineCacheCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .initialDataSize = initialDataSize,
+        .pInitialData = initialData,
+    };
+    VkResult vkResult = vkCreatePipelineCache(pTknGfxContext->vkDevice, &vkPipelineCacheCreateInfo, NULL, &pTknGfxContext->vkPipelineCache);
+    if (VK_SUCCESS != vkResult && initialData != NULL)
+    {
+        // The header matched but the driver still refused the contents, start over with an empty cache
+        tknWarning("Driver rejected the pipeline cache, result: %d", vkResult);
+        initialDataSize = 0;
+        vkPipelineCacheCreateInfo.initialDataSize = 0;
+        vkPipelineCacheCreateInfo.pInitialData = NULL;
+        tknAssertVkResult(vkCreatePipelineCache(pTknGfxContext->vkDevice, &vkPipelineCacheCreateInfo, NULL, &pTknGfxContext->vkPipelineCache));
+    }
+    else
+    {
+        tknAssertVkResult(vkResult);
+    }
+    tknFree(initialData);
+
+    pTknGfxContext->tknPipelineCacheStats = (TknPipelineCacheStats){
+        .isLoaded = initialDataSize > 0,
+        .loadedSize = initialDataSize,
+        .loadMilliseconds = tknGetTimeMilliseconds() - startMilliseconds,
+        .isFeedbackSupported = pTknGfxContext->isPipelineCreationFeedbackEnabled,
+        .hitCount = 0,
+        .missCount = 0,
+        .hitMilliseconds = 0.0,
+        .missMilliseconds = 0.0,
+    };
+}
+
+void tknCleanupPipelineCache(TknGfxContext *pTknGfxContext)
+{
+    TknPipelineCacheStats *pTknPipelineCacheStats = &pTknGfxContext->tknPipelineCacheStats;
+    printf("Pipeline cache: %u hits in %.2f ms, %u misses in %.2f ms, loaded %zu bytes in %.2f ms\n",
+           pTknPipelineCacheStats->hitCount, pTknPipelineCacheStats->hitMilliseconds,
+           pTknPipelineCacheStats->missCount, pTknPipelineCacheStats->missMilliseconds,
+           pTknPipelineCacheStats->loadedSize, pTknPipelineCacheStats->loadMilliseconds);
+    if (pTknGfxContext->pipelineCachePath != NULL)
+    {
+        tknSavePipelineCacheData(pTknGfxContext, pTknGfxContext->pipelineCachePath);
+        tknFree(pTknGfxContext->pipelineCachePath);
+        pTknGfxContext->pipelineCachePath = NULL;
+    }
+    else
+    {
+        // Nothing to persist
+    }
+    vkDestroyPipelineCache(pTknGfxContext->vkDevice, pTknGfxContext->vkPipelineCache, NULL);
+    pTknGfxContext->vkPipelineCache = VK_NULL_HANDLE;
+}
+
+typedef VkResult (*TknCreateVkPipelineFunction)(TknGfxContext *pTknGfxContext, const void *pCreateInfo, VkPipeline *pVkPipeline);
+
+static VkResult tknCallCreateGraphicsPipelines(TknGfxContext *pTknGfxContext, const void *pCreateInfo, VkPipeline *pVkPipeline)
+{
+    return vkCreateGraphicsPipelines(pTknGfxContext->vkDevice, pTknGfxContext->vkPipelineCache, 1, pCreateInfo, NULL, pVkPipeline);
+}
+
+static VkResult tknCallCreateComputePipelines(TknGfxContext *pTknGfxContext, const void *pCreateInfo, VkPipeline *pVkPipeline)
+{
+    return vkCreateComputePipelines(pTknGfxContext->vkDevice, pTknGfxContext->vkPipelineCache, 1, pCreateInfo, NULL, pVkPipeline);
+}
+
+// Creates the pipeline through the context's cache and reports whether the cache had it.
+// Safe to call from worker threads, the driver synchronizes the cache and the result is recorded by the caller.
+// ppNext points at the pNext of pCreateInfo, the creation feedback is chained in front of it for the call
+static VkPipeline tknCreateVkPipelineWithFeedback(TknGfxContext *pTknGfxContext, TknCreateVkPipelineFunction createVkPipeline, const void *pCreateInfo, const void **ppNext, TknPipelineCacheResult *pTknPipelineCacheResult)
+{
+    VkPipelineCreationFeedbackEXT vkPipelineCreationFeedback = {0};
+    VkPipelineCreationFeedbackCreateInfoEXT vkPipelineCreationFeedbackCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT,
+        .pNext = *ppNext,
+        .pPipelineCreationFeedback = &vkPipelineCreationFeedback,
+        .pipelineStageCreationFeedbackCount = 0,
+        .pPipelineStageCreationFeedbacks = NULL,
+    };
+    if (pTknGfxContext->isPipelineCreationFeedbackEnabled)
+    {
+        *ppNext = &vkPipelineCreationFeedbackCreateInfo;
+    }
+    else
+    {
+        // Every pipeline counts as a miss, compare the totals of a cold and a warm start instead
+    }
+
+    VkPipeline vkPipeline = VK_NULL_HANDLE;
+    double startMilliseconds = tknGetTimeMilliseconds();
+    tknAssertVkResult(createVkPipeline(pTknGfxContext, pCreateInfo, &vkPipeline));
+    *pTknPipelineCacheResult = (TknPipelineCacheResult){
+        .isHit = (vkPipelineCreationFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT) &&
+                 (vkPipelineCreationFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT),
+        .milliseconds = tknGetTimeMilliseconds() - startMilliseconds,
+    };
+    return vkPipeline;
+}
+
+VkPipeline tknCreateVkGraphicsPipeline(TknGfxContext *pTknGfxContext, VkGraphicsPipelineCreateInfo vkGraphicsPipelineCreateInfo, TknPipelineCacheResult *pTknPipelineCacheResult)
+{
+    return tknCreateVkPipelineWithFeedback(pTknGfxContext, tknCallCreateGraphicsPipelines, &vkGraphicsPipelineCreateInfo, &vkGraphicsPipelineCreateInfo.pNext, pTknPipelineCacheResult);
+}
+
+VkPipeline tknCreateVkComputePipeline(TknGfxContext *pTknGfxContext, VkComputePipelineCreateInfo vkComputePipelineCreateInfo, TknPipelineCacheResult *pTknPipelineCacheResult)
+{
+    return tknCreateVkPipelineWithFeedback(pTknGfxContext, tknCallCreateComputePipelines, &vkComputePipelineCreateInfo, &vkComputePipelineCreateInfo.pNext, pTknPipelineCacheResult);
+}
+
+void tknRecordPipelineCacheResult(TknGfxContext *pTknGfxContext, TknPipelineCacheResult tknPipelineCacheResult)
+{
+    TknPipelineCacheStats *pTknPipelineCacheStats = &pTknGfxContext->tknPipelineCacheStats;
+    if (tknPipelineCacheResult.isHit)
+    {
+        pTknPipelineCacheStats->hitCount++;
+        pTknPipelineCacheStats->hitMilliseconds += tknPipelineCacheResult.milliseconds;
+    }
+    else
+    {
+        pTknPipelineCacheStats->missCount++;
+        pTknPipelineCacheStats->missMilliseconds += tknPipelineCacheResult.milliseconds;
+    }
+}
+
+TknPipelineCacheStats tknGetPipelineCacheStats(TknGfxContext *pTknGfxContext)
+{
+    return pTknGfxContext->tknPipelineCacheStats;
+}
@@ -10,9 +10,10 @@ static struct TknSubpass tknCreateSubpass(TknGfxContext *pTknGfxContext, uint32_
         inputAttachmentIndexToVkImageLayout[inputVkAttachmentReferenceIndex] = inputVkAttachmentReferences[inputVkAttachmentReferenceIndex].layout;
     }
     SpvReflectShaderModule *spvReflectShaderModules = tknMalloc(sizeof(SpvReflectShaderModule) * spvPathCount);
+    tknLoadShaderReflections(pTknGfxContext, spvPathCount, spvPaths);
     for (uint32_t spvPathIndex = 0; spvPathIndex < spvPathCount; spvPathIndex++)
     {
-        spvReflectShaderModules[spvPathIndex] = tknCreateSpvReflectShaderModule(spvPaths[spvPathIndex]);
+        spvReflectShaderModules[spvPathIndex] = tknGetSpvReflectShaderModule(pTknGfxContext, spvPaths[spvPathIndex]);
     }
     TknDescriptorSet *pTknSubpassDescriptorSet = tknCreateDescriptorSetPtr(pTknGfxContext, spvPathCount, spvReflectShaderModules, TKN_SUBPASS_DESCRIPTOR_SET);
     TknMaterial *pTknMaterial = tknCreateMaterialPtr(pTknGfxContext, pTknSubpassDescriptorSet);
@@ -54,7 +55,6 @@ static struct TknSubpass tknCreateSubpass(TknGfxContext *pTknGfxContext, uint32_
                 }
             }
         }
-        tknDestroySpvReflectShaderModule(&spvReflectShaderModules[spvPathIndex]);
     }
     tknFree(spvReflectShaderModules);
     tknFree(inputAttachmentIndexToVkImageLayout);
@@ -68,36 +68,19 @@ static struct TknSubpass tknCreateSubpass(TknGfxContext *pTknGfxContext, uint32_
     };
     return subpass;
 }
-static void tknDestroySubpass(TknGfxContext *pTknGfxContext, struct TknSubpass tknSubpass)
+static void tknDestroySubpass(TknGfxContext *pTknGfxContext, struct TknSubpass *pTknSubpass)
 {
-    for (uint32_t i = 0; i < tknSubpass.tknPipelinePtrHashSet.capacity; i++)
+    // Destroying a pipeline removes it from this set
+    while (pTknSubpass->tknPipelinePtrHashSet.count > 0)
     {
-        TknListNode *node = tknSubpass.tknPipelinePtrHashSet.nodePtrs[i];
-        while (node)
-        {
-            TknListNode *nextNode = node->pNextNode;
-            TknPipeline *pTknPipeline = *(TknPipeline **)node->data;
-            tknDestroyPipelinePtr(pTknGfxContext, pTknPipeline);
-            node = nextNode;
-        }
-    }
-    tknAssert(tknSubpass.pTknSubpassDescriptorSet->tknMaterialPtrHashSet.count == 1, "Subpass must have exactly one material");
-    for (uint32_t i = 0; i < tknSubpass.pTknSubpassDescriptorSet->tknMaterialPtrHashSet.capacity; i++)
-    {
-        TknListNode *node = tknSubpass.pTknSubpassDescriptorSet->tknMaterialPtrHashSet.nodePtrs[i];
-        if (node != NULL)
-        {
-            TknMaterial *pTknMaterial = *(TknMaterial **)node->data;
-            tknUnbindAttachmentsFromMaterialPtr(pTknGfxContext, pTknMaterial);
-            break;
-        }
-        else
-        {
-            // Skip
-        }
+        TknPipeline *pTknPipeline = *(TknPipeline **)tknGetFromHashSet(&pTknSubpass->tknPipelinePtrHashSet, pTknSubpass->tknPipelinePtrHashSet.count - 1);
+        tknDestroyPipelinePtr(pTknGfxContext, pTknPipeline);
     }
-    tknDestroyDescriptorSetPtr(pTknGfxContext, tknSubpass.pTknSubpassDescriptorSet);
-    tknDestroyHashSet(tknSubpass.tknPipelinePtrHashSet);
+    tknAssert(pTknSubpass->pTknSubpassDescriptorSet->tknMaterialPtrHashSet.count == 1, "Subpass must have exactly one material");
+    TknMaterial *pTknMaterial = *(TknMaterial **)tknGetFromHashSet(&pTknSubpass->pTknSubpassDescriptorSet->tknMaterialPtrHashSet, 0);
+    tknUnbindAttachmentsFromMaterialPtr(pTknGfxContext, pTknMaterial);
+    tknDestroyDescriptorSetPtr(pTknGfxContext, pTknSubpass->pTknSubpassDescriptorSet);
+    tknDestroyHashSet(pTknSubpass->tknPipelinePtrHashSet);
 }
 
 TknRenderPass *tknCreateRenderPassPtr(TknGfxContext *pTknGfxContext, uint32_t tknAttachmentCount, VkAttachmentDescription *vkAttachmentDescriptions, TknAttachment **inputAttachmentPtrs, VkClearValue *vkClearValues, uint32_t tknSubpassCount, VkSubpassDescription *vkSubpassDescriptions, uint32_t *spvPathCounts, const char ***spvPathsArray, uint32_t vkSubpassDependencyCount, VkSubpassDependency *vkSubpassDependencies, uint32_t renderPassIndex)
@@ -153,13 +136,14 @@ TknRenderPass *tknCreateRenderPassPtr(TknGfxContext *pTknGfxContext, uint32_t tk
 }
 void tknDestroyRenderPassPtr(TknGfxContext *pTknGfxContext, TknRenderPass *pTknRenderPass)
 {
+    tknWaitGfxFramesInFlight(pTknGfxContext);
     tknRemoveFromHashSet(&pTknGfxContext->tknRenderPassPtrHashSet, &pTknRenderPass);
     tknCleanupFramebuffers(pTknGfxContext, pTknRenderPass);
     vkDestroyRenderPass(pTknGfxContext->vkDevice, pTknRenderPass->vkRenderPass, NULL);
     for (uint32_t i = 0; i < pTknRenderPass->tknSubpassCount; i++)
     {
         struct TknSubpass *pTknSubpass = &pTknRenderPass->pTknSubpasses[i];
-        tknDestroySubpass(pTknGfxContext, *pTknSubpass);
+        tknDestroySubpass(pTknGfxContext, pTknSubpass);
     }
     for (uint32_t i = 0; i < pTknRenderPass->tknAttachmentCount; i++)
     {
@@ -0,0 +1,178 @@
+#include "tknGfxCore.h"
+
+static void tknReleaseRetiredResource(TknGfxContext *pTknGfxContext, TknRetiredResource *pTknRetiredResource)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    if (TKN_RETIRED_RESOURCE_BUFFER == pTknRetiredResource->tknRetiredResourceType)
+    {
+        tknDestroyVkBuffer(pTknGfxContext, pTknRetiredResource->vkBuffer, pTknRetiredResource->tknMemoryAllocation);
+    }
+    else if (TKN_RETIRED_RESOURCE_IMAGE == pTknRetiredResource->tknRetiredResourceType)
+    {
+        tknDestroyVkImage(pTknGfxContext, pTknRetiredResource->vkImage, pTknRetiredResource->tknMemoryAllocation, pTknRetiredResource->vkImageView);
+    }
+    else if (TKN_RETIRED_RESOURCE_SAMPLER == pTknRetiredResource->tknRetiredResourceType)
+    {
+        vkDestroySampler(vkDevice, pTknRetiredResource->vkSampler, NULL);
+    }
+    else if (TKN_RETIRED_RESOURCE_DESCRIPTOR_POOL == pTknRetiredResource->tknRetiredResourceType)
+    {
+        vkDestroyDescriptorPool(vkDevice, pTknRetiredResource->vkDescriptorPool, NULL);
+    }
+    else if (TKN_RETIRED_RESOURCE_DESCRIPTOR_SET == pTknRetiredResource->tknRetiredResourceType)
+    {
+        tknRecycleVkDescriptorSet(pTknGfxContext, pTknRetiredResource->pTknDescriptorSet, pTknRetiredResource->vkDescriptorSet);
+    }
+    else
+    {
+        tknError("Unknown retired resource type: %d", pTknRetiredResource->tknRetiredResourceType);
+    }
+}
+
+static void tknRetireResource(TknGfxContext *pTknGfxContext, TknRetiredResource tknRetiredResource)
+{
+    // The frame being recorded may reference the resource too, it is submitted with the next serial
+    tknRetiredResource.retireSerial = pTknGfxContext->tknSubmitSerial;
+    tknAddToDynamicArray(&pTknGfxContext->tknRetiredResourceDynamicArray, &tknRetiredResource);
+}
+
+void tknPopulateRetiredResources(TknGfxContext *pTknGfxContext)
+{
+    pTknGfxContext->tknRetiredResourceDynamicArray = tknCreateDynamicArray(sizeof(TknRetiredResource), TKN_DEFAULT_COLLECTION_SIZE);
+    pTknGfxContext->tknSubmitSerial = 0;
+    pTknGfxContext->tknCompletedSubmitSerial = 0;
+    for (uint32_t frameIndex = 0; frameIndex < TKN_MAX_FRAMES_IN_FLIGHT; frameIndex++)
+    {
+        pTknGfxContext->tknFrameSubmitSerials[frameIndex] = 0;
+    }
+}
+
+// The device must be idle
+void tknCleanupRetiredResources(TknGfxContext *pTknGfxContext)
+{
+    TknDynamicArray *pTknRetiredResourceDynamicArray = &pTknGfxContext->tknRetiredResourceDynamicArray;
+    for (uint32_t retiredResourceIndex = 0; retiredResourceIndex < pTknRetiredResourceDynamicArray->count; retiredResourceIndex++)
+    {
+        tknReleaseRetiredResource(pTknGfxContext, tknGetFromDynamicArray(pTknRetiredResourceDynamicArray, retiredResourceIndex));
+    }
+    tknDestroyDynamicArray(*pTknRetiredResourceDynamicArray);
+}
+
+// Called right after the frame is submitted, the submission gets the next serial
+void tknSubmitRetiredResources(TknGfxContext *pTknGfxContext, uint32_t frameIndex)
+{
+    pTknGfxContext->tknSubmitSerial++;
+    pTknGfxContext->tknFrameSubmitSerials[frameIndex] = pTknGfxContext->tknSubmitSerial;
+}
+
+// The frame's fence must have signaled. A fence covers its submission and every earlier one on the queue,
+// so a resource retired at serial S is freed only once a submission with a serial greater than S is done
+void tknReleaseRetiredResources(TknGfxContext *pTknGfxContext, uint32_t frameIndex)
+{
+    uint64_t frameSubmitSerial = pTknGfxContext->tknFrameSubmitSerials[frameIndex];
+    if (frameSubmitSerial > pTknGfxContext->tknCompletedSubmitSerial)
+    {
+        pTknGfxContext->tknCompletedSubmitSerial = frameSubmitSerial;
+    }
+    else
+    {
+        // The frame was not submitted since, e.g. the swapchain was recreated instead
+    }
+    // Serials only grow, so the resources that are done form a prefix of the array
+    TknDynamicArray *pTknRetiredResourceDynamicArray = &pTknGfxContext->tknRetiredResourceDynamicArray;
+    uint32_t releasedCount = 0;
+    while (releasedCount < pTknRetiredResourceDynamicArray->count)
+    {
+        TknRetiredResource *pTknRetiredResource = tknGetFromDynamicArray(pTknRetiredResourceDynamicArray, releasedCount);
+        if (pTknRetiredResource->retireSerial < pTknGfxContext->tknCompletedSubmitSerial)
+        {
+            tknReleaseRetiredResource(pTknGfxContext, pTknRetiredResource);
+            releasedCount++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (releasedCount > 0)
+    {
+        uint32_t remainingCount = pTknRetiredResourceDynamicArray->count - releasedCount;
+        memmove(pTknRetiredResourceDynamicArray->array, tknGetFromDynamicArray(pTknRetiredResourceDynamicArray, releasedCount), remainingCount * pTknRetiredResourceDynamicArray->dataSize);
+        pTknRetiredResourceDynamicArray->count = remainingCount;
+    }
+    else
+    {
+        // Skip
+    }
+}
+
+void tknRetireVkBuffer(TknGfxContext *pTknGfxContext, VkBuffer vkBuffer, TknMemoryAllocation tknMemoryAllocation)
+{
+    TknRetiredResource tknRetiredResource = {
+        .tknRetiredResourceType = TKN_RETIRED_RESOURCE_BUFFER,
+        .vkBuffer = vkBuffer,
+        .tknMemoryAllocation = tknMemoryAllocation,
+    };
+    tknRetireResource(pTknGfxContext, tknRetiredResource);
+}
+
+void tknRetireVkImage(TknGfxContext *pTknGfxContext, VkImage vkImage, TknMemoryAllocation tknMemoryAllocation, VkImageView vkImageView)
+{
+    TknRetiredResource tknRetiredResource = {
+        .tknRetiredResourceType = TKN_RETIRED_RESOURCE_IMAGE,
+        .vkImage = vkImage,
+        .vkImageView = vkImageView,
+        .tknMemoryAllocation = tknMemoryAllocation,
+    };
+    tknRetireResource(pTknGfxContext, tknRetiredResource);
+}
+
+void tknRetireVkSampler(TknGfxContext *pTknGfxContext, VkSampler vkSampler)
+{
+    TknRetiredResource tknRetiredResource = {
+        .tknRetiredResourceType = TKN_RETIRED_RESOURCE_SAMPLER,
+        .vkSampler = vkSampler,
+    };
+    tknRetireResource(pTknGfxContext, tknRetiredResource);
+}
+
+void tknRetireVkDescriptorPool(TknGfxContext *pTknGfxContext, VkDescriptorPool vkDescriptorPool)
+{
+    TknRetiredResource tknRetiredResource = {
+        .tknRetiredResourceType = TKN_RETIRED_RESOURCE_DESCRIPTOR_POOL,
+        .vkDescriptorPool = vkDescriptorPool,
+    };
+    tknRetireResource(pTknGfxContext, tknRetiredResource);
+}
+
+void tknRetireVkDescriptorSet(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet, VkDescriptorSet vkDescriptorSet)
+{
+    TknRetiredResource tknRetiredResource = {
+        .tknRetiredResourceType = TKN_RETIRED_RESOURCE_DESCRIPTOR_SET,
+        .pTknDescriptorSet = pTknDescriptorSet,
+        .vkDescriptorSet = vkDescriptorSet,
+    };
+    tknRetireResource(pTknGfxContext, tknRetiredResource);
+    pTknGfxContext->tknDescriptorPoolStats.usedSetCount--;
+    pTknGfxContext->tknDescriptorPoolStats.retiredSetCount++;
+}
+
+// The layout is being destroyed, its retired sets go away with its pools instead of back to its free list
+void tknForgetRetiredVkDescriptorSets(TknGfxContext *pTknGfxContext, TknDescriptorSet *pTknDescriptorSet)
+{
+    TknDynamicArray *pTknRetiredResourceDynamicArray = &pTknGfxContext->tknRetiredResourceDynamicArray;
+    uint32_t retiredResourceIndex = 0;
+    while (retiredResourceIndex < pTknRetiredResourceDynamicArray->count)
+    {
+        TknRetiredResource *pTknRetiredResource = tknGetFromDynamicArray(pTknRetiredResourceDynamicArray, retiredResourceIndex);
+        if (TKN_RETIRED_RESOURCE_DESCRIPTOR_SET == pTknRetiredResource->tknRetiredResourceType && pTknDescriptorSet == pTknRetiredResource->pTknDescriptorSet)
+        {
+            tknRemoveAtIndexFromDynamicArray(pTknRetiredResourceDynamicArray, retiredResourceIndex);
+            pTknGfxContext->tknDescriptorPoolStats.retiredSetCount--;
+        }
+        else
+        {
+            retiredResourceIndex++;
+        }
+    }
+}
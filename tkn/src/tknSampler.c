@@ -46,17 +46,16 @@ void tknDestroySamplerPtr(TknGfxContext *pTknGfxContext, TknSampler *pTknSampler
     {
         return;
     }
-    
     // Clear all binding references
-    tknClearBindingPtrHashSet(pTknGfxContext, pTknSampler->tknBindingPtrHashSet);
+    tknClearBindingPtrHashSet(pTknGfxContext, &pTknSampler->tknBindingPtrHashSet);
     
     // Destroy the hash set
     tknDestroyHashSet(pTknSampler->tknBindingPtrHashSet);
     
-    // Destroy the Vulkan sampler
+    // Retire the Vulkan sampler, frames in flight may still sample with it
     if (pTknSampler->vkSampler != VK_NULL_HANDLE)
     {
-        vkDestroySampler(pTknGfxContext->vkDevice, pTknSampler->vkSampler, NULL);
+        tknRetireVkSampler(pTknGfxContext, pTknSampler->vkSampler);
     }
     
     // Free the sampler struct
@@ -0,0 +1,126 @@
+#include "tknGfxCore.h"
+
+static TknSecondaryCommandPool *tknGetSecondaryCommandPool(TknGfxContext *pTknGfxContext, uint32_t frameIndex, uint32_t workerIndex)
+{
+    return &pTknGfxContext->tknSecondaryCommandPools[frameIndex * tknGetWorkerCount(pTknGfxContext->pTknWorkerPool) + workerIndex];
+}
+
+void tknPopulateSecondaryCommandPools(TknGfxContext *pTknGfxContext)
+{
+    uint32_t poolCount = pTknGfxContext->tknFrameInFlightCount * tknGetWorkerCount(pTknGfxContext->pTknWorkerPool);
+    pTknGfxContext->tknSecondaryCommandPools = tknMalloc(sizeof(TknSecondaryCommandPool) * poolCount);
+    VkCommandPoolCreateInfo vkCommandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = pTknGfxContext->tknGfxQueueFamilyIndex,
+    };
+    for (uint32_t poolIndex = 0; poolIndex < poolCount; poolIndex++)
+    {
+        TknSecondaryCommandPool *pTknSecondaryCommandPool = &pTknGfxContext->tknSecondaryCommandPools[poolIndex];
+        *pTknSecondaryCommandPool = (TknSecondaryCommandPool){
+            .vkCommandPool = VK_NULL_HANDLE,
+            .vkCommandBufferDynamicArray = tknCreateDynamicArray(sizeof(VkCommandBuffer), TKN_DEFAULT_COLLECTION_SIZE),
+            .usedCount = 0,
+        };
+        tknAssertVkResult(vkCreateCommandPool(pTknGfxContext->vkDevice, &vkCommandPoolCreateInfo, NULL, &pTknSecondaryCommandPool->vkCommandPool));
+    }
+}
+
+// The device must be idle, destroying the pools frees their command buffers
+void tknCleanupSecondaryCommandPools(TknGfxContext *pTknGfxContext)
+{
+    uint32_t poolCount = pTknGfxContext->tknFrameInFlightCount * tknGetWorkerCount(pTknGfxContext->pTknWorkerPool);
+    for (uint32_t poolIndex = 0; poolIndex < poolCount; poolIndex++)
+    {
+        TknSecondaryCommandPool *pTknSecondaryCommandPool = &pTknGfxContext->tknSecondaryCommandPools[poolIndex];
+        vkDestroyCommandPool(pTknGfxContext->vkDevice, pTknSecondaryCommandPool->vkCommandPool, NULL);
+        tknDestroyDynamicArray(pTknSecondaryCommandPool->vkCommandBufferDynamicArray);
+    }
+    tknFree(pTknGfxContext->tknSecondaryCommandPools);
+    pTknGfxContext->tknSecondaryCommandPools = NULL;
+}
+
+// The frame's fence must have signaled, one reset per pool is cheaper than resetting every buffer
+void tknResetSecondaryCommandPools(TknGfxContext *pTknGfxContext, uint32_t frameIndex)
+{
+    for (uint32_t workerIndex = 0; workerIndex < tknGetWorkerCount(pTknGfxContext->pTknWorkerPool); workerIndex++)
+    {
+        TknSecondaryCommandPool *pTknSecondaryCommandPool = tknGetSecondaryCommandPool(pTknGfxContext, frameIndex, workerIndex);
+        if (pTknSecondaryCommandPool->usedCount > 0)
+        {
+            tknAssertVkResult(vkResetCommandPool(pTknGfxContext->vkDevice, pTknSecondaryCommandPool->vkCommandPool, 0));
+            pTknSecondaryCommandPool->usedCount = 0;
+        }
+        else
+        {
+            // Nothing recorded since the last reset
+        }
+    }
+}
+
+// Begins a secondary command buffer for the frame's current subpass on the calling worker.
+// The returned frame records into it like an inline subpass, with its own bound state and stats.
+TknFrame tknBeginSecondaryFrame(TknGfxContext *pTknGfxContext, TknFrame *pTknFrame, uint32_t workerIndex)
+{
+    TknSecondaryCommandPool *pTknSecondaryCommandPool = tknGetSecondaryCommandPool(pTknGfxContext, pTknFrame->frameIndex, workerIndex);
+    if (pTknSecondaryCommandPool->usedCount == pTknSecondaryCommandPool->vkCommandBufferDynamicArray.count)
+    {
+        VkCommandBufferAllocateInfo vkCommandBufferAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = NULL,
+            .commandPool = pTknSecondaryCommandPool->vkCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1,
+        };
+        VkCommandBuffer vkCommandBuffer = VK_NULL_HANDLE;
+        tknAssertVkResult(vkAllocateCommandBuffers(pTknGfxContext->vkDevice, &vkCommandBufferAllocateInfo, &vkCommandBuffer));
+        tknAddToDynamicArray(&pTknSecondaryCommandPool->vkCommandBufferDynamicArray, &vkCommandBuffer);
+    }
+    else
+    {
+        // Reuse a buffer from an earlier frame
+    }
+    VkCommandBuffer vkCommandBuffer = *(VkCommandBuffer *)tknGetFromDynamicArray(&pTknSecondaryCommandPool->vkCommandBufferDynamicArray, pTknSecondaryCommandPool->usedCount);
+    pTknSecondaryCommandPool->usedCount++;
+
+    TknRenderPass *pTknRenderPass = pTknFrame->pTknRenderPass;
+    VkCommandBufferInheritanceInfo vkCommandBufferInheritanceInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = NULL,
+        .renderPass = pTknRenderPass->vkRenderPass,
+        .subpass = pTknFrame->subpassIndex,
+        .framebuffer = pTknRenderPass->vkFramebuffers[pTknFrame->swapchainIndex],
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags = 0,
+        .pipelineStatistics = tknGetActivePipelineStatisticFlags(pTknGfxContext, pTknFrame->frameIndex),
+    };
+    VkCommandBufferBeginInfo vkCommandBufferBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = &vkCommandBufferInheritanceInfo,
+    };
+    tknAssertVkResult(vkBeginCommandBuffer(vkCommandBuffer, &vkCommandBufferBeginInfo));
+    tknSetRenderAreaViewport(vkCommandBuffer, pTknRenderPass);
+
+    TknFrame secondaryTknFrame = {
+        .frameIndex = pTknFrame->frameIndex,
+        .vkCommandBuffer = vkCommandBuffer,
+        .swapchainIndex = pTknFrame->swapchainIndex,
+        .pTknRenderPass = pTknRenderPass,
+        .subpassIndex = pTknFrame->subpassIndex,
+        .vkSubpassContents = VK_SUBPASS_CONTENTS_INLINE,
+        .pTknPipeline = NULL,
+        // Recording draws never allocates frame memory, the arena stays with the primary frame
+        .tknArena = {0},
+        .tknFrameStats = {0},
+    };
+    tknForgetBoundState(&secondaryTknFrame);
+    return secondaryTknFrame;
+}
+
+void tknEndSecondaryFrame(TknFrame *pSecondaryTknFrame)
+{
+    tknAssertVkResult(vkEndCommandBuffer(pSecondaryTknFrame->vkCommandBuffer));
+}
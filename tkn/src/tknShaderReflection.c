@@ -0,0 +1,196 @@
+#include "tknGfxCore.h"
+
+// FNV-1a, only used to tell paths and file contents apart
+static uint64_t tknHashBytes(const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t byteIndex = 0; byteIndex < size; byteIndex++)
+    {
+        hash ^= bytes[byteIndex];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static void *tknReadSpvFile(const char *filePath, size_t *pShaderSize)
+{
+    FILE *file = fopen(filePath, "rb");
+    if (!file)
+    {
+        tknError("Failed to open file: %s\n", filePath);
+    }
+    else
+    {
+        // File opened successfully
+    }
+    fseek(file, 0, SEEK_END);
+    size_t shaderSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (shaderSize % 4 != 0)
+    {
+        fclose(file);
+        tknError("Invalid SPIR-V file size: %s\n", filePath);
+    }
+    else
+    {
+        // Valid SPIR-V file size
+    }
+    void *shaderCode = tknMalloc(shaderSize);
+    size_t bytesRead = fread(shaderCode, 1, shaderSize, file);
+
+    fclose(file);
+
+    if (bytesRead != shaderSize)
+    {
+        tknError("Failed to read entire file: %s\n", filePath);
+    }
+    else
+    {
+        // File read successfully
+    }
+    *pShaderSize = shaderSize;
+    return shaderCode;
+}
+
+// Reads and parses the file into the reflection, or only rereads it when the contents did not change
+static void tknParseShaderReflection(TknShaderReflection *pTknShaderReflection)
+{
+    size_t shaderSize = 0;
+    void *shaderCode = tknReadSpvFile(pTknShaderReflection->path, &shaderSize);
+    uint64_t contentHash = tknHashBytes(shaderCode, shaderSize);
+    if (pTknShaderReflection->isParsed && contentHash == pTknShaderReflection->contentHash)
+    {
+        pTknShaderReflection->isChanged = false;
+    }
+    else
+    {
+        if (pTknShaderReflection->isParsed)
+        {
+            spvReflectDestroyShaderModule(&pTknShaderReflection->spvReflectShaderModule);
+        }
+        else
+        {
+            // First parse
+        }
+        // spirv_reflect keeps its own copy of the code, shader modules are created from that copy
+        SpvReflectResult spvReflectResult = spvReflectCreateShaderModule(shaderSize, shaderCode, &pTknShaderReflection->spvReflectShaderModule);
+        tknAssert(spvReflectResult == SPV_REFLECT_RESULT_SUCCESS, "Failed to reflect shader module: %s", pTknShaderReflection->path);
+        pTknShaderReflection->contentHash = contentHash;
+        pTknShaderReflection->isParsed = true;
+        pTknShaderReflection->isChanged = true;
+    }
+    tknFree(shaderCode);
+}
+
+static void tknParseShaderReflectionTask(void *pContext, uint32_t taskIndex, uint32_t workerIndex)
+{
+    TknShaderReflection **shaderReflectionPtrs = pContext;
+    tknParseShaderReflection(shaderReflectionPtrs[taskIndex]);
+}
+
+// Reflections are never removed, so a path hash's dense index in the set is also its index in the pointer array
+static TknShaderReflection *tknFindShaderReflectionPtr(TknGfxContext *pTknGfxContext, const char *spvPath, uint64_t pathHash)
+{
+    uint32_t shaderReflectionIndex = tknGetIndexInHashSet(&pTknGfxContext->tknShaderReflectionPathHashSet, &pathHash);
+    if (UINT32_MAX == shaderReflectionIndex)
+    {
+        return NULL;
+    }
+    else
+    {
+        TknShaderReflection *pTknShaderReflection = *(TknShaderReflection **)tknGetFromDynamicArray(&pTknGfxContext->tknShaderReflectionPtrDynamicArray, shaderReflectionIndex);
+        tknAssert(0 == strcmp(spvPath, pTknShaderReflection->path), "Shader paths %s and %s have the same hash", spvPath, pTknShaderReflection->path);
+        return pTknShaderReflection;
+    }
+}
+
+static TknShaderReflection *tknAddShaderReflectionPtr(TknGfxContext *pTknGfxContext, const char *spvPath, uint64_t pathHash)
+{
+    size_t pathSize = strlen(spvPath) + 1;
+    TknShaderReflection *pTknShaderReflection = tknMalloc(sizeof(TknShaderReflection));
+    *pTknShaderReflection = (TknShaderReflection){
+        .path = tknMalloc(pathSize),
+        .pathHash = pathHash,
+        .contentHash = 0,
+        .isParsed = false,
+        .isChanged = false,
+        .spvReflectShaderModule = {0},
+    };
+    memcpy(pTknShaderReflection->path, spvPath, pathSize);
+    tknAddToHashSet(&pTknGfxContext->tknShaderReflectionPathHashSet, &pathHash);
+    tknAddToDynamicArray(&pTknGfxContext->tknShaderReflectionPtrDynamicArray, &pTknShaderReflection);
+    return pTknShaderReflection;
+}
+
+void tknPopulateShaderReflections(TknGfxContext *pTknGfxContext)
+{
+    pTknGfxContext->tknShaderReflectionPtrDynamicArray = tknCreateDynamicArray(sizeof(TknShaderReflection *), TKN_DEFAULT_COLLECTION_SIZE);
+    pTknGfxContext->tknShaderReflectionPathHashSet = tknCreateHashSet(sizeof(uint64_t));
+    pTknGfxContext->tknShaderReflectionHitCount = 0;
+}
+
+void tknCleanupShaderReflections(TknGfxContext *pTknGfxContext)
+{
+    TknDynamicArray *pTknShaderReflectionPtrDynamicArray = &pTknGfxContext->tknShaderReflectionPtrDynamicArray;
+    printf("Shader reflection cache: %u shaders, %u hits\n", pTknShaderReflectionPtrDynamicArray->count, pTknGfxContext->tknShaderReflectionHitCount);
+    for (uint32_t shaderReflectionIndex = 0; shaderReflectionIndex < pTknShaderReflectionPtrDynamicArray->count; shaderReflectionIndex++)
+    {
+        TknShaderReflection *pTknShaderReflection = *(TknShaderReflection **)tknGetFromDynamicArray(pTknShaderReflectionPtrDynamicArray, shaderReflectionIndex);
+        spvReflectDestroyShaderModule(&pTknShaderReflection->spvReflectShaderModule);
+        tknFree(pTknShaderReflection->path);
+        tknFree(pTknShaderReflection);
+    }
+    tknDestroyDynamicArray(*pTknShaderReflectionPtrDynamicArray);
+    tknDestroyHashSet(pTknGfxContext->tknShaderReflectionPathHashSet);
+}
+
+// Makes sure every path is reflected, the ones seen for the first time are read and parsed in parallel.
+// Must not run while anything reads reflections, e.g. during a pipeline batch.
+void tknLoadShaderReflections(TknGfxContext *pTknGfxContext, uint32_t spvPathCount, const char **spvPaths)
+{
+    TknShaderReflection **missingShaderReflectionPtrs = tknMalloc(sizeof(TknShaderReflection *) * spvPathCount);
+    uint32_t missingCount = 0;
+    for (uint32_t spvPathIndex = 0; spvPathIndex < spvPathCount; spvPathIndex++)
+    {
+        const char *spvPath = spvPaths[spvPathIndex];
+        uint64_t pathHash = tknHashBytes(spvPath, strlen(spvPath));
+        if (NULL != tknFindShaderReflectionPtr(pTknGfxContext, spvPath, pathHash))
+        {
+            pTknGfxContext->tknShaderReflectionHitCount++;
+        }
+        else
+        {
+            // Adding right away also dedups paths repeated within the batch
+            missingShaderReflectionPtrs[missingCount] = tknAddShaderReflectionPtr(pTknGfxContext, spvPath, pathHash);
+            missingCount++;
+        }
+    }
+    tknRunOnWorkerPool(pTknGfxContext->pTknWorkerPool, missingCount, tknParseShaderReflectionTask, missingShaderReflectionPtrs);
+    tknFree(missingShaderReflectionPtrs);
+}
+
+// Read only, safe from workers as long as no load or reload runs at the same time
+SpvReflectShaderModule tknGetSpvReflectShaderModule(TknGfxContext *pTknGfxContext, const char *spvPath)
+{
+    TknShaderReflection *pTknShaderReflection = tknFindShaderReflectionPtr(pTknGfxContext, spvPath, tknHashBytes(spvPath, strlen(spvPath)));
+    tknAssert(NULL != pTknShaderReflection, "Shader %s was not loaded before use", spvPath);
+    return pTknShaderReflection->spvReflectShaderModule;
+}
+
+bool tknReloadShaderReflection(TknGfxContext *pTknGfxContext, const char *spvPath)
+{
+    uint64_t pathHash = tknHashBytes(spvPath, strlen(spvPath));
+    TknShaderReflection *pTknShaderReflection = tknFindShaderReflectionPtr(pTknGfxContext, spvPath, pathHash);
+    if (NULL == pTknShaderReflection)
+    {
+        pTknShaderReflection = tknAddShaderReflectionPtr(pTknGfxContext, spvPath, pathHash);
+    }
+    else
+    {
+        // Reparsed only if the contents changed
+    }
+    tknParseShaderReflection(pTknShaderReflection);
+    return pTknShaderReflection->isChanged;
+}
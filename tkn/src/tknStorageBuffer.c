@@ -0,0 +1,50 @@
+#include "tknGfxCore.h"
+
+TknStorageBuffer *tknCreateStorageBufferPtr(TknGfxContext *pTknGfxContext, const void *data, VkDeviceSize size)
+{
+    tknAssert(size > 0, "Storage buffer needs at least one byte");
+    TknStorageBuffer *pTknStorageBuffer = tknMalloc(sizeof(TknStorageBuffer));
+    VkBuffer vkBuffer = VK_NULL_HANDLE;
+    TknMemoryAllocation tknMemoryAllocation;
+    // Only shaders write it, so one copy serves every frame and the passes order themselves with tknBufferBarrier
+    VkBufferUsageFlags vkBufferUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    tknCreateVkBuffer(pTknGfxContext, size, vkBufferUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TKN_MEMORY_USAGE_STORAGE_BUFFER, &vkBuffer, &tknMemoryAllocation);
+
+    *pTknStorageBuffer = (TknStorageBuffer){
+        .vkBuffer = vkBuffer,
+        .tknMemoryAllocation = tknMemoryAllocation,
+        .tknBindingPtrHashSet = tknCreateHashSet(sizeof(TknBinding *)),
+        .tknDrawCallPtrHashSet = tknCreateHashSet(sizeof(TknDrawCall *)),
+        .size = size,
+    };
+    if (NULL != data)
+    {
+        // Copied through the staging ring, the copy runs before the next frame's work
+        TknUpload tknUpload = tknBeginUpload(pTknGfxContext, size);
+        memcpy(tknUpload.mapped, data, (size_t)size);
+        VkBufferCopy vkBufferCopy = {
+            .srcOffset = tknUpload.offset,
+            .dstOffset = 0,
+            .size = size,
+        };
+        vkCmdCopyBuffer(tknUpload.vkCommandBuffer, tknUpload.vkBuffer, vkBuffer, 1, &vkBufferCopy);
+        tknEndUpload(pTknGfxContext, tknUpload);
+    }
+    else
+    {
+        // Contents are undefined until a shader writes them
+    }
+    return pTknStorageBuffer;
+}
+
+void tknDestroyStorageBufferPtr(TknGfxContext *pTknGfxContext, TknStorageBuffer *pTknStorageBuffer)
+{
+    tknAssert(0 == pTknStorageBuffer->tknDrawCallPtrHashSet.count, "TknStorageBuffer still has indirect draw calls attached!");
+    tknDestroyHashSet(pTknStorageBuffer->tknDrawCallPtrHashSet);
+    tknClearBindingPtrHashSet(pTknGfxContext, &pTknStorageBuffer->tknBindingPtrHashSet);
+    tknDestroyHashSet(pTknStorageBuffer->tknBindingPtrHashSet);
+    // Frames in flight may still read or write the buffer through their descriptor sets
+    tknRetireVkBuffer(pTknGfxContext, pTknStorageBuffer->vkBuffer, pTknStorageBuffer->tknMemoryAllocation);
+    pTknStorageBuffer->vkBuffer = VK_NULL_HANDLE;
+    tknFree(pTknStorageBuffer);
+}
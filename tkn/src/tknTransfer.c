@@ -0,0 +1,346 @@
+#include "tknGfxCore.h"
+
+static bool tknHasTransferQueue(TknGfxContext *pTknGfxContext)
+{
+    return pTknGfxContext->tknTransferQueueFamilyIndex != UINT32_MAX;
+}
+
+static TknTransfer tknBeginTransfer(TknGfxContext *pTknGfxContext, VkDeviceSize size)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    TknTransfer tknTransfer = {
+        .ticket = pTknGfxContext->tknNextUploadTicket++,
+        .vkFence = VK_NULL_HANDLE,
+        .vkCommandBuffer = VK_NULL_HANDLE,
+        .stagingVkBuffer = VK_NULL_HANDLE,
+        .stagingMemoryAllocation = {0},
+        .pTknMesh = NULL,
+        .pTknImage = NULL,
+    };
+    // Transfers finish on their own timeline, so they get their own staging buffer instead of a slice of the frame ring
+    tknCreateVkBuffer(pTknGfxContext, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      TKN_MEMORY_USAGE_STAGING, &tknTransfer.stagingVkBuffer, &tknTransfer.stagingMemoryAllocation);
+
+    VkCommandBufferAllocateInfo vkCommandBufferAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pTknGfxContext->vkTransferCommandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+    tknAssertVkResult(vkAllocateCommandBuffers(vkDevice, &vkCommandBufferAllocateInfo, &tknTransfer.vkCommandBuffer));
+    VkCommandBufferBeginInfo vkCommandBufferBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    tknAssertVkResult(vkBeginCommandBuffer(tknTransfer.vkCommandBuffer, &vkCommandBufferBeginInfo));
+    return tknTransfer;
+}
+
+static uint64_t tknSubmitTransfer(TknGfxContext *pTknGfxContext, TknTransfer tknTransfer)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    tknAssertVkResult(vkEndCommandBuffer(tknTransfer.vkCommandBuffer));
+    VkFenceCreateInfo vkFenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+    };
+    tknAssertVkResult(vkCreateFence(vkDevice, &vkFenceCreateInfo, NULL, &tknTransfer.vkFence));
+    VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &tknTransfer.vkCommandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL,
+    };
+    tknAssertVkResult(vkQueueSubmit(pTknGfxContext->vkTransferQueue, 1, &submitInfo, tknTransfer.vkFence));
+    tknAddToDynamicArray(&pTknGfxContext->tknTransferDynamicArray, &tknTransfer);
+    return tknTransfer.ticket;
+}
+
+static VkBufferMemoryBarrier tknGetBufferOwnershipBarrier(TknGfxContext *pTknGfxContext, VkBuffer vkBuffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask)
+{
+    VkBufferMemoryBarrier vkBufferMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask,
+        .srcQueueFamilyIndex = pTknGfxContext->tknTransferQueueFamilyIndex,
+        .dstQueueFamilyIndex = pTknGfxContext->tknGfxQueueFamilyIndex,
+        .buffer = vkBuffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    };
+    return vkBufferMemoryBarrier;
+}
+
+static VkImageMemoryBarrier tknGetImageOwnershipBarrier(TknGfxContext *pTknGfxContext, TknImage *pTknImage, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask)
+{
+    VkImageMemoryBarrier vkImageMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout = pTknImage->vkImageLayout,
+        .srcQueueFamilyIndex = pTknGfxContext->tknTransferQueueFamilyIndex,
+        .dstQueueFamilyIndex = pTknGfxContext->tknGfxQueueFamilyIndex,
+        .image = pTknImage->vkImage,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+    return vkImageMemoryBarrier;
+}
+
+// Records the acquire half of the ownership transfer on the graphics queue and frees the transfer
+static void tknRetireTransfer(TknGfxContext *pTknGfxContext, TknTransfer *pTknTransfer)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    TknUpload tknUpload = tknBeginUpload(pTknGfxContext, 0);
+    if (pTknTransfer->pTknMesh != NULL)
+    {
+        TknMesh *pTknMesh = pTknTransfer->pTknMesh;
+        VkBufferMemoryBarrier vkBufferMemoryBarriers[2];
+        uint32_t bufferMemoryBarrierCount = 0;
+        if (pTknMesh->tknVertexVkBuffer != VK_NULL_HANDLE)
+        {
+            vkBufferMemoryBarriers[bufferMemoryBarrierCount++] = tknGetBufferOwnershipBarrier(pTknGfxContext, pTknMesh->tknVertexVkBuffer, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+        }
+        if (pTknMesh->tknIndexVkBuffer != VK_NULL_HANDLE)
+        {
+            vkBufferMemoryBarriers[bufferMemoryBarrierCount++] = tknGetBufferOwnershipBarrier(pTknGfxContext, pTknMesh->tknIndexVkBuffer, 0, VK_ACCESS_INDEX_READ_BIT);
+        }
+        vkCmdPipelineBarrier(tknUpload.vkCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0, 0, NULL, bufferMemoryBarrierCount, vkBufferMemoryBarriers, 0, NULL);
+        pTknMesh->tknUploadTicket = 0;
+    }
+    else
+    {
+        TknImage *pTknImage = pTknTransfer->pTknImage;
+        VkImageMemoryBarrier vkImageMemoryBarrier = tknGetImageOwnershipBarrier(pTknGfxContext, pTknImage, 0, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(tknUpload.vkCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, NULL, 0, NULL, 1, &vkImageMemoryBarrier);
+        pTknImage->tknUploadTicket = 0;
+    }
+    tknEndUpload(pTknGfxContext, tknUpload);
+
+    vkDestroyFence(vkDevice, pTknTransfer->vkFence, NULL);
+    vkFreeCommandBuffers(vkDevice, pTknGfxContext->vkTransferCommandPool, 1, &pTknTransfer->vkCommandBuffer);
+    tknDestroyVkBuffer(pTknGfxContext, pTknTransfer->stagingVkBuffer, pTknTransfer->stagingMemoryAllocation);
+}
+
+void tknPopulateTransfers(TknGfxContext *pTknGfxContext)
+{
+    pTknGfxContext->tknTransferDynamicArray = tknCreateDynamicArray(sizeof(TknTransfer), TKN_DEFAULT_COLLECTION_SIZE);
+    pTknGfxContext->tknNextUploadTicket = 1;
+    if (tknHasTransferQueue(pTknGfxContext))
+    {
+        VkCommandPoolCreateInfo vkCommandPoolCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = NULL,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = pTknGfxContext->tknTransferQueueFamilyIndex,
+        };
+        tknAssertVkResult(vkCreateCommandPool(pTknGfxContext->vkDevice, &vkCommandPoolCreateInfo, NULL, &pTknGfxContext->vkTransferCommandPool));
+    }
+    else
+    {
+        pTknGfxContext->vkTransferCommandPool = VK_NULL_HANDLE;
+    }
+}
+
+void tknCleanupTransfers(TknGfxContext *pTknGfxContext)
+{
+    tknRetireTransfers(pTknGfxContext, true);
+    tknDestroyDynamicArray(pTknGfxContext->tknTransferDynamicArray);
+    if (pTknGfxContext->vkTransferCommandPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(pTknGfxContext->vkDevice, pTknGfxContext->vkTransferCommandPool, NULL);
+        pTknGfxContext->vkTransferCommandPool = VK_NULL_HANDLE;
+    }
+    else
+    {
+        // No transfer queue
+    }
+}
+
+// Hands finished transfers over to the graphics queue, with wait every pending transfer is finished first
+void tknRetireTransfers(TknGfxContext *pTknGfxContext, bool wait)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    // Iterate backwards, retired transfers are removed
+    for (uint32_t transferIndex = pTknGfxContext->tknTransferDynamicArray.count; transferIndex > 0; transferIndex--)
+    {
+        TknTransfer *pTknTransfer = tknGetFromDynamicArray(&pTknGfxContext->tknTransferDynamicArray, transferIndex - 1);
+        if (wait)
+        {
+            tknAssertVkResult(vkWaitForFences(vkDevice, 1, &pTknTransfer->vkFence, VK_TRUE, UINT64_MAX));
+        }
+        else
+        {
+            // Poll
+        }
+        VkResult vkResult = vkGetFenceStatus(vkDevice, pTknTransfer->vkFence);
+        if (VK_SUCCESS == vkResult)
+        {
+            tknRetireTransfer(pTknGfxContext, pTknTransfer);
+            tknRemoveAtIndexFromDynamicArray(&pTknGfxContext->tknTransferDynamicArray, transferIndex - 1);
+        }
+        else if (VK_NOT_READY == vkResult)
+        {
+            // Still running
+        }
+        else
+        {
+            tknAssertVkResult(vkResult);
+        }
+    }
+}
+
+uint64_t tknUploadMeshAsync(TknGfxContext *pTknGfxContext, TknVertexInputLayout *pTknVertexInputLayout, void *vertices, uint32_t tknVertexCount, VkIndexType vkIndexType, void *indices, uint32_t tknIndexCount, TknMesh **ppTknMesh)
+{
+    VkDeviceSize vertexSize = tknVertexCount * pTknVertexInputLayout->stride;
+    size_t indexSize = (vkIndexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    VkDeviceSize indexBufferSize = tknIndexCount * indexSize;
+    if (!tknHasTransferQueue(pTknGfxContext) || 0 == vertexSize + indexBufferSize)
+    {
+        // Nothing to overlap with, the staging ring already keeps the upload off the frame's critical path
+        *ppTknMesh = tknCreateMeshPtrWithData(pTknGfxContext, pTknVertexInputLayout, vertices, tknVertexCount, vkIndexType, indices, tknIndexCount);
+        return 0;
+    }
+    else
+    {
+        TknMesh *pTknMesh = tknCreateEmptyMeshPtr(pTknGfxContext, pTknVertexInputLayout, tknVertexCount, vkIndexType, tknIndexCount);
+        TknTransfer tknTransfer = tknBeginTransfer(pTknGfxContext, vertexSize + indexBufferSize);
+        tknTransfer.pTknMesh = pTknMesh;
+        VkBufferMemoryBarrier vkBufferMemoryBarriers[2];
+        uint32_t bufferMemoryBarrierCount = 0;
+        if (pTknMesh->tknVertexVkBuffer != VK_NULL_HANDLE)
+        {
+            memcpy(tknTransfer.stagingMemoryAllocation.mapped, vertices, (size_t)vertexSize);
+            VkBufferCopy vkBufferCopy = {.srcOffset = 0, .dstOffset = 0, .size = vertexSize};
+            vkCmdCopyBuffer(tknTransfer.vkCommandBuffer, tknTransfer.stagingVkBuffer, pTknMesh->tknVertexVkBuffer, 1, &vkBufferCopy);
+            vkBufferMemoryBarriers[bufferMemoryBarrierCount++] = tknGetBufferOwnershipBarrier(pTknGfxContext, pTknMesh->tknVertexVkBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+        }
+        if (pTknMesh->tknIndexVkBuffer != VK_NULL_HANDLE)
+        {
+            memcpy((char *)tknTransfer.stagingMemoryAllocation.mapped + vertexSize, indices, (size_t)indexBufferSize);
+            VkBufferCopy vkBufferCopy = {.srcOffset = vertexSize, .dstOffset = 0, .size = indexBufferSize};
+            vkCmdCopyBuffer(tknTransfer.vkCommandBuffer, tknTransfer.stagingVkBuffer, pTknMesh->tknIndexVkBuffer, 1, &vkBufferCopy);
+            vkBufferMemoryBarriers[bufferMemoryBarrierCount++] = tknGetBufferOwnershipBarrier(pTknGfxContext, pTknMesh->tknIndexVkBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+        }
+        // Release half of the ownership transfer, tknRetireTransfer records the acquire half
+        vkCmdPipelineBarrier(tknTransfer.vkCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, NULL, bufferMemoryBarrierCount, vkBufferMemoryBarriers, 0, NULL);
+        pTknMesh->tknUploadTicket = tknTransfer.ticket;
+        *ppTknMesh = pTknMesh;
+        return tknSubmitTransfer(pTknGfxContext, tknTransfer);
+    }
+}
+
+uint64_t tknUploadImageAsync(TknGfxContext *pTknGfxContext, VkExtent3D vkExtent3D, VkFormat vkFormat, VkImageUsageFlags vkImageUsageFlags, VkImageAspectFlags vkImageAspectFlags, void *data, VkDeviceSize dataSize, TknImage **ppTknImage)
+{
+    if (!tknHasTransferQueue(pTknGfxContext) || NULL == data || 0 == dataSize)
+    {
+        *ppTknImage = tknCreateImagePtr(pTknGfxContext, vkExtent3D, vkFormat, VK_IMAGE_TILING_OPTIMAL, vkImageUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vkImageAspectFlags, data, dataSize);
+        return 0;
+    }
+    else
+    {
+        TknImage *pTknImage = tknMalloc(sizeof(TknImage));
+        *pTknImage = (TknImage){
+            .vkImage = VK_NULL_HANDLE,
+            .tknMemoryAllocation = {0},
+            .vkImageView = VK_NULL_HANDLE,
+            .vkImageLayout = tknGetImageLayout(vkImageUsageFlags),
+            .tknBindingPtrHashSet = tknCreateHashSet(sizeof(TknBinding *)),
+            .tknUploadTicket = 0,
+        };
+        tknCreateVkImage(pTknGfxContext, vkExtent3D, vkFormat, VK_IMAGE_TILING_OPTIMAL, vkImageUsageFlags | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vkImageAspectFlags, TKN_MEMORY_USAGE_IMAGE, &pTknImage->vkImage, &pTknImage->tknMemoryAllocation, &pTknImage->vkImageView);
+
+        TknTransfer tknTransfer = tknBeginTransfer(pTknGfxContext, dataSize);
+        tknTransfer.pTknImage = pTknImage;
+        memcpy(tknTransfer.stagingMemoryAllocation.mapped, data, (size_t)dataSize);
+
+        VkImageMemoryBarrier vkImageMemoryBarrier = tknGetImageOwnershipBarrier(pTknGfxContext, pTknImage, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkImageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        vkImageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        vkImageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vkImageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vkCmdPipelineBarrier(tknTransfer.vkCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, NULL, 0, NULL, 1, &vkImageMemoryBarrier);
+
+        VkBufferImageCopy region = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {vkExtent3D.width, vkExtent3D.height, 1},
+        };
+        vkCmdCopyBufferToImage(tknTransfer.vkCommandBuffer, tknTransfer.stagingVkBuffer, pTknImage->vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        // Release half of the ownership transfer, the layout change to the shader layout is part of it
+        vkImageMemoryBarrier = tknGetImageOwnershipBarrier(pTknGfxContext, pTknImage, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+        vkCmdPipelineBarrier(tknTransfer.vkCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, NULL, 0, NULL, 1, &vkImageMemoryBarrier);
+        pTknImage->tknUploadTicket = tknTransfer.ticket;
+        *ppTknImage = pTknImage;
+        return tknSubmitTransfer(pTknGfxContext, tknTransfer);
+    }
+}
+
+bool tknIsUploadComplete(TknGfxContext *pTknGfxContext, uint64_t ticket)
+{
+    tknRetireTransfers(pTknGfxContext, false);
+    for (uint32_t transferIndex = 0; transferIndex < pTknGfxContext->tknTransferDynamicArray.count; transferIndex++)
+    {
+        TknTransfer *pTknTransfer = tknGetFromDynamicArray(&pTknGfxContext->tknTransferDynamicArray, transferIndex);
+        if (ticket == pTknTransfer->ticket)
+        {
+            return false;
+        }
+        else
+        {
+            // Skip
+        }
+    }
+    return true;
+}
+
+void tknWaitUpload(TknGfxContext *pTknGfxContext, uint64_t ticket)
+{
+    VkDevice vkDevice = pTknGfxContext->vkDevice;
+    for (uint32_t transferIndex = 0; transferIndex < pTknGfxContext->tknTransferDynamicArray.count; transferIndex++)
+    {
+        TknTransfer *pTknTransfer = tknGetFromDynamicArray(&pTknGfxContext->tknTransferDynamicArray, transferIndex);
+        if (ticket == pTknTransfer->ticket)
+        {
+            tknAssertVkResult(vkWaitForFences(vkDevice, 1, &pTknTransfer->vkFence, VK_TRUE, UINT64_MAX));
+            tknRetireTransfers(pTknGfxContext, false);
+            return;
+        }
+        else
+        {
+            // Skip
+        }
+    }
+}
@@ -4,41 +4,105 @@ TknUniformBuffer *tknCreateUniformBufferPtr(TknGfxContext *pTknGfxContext, const
 {
     TknUniformBuffer *pTknUniformBuffer = tknMalloc(sizeof(TknUniformBuffer));
     VkBuffer vkBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory vkDeviceMemory = VK_NULL_HANDLE;
-    void *mapped = NULL;
+    TknMemoryAllocation tknMemoryAllocation;
     TknHashSet tknBindingPtrHashSet = tknCreateHashSet(sizeof(TknBinding *));
 
-    tknCreateVkBuffer(pTknGfxContext, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &vkBuffer, &vkDeviceMemory);
-    VkDevice vkDevice = pTknGfxContext->vkDevice;
-    tknAssertVkResult(vkMapMemory(vkDevice, vkDeviceMemory, 0, size, 0, &mapped));
+    // Every frame in flight gets its own copy, aligned so each one can be bound by offset
+    VkDeviceSize alignment = pTknGfxContext->vkPhysicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
+    VkDeviceSize frameStride = alignment > 0 ? (size + alignment - 1) / alignment * alignment : size;
+    VkDeviceSize bufferSize = frameStride * pTknGfxContext->tknFrameInFlightCount;
+    tknCreateVkBuffer(pTknGfxContext, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, TKN_MEMORY_USAGE_UNIFORM_BUFFER, &vkBuffer, &tknMemoryAllocation);
 
     *pTknUniformBuffer = (TknUniformBuffer){
         .vkBuffer = vkBuffer,
-        .vkDeviceMemory = vkDeviceMemory,
-        .mapped = mapped,
+        .tknMemoryAllocation = tknMemoryAllocation,
+        .mapped = tknMemoryAllocation.mapped,
         .tknBindingPtrHashSet = tknBindingPtrHashSet,
         .size = size,
+        .frameStride = frameStride,
+        .data = tknMalloc(size),
+        .dirtyFrameMask = 0,
+        .dirtyOffset = 0,
+        .dirtyEnd = 0,
     };
 
-    memcpy(pTknUniformBuffer->mapped, data, size);
+    memcpy(pTknUniformBuffer->data, data, size);
+    // No frame can be using a new buffer yet, so every copy is written directly
+    for (uint32_t frameIndex = 0; frameIndex < pTknGfxContext->tknFrameInFlightCount; frameIndex++)
+    {
+        memcpy((char *)pTknUniformBuffer->mapped + frameIndex * frameStride, data, size);
+    }
     return pTknUniformBuffer;
 }
 void tknDestroyUniformBufferPtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer)
 {
-    tknClearBindingPtrHashSet(pTknGfxContext, pTknUniformBuffer->tknBindingPtrHashSet);
+    tknClearBindingPtrHashSet(pTknGfxContext, &pTknUniformBuffer->tknBindingPtrHashSet);
     tknDestroyHashSet(pTknUniformBuffer->tknBindingPtrHashSet);
-    if (pTknUniformBuffer->mapped != NULL)
+    if (pTknUniformBuffer->dirtyFrameMask != 0)
     {
-        vkUnmapMemory(pTknGfxContext->vkDevice, pTknUniformBuffer->vkDeviceMemory);
+        tknRemoveFromHashSet(&pTknGfxContext->tknDirtyUniformBufferPtrHashSet, &pTknUniformBuffer);
     }
-    tknDestroyVkBuffer(pTknGfxContext, pTknUniformBuffer->vkBuffer, pTknUniformBuffer->vkDeviceMemory);
+    else
+    {
+        // Skip
+    }
+    // Frames in flight may still read the buffer through their descriptor sets
+    tknRetireVkBuffer(pTknGfxContext, pTknUniformBuffer->vkBuffer, pTknUniformBuffer->tknMemoryAllocation);
     pTknUniformBuffer->vkBuffer = VK_NULL_HANDLE;
-    pTknUniformBuffer->vkDeviceMemory = VK_NULL_HANDLE;
+    pTknUniformBuffer->mapped = NULL;
+    tknFree(pTknUniformBuffer->data);
     tknFree(pTknUniformBuffer);
 }
+static void tknMarkUniformBufferDirty(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, VkDeviceSize offset, VkDeviceSize end)
+{
+    if (0 == pTknUniformBuffer->dirtyFrameMask)
+    {
+        tknAddToHashSet(&pTknGfxContext->tknDirtyUniformBufferPtrHashSet, &pTknUniformBuffer);
+        pTknUniformBuffer->dirtyOffset = offset;
+        pTknUniformBuffer->dirtyEnd = end;
+    }
+    else
+    {
+        // Some frames have not seen the earlier writes yet, keep them in the range
+        pTknUniformBuffer->dirtyOffset = offset < pTknUniformBuffer->dirtyOffset ? offset : pTknUniformBuffer->dirtyOffset;
+        pTknUniformBuffer->dirtyEnd = end > pTknUniformBuffer->dirtyEnd ? end : pTknUniformBuffer->dirtyEnd;
+    }
+    pTknUniformBuffer->dirtyFrameMask = tknGetAllFramesMask(pTknGfxContext);
+}
 void tknUpdateUniformBufferPtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, const void *data, VkDeviceSize size)
 {
     tknAssert(pTknUniformBuffer->mapped != NULL, "Uniform buffer is not mapped!");
     tknAssert(size <= pTknUniformBuffer->size, "Data size exceeds mapped buffer size!");
-    memcpy(pTknUniformBuffer->mapped, data, size);
+    // The copies are written when their frames are acquired, frames still in flight keep reading their old data
+    memcpy(pTknUniformBuffer->data, data, size);
+    tknMarkUniformBufferDirty(pTknGfxContext, pTknUniformBuffer, 0, size);
+}
+void *tknWriteUniformBufferRangePtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, VkDeviceSize offset, VkDeviceSize size)
+{
+    // Compared without adding, so a huge offset cannot wrap back into range
+    tknAssert(offset <= pTknUniformBuffer->size && size <= pTknUniformBuffer->size - offset, "Range [%llu, %llu) exceeds uniform buffer size %llu", (unsigned long long)offset, (unsigned long long)(offset + size), (unsigned long long)pTknUniformBuffer->size);
+    tknMarkUniformBufferDirty(pTknGfxContext, pTknUniformBuffer, offset, offset + size);
+    return (char *)pTknUniformBuffer->data + offset;
+}
+void tknFlushUniformBufferPtr(TknGfxContext *pTknGfxContext, TknUniformBuffer *pTknUniformBuffer, uint32_t frameIndex)
+{
+    uint32_t frameMask = 1u << frameIndex;
+    if (pTknUniformBuffer->dirtyFrameMask & frameMask)
+    {
+        VkDeviceSize dirtyOffset = pTknUniformBuffer->dirtyOffset;
+        memcpy((char *)pTknUniformBuffer->mapped + frameIndex * pTknUniformBuffer->frameStride + dirtyOffset, (char *)pTknUniformBuffer->data + dirtyOffset, pTknUniformBuffer->dirtyEnd - dirtyOffset);
+        pTknUniformBuffer->dirtyFrameMask &= ~frameMask;
+        if (0 == pTknUniformBuffer->dirtyFrameMask)
+        {
+            tknRemoveFromHashSet(&pTknGfxContext->tknDirtyUniformBufferPtrHashSet, &pTknUniformBuffer);
+        }
+        else
+        {
+            // Other frames still need this data
+        }
+    }
+    else
+    {
+        // Skip
+    }
 }
@@ -0,0 +1,179 @@
+#include "tknGfxCore.h"
+
+static VkDeviceSize tknGetStagingAlignment(TknGfxContext *pTknGfxContext)
+{
+    // Buffer to image copies need offsets aligned to 4 bytes and to the texel block size, 16 covers every compressed format
+    VkDeviceSize alignment = pTknGfxContext->vkPhysicalDeviceProperties.limits.optimalBufferCopyOffsetAlignment;
+    return alignment > 16 ? alignment : 16;
+}
+
+static void tknBeginUploadCommandBuffer(TknGfxContext *pTknGfxContext)
+{
+    // The slice of this frame is free once the frame's previous submission is done
+    tknWaitGfxRenderFence(pTknGfxContext);
+    pTknGfxContext->tknStagingOffset = 0;
+
+    VkCommandBuffer vkCommandBuffer = pTknGfxContext->vkUploadCommandBuffers[pTknGfxContext->tknFrameIndex];
+    VkCommandBufferBeginInfo vkCommandBufferBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    tknAssertVkResult(vkBeginCommandBuffer(vkCommandBuffer, &vkCommandBufferBeginInfo));
+    // Buffers updated in place may still be read by the frames submitted before
+    vkCmdPipelineBarrier(vkCommandBuffer,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, NULL, 0, NULL, 0, NULL);
+    pTknGfxContext->isUploadRecording = true;
+}
+
+void tknPopulateStagingRing(TknGfxContext *pTknGfxContext)
+{
+    pTknGfxContext->tknStagingSliceSize = TKN_DEFAULT_STAGING_SLICE_SIZE;
+    pTknGfxContext->tknStagingOffset = 0;
+    pTknGfxContext->isUploadRecording = false;
+    tknCreateVkBuffer(pTknGfxContext, pTknGfxContext->tknStagingSliceSize * pTknGfxContext->tknFrameInFlightCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      TKN_MEMORY_USAGE_STAGING, &pTknGfxContext->tknStagingVkBuffer, &pTknGfxContext->tknStagingMemoryAllocation);
+
+    VkCommandBufferAllocateInfo vkCommandBufferAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pTknGfxContext->vkGfxCommandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = pTknGfxContext->tknFrameInFlightCount,
+    };
+    tknAssertVkResult(vkAllocateCommandBuffers(pTknGfxContext->vkDevice, &vkCommandBufferAllocateInfo, pTknGfxContext->vkUploadCommandBuffers));
+}
+
+void tknCleanupStagingRing(TknGfxContext *pTknGfxContext)
+{
+    tknFlushUploads(pTknGfxContext);
+    vkFreeCommandBuffers(pTknGfxContext->vkDevice, pTknGfxContext->vkGfxCommandPool, pTknGfxContext->tknFrameInFlightCount, pTknGfxContext->vkUploadCommandBuffers);
+    tknDestroyVkBuffer(pTknGfxContext, pTknGfxContext->tknStagingVkBuffer, pTknGfxContext->tknStagingMemoryAllocation);
+    pTknGfxContext->tknStagingVkBuffer = VK_NULL_HANDLE;
+}
+
+// Reserves size bytes of mapped staging memory, copies recorded into vkCommandBuffer run right before the current frame's graphics work
+TknUpload tknBeginUpload(TknGfxContext *pTknGfxContext, VkDeviceSize size)
+{
+    if (size > pTknGfxContext->tknStagingSliceSize)
+    {
+        // Too large for the ring, fall back to a temporary staging buffer and a blocking submission after the pending uploads
+        tknFlushUploads(pTknGfxContext);
+        TknUpload tknUpload = {
+            .vkCommandBuffer = tknBeginSingleTimeCommands(pTknGfxContext),
+            .vkBuffer = VK_NULL_HANDLE,
+            .offset = 0,
+            .mapped = NULL,
+            .isSingleTime = true,
+            .tknMemoryAllocation = {0},
+        };
+        tknCreateVkBuffer(pTknGfxContext, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          TKN_MEMORY_USAGE_STAGING, &tknUpload.vkBuffer, &tknUpload.tknMemoryAllocation);
+        tknUpload.mapped = tknUpload.tknMemoryAllocation.mapped;
+        return tknUpload;
+    }
+    else
+    {
+        if (pTknGfxContext->isUploadRecording)
+        {
+            VkDeviceSize alignment = tknGetStagingAlignment(pTknGfxContext);
+            VkDeviceSize alignedOffset = (pTknGfxContext->tknStagingOffset + alignment - 1) / alignment * alignment;
+            if (alignedOffset + size > pTknGfxContext->tknStagingSliceSize)
+            {
+                // The slice is full, drain it and start over
+                tknFlushUploads(pTknGfxContext);
+                tknBeginUploadCommandBuffer(pTknGfxContext);
+            }
+            else
+            {
+                pTknGfxContext->tknStagingOffset = alignedOffset;
+            }
+        }
+        else
+        {
+            tknBeginUploadCommandBuffer(pTknGfxContext);
+        }
+        VkDeviceSize offset = pTknGfxContext->tknFrameIndex * pTknGfxContext->tknStagingSliceSize + pTknGfxContext->tknStagingOffset;
+        pTknGfxContext->tknStagingOffset += size;
+        TknUpload tknUpload = {
+            .vkCommandBuffer = pTknGfxContext->vkUploadCommandBuffers[pTknGfxContext->tknFrameIndex],
+            .vkBuffer = pTknGfxContext->tknStagingVkBuffer,
+            .offset = offset,
+            .mapped = (char *)pTknGfxContext->tknStagingMemoryAllocation.mapped + offset,
+            .isSingleTime = false,
+            .tknMemoryAllocation = {0},
+        };
+        return tknUpload;
+    }
+}
+
+void tknEndUpload(TknGfxContext *pTknGfxContext, TknUpload tknUpload)
+{
+    if (tknUpload.isSingleTime)
+    {
+        tknEndSingleTimeCommands(pTknGfxContext, tknUpload.vkCommandBuffer);
+        tknDestroyVkBuffer(pTknGfxContext, tknUpload.vkBuffer, tknUpload.tknMemoryAllocation);
+    }
+    else
+    {
+        // Submitted with the frame
+    }
+}
+
+// Ends the pending uploads of the current frame and returns their command buffer, or NULL if nothing was uploaded
+VkCommandBuffer tknEndUploadCommandBuffer(TknGfxContext *pTknGfxContext)
+{
+    if (pTknGfxContext->isUploadRecording)
+    {
+        VkCommandBuffer vkCommandBuffer = pTknGfxContext->vkUploadCommandBuffers[pTknGfxContext->tknFrameIndex];
+        VkMemoryBarrier vkMemoryBarrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            // Storage buffers may next be written by compute or read as indirect commands
+            .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        };
+        vkCmdPipelineBarrier(vkCommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &vkMemoryBarrier, 0, NULL, 0, NULL);
+        tknAssertVkResult(vkEndCommandBuffer(vkCommandBuffer));
+        pTknGfxContext->isUploadRecording = false;
+        return vkCommandBuffer;
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+// Submits the pending uploads on their own and waits for them, needed before anything they reference is destroyed
+void tknFlushUploads(TknGfxContext *pTknGfxContext)
+{
+    VkCommandBuffer vkCommandBuffer = tknEndUploadCommandBuffer(pTknGfxContext);
+    if (vkCommandBuffer != NULL)
+    {
+        VkSubmitInfo submitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = NULL,
+            .waitSemaphoreCount = 0,
+            .pWaitSemaphores = NULL,
+            .pWaitDstStageMask = NULL,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &vkCommandBuffer,
+            .signalSemaphoreCount = 0,
+            .pSignalSemaphores = NULL,
+        };
+        tknAssertVkResult(vkQueueSubmit(pTknGfxContext->vkGfxQueue, 1, &submitInfo, VK_NULL_HANDLE));
+        tknAssertVkResult(vkQueueWaitIdle(pTknGfxContext->vkGfxQueue));
+    }
+    else
+    {
+        // Nothing pending
+    }
+}
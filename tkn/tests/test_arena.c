@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <string.h>
+#include "tknCore.h"
+
+static void test_arena_alignment_and_rewind()
+{
+    printf("--- arena alignment and rewind test ---\n");
+    TknArena tknArena = tknCreateArena(256);
+    char *a = tknAllocateFromArena(&tknArena, 3);
+    char *b = tknAllocateFromArena(&tknArena, 5);
+    tknAssert(((uintptr_t)b - (uintptr_t)tknArena.data) % TKN_ARENA_ALIGNMENT == 0, "Allocation is not aligned");
+    tknAssert(b > a, "Allocations overlap");
+    size_t marker = tknArena.offset;
+    tknAllocateFromArena(&tknArena, 64);
+    tknRewindArena(&tknArena, marker);
+    tknAssert(tknArena.offset == marker, "Rewind did not restore offset");
+    tknResetArena(&tknArena);
+    tknAssert(tknArena.offset == 0, "Reset did not clear offset");
+    tknDestroyArena(tknArena);
+    printf("Alignment and rewind passed\n");
+}
+
+static void test_arena_overflow_grows()
+{
+    printf("--- arena overflow test ---\n");
+    TknArena tknArena = tknCreateArena(128);
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        char *data = tknAllocateFromArena(&tknArena, 100);
+        memset(data, (int)i, 100);
+    }
+    tknAssert(tknArena.pOverflowBlock != NULL, "Overflow should fall back to heap blocks");
+    tknResetArena(&tknArena);
+    tknAssert(tknArena.capacity >= 16 * 100, "Arena did not grow to cover overflow, capacity=%zu", tknArena.capacity);
+
+    uint64_t mallocCount = tknGetMallocCount();
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            tknAllocateFromArena(&tknArena, 100);
+        }
+        tknResetArena(&tknArena);
+    }
+    tknAssert(tknGetMallocCount() == mallocCount, "Steady state frames should not hit the heap");
+    tknDestroyArena(tknArena);
+    printf("Overflow passed, capacity=%zu\n", tknArena.capacity);
+}
+
+static void test_scratch()
+{
+    printf("--- scratch test ---\n");
+    size_t outerMarker = tknGetScratchMarker();
+    uint32_t *outer = tknAllocateScratch(sizeof(uint32_t) * 4);
+    outer[0] = 42;
+    size_t innerMarker = tknGetScratchMarker();
+    tknAllocateScratch(1024);
+    tknRewindScratch(innerMarker);
+    tknAssert(outer[0] == 42, "Inner scratch clobbered outer data");
+    tknRewindScratch(outerMarker);
+    tknAssert(tknGetScratchMarker() == outerMarker, "Scratch marker mismatch");
+    tknDestroyScratchArena();
+    printf("Scratch passed\n");
+}
+
+int main()
+{
+    test_arena_alignment_and_rewind();
+    test_arena_overflow_grows();
+    test_scratch();
+    return 0;
+}
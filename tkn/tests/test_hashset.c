@@ -22,15 +22,10 @@ static void test_struct_hashset()
     printf("Contains b? %d\n", tknContainsInHashSet(&set, &b));
     printf("Contains c? %d\n", tknContainsInHashSet(&set, &c));
     printf("Iterate through struct hashset:\n");
-    for (size_t i = 0; i < set.capacity; i++)
+    for (uint32_t i = 0; i < set.count; i++)
     {
-        TknListNode *node = set.nodePtrs[i];
-        while (node)
-        {
-            MyStruct *data = (MyStruct *)node->data;
-            printf("id=%d, value=%f\n", data->id, data->value);
-            node = node->pNextNode;
-        }
+        MyStruct *data = (MyStruct *)tknGetFromHashSet(&set, i);
+        printf("id=%d, value=%f\n", data->id, data->value);
     }
     tknDestroyHashSet(set);
 }
@@ -48,22 +43,58 @@ static void test_pointer_hashset()
     printf("Contains py:%p? %d\n", py, tknContainsInHashSet(&set, &py));
     printf("Contains pz:%p? %d\n", pz, tknContainsInHashSet(&set, &pz));
     printf("Iterate through pointer hashset:\n");
-    for (size_t i = 0; i < set.capacity; i++)
+    for (uint32_t i = 0; i < set.count; i++)
     {
-        TknListNode *node = set.nodePtrs[i];
-        while (node)
-        {
-            void *ptr = *(void **)node->data;
-            printf("ptr=%p, *ptr=%d\n", ptr, *(int *)ptr);
-            node = node->pNextNode;
-        }
+        void *ptr = *(void **)tknGetFromHashSet(&set, i);
+        printf("ptr=%p, *ptr=%d\n", ptr, *(int *)ptr);
     }
     tknDestroyHashSet(set);
 }
 
+static void test_grow_and_remove_hashset()
+{
+    printf("--- grow and remove hashset test ---\n");
+    TknHashSet set = tknCreateHashSet(sizeof(uint64_t));
+    const uint64_t keyCount = 10000;
+    for (uint64_t key = 0; key < keyCount; key++)
+    {
+        uint64_t value = key * 64;
+        tknAssert(tknAddToHashSet(&set, &value), "Failed to add key %llu", (unsigned long long)key);
+        tknAssert(!tknAddToHashSet(&set, &value), "Duplicated key %llu was added", (unsigned long long)key);
+    }
+    tknAssert(set.count == keyCount, "Count %u does not match key count", set.count);
+    for (uint64_t key = 0; key < keyCount; key += 2)
+    {
+        uint64_t value = key * 64;
+        tknRemoveFromHashSet(&set, &value);
+    }
+    tknAssert(set.count == keyCount / 2, "Count %u does not match half key count", set.count);
+    for (uint64_t key = 0; key < keyCount; key++)
+    {
+        uint64_t value = key * 64;
+        tknAssert(tknContainsInHashSet(&set, &value) == (key % 2 == 1), "Contains mismatch for key %llu", (unsigned long long)key);
+    }
+    for (uint32_t i = 0; i < set.count; i++)
+    {
+        uint64_t value = *(uint64_t *)tknGetFromHashSet(&set, i);
+        tknAssert(value / 64 % 2 == 1, "Removed key %llu is still iterated", (unsigned long long)(value / 64));
+        tknAssert(tknGetIndexInHashSet(&set, &value) == i, "Key %llu is not found at its dense index %u", (unsigned long long)(value / 64), i);
+    }
+    uint64_t removedValue = 0;
+    tknAssert(tknGetIndexInHashSet(&set, &removedValue) == UINT32_MAX, "Removed key 0 still has an index");
+    for (uint32_t i = set.count; i > 0; i--)
+    {
+        tknRemoveFromHashSet(&set, tknGetFromHashSet(&set, i - 1));
+    }
+    tknAssert(set.count == 0, "Count %u is not 0 after removing all keys", set.count);
+    printf("Grow and remove passed, capacity=%u\n", set.capacity);
+    tknDestroyHashSet(set);
+}
+
 int main()
 {
     test_struct_hashset();
     test_pointer_hashset();
+    test_grow_and_remove_hashset();
     return 0;
 }
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tknCore.h"
+
+#define TEST_TASK_COUNT 256
+#define TEST_WORKER_THREAD_COUNT 3
+#define TEST_TRACE_NAME "test_profiler_trace.json"
+
+static char tracePath[1024];
+
+static void test_profiler_task(void *pContext, uint32_t taskIndex, uint32_t workerIndex)
+{
+    TKN_PROFILE_SCOPE("task")
+    {
+        tknBeginProfileScope("nested");
+        tknEndProfileScope();
+    }
+}
+
+static uint32_t countOccurrences(const char *text, const char *pattern)
+{
+    uint32_t count = 0;
+    for (const char *match = strstr(text, pattern); match != NULL; match = strstr(match + 1, pattern))
+    {
+        count++;
+    }
+    return count;
+}
+
+// The trace goes to the temp directory so test runs leave nothing in the working directory
+static void setupTracePath(void)
+{
+    const char *directory = getenv("TMPDIR");
+    if (NULL == directory)
+    {
+        directory = getenv("TEMP");
+    }
+    if (NULL == directory)
+    {
+        directory = "/tmp";
+    }
+    snprintf(tracePath, sizeof(tracePath), "%s/%s", directory, TEST_TRACE_NAME);
+    remove(tracePath);
+}
+
+static char *readTrace(void)
+{
+    FILE *file = fopen(tracePath, "rb");
+    tknAssert(file != NULL, "Trace was not written");
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = tknMalloc((size_t)fileSize + 1);
+    size_t bytesRead = fread(text, 1, (size_t)fileSize, file);
+    text[bytesRead] = '\0';
+    fclose(file);
+    return text;
+}
+
+static void test_profiler_threads()
+{
+    printf("--- profiler threads test ---\n");
+    TknWorkerPool *pTknWorkerPool = tknCreateWorkerPoolPtr(TEST_WORKER_THREAD_COUNT);
+    // Disabled scopes leave nothing behind
+    tknRunOnWorkerPool(pTknWorkerPool, TEST_TASK_COUNT, test_profiler_task, NULL);
+    tknSetProfilerEnabled(true);
+    tknRunOnWorkerPool(pTknWorkerPool, TEST_TASK_COUNT, test_profiler_task, NULL);
+    tknSetProfilerEnabled(false);
+    tknAssert(tknWriteProfileTrace(tracePath), "Failed to write trace");
+    tknDestroyWorkerPoolPtr(pTknWorkerPool);
+
+    char *text = readTrace();
+    tknAssert(0 == strncmp(text, "{\"traceEvents\":[", 16), "Trace does not start with traceEvents");
+    uint32_t beginCount = countOccurrences(text, "\"ph\":\"B\"");
+    uint32_t endCount = countOccurrences(text, "\"ph\":\"E\"");
+    tknAssert(beginCount == TEST_TASK_COUNT * 2, "Expected %u begins, got %u", TEST_TASK_COUNT * 2, beginCount);
+    tknAssert(endCount == beginCount, "Begins %u and ends %u do not pair", beginCount, endCount);
+    tknAssert(countOccurrences(text, "\"name\":\"task\"") == TEST_TASK_COUNT, "Task scopes missing");
+    tknFree(text);
+    tknDestroyProfiler();
+    remove(tracePath);
+    printf("Threads passed\n");
+}
+
+static void test_profiler_wraparound()
+{
+    printf("--- profiler wraparound test ---\n");
+    tknSetProfilerEnabled(true);
+    // The outer begin is overwritten, its end must not show up unmatched
+    tknBeginProfileScope("outer \"quoted\"");
+    for (uint32_t i = 0; i < TKN_PROFILE_EVENT_CAPACITY; i++)
+    {
+        tknBeginProfileScope("inner");
+        tknEndProfileScope();
+    }
+    tknEndProfileScope();
+    tknAssert(tknWriteProfileTrace(tracePath), "Failed to write trace");
+
+    char *text = readTrace();
+    uint32_t beginCount = countOccurrences(text, "\"ph\":\"B\"");
+    uint32_t endCount = countOccurrences(text, "\"ph\":\"E\"");
+    tknAssert(beginCount == endCount, "Begins %u and ends %u do not pair after wrapping", beginCount, endCount);
+    tknAssert(beginCount + endCount <= TKN_PROFILE_EVENT_CAPACITY, "More events than the ring holds");
+    tknAssert(NULL == strstr(text, "outer"), "Overwritten scope is still in the trace");
+    tknFree(text);
+    tknDestroyProfiler();
+    remove(tracePath);
+    printf("Wraparound passed\n");
+}
+
+int main()
+{
+    setupTracePath();
+    test_profiler_threads();
+    test_profiler_wraparound();
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <string.h>
+#include "tknCore.h"
+
+static uint64_t nextRandom(uint64_t *pState)
+{
+    *pState ^= *pState << 13;
+    *pState ^= *pState >> 7;
+    *pState ^= *pState << 17;
+    return *pState;
+}
+
+static void test_radix_sort_random()
+{
+    printf("--- radix sort random test ---\n");
+    uint32_t count = 10000;
+    TknSortItem *tknSortItems = tknMalloc(sizeof(TknSortItem) * count);
+    TknSortItem *scratchSortItems = tknMalloc(sizeof(TknSortItem) * count);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        tknSortItems[i] = (TknSortItem){.key = nextRandom(&state), .index = i};
+    }
+    tknRadixSort(tknSortItems, scratchSortItems, count);
+    for (uint32_t i = 1; i < count; i++)
+    {
+        tknAssert(tknSortItems[i - 1].key <= tknSortItems[i].key, "Keys out of order at %u", i);
+    }
+    tknFree(scratchSortItems);
+    tknFree(tknSortItems);
+    printf("Random keys passed\n");
+}
+
+static void test_radix_sort_stable()
+{
+    printf("--- radix sort stability test ---\n");
+    uint32_t count = 4096;
+    TknSortItem *tknSortItems = tknMalloc(sizeof(TknSortItem) * count);
+    TknSortItem *scratchSortItems = tknMalloc(sizeof(TknSortItem) * count);
+    // Few distinct keys spread over the high and low bytes, equal keys must keep their push order
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t bucket = (i * 7) % 5;
+        tknSortItems[i] = (TknSortItem){.key = (bucket << 56) | (bucket & 1), .index = i};
+    }
+    tknRadixSort(tknSortItems, scratchSortItems, count);
+    for (uint32_t i = 1; i < count; i++)
+    {
+        tknAssert(tknSortItems[i - 1].key <= tknSortItems[i].key, "Keys out of order at %u", i);
+        if (tknSortItems[i - 1].key == tknSortItems[i].key)
+        {
+            tknAssert(tknSortItems[i - 1].index < tknSortItems[i].index, "Equal keys reordered at %u", i);
+        }
+    }
+
+    // Sorted input and a single item stay as they are
+    tknRadixSort(tknSortItems, scratchSortItems, count);
+    tknAssert(tknSortItems[0].key == 0 && tknSortItems[count - 1].key == (4ull << 56), "Sorted input changed");
+    tknRadixSort(tknSortItems, scratchSortItems, 1);
+    tknRadixSort(tknSortItems, scratchSortItems, 0);
+    tknFree(scratchSortItems);
+    tknFree(tknSortItems);
+    printf("Stability passed\n");
+}
+
+int main()
+{
+    test_radix_sort_random();
+    test_radix_sort_stable();
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include "tknCore.h"
+
+static void test_tlsf_alignment_and_merge()
+{
+    printf("--- tlsf alignment and merge test ---\n");
+    TknTlsf tknTlsf = tknCreateTlsf(4096);
+    uint64_t offsetA, offsetB, offsetC;
+    uint32_t nodeA = tknAllocateFromTlsf(&tknTlsf, 3, 1, &offsetA);
+    uint32_t nodeB = tknAllocateFromTlsf(&tknTlsf, 100, 256, &offsetB);
+    uint32_t nodeC = tknAllocateFromTlsf(&tknTlsf, 64, 64, &offsetC);
+    tknAssert(nodeA != TKN_TLSF_NULL_NODE && nodeB != TKN_TLSF_NULL_NODE && nodeC != TKN_TLSF_NULL_NODE, "Allocation failed");
+    tknAssert(0 == offsetB % 256, "Offset %llu is not aligned to 256", (unsigned long long)offsetB);
+    tknAssert(0 == offsetC % 64, "Offset %llu is not aligned to 64", (unsigned long long)offsetC);
+    tknAssert(offsetA + 3 <= offsetB || offsetB + 100 <= offsetA, "Allocations overlap");
+    tknAssert(tknTlsf.freeSize == 4096 - 3 - 100 - 64, "Free size mismatch: %llu", (unsigned long long)tknTlsf.freeSize);
+
+    tknFreeToTlsf(&tknTlsf, nodeB);
+    tknFreeToTlsf(&tknTlsf, nodeA);
+    tknFreeToTlsf(&tknTlsf, nodeC);
+    tknAssert(0 == tknTlsf.allocationCount, "Allocations left after freeing everything");
+    tknAssert(tknGetTlsfLargestFreeSize(&tknTlsf) == 4096, "Free nodes did not merge back into one range");
+
+    uint64_t offsetFull;
+    uint32_t nodeFull = tknAllocateFromTlsf(&tknTlsf, 4096, 1, &offsetFull);
+    tknAssert(nodeFull != TKN_TLSF_NULL_NODE && 0 == offsetFull, "Whole range should be allocatable after merge");
+    uint64_t offsetNone;
+    tknAssert(TKN_TLSF_NULL_NODE == tknAllocateFromTlsf(&tknTlsf, 1, 1, &offsetNone), "Full allocator should fail");
+    tknFreeToTlsf(&tknTlsf, nodeFull);
+    tknDestroyTlsf(tknTlsf);
+    printf("Alignment and merge passed\n");
+}
+
+static void test_tlsf_random()
+{
+    printf("--- tlsf random test ---\n");
+    const uint64_t size = 1 << 20;
+    const uint32_t slotCount = 256;
+    TknTlsf tknTlsf = tknCreateTlsf(size);
+    uint32_t nodeIndices[256];
+    uint64_t offsets[256];
+    uint64_t sizes[256];
+    unsigned char *owners = tknMalloc(size);
+    memset(owners, 0xFF, size);
+    for (uint32_t slotIndex = 0; slotIndex < slotCount; slotIndex++)
+    {
+        nodeIndices[slotIndex] = TKN_TLSF_NULL_NODE;
+    }
+
+    uint32_t seed = 12345;
+    uint32_t failedCount = 0;
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t slotIndex = (seed >> 8) % slotCount;
+        if (TKN_TLSF_NULL_NODE == nodeIndices[slotIndex])
+        {
+            seed = seed * 1664525u + 1013904223u;
+            uint64_t allocationSize = 1 + (seed >> 8) % 16384;
+            uint64_t alignment = 1ull << ((seed >> 4) % 9);
+            uint64_t offset;
+            uint32_t nodeIndex = tknAllocateFromTlsf(&tknTlsf, allocationSize, alignment, &offset);
+            if (TKN_TLSF_NULL_NODE == nodeIndex)
+            {
+                failedCount++;
+                continue;
+            }
+            tknAssert(0 == offset % alignment, "Offset %llu is not aligned to %llu", (unsigned long long)offset, (unsigned long long)alignment);
+            tknAssert(offset + allocationSize <= size, "Allocation is out of range");
+            for (uint64_t byteIndex = offset; byteIndex < offset + allocationSize; byteIndex++)
+            {
+                tknAssert(0xFF == owners[byteIndex], "Allocations overlap at %llu", (unsigned long long)byteIndex);
+                owners[byteIndex] = (unsigned char)slotIndex;
+            }
+            nodeIndices[slotIndex] = nodeIndex;
+            offsets[slotIndex] = offset;
+            sizes[slotIndex] = allocationSize;
+        }
+        else
+        {
+            memset(owners + offsets[slotIndex], 0xFF, sizes[slotIndex]);
+            tknFreeToTlsf(&tknTlsf, nodeIndices[slotIndex]);
+            nodeIndices[slotIndex] = TKN_TLSF_NULL_NODE;
+        }
+    }
+    for (uint32_t slotIndex = 0; slotIndex < slotCount; slotIndex++)
+    {
+        if (nodeIndices[slotIndex] != TKN_TLSF_NULL_NODE)
+        {
+            tknFreeToTlsf(&tknTlsf, nodeIndices[slotIndex]);
+        }
+    }
+    tknAssert(0 == tknTlsf.allocationCount && size == tknTlsf.freeSize, "Allocator did not return to empty");
+    tknAssert(size == tknGetTlsfLargestFreeSize(&tknTlsf), "Free nodes did not merge back into one range");
+    tknFree(owners);
+    tknDestroyTlsf(tknTlsf);
+    printf("Random passed, %u allocations did not fit\n", failedCount);
+}
+
+int main()
+{
+    test_tlsf_alignment_and_merge();
+    test_tlsf_random();
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <string.h>
+#include "tknCore.h"
+
+#define TEST_TASK_COUNT 1000
+#define TEST_WORKER_THREAD_COUNT 3
+
+typedef struct
+{
+    uint32_t taskRunCounts[TEST_TASK_COUNT];
+    uint32_t workerTaskCounts[TEST_WORKER_THREAD_COUNT + 1];
+} TestWorkerContext;
+
+static void test_worker_task(void *pContext, uint32_t taskIndex, uint32_t workerIndex)
+{
+    TestWorkerContext *pTestWorkerContext = pContext;
+    // Every task index is handed out once, so no two workers write the same slot
+    pTestWorkerContext->taskRunCounts[taskIndex]++;
+    __atomic_fetch_add(&pTestWorkerContext->workerTaskCounts[workerIndex], 1, __ATOMIC_RELAXED);
+    void *data = tknAllocateScratch(64);
+    memset(data, (int)taskIndex, 64);
+}
+
+static void test_worker_pool_runs_every_task_once()
+{
+    printf("--- worker pool every task once test ---\n");
+    TknWorkerPool *pTknWorkerPool = tknCreateWorkerPoolPtr(TEST_WORKER_THREAD_COUNT);
+    tknAssert(tknGetWorkerCount(pTknWorkerPool) == TEST_WORKER_THREAD_COUNT + 1, "Caller should count as a worker");
+    for (uint32_t run = 0; run < 16; run++)
+    {
+        TestWorkerContext testWorkerContext = {0};
+        tknRunOnWorkerPool(pTknWorkerPool, TEST_TASK_COUNT, test_worker_task, &testWorkerContext);
+        uint32_t totalCount = 0;
+        for (uint32_t taskIndex = 0; taskIndex < TEST_TASK_COUNT; taskIndex++)
+        {
+            tknAssert(testWorkerContext.taskRunCounts[taskIndex] == 1, "Task %u ran %u times in run %u", taskIndex, testWorkerContext.taskRunCounts[taskIndex], run);
+        }
+        for (uint32_t workerIndex = 0; workerIndex <= TEST_WORKER_THREAD_COUNT; workerIndex++)
+        {
+            totalCount += testWorkerContext.workerTaskCounts[workerIndex];
+        }
+        tknAssert(totalCount == TEST_TASK_COUNT, "Workers ran %u tasks instead of %u", totalCount, TEST_TASK_COUNT);
+    }
+    tknDestroyWorkerPoolPtr(pTknWorkerPool);
+    printf("Every task once passed\n");
+}
+
+static void test_worker_pool_small_batches()
+{
+    printf("--- worker pool small batch test ---\n");
+    TknWorkerPool *pTknWorkerPool = tknCreateWorkerPoolPtr(TEST_WORKER_THREAD_COUNT);
+    TestWorkerContext testWorkerContext = {0};
+    tknRunOnWorkerPool(pTknWorkerPool, 0, test_worker_task, &testWorkerContext);
+    tknRunOnWorkerPool(pTknWorkerPool, 1, test_worker_task, &testWorkerContext);
+    tknAssert(testWorkerContext.taskRunCounts[0] == 1, "Single task did not run");
+    tknAssert(testWorkerContext.workerTaskCounts[0] == 1, "Single task should run on the caller");
+    tknDestroyWorkerPoolPtr(pTknWorkerPool);
+
+    // No threads at all still runs everything on the caller
+    pTknWorkerPool = tknCreateWorkerPoolPtr(0);
+    memset(&testWorkerContext, 0, sizeof(testWorkerContext));
+    tknRunOnWorkerPool(pTknWorkerPool, 8, test_worker_task, &testWorkerContext);
+    tknAssert(testWorkerContext.workerTaskCounts[0] == 8, "Caller should run all tasks without threads");
+    tknDestroyWorkerPoolPtr(pTknWorkerPool);
+    printf("Small batches passed\n");
+}
+
+int main()
+{
+    test_worker_pool_runs_every_task_once();
+    test_worker_pool_small_batches();
+    tknDestroyScratchArena();
+    printf("All worker pool tests passed\n");
+    return 0;
+}